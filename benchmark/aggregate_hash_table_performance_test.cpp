@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <benchmark/benchmark.h>
 
+#include "common/lang/algorithm.h"
 #include "common/lang/memory.h"
 #include "common/lang/vector.h"
 #include "sql/expr/aggregate_hash_table.h"
@@ -41,31 +42,80 @@ protected:
   Chunk aggr_chunk_;
 };
 
-class DISABLED_StandardAggregateHashTableBenchmark : public AggregateHashTableBenchmark
+/**
+ * 分组列为 (key / 1024, key % 1024) 两个 int 列，聚合为 sum(val) 和 count(*)，参数为分组数。
+ * 输入至少有 MIN_ROWS 行，且键是打乱的，每个分组都会出现。
+ */
+class StandardAggregateHashTableBenchmark : public benchmark::Fixture
 {
 public:
+  static constexpr int64_t MIN_ROWS = 4 * 1024 * 1024;
+
   void SetUp(const ::benchmark::State &state) override
   {
+    const int64_t groups = state.range(0);
+    rows_                = std::max(groups, MIN_ROWS);
+    for (int64_t begin = 0; begin < rows_; begin += Chunk::MAX_ROWS) {
+      auto group1 = make_unique<Column>(AttrType::INTS, 4);
+      auto group2 = make_unique<Column>(AttrType::INTS, 4);
+      auto val    = make_unique<Column>(AttrType::INTS, 4);
+      auto one    = make_unique<Column>(AttrType::INTS, 4);
+      for (int64_t i = begin; i < std::min(begin + Chunk::MAX_ROWS, rows_); i++) {
+        // 2654435761 是与分组数互质的素数，i % groups 的每个值都会出现
+        int key  = static_cast<int>((i % groups) * 2654435761ULL % groups);
+        int key1 = key / 1024;
+        int key2 = key % 1024;
+        int v    = static_cast<int>(i);
+        int c    = 1;
+        group1->append_one((char *)&key1);
+        group2->append_one((char *)&key2);
+        val->append_one((char *)&v);
+        one->append_one((char *)&c);
+      }
+      Chunk group_chunk;
+      Chunk aggr_chunk;
+      group_chunk.add_column(std::move(group1), 0);
+      group_chunk.add_column(std::move(group2), 1);
+      aggr_chunk.add_column(std::move(val), 0);
+      aggr_chunk.add_column(std::move(one), 1);
+      group_chunks_.push_back(std::move(group_chunk));
+      aggr_chunks_.push_back(std::move(aggr_chunk));
+    }
 
-    AggregateHashTableBenchmark::SetUp(state);
-    AggregateExpr        aggregate_expr(AggregateExpr::Type::SUM, nullptr);
-    vector<Expression *> aggregate_exprs;
-    aggregate_exprs.push_back(&aggregate_expr);
-    standard_hash_table_ = make_unique<StandardAggregateHashTable>(aggregate_exprs);
+    sum_   = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, make_unique<ValueExpr>(Value(0)));
+    count_ = make_unique<AggregateExpr>(AggregateExpr::Type::COUNT, make_unique<ValueExpr>(Value(1)));
+  }
+
+  void TearDown(const ::benchmark::State &state) override
+  {
+    group_chunks_.clear();
+    aggr_chunks_.clear();
   }
 
 protected:
-  unique_ptr<AggregateHashTable> standard_hash_table_;
+  int64_t                   rows_ = 0;
+  vector<Chunk>             group_chunks_;
+  vector<Chunk>             aggr_chunks_;
+  unique_ptr<AggregateExpr> sum_;
+  unique_ptr<AggregateExpr> count_;
 };
 
-BENCHMARK_DEFINE_F(DISABLED_StandardAggregateHashTableBenchmark, Aggregate)(benchmark::State &state)
+BENCHMARK_DEFINE_F(StandardAggregateHashTableBenchmark, Aggregate)(benchmark::State &state)
 {
   for (auto _ : state) {
-    standard_hash_table_->add_chunk(group_chunk_, aggr_chunk_);
+    StandardAggregateHashTable hash_table({sum_.get(), count_.get()});
+    for (size_t i = 0; i < group_chunks_.size(); i++) {
+      hash_table.add_chunk(group_chunks_[i], aggr_chunks_[i]);
+    }
   }
+  state.SetItemsProcessed(state.iterations() * rows_);
 }
 
-BENCHMARK_REGISTER_F(DISABLED_StandardAggregateHashTableBenchmark, Aggregate)->Arg(16)->Arg(1024)->Arg(8192);
+BENCHMARK_REGISTER_F(StandardAggregateHashTableBenchmark, Aggregate)
+    ->Arg(1000)
+    ->Arg(1000 * 1000)
+    ->Arg(10 * 1000 * 1000)
+    ->Unit(benchmark::kMillisecond);
 
 #ifdef USE_SIMD
 class DISABLED_LinearProbingAggregateHashTableBenchmark : public AggregateHashTableBenchmark
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <dirent.h>
+#include <limits.h>
 #include <iostream>
 #include <stdio.h>
 #include <sys/stat.h>
@@ -20,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include <unistd.h>
 
 #include "common/io/io.h"
+#include "common/lang/algorithm.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/math/regex.h"
@@ -386,4 +388,97 @@ int readn(int fd, void *buf, int size)
   }
   return 0;
 }
+
+int pwriten(int fd, const void *buf, int size, off_t offset)
+{
+  const char *tmp = (const char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pwrite(fd, tmp, size, offset);
+    if (ret >= 0) {
+      tmp += ret;
+      size -= ret;
+      offset += ret;
+      continue;
+    }
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+int preadn(int fd, void *buf, int size, off_t offset)
+{
+  char *tmp = (char *)buf;
+  while (size > 0) {
+    const ssize_t ret = ::pread(fd, tmp, size, offset);
+    if (ret > 0) {
+      tmp += ret;
+      size -= ret;
+      offset += ret;
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // end of file
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+/// 跳过已经读写完成的数据，返回剩余的第一个 iovec 的位置
+static int advance_iovec(vector<struct iovec> &iovs, int index, size_t done)
+{
+  while (index < static_cast<int>(iovs.size()) && done >= iovs[index].iov_len) {
+    done -= iovs[index].iov_len;
+    index++;
+  }
+  if (index < static_cast<int>(iovs.size())) {
+    iovs[index].iov_base = (char *)iovs[index].iov_base + done;
+    iovs[index].iov_len -= done;
+  }
+  return index;
+}
+
+int pwritevn(int fd, const struct iovec *iov, int iovcnt, off_t offset)
+{
+  // 部分写入时需要调整 iovec，所以复制一份
+  vector<struct iovec> iovs(iov, iov + iovcnt);
+  int                  index = advance_iovec(iovs, 0, 0);
+  while (index < iovcnt) {
+    const ssize_t ret = ::pwritev(fd, iovs.data() + index, std::min(iovcnt - index, IOV_MAX), offset);
+    if (ret >= 0) {
+      offset += ret;
+      index = advance_iovec(iovs, index, ret);
+      continue;
+    }
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
+
+int preadvn(int fd, const struct iovec *iov, int iovcnt, off_t offset)
+{
+  vector<struct iovec> iovs(iov, iov + iovcnt);
+  int                  index = advance_iovec(iovs, 0, 0);
+  while (index < iovcnt) {
+    const ssize_t ret = ::preadv(fd, iovs.data() + index, std::min(iovcnt - index, IOV_MAX), offset);
+    if (ret > 0) {
+      offset += ret;
+      index = advance_iovec(iovs, index, ret);
+      continue;
+    }
+    if (0 == ret)
+      return -1;  // end of file
+
+    const int err = errno;
+    if (EAGAIN != err && EINTR != err)
+      return err;
+  }
+  return 0;
+}
 }  // namespace common
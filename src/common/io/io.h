@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include <sys/types.h>
+#include <sys/uio.h>
 #include <vector>
 
 #include "common/defs.h"
@@ -77,4 +79,30 @@ int writen(int fd, const void *buf, int size);
  */
 int readn(int fd, void *buf, int size);
 
+/**
+ * @brief 在指定位置一次性写入所有指定数据
+ * @details 不修改文件的读写位置，多个线程可以同时在同一个描述符上读写
+ * @return int 0 表示成功，否则返回errno
+ */
+int pwriten(int fd, const void *buf, int size, off_t offset);
+
+/**
+ * @brief 从指定位置一次性读取指定长度的数据
+ * @return int 返回0表示成功。-1 表示读取到文件尾，并且没有读到size大小数据，其它表示errno
+ */
+int preadn(int fd, void *buf, int size, off_t offset);
+
+/**
+ * @brief 把多块内存写到文件中从 offset 开始的连续位置
+ * @details 一次系统调用写入多块数据，iov 的数量超过 IOV_MAX 时分多次写入
+ * @return int 0 表示成功，否则返回errno
+ */
+int pwritevn(int fd, const struct iovec *iov, int iovcnt, off_t offset);
+
+/**
+ * @brief 把文件中从 offset 开始的连续数据读到多块内存中
+ * @return int 返回0表示成功。-1 表示读取到文件尾，并且没有读满所有内存，其它表示errno
+ */
+int preadvn(int fd, const struct iovec *iov, int iovcnt, off_t offset);
+
 }  // namespace common
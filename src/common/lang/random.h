@@ -13,5 +13,6 @@ See the Mulan PSL v2 for more details. */
 #include <random>
 
 using std::mt19937;
+using std::mt19937_64;
 using std::random_device;
 using std::uniform_int_distribution;
\ No newline at end of file
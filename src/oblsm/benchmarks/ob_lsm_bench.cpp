@@ -1,2 +1,806 @@
-// TODO: add oblsm bench tool, reference leveldb db_bench
-int main() { return 0; }
\ No newline at end of file
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// A benchmark tool for oblsm, in the style of leveldb's db_bench.
+//
+// Usage: oblsm_bench --benchmarks=fillseq,readrandom --num=1000000 --value_size=100 ...
+// Run `oblsm_bench --help` for all the flags.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+
+#include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/fstream.h"
+#include "common/lang/functional.h"
+#include "common/lang/memory.h"
+#include "common/lang/random.h"
+#include "common/lang/sstream.h"
+#include "common/lang/string.h"
+#include "common/lang/thread.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "oblsm/include/ob_lsm.h"
+#include "oblsm/include/ob_lsm_iterator.h"
+#include "oblsm/include/ob_lsm_options.h"
+#include "oblsm/include/ob_lsm_write_batch.h"
+
+using namespace oceanbase;
+
+namespace {
+
+struct BenchFlags
+{
+  // comma separated benchmarks to run, in order
+  string benchmarks = "fillseq,fillrandom,overwrite,readrandom,readseq,readmissing,seekrandom,readrandomwriterandom";
+  string db         = "oblsm_bench_db";
+  // number of key/value pairs of the database
+  int64_t num = 100000;
+  // number of reads, -1 means `num`
+  int64_t reads   = -1;
+  int     threads = 1;
+  int     key_size   = 16;
+  int     value_size = 100;
+  // the values can be compressed to this ratio of their size
+  double compression_ratio = 0.5;
+  // number of entries of a write batch, 1 means single puts
+  int batch_size = 1;
+  // number of `next` after a seek in seekrandom
+  int seek_nexts = 10;
+  // percentage of reads in readrandomwriterandom
+  int     read_write_percent = 90;
+  bool    use_existing_db    = false;
+  int64_t seed               = 301;
+  // print the latency histogram of every benchmark
+  bool histogram = false;
+
+  ObLsmOptions options;
+};
+
+BenchFlags FLAGS;
+
+void print_usage()
+{
+  const ObLsmOptions defaults;
+  printf(R"(Usage: oblsm_bench [--flag=value]...
+
+Benchmarks (--benchmarks=a,b,...):
+  fillseq               write N values in sequential key order into a new database
+  fillrandom            write N values in random key order into a new database
+  fillbatch             write N values in sequential key order in batches of --batch_size
+  overwrite             overwrite N values in random key order
+  readrandom            read N times in random key order
+  readseq               read N times sequentially with an iterator
+  readmissing           read N missing keys in random order
+  seekrandom            N random seeks, each followed by --seek_nexts nexts
+  readrandomwriterandom N random operations, --read_write_percent of them are reads
+  stats                 print the sstables of each level and the write stall statistics
+
+Workload flags:
+  --db=%s --num=%ld --reads=-1 --threads=%d --key_size=%d --value_size=%d
+  --compression_ratio=%.2f --batch_size=%d --seek_nexts=%d --read_write_percent=%d
+  --use_existing_db=0 --seed=%ld --histogram=0
+
+ObLsmOptions flags:
+  --memtable_size=%lu --table_size=%lu --levels=%lu --l1_level_size=%lu --level_ratio=%lu
+  --l0_file_num=%lu --run_num=%lu --compaction_style=leveled|tiered --bloom_bits=%lu --compression=none|lz4
+  --cache_size=%lu --cache_shards=%lu --sync=%d --concurrent_memtable_write=%d
+  --max_immutable_memtables=%lu --l0_slowdown_trigger=%lu --l0_stop_trigger=%lu
+  --slowdown_delay_us=%lu --max_subcompactions=%lu --compaction_rate_limit=%lu
+)",
+      FLAGS.db.c_str(), FLAGS.num, FLAGS.threads, FLAGS.key_size, FLAGS.value_size, FLAGS.compression_ratio,
+      FLAGS.batch_size, FLAGS.seek_nexts, FLAGS.read_write_percent, FLAGS.seed,
+      defaults.memtable_size, defaults.table_size, defaults.default_levels, defaults.default_l1_level_size,
+      defaults.default_level_ratio, defaults.default_l0_file_num, defaults.default_run_num,
+      defaults.bloom_filter_bits_per_key, defaults.block_cache_capacity, defaults.block_cache_shard_num,
+      defaults.force_sync_new_log, defaults.allow_concurrent_memtable_write, defaults.max_immutable_memtables,
+      defaults.level0_slowdown_writes_trigger, defaults.level0_stop_writes_trigger, defaults.slowdown_delay_us,
+      defaults.max_subcompactions, defaults.compaction_rate_limit);
+}
+
+/**
+ * @brief Parses `--name=value` flags into FLAGS, returns false if a flag is unknown or malformed.
+ */
+bool parse_flags(int argc, char **argv)
+{
+  ObLsmOptions &opt = FLAGS.options;
+  // the integer flags
+  vector<pair<const char *, function<void(int64_t)>>> int_flags = {
+      {"num", [](int64_t v) { FLAGS.num = v; }},
+      {"reads", [](int64_t v) { FLAGS.reads = v; }},
+      {"threads", [](int64_t v) { FLAGS.threads = std::max<int>(v, 1); }},
+      {"key_size", [](int64_t v) { FLAGS.key_size = std::max<int>(v, 1); }},
+      {"value_size", [](int64_t v) { FLAGS.value_size = std::max<int>(v, 0); }},
+      {"batch_size", [](int64_t v) { FLAGS.batch_size = std::max<int>(v, 1); }},
+      {"seek_nexts", [](int64_t v) { FLAGS.seek_nexts = std::max<int>(v, 0); }},
+      {"read_write_percent", [](int64_t v) { FLAGS.read_write_percent = v; }},
+      {"use_existing_db", [](int64_t v) { FLAGS.use_existing_db = v != 0; }},
+      {"seed", [](int64_t v) { FLAGS.seed = v; }},
+      {"histogram", [](int64_t v) { FLAGS.histogram = v != 0; }},
+      {"memtable_size", [&opt](int64_t v) { opt.memtable_size = v; }},
+      {"table_size", [&opt](int64_t v) { opt.table_size = v; }},
+      {"levels", [&opt](int64_t v) { opt.default_levels = v; }},
+      {"l1_level_size", [&opt](int64_t v) { opt.default_l1_level_size = v; }},
+      {"level_ratio", [&opt](int64_t v) { opt.default_level_ratio = v; }},
+      {"l0_file_num", [&opt](int64_t v) { opt.default_l0_file_num = v; }},
+      {"run_num", [&opt](int64_t v) { opt.default_run_num = v; }},
+      {"bloom_bits", [&opt](int64_t v) { opt.bloom_filter_bits_per_key = v; }},
+      {"cache_size", [&opt](int64_t v) { opt.block_cache_capacity = v; }},
+      {"cache_shards", [&opt](int64_t v) { opt.block_cache_shard_num = v; }},
+      {"sync", [&opt](int64_t v) { opt.force_sync_new_log = v != 0; }},
+      {"concurrent_memtable_write", [&opt](int64_t v) { opt.allow_concurrent_memtable_write = v != 0; }},
+      {"max_immutable_memtables", [&opt](int64_t v) { opt.max_immutable_memtables = v; }},
+      {"l0_slowdown_trigger", [&opt](int64_t v) { opt.level0_slowdown_writes_trigger = v; }},
+      {"l0_stop_trigger", [&opt](int64_t v) { opt.level0_stop_writes_trigger = v; }},
+      {"slowdown_delay_us", [&opt](int64_t v) { opt.slowdown_delay_us = v; }},
+      {"max_subcompactions", [&opt](int64_t v) { opt.max_subcompactions = v; }},
+      {"compaction_rate_limit", [&opt](int64_t v) { opt.compaction_rate_limit = v; }},
+  };
+
+  for (int i = 1; i < argc; i++) {
+    string arg = argv[i];
+    if (arg == "--help" || arg == "-h") {
+      return false;
+    }
+    size_t eq = arg.find('=');
+    if (arg.compare(0, 2, "--") != 0 || eq == string::npos) {
+      fprintf(stderr, "invalid flag: %s\n", arg.c_str());
+      return false;
+    }
+    string name  = arg.substr(2, eq - 2);
+    string value = arg.substr(eq + 1);
+
+    if (name == "benchmarks") {
+      FLAGS.benchmarks = value;
+      continue;
+    } else if (name == "db") {
+      FLAGS.db = value;
+      continue;
+    } else if (name == "compression_ratio") {
+      FLAGS.compression_ratio = std::stod(value);
+      continue;
+    } else if (name == "compaction_style") {
+      if (value == "leveled") {
+        opt.type = CompactionType::LEVELED;
+      } else if (value == "tiered") {
+        opt.type = CompactionType::TIRED;
+      } else {
+        fprintf(stderr, "unknown compaction style: %s\n", value.c_str());
+        return false;
+      }
+      continue;
+    } else if (name == "compression") {
+      if (value == "none") {
+        opt.compression = CompressionType::NONE;
+      } else if (value == "lz4") {
+        opt.compression = CompressionType::LZ4;
+      } else {
+        fprintf(stderr, "unknown compression: %s\n", value.c_str());
+        return false;
+      }
+      continue;
+    }
+
+    auto iter = std::find_if(int_flags.begin(), int_flags.end(), [&name](const auto &f) { return name == f.first; });
+    if (iter == int_flags.end()) {
+      fprintf(stderr, "unknown flag: %s\n", arg.c_str());
+      return false;
+    }
+    char   *end = nullptr;
+    int64_t v   = strtoll(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0') {
+      fprintf(stderr, "invalid value of flag: %s\n", arg.c_str());
+      return false;
+    }
+    iter->second(v);
+  }
+  if (FLAGS.reads < 0) {
+    FLAGS.reads = FLAGS.num;
+  }
+  return true;
+}
+
+uint64_t now_nanos()
+{
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Latency histogram with exponential buckets, the percentiles are interpolated in a bucket.
+ */
+class Histogram
+{
+public:
+  Histogram() : buckets_(bucket_limits().size(), 0) {}
+
+  void add(uint64_t nanos)
+  {
+    const vector<uint64_t> &limits = bucket_limits();
+    size_t                  b      = std::upper_bound(limits.begin(), limits.end(), nanos) - limits.begin();
+    buckets_[std::min(b, limits.size() - 1)]++;
+    min_ = std::min(min_, nanos);
+    max_ = std::max(max_, nanos);
+    count_++;
+    sum_ += nanos;
+  }
+
+  void merge(const Histogram &other)
+  {
+    for (size_t i = 0; i < buckets_.size(); i++) {
+      buckets_[i] += other.buckets_[i];
+    }
+    min_ = std::min(min_, other.min_);
+    max_ = std::max(max_, other.max_);
+    count_ += other.count_;
+    sum_ += other.sum_;
+  }
+
+  uint64_t count() const { return count_; }
+  double   average_micros() const { return count_ == 0 ? 0 : sum_ / 1000.0 / count_; }
+
+  double percentile_micros(double p) const
+  {
+    const vector<uint64_t> &limits    = bucket_limits();
+    double                  threshold = count_ * (p / 100.0);
+    double                  sum       = 0;
+    for (size_t b = 0; b < buckets_.size(); b++) {
+      sum += buckets_[b];
+      if (sum >= threshold && buckets_[b] > 0) {
+        // interpolate in the bucket
+        double left  = b == 0 ? 0 : limits[b - 1];
+        double right = limits[b];
+        double pos   = (threshold - (sum - buckets_[b])) / buckets_[b];
+        double r     = left + (right - left) * pos;
+        r            = std::max<double>(r, min_);
+        r            = std::min<double>(r, max_);
+        return r / 1000.0;
+      }
+    }
+    return max_ / 1000.0;
+  }
+
+  string to_string() const
+  {
+    char buf[512];
+    snprintf(buf, sizeof(buf),
+        "Latency (micros): avg %.2f, P50 %.2f, P95 %.2f, P99 %.2f, P99.9 %.2f, P99.99 %.2f, max %.2f",
+        average_micros(), percentile_micros(50), percentile_micros(95), percentile_micros(99),
+        percentile_micros(99.9), percentile_micros(99.99), count_ == 0 ? 0 : max_ / 1000.0);
+    string result = buf;
+    if (!FLAGS.histogram) {
+      return result;
+    }
+
+    // the buckets with data
+    const vector<uint64_t> &limits = bucket_limits();
+    double                  cumulative = 0;
+    result.append("\n  ------------------------------------------------------");
+    for (size_t b = 0; b < buckets_.size(); b++) {
+      if (buckets_[b] == 0) {
+        continue;
+      }
+      cumulative += buckets_[b];
+      snprintf(buf, sizeof(buf), "\n  [ %10.2f, %10.2f ) %10" PRIu64 " %7.3f%% %7.3f%%", b == 0 ? 0 : limits[b - 1] / 1000.0,
+          limits[b] / 1000.0, buckets_[b], 100.0 * buckets_[b] / count_, 100.0 * cumulative / count_);
+      result.append(buf);
+    }
+    return result;
+  }
+
+private:
+  // upper bounds of the buckets in nanoseconds, growing by 20%
+  static const vector<uint64_t> &bucket_limits()
+  {
+    static const vector<uint64_t> limits = []() {
+      vector<uint64_t> v;
+      for (double limit = 100; limit < 1e12; limit *= 1.2) {
+        v.push_back(static_cast<uint64_t>(limit));
+      }
+      v.push_back(UINT64_MAX);
+      return v;
+    }();
+    return limits;
+  }
+
+  vector<uint64_t> buckets_;
+  uint64_t         min_   = UINT64_MAX;
+  uint64_t         max_   = 0;
+  uint64_t         count_ = 0;
+  double           sum_   = 0;
+};
+
+/**
+ * @brief Generates the values, each of them can be compressed to about `compression_ratio`.
+ */
+class ValueGenerator
+{
+public:
+  ValueGenerator()
+  {
+    // a piece of random data repeated, the values are cut from it
+    mt19937_64 rnd(FLAGS.seed);
+    size_t     piece_len = std::max<size_t>(1, 100 * FLAGS.compression_ratio);
+    while (data_.size() < 1024 * 1024) {
+      string piece;
+      for (size_t i = 0; i < piece_len; i++) {
+        piece.push_back(' ' + rnd() % 95);
+      }
+      while (piece.size() < 100) {
+        piece.append(piece, 0, std::min<size_t>(piece_len, 100 - piece.size()));
+      }
+      data_.append(piece);
+    }
+  }
+
+  string_view generate(size_t len)
+  {
+    if (pos_ + len > data_.size()) {
+      pos_ = 0;
+    }
+    pos_ += len;
+    return string_view(data_).substr(pos_ - len, len);
+  }
+
+private:
+  string data_;
+  size_t pos_ = 0;
+};
+
+/**
+ * @brief The bytes read and written by the process, from /proc/self/io.
+ * Used for the read and write amplification, the reads of the block cache are not counted.
+ */
+struct IoCounters
+{
+  int64_t read_bytes  = -1;
+  int64_t write_bytes = -1;
+
+  static IoCounters current()
+  {
+    IoCounters counters;
+    ifstream   in("/proc/self/io");
+    string     name;
+    int64_t    value = 0;
+    while (in >> name >> value) {
+      if (name == "rchar:") {
+        counters.read_bytes = value;
+      } else if (name == "wchar:") {
+        counters.write_bytes = value;
+      }
+    }
+    return counters;
+  }
+};
+
+/**
+ * @brief The result of a thread, merged into the result of the benchmark.
+ */
+struct ThreadStats
+{
+  Histogram hist;
+  int64_t   done          = 0;  ///< number of operations
+  int64_t   found         = 0;  ///< number of keys found by reads
+  int64_t   bytes_written = 0;  ///< user bytes (key + value) written
+  int64_t   bytes_read    = 0;  ///< user bytes (key + value) read
+
+  void finished_op(uint64_t begin_nanos)
+  {
+    hist.add(now_nanos() - begin_nanos);
+    done++;
+  }
+
+  void merge(const ThreadStats &other)
+  {
+    hist.merge(other.hist);
+    done += other.done;
+    found += other.found;
+    bytes_written += other.bytes_written;
+    bytes_read += other.bytes_read;
+  }
+};
+
+struct ThreadState
+{
+  int            tid;
+  mt19937_64     rnd;
+  ValueGenerator values;
+  ThreadStats    stats;
+
+  explicit ThreadState(int id) : tid(id), rnd(FLAGS.seed + id) {}
+};
+
+class Benchmark;
+
+struct BenchmarkSpec
+{
+  const char *name;
+  void (Benchmark::*method)(ThreadState *);
+  bool fresh_db;  ///< runs on a new database
+  bool write;     ///< writes, the space amplification and write stalls are reported
+};
+
+class Benchmark
+{
+public:
+  ~Benchmark() { delete db_; }
+
+  void run()
+  {
+    print_header();
+    if (!FLAGS.use_existing_db) {
+      filesystem::remove_all(FLAGS.db);
+    }
+    open_db();
+
+    std::stringstream ss(FLAGS.benchmarks);
+    string            name;
+    while (std::getline(ss, name, ',')) {
+      if (name.empty()) {
+        continue;
+      }
+      if (name == "stats") {
+        print_stats();
+        continue;
+      }
+      const vector<BenchmarkSpec> &specs = benchmark_specs();
+      auto spec = std::find_if(specs.begin(), specs.end(), [&name](const BenchmarkSpec &b) { return name == b.name; });
+      if (spec == specs.end()) {
+        fprintf(stderr, "unknown benchmark '%s'\n", name.c_str());
+        continue;
+      }
+      const bool fresh_db = spec->fresh_db;
+
+      if (fresh_db && FLAGS.use_existing_db) {
+        fprintf(stdout, "%-21s : skipped (--use_existing_db is true)\n", name.c_str());
+        continue;
+      }
+      if (fresh_db) {
+        delete db_;
+        db_ = nullptr;
+        filesystem::remove_all(FLAGS.db);
+        open_db();
+      }
+      run_benchmark(name, spec->method, spec->write);
+    }
+  }
+
+private:
+  void open_db()
+  {
+    filesystem::create_directories(FLAGS.db);
+    RC rc = ObLsm::open(FLAGS.options, FLAGS.db, &db_);
+    if (OB_FAIL(rc)) {
+      fprintf(stderr, "failed to open oblsm at %s. rc=%s\n", FLAGS.db.c_str(), strrc(rc));
+      exit(1);
+    }
+  }
+
+  void print_header()
+  {
+    const ObLsmOptions &opt = FLAGS.options;
+    fprintf(stdout, "Keys:       %d bytes each\n", FLAGS.key_size);
+    fprintf(stdout, "Values:     %d bytes each (%d bytes after compression)\n", FLAGS.value_size,
+        static_cast<int>(FLAGS.value_size * FLAGS.compression_ratio + 0.5));
+    fprintf(stdout, "Entries:    %ld\n", FLAGS.num);
+    fprintf(stdout, "Threads:    %d\n", FLAGS.threads);
+    fprintf(stdout, "RawSize:    %.1f MB (estimated)\n",
+        (FLAGS.key_size + FLAGS.value_size) * static_cast<double>(FLAGS.num) / 1048576.0);
+    fprintf(stdout, "Compaction: %s, memtable %lu, table %lu, levels %lu, l1 %lu, ratio %lu, l0 files %lu\n",
+        opt.type == CompactionType::LEVELED ? "leveled" : "tiered", opt.memtable_size, opt.table_size,
+        opt.default_levels, opt.default_l1_level_size, opt.default_level_ratio, opt.default_l0_file_num);
+    fprintf(stdout, "Cache:      %lu bytes, %lu shards, bloom filter %lu bits per key\n", opt.block_cache_capacity,
+        opt.block_cache_shard_num, opt.bloom_filter_bits_per_key);
+    fprintf(stdout, "Blocks:     %s compression\n", opt.compression == CompressionType::NONE ? "no" : "lz4");
+    fprintf(stdout, "------------------------------------------------\n");
+  }
+
+  void run_benchmark(const string &name, void (Benchmark::*method)(ThreadState *), bool write_benchmark)
+  {
+    vector<unique_ptr<ThreadState>> states;
+    for (int i = 0; i < FLAGS.threads; i++) {
+      states.emplace_back(make_unique<ThreadState>(i));
+    }
+
+    ObLsmWriteStallStats stall_before = db_->write_stall_stats();
+    IoCounters           io_before    = IoCounters::current();
+    uint64_t             begin        = now_nanos();
+    vector<thread>       threads;
+    for (auto &state : states) {
+      threads.emplace_back([this, method, &state]() { (this->*method)(state.get()); });
+    }
+    for (auto &t : threads) {
+      t.join();
+    }
+    uint64_t   elapsed  = now_nanos() - begin;
+    IoCounters io_after = IoCounters::current();
+
+    ThreadStats stats;
+    for (auto &state : states) {
+      stats.merge(state->stats);
+    }
+    report(name, stats, elapsed, io_before, io_after, stall_before, write_benchmark);
+  }
+
+  void report(const string &name, const ThreadStats &stats, uint64_t elapsed_nanos, const IoCounters &io_before,
+      const IoCounters &io_after, const ObLsmWriteStallStats &stall_before, bool write_benchmark)
+  {
+    double seconds = elapsed_nanos / 1e9;
+    int64_t user_bytes = stats.bytes_written + stats.bytes_read;
+    string  extra;
+    char    buf[256];
+    if (user_bytes > 0 && seconds > 0) {
+      snprintf(buf, sizeof(buf), "%6.1f MB/s", user_bytes / 1048576.0 / seconds);
+      extra.append(buf);
+    }
+    if (stats.bytes_read > 0 || name.compare(0, 4, "read") == 0 || name == "seekrandom") {
+      snprintf(buf, sizeof(buf), "%s(%ld of %ld found)", extra.empty() ? "" : "; ", stats.found, stats.done);
+      extra.append(buf);
+    }
+    fprintf(stdout, "%-21s : %11.3f micros/op; %10.0f ops/s; %s\n", name.c_str(),
+        stats.done == 0 ? 0 : elapsed_nanos / 1000.0 / stats.done, stats.done / std::max(seconds, 1e-9),
+        extra.c_str());
+    fprintf(stdout, "%-21s   %s\n", "", stats.hist.to_string().c_str());
+
+    // amplification, the bytes of the background flushes and compactions that are still running
+    // after the benchmark are not counted
+    string amplification;
+    if (io_before.write_bytes >= 0 && stats.bytes_written > 0) {
+      snprintf(buf, sizeof(buf), "write amp %.2f",
+          static_cast<double>(io_after.write_bytes - io_before.write_bytes) / stats.bytes_written);
+      amplification.append(buf);
+    }
+    if (io_before.read_bytes >= 0 && stats.bytes_read > 0) {
+      snprintf(buf, sizeof(buf), "%sread amp %.2f", amplification.empty() ? "" : ", ",
+          static_cast<double>(io_after.read_bytes - io_before.read_bytes) / stats.bytes_read);
+      amplification.append(buf);
+    }
+    if (write_benchmark) {
+      uint64_t live_bytes = live_data_bytes();
+      uint64_t disk_bytes = disk_usage_bytes();
+      snprintf(buf, sizeof(buf), "%sspace amp %.2f (%.1f MB on disk, %.1f MB live)", amplification.empty() ? "" : ", ",
+          live_bytes == 0 ? 0 : static_cast<double>(disk_bytes) / live_bytes, disk_bytes / 1048576.0,
+          live_bytes / 1048576.0);
+      amplification.append(buf);
+
+      ObLsmWriteStallStats stall = db_->write_stall_stats();
+      snprintf(buf, sizeof(buf), "; stalls: slowdown %lu (%.1f ms), memtable stop %lu (%.1f ms), level0 stop %lu (%.1f ms)",
+          stall.slowdown_count - stall_before.slowdown_count, (stall.slowdown_us - stall_before.slowdown_us) / 1000.0,
+          stall.memtable_stop_count - stall_before.memtable_stop_count,
+          (stall.memtable_stop_us - stall_before.memtable_stop_us) / 1000.0,
+          stall.level0_stop_count - stall_before.level0_stop_count,
+          (stall.level0_stop_us - stall_before.level0_stop_us) / 1000.0);
+      amplification.append(buf);
+    }
+    if (!amplification.empty()) {
+      fprintf(stdout, "%-21s   %s\n", "", amplification.c_str());
+    }
+    fflush(stdout);
+  }
+
+  void print_stats()
+  {
+    db_->dump_sstables();
+    ObLsmWriteStallStats stall = db_->write_stall_stats();
+    fprintf(stdout,
+        "write stalls: slowdown %lu (%.1f ms), memtable stop %lu (%.1f ms), level0 stop %lu (%.1f ms)\n",
+        stall.slowdown_count, stall.slowdown_us / 1000.0, stall.memtable_stop_count, stall.memtable_stop_us / 1000.0,
+        stall.level0_stop_count, stall.level0_stop_us / 1000.0);
+    fprintf(stdout, "disk usage: %.1f MB\n", disk_usage_bytes() / 1048576.0);
+    fflush(stdout);
+  }
+
+  // the bytes of the keys and values visible to a scan
+  uint64_t live_data_bytes()
+  {
+    uint64_t                  bytes = 0;
+    unique_ptr<ObLsmIterator> iter(db_->new_iterator(ObLsmReadOptions()));
+    for (iter->seek_to_first(); iter->valid(); iter->next()) {
+      bytes += iter->key().size() + iter->value().size();
+    }
+    return bytes;
+  }
+
+  uint64_t disk_usage_bytes()
+  {
+    uint64_t        bytes = 0;
+    std::error_code ec;
+    for (const auto &entry : filesystem::recursive_directory_iterator(FLAGS.db, ec)) {
+      if (entry.is_regular_file(ec)) {
+        bytes += entry.file_size(ec);
+      }
+    }
+    return bytes;
+  }
+
+  static string make_key(int64_t k)
+  {
+    char buf[64];
+    int  len = snprintf(buf, sizeof(buf), "%0*" PRId64, std::min(FLAGS.key_size, 40), k);
+    string key(buf, len);
+    if (static_cast<int>(key.size()) < FLAGS.key_size) {
+      key.append(FLAGS.key_size - key.size(), '0');
+    }
+    return key;
+  }
+
+  // the operations of a thread, [begin, end) of num
+  static pair<int64_t, int64_t> thread_range(ThreadState *state, int64_t n)
+  {
+    return {n * state->tid / FLAGS.threads, n * (state->tid + 1) / FLAGS.threads};
+  }
+
+  void do_write(ThreadState *state, bool seq)
+  {
+    auto [begin, end] = thread_range(state, FLAGS.num);
+    for (int64_t i = begin; i < end; i++) {
+      int64_t     k     = seq ? i : state->rnd() % FLAGS.num;
+      string      key   = make_key(k);
+      string_view value = state->values.generate(FLAGS.value_size);
+      uint64_t    start = now_nanos();
+      RC          rc    = db_->put(key, value);
+      if (OB_FAIL(rc)) {
+        fprintf(stderr, "put error: %s\n", strrc(rc));
+        exit(1);
+      }
+      state->stats.bytes_written += key.size() + value.size();
+      state->stats.finished_op(start);
+    }
+  }
+
+  void write_seq(ThreadState *state) { do_write(state, true); }
+  void write_random(ThreadState *state) { do_write(state, false); }
+
+  void write_batch(ThreadState *state)
+  {
+    auto [begin, end] = thread_range(state, FLAGS.num);
+    ObWriteBatch batch;
+    for (int64_t i = begin; i < end; i += FLAGS.batch_size) {
+      batch.clear();
+      int64_t bytes = 0;
+      for (int64_t j = i; j < std::min<int64_t>(i + FLAGS.batch_size, end); j++) {
+        string      key   = make_key(j);
+        string_view value = state->values.generate(FLAGS.value_size);
+        batch.put(key, value);
+        bytes += key.size() + value.size();
+      }
+      uint64_t start = now_nanos();
+      RC       rc    = db_->write(batch);
+      if (OB_FAIL(rc)) {
+        fprintf(stderr, "write batch error: %s\n", strrc(rc));
+        exit(1);
+      }
+      state->stats.bytes_written += bytes;
+      state->stats.finished_op(start);
+    }
+  }
+
+  void read_random(ThreadState *state)
+  {
+    auto [begin, end] = thread_range(state, FLAGS.reads);
+    string value;
+    for (int64_t i = begin; i < end; i++) {
+      string   key   = make_key(state->rnd() % FLAGS.num);
+      uint64_t start = now_nanos();
+      if (OB_SUCC(db_->get(key, &value))) {
+        state->stats.found++;
+        state->stats.bytes_read += key.size() + value.size();
+      }
+      state->stats.finished_op(start);
+    }
+  }
+
+  void read_missing(ThreadState *state)
+  {
+    auto [begin, end] = thread_range(state, FLAGS.reads);
+    string value;
+    for (int64_t i = begin; i < end; i++) {
+      // the keys are in the range of the existing keys but never written
+      string   key   = make_key(state->rnd() % FLAGS.num) + ".";
+      uint64_t start = now_nanos();
+      if (OB_SUCC(db_->get(key, &value))) {
+        state->stats.found++;
+      }
+      state->stats.finished_op(start);
+    }
+  }
+
+  void read_sequential(ThreadState *state)
+  {
+    auto [begin, end] = thread_range(state, FLAGS.reads);
+    unique_ptr<ObLsmIterator> iter(db_->new_iterator(ObLsmReadOptions()));
+    int64_t                   i     = begin;
+    uint64_t                  start = now_nanos();
+    for (iter->seek_to_first(); i < end && iter->valid(); iter->next()) {
+      state->stats.bytes_read += iter->key().size() + iter->value().size();
+      state->stats.found++;
+      state->stats.finished_op(start);
+      start = now_nanos();
+      i++;
+    }
+  }
+
+  void seek_random(ThreadState *state)
+  {
+    auto [begin, end] = thread_range(state, FLAGS.reads);
+    unique_ptr<ObLsmIterator> iter(db_->new_iterator(ObLsmReadOptions()));
+    for (int64_t i = begin; i < end; i++) {
+      string   key   = make_key(state->rnd() % FLAGS.num);
+      uint64_t start = now_nanos();
+      iter->seek(key);
+      if (iter->valid() && iter->key() == key) {
+        state->stats.found++;
+      }
+      for (int j = 0; j < FLAGS.seek_nexts && iter->valid(); j++) {
+        state->stats.bytes_read += iter->key().size() + iter->value().size();
+        iter->next();
+      }
+      state->stats.finished_op(start);
+    }
+  }
+
+  void read_random_write_random(ThreadState *state)
+  {
+    auto [begin, end] = thread_range(state, FLAGS.reads);
+    string value;
+    for (int64_t i = begin; i < end; i++) {
+      string   key   = make_key(state->rnd() % FLAGS.num);
+      uint64_t start = now_nanos();
+      if (static_cast<int>(state->rnd() % 100) < FLAGS.read_write_percent) {
+        if (OB_SUCC(db_->get(key, &value))) {
+          state->stats.found++;
+          state->stats.bytes_read += key.size() + value.size();
+        }
+      } else {
+        string_view new_value = state->values.generate(FLAGS.value_size);
+        RC          rc        = db_->put(key, new_value);
+        if (OB_FAIL(rc)) {
+          fprintf(stderr, "put error: %s\n", strrc(rc));
+          exit(1);
+        }
+        state->stats.bytes_written += key.size() + new_value.size();
+      }
+      state->stats.finished_op(start);
+    }
+  }
+
+  static const vector<BenchmarkSpec> &benchmark_specs()
+  {
+    static const vector<BenchmarkSpec> specs = {
+        {"fillseq", &Benchmark::write_seq, true, true},
+        {"fillrandom", &Benchmark::write_random, true, true},
+        {"fillbatch", &Benchmark::write_batch, true, true},
+        {"overwrite", &Benchmark::write_random, false, true},
+        {"readrandom", &Benchmark::read_random, false, false},
+        {"readseq", &Benchmark::read_sequential, false, false},
+        {"readmissing", &Benchmark::read_missing, false, false},
+        {"seekrandom", &Benchmark::seek_random, false, false},
+        {"readrandomwriterandom", &Benchmark::read_random_write_random, false, true},
+    };
+    return specs;
+  }
+
+private:
+  ObLsm *db_ = nullptr;
+};
+
+}  // namespace
+
+int main(int argc, char **argv)
+{
+  if (!parse_flags(argc, argv)) {
+    print_usage();
+    return 1;
+  }
+  Benchmark benchmark;
+  benchmark.run();
+  return 0;
+}
@@ -10,6 +10,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/compaction/ob_compaction_picker.h"
 #include "common/log/log.h"
+#include "common/lang/algorithm.h"
+#include "oblsm/util/ob_coding.h"
 
 namespace oceanbase {
 
@@ -31,11 +33,112 @@ unique_ptr<ObCompaction> TiredCompactionPicker::pick(SSTablesPtr sstables)
   return compaction;
 }
 
+size_t LeveledCompactionPicker::level_target_size(size_t level) const
+{
+  size_t size = options_->default_l1_level_size;
+  for (size_t i = 1; i < level; i++) {
+    size *= options_->default_level_ratio;
+  }
+  return size;
+}
+
+double LeveledCompactionPicker::level_score(const vector<shared_ptr<ObSSTable>> &tables, size_t level) const
+{
+  // Level 0 is scored by file count rather than bytes: every read checks every file in level 0,
+  // and the files are small if the memtable size is small.
+  if (level == 0) {
+    return static_cast<double>(tables.size()) / max(options_->default_l0_file_num, static_cast<size_t>(1));
+  }
+
+  size_t level_size = 0;
+  for (const auto &sstable : tables) {
+    level_size += sstable->size();
+  }
+  return static_cast<double>(level_size) / level_target_size(level);
+}
+
+void LeveledCompactionPicker::get_overlapping_inputs(const vector<shared_ptr<ObSSTable>> &tables,
+    const string_view &smallest, const string_view &largest, vector<shared_ptr<ObSSTable>> &inputs) const
+{
+  for (const auto &sstable : tables) {
+    if (sstable->block_count() == 0) {
+      continue;
+    }
+    const string first_key = sstable->first_key();
+    const string last_key  = sstable->last_key();
+    if (user_comparator_.compare(extract_user_key(last_key), smallest) < 0 ||
+        user_comparator_.compare(extract_user_key(first_key), largest) > 0) {
+      continue;
+    }
+    inputs.emplace_back(sstable);
+  }
+}
+
+unique_ptr<ObCompaction> LeveledCompactionPicker::pick(SSTablesPtr sstables)
+{
+  // the last level can't be compacted into the next level
+  int    best_level = -1;
+  double best_score = 1;
+  for (size_t level = 0; level + 1 < sstables->size(); level++) {
+    double score = level_score(sstables->at(level), level);
+    if (score >= best_score) {
+      best_level = level;
+      best_score = score;
+    }
+  }
+  if (best_level < 0) {
+    return nullptr;
+  }
+
+  unique_ptr<ObCompaction>             compaction(new ObCompaction(best_level));
+  const vector<shared_ptr<ObSSTable>> &level_tables = sstables->at(best_level);
+  if (best_level == 0) {
+    // tables in level 0 overlap with each other, compact them all at once
+    compaction->inputs_[0] = level_tables;
+  } else {
+    // pick the largest table of the level
+    shared_ptr<ObSSTable> picked = level_tables.front();
+    for (const auto &sstable : level_tables) {
+      if (sstable->size() > picked->size()) {
+        picked = sstable;
+      }
+    }
+    compaction->inputs_[0].emplace_back(picked);
+  }
+
+  // the user key range of the picked tables
+  string smallest;
+  string largest;
+  bool   has_range = false;
+  for (const auto &sstable : compaction->inputs_[0]) {
+    if (sstable->block_count() == 0) {
+      continue;
+    }
+    const string first_key = sstable->first_key();
+    const string last_key  = sstable->last_key();
+    if (!has_range || user_comparator_.compare(extract_user_key(first_key), smallest) < 0) {
+      smallest = extract_user_key(first_key);
+    }
+    if (!has_range || user_comparator_.compare(extract_user_key(last_key), largest) > 0) {
+      largest = extract_user_key(last_key);
+    }
+    has_range = true;
+  }
+  if (has_range) {
+    get_overlapping_inputs(sstables->at(best_level + 1), smallest, largest, compaction->inputs_[1]);
+  }
+
+  LOG_INFO("pick leveled compaction. level=%d, score=%.2f, level inputs=%lu, next level inputs=%lu",
+      best_level, best_score, compaction->inputs_[0].size(), compaction->inputs_[1].size());
+  return compaction;
+}
+
 ObCompactionPicker *ObCompactionPicker::create(CompactionType type, ObLsmOptions *options)
 {
 
   switch (type) {
     case CompactionType::TIRED: return new TiredCompactionPicker(options);
+    case CompactionType::LEVELED: return new LeveledCompactionPicker(options);
     default: return nullptr;
   }
   return nullptr;
@@ -76,4 +76,51 @@ public:
 private:
 };
 
+/**
+ * @class LeveledCompactionPicker
+ * @brief A class implementing the leveled compaction strategy.
+ *
+ * Level 0 is scored by its file count against `default_l0_file_num`, and level i (i >= 1)
+ * by its total size against its target size, which is `default_l1_level_size` for level 1
+ * and grows by `default_level_ratio` per level. The level with the highest score not less
+ * than 1 is compacted into the next level, together with the tables of the next level whose
+ * key ranges overlap the picked tables. Tables in level i (i >= 1) don't overlap and are
+ * sorted by key.
+ */
+class LeveledCompactionPicker : public ObCompactionPicker
+{
+public:
+  /**
+   * @param options Pointer to the LSM-Tree options configuration.
+   */
+  LeveledCompactionPicker(ObLsmOptions *options) : ObCompactionPicker(options) {}
+
+  ~LeveledCompactionPicker() = default;
+
+  /**
+   * @brief Implementation of the pick method for leveled compaction.
+   * @return nullptr if no level needs compaction.
+   */
+  unique_ptr<ObCompaction> pick(SSTablesPtr sstables) override;
+
+  /**
+   * @brief The target size in bytes of level i (i >= 1).
+   */
+  size_t level_target_size(size_t level) const;
+
+  /**
+   * @brief The compaction score of a level, a level needs compaction if its score is not less than 1.
+   */
+  double level_score(const vector<shared_ptr<ObSSTable>> &tables, size_t level) const;
+
+private:
+  /**
+   * @brief Collects the tables in `tables` whose user key range overlaps [smallest, largest].
+   */
+  void get_overlapping_inputs(const vector<shared_ptr<ObSSTable>> &tables, const string_view &smallest,
+      const string_view &largest, vector<shared_ptr<ObSSTable>> &inputs) const;
+
+  ObDefaultComparator user_comparator_;
+};
+
 }  // namespace oceanbase
\ No newline at end of file
@@ -16,10 +16,49 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/utility.h"
 #include "oblsm/include/ob_lsm_options.h"
 #include "oblsm/include/ob_lsm_iterator.h"
+#include "oblsm/include/ob_lsm_write_batch.h"
 
 namespace oceanbase {
 
 class ObLsmTransaction;
+
+/**
+ * @brief A consistent read view of the LSM-Tree, created by `ObLsm::get_snapshot`.
+ *
+ * Reads with the snapshot (see `ObLsmReadOptions::snapshot`) see all the updates written
+ * before the snapshot was taken and none after it. While a snapshot is alive, compaction keeps
+ * the versions that are visible to it.
+ */
+class ObLsmSnapshot
+{
+public:
+  explicit ObLsmSnapshot(uint64_t seq) : seq_(seq) {}
+
+  /**
+   * @brief The largest sequence number visible to the snapshot.
+   */
+  uint64_t seq() const { return seq_; }
+
+private:
+  const uint64_t seq_;
+};
+
+/**
+ * @brief Statistics of the write stalls, see `ObLsmOptions::level0_slowdown_writes_trigger`.
+ *
+ * The durations are in microseconds. A slowdown delays a write group a little, a stop blocks
+ * the writes until the background flush or compaction catches up.
+ */
+struct ObLsmWriteStallStats
+{
+  uint64_t slowdown_count      = 0;  ///< number of delayed write groups
+  uint64_t slowdown_us         = 0;  ///< total time of the delays
+  uint64_t memtable_stop_count = 0;  ///< number of stops waiting for the flush of immutable memtables
+  uint64_t memtable_stop_us    = 0;  ///< total time of the stops waiting for the flush
+  uint64_t level0_stop_count   = 0;  ///< number of stops waiting for the compaction of level 0
+  uint64_t level0_stop_us      = 0;  ///< total time of the stops waiting for the compaction
+};
+
 /**
  * @brief ObLsm is a key-value storage engine for educational purpose.
  * ObLsm learned a lot about design from leveldb and streamlined it.
@@ -75,6 +114,16 @@ public:
    */
   virtual RC get(const string_view &key, string *value) = 0;
 
+  /**
+   * @brief Retrieves the value associated with a specified key as of `options`.
+   *
+   * @param options Read options, `options.snapshot` or `options.seq` bounds the visible versions.
+   * @param key The key to look up.
+   * @param value Pointer to a string where the retrieved value will be stored.
+   * @return An RC value indicating success or failure of the operation.
+   */
+  virtual RC get(const ObLsmReadOptions &options, const string_view &key, string *value) = 0;
+
   /**
    * @brief Delete a key-value entry in the LSM-Tree.
    *
@@ -105,11 +154,43 @@ public:
   /**
    * @brief Inserts a batch of key-value entries into the LSM-Tree.
    *
+   * The entries are written atomically, see `write`.
+   *
    * @param kvs A vector of key-value pairs to insert.
    * @return An RC value indicating success or failure of the operation.
    */
   virtual RC batch_put(const vector<pair<string, string>> &kvs) = 0;
 
+  /**
+   * @brief Applies the updates of a write batch atomically.
+   *
+   * The updates are written into the WAL as one record and take consecutive sequence
+   * numbers. Readers see either all of them or none of them.
+   *
+   * @param batch The updates to apply.
+   * @return An RC value indicating success or failure of the operation.
+   */
+  virtual RC write(const ObWriteBatch &batch) = 0;
+
+  /**
+   * @brief Returns the statistics of the write stalls since the LSM-Tree is opened.
+   */
+  virtual ObLsmWriteStallStats write_stall_stats() const = 0;
+
+  /**
+   * @brief Takes a snapshot of the current state of the LSM-Tree.
+   *
+   * @return A handle that can be set to `ObLsmReadOptions::snapshot`.
+   * @note The caller must release the snapshot with `release_snapshot` when it is no longer needed,
+   *       old versions of the keys can't be dropped by compaction before that.
+   */
+  virtual const ObLsmSnapshot *get_snapshot() = 0;
+
+  /**
+   * @brief Releases a snapshot returned by `get_snapshot`, the snapshot must not be used after this.
+   */
+  virtual void release_snapshot(const ObLsmSnapshot *snapshot) = 0;
+
   /**
    * @brief Dumps all SSTables for debugging purposes.
    *
@@ -37,18 +37,67 @@ struct ObLsmOptions
   // tired compaction
   size_t default_run_num = 7;
 
+  // bits of bloom filter for each key in sstable, 10 bits gives about 1% false positive rate.
+  // 0 means no bloom filter.
+  size_t bloom_filter_bits_per_key = 10;
+
+  // codec of the sstable blocks, a block is stored uncompressed if the codec saves little space.
+  CompressionType compression = CompressionType::LZ4;
+
+  // capacity in bytes of the block cache shared by all sstables, 0 means no block cache.
+  size_t block_cache_capacity = 8 * 1024 * 1024;
+  // the block cache is split into shards to reduce lock contention.
+  size_t block_cache_shard_num = 16;
+
+  // the max number of immutable memtables waiting to be flushed, the writes stop when all of them
+  // are waiting and the memtable is full.
+  size_t max_immutable_memtables = 4;
+
+  // the writes are slowed down when the immutable memtables waiting to be flushed have more bytes
+  // than this, 0 means half of `max_immutable_memtables` memtables (at least one).
+  size_t pending_flush_slowdown_bytes = 0;
+
+  // the writes are slowed down when level 0 (leveled compaction) or the runs (tired compaction) have
+  // this many files, and stop when they have `level0_stop_writes_trigger` files.
+  size_t level0_slowdown_writes_trigger = 8;
+  size_t level0_stop_writes_trigger     = 12;
+
+  // the delay of a write group when the writes are slowed down, in microseconds. It grows with
+  // how far the files or bytes are over the slowdown trigger.
+  size_t slowdown_delay_us = 1000;
+
+  // a large compaction is split into at most `max_subcompactions` key ranges, which are merged in
+  // parallel and written into their own sstables. 1 means no split, which suits machines with few cores.
+  size_t max_subcompactions = 1;
+
+  // the max bytes per second written by compaction, 0 means no limit.
+  size_t compaction_rate_limit = 0;
+
   // default compaction type
   CompactionType type = CompactionType::LEVELED;
 
   // it is used to control whether the WAL is forced to be written to the disk every time a new key is written.
   bool force_sync_new_log = true;
+
+  // whether the writers of a write group insert their own batches into the memtable in parallel.
+  // if false, the leader of the group inserts all of them.
+  bool allow_concurrent_memtable_write = true;
 };
 
-// TODO: UNIMPLEMENTED
+class ObLsmSnapshot;
+
+/**
+ * @brief Options for the reads (`ObLsm::get` and `ObLsm::new_iterator`).
+ */
 struct ObLsmReadOptions
 {
   ObLsmReadOptions(){};
 
+  // if not nullptr, read the data as of the snapshot, which comes from `ObLsm::get_snapshot`.
+  const ObLsmSnapshot *snapshot = nullptr;
+
+  // if `snapshot` is nullptr and `seq` is not -1, read the data as of the sequence.
+  // otherwise read the latest data.
   int64_t seq = -1;
 };
 
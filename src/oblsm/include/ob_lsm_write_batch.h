@@ -0,0 +1,80 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/functional.h"
+#include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/sys/rc.h"
+
+namespace oceanbase {
+
+/**
+ * @class ObWriteBatch
+ * @brief A group of updates that are applied to oblsm atomically.
+ *
+ * The updates of a batch are written into the WAL as one record and get consecutive
+ * sequence numbers, so after a crash either all of them are recovered or none of them.
+ * A delete is stored as a put with an empty value, the same as in the memtable.
+ *
+ * The updates are encoded as they are added, the format is:
+ *   [key length(size_t)][key][value length(size_t)][value] ...
+ */
+class ObWriteBatch
+{
+public:
+  ObWriteBatch() = default;
+
+  /**
+   * @brief Adds a put of `key` to `value`.
+   */
+  void put(const string_view &key, const string_view &value);
+
+  /**
+   * @brief Adds a delete of `key`.
+   */
+  void remove(const string_view &key) { put(key, string_view()); }
+
+  void clear();
+
+  /**
+   * @brief The number of updates in the batch.
+   */
+  size_t count() const { return count_; }
+  bool   empty() const { return count_ == 0; }
+
+  /**
+   * @brief The size of the encoded updates.
+   */
+  size_t byte_size() const { return rep_.size(); }
+
+  /**
+   * @brief The encoded updates.
+   */
+  const string &rep() const { return rep_; }
+
+  /**
+   * @brief Replaces the contents of the batch with encoded updates, which come from `rep()`.
+   */
+  void set_rep(string rep, size_t count);
+
+  /**
+   * @brief Calls `handler` for each update in the order they were added, stops at the first failure.
+   * @return `RC::INVALID_ARGUMENT` if the encoded updates are broken.
+   */
+  RC for_each(const function<RC(const string_view &key, const string_view &value)> &handler) const;
+
+private:
+  string rep_;
+  size_t count_ = 0;
+};
+
+}  // namespace oceanbase
@@ -41,7 +41,33 @@ void ObMemTable::put(uint64_t seq, const string_view &key, const string_view &va
   memcpy(p, &val_size, sizeof(size_t));
   p += sizeof(size_t);
   memcpy(p, value.data(), val_size);
-  table_.insert(buf);
+  table_.insert_concurrently(buf);
+}
+
+RC ObMemTable::get(uint64_t seq, const string_view &key, string *value)
+{
+  // entries of the same user key are ordered by sequence descending, so seeking to (key, seq)
+  // stops at the newest version visible to `seq`.
+  string lookup_key;
+  put_numeric<uint64_t>(&lookup_key, key.size() + SEQ_SIZE);
+  lookup_key.append(key.data(), key.size());
+  put_numeric<uint64_t>(&lookup_key, seq);
+
+  Table::Iterator iter(&table_);
+  iter.seek(lookup_key.data());
+  if (!iter.valid()) {
+    return RC::NOTFOUND;
+  }
+  string_view internal_key = get_length_prefixed_string(iter.key());
+  if (extract_user_key(internal_key) != key) {
+    return RC::NOTFOUND;
+  }
+  string_view entry_value = get_length_prefixed_string(internal_key.data() + internal_key.size());
+  if (entry_value.empty()) {  // for delete
+    return RC::NOT_EXIST;
+  }
+  value->assign(entry_value.data(), entry_value.size());
+  return RC::SUCCESS;
 }
 
 int ObMemTable::KeyComparator::operator()(const char *a, const char *b) const
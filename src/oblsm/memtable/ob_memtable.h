@@ -54,6 +54,7 @@ public:
    * Each entry is versioned using the provided `seq` number. If the same key is
    * inserted multiple times, the version with the highest sequence number will
    * take precedence when queried.
+   * It can be called by several threads concurrently.
    *
    * @param seq A sequence number used for versioning the key-value entry.
    * @param key The key to be inserted.
@@ -61,6 +62,17 @@ public:
    */
   void put(uint64_t seq, const string_view &key, const string_view &value);
 
+  /**
+   * @brief Looks up the newest version of `key` whose sequence number is not greater than `seq`.
+   *
+   * @param seq The snapshot sequence number.
+   * @param key The user key to look up.
+   * @param value The value of the key if found.
+   * @return RC::SUCCESS if the key is found, RC::NOT_EXIST if the key has been deleted,
+   *         RC::NOTFOUND if the memtable doesn't contain the key.
+   */
+  RC get(uint64_t seq, const string_view &key, string *value);
+
   /**
    * @brief Estimates the memory usage of the memtable.
    *
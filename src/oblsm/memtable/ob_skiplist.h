@@ -17,7 +17,9 @@ See the Mulan PSL v2 for more details. */
 // Thread safety
 // -------------
 //
-// Writes require external synchronization, most likely a mutex.
+// insert() requires external synchronization, most likely a mutex.
+// insert_concurrently() can be called by several threads at the same
+// time, but not together with insert().
 // Reads require a guarantee that the ObSkipList will not be destroyed
 // while the read is in progress. Apart from that, reads progress
 // without any internal locking or synchronization.
@@ -65,6 +67,13 @@ public:
    */
   void insert(const Key &key);
 
+  /**
+   * @brief Like insert, but it is safe to be called by several threads concurrently.
+   * @details The node is linked into each level with a CAS on the next pointer of its
+   * predecessor. If the CAS fails, another node was linked there first, so the position
+   * in that level is searched again from the old predecessor.
+   * REQUIRES: nothing that compares equal to key is currently in the list
+   */
   void insert_concurrently(const Key &key);
 
   /**
@@ -154,6 +163,11 @@ private:
   // Return head_ if there is no such node.
   Node *find_less_than(const Key &key) const;
 
+  // Starting from "before", find the nodes between which key should be
+  // linked at "level": *out_prev < key <= *out_next.
+  // REQUIRES: before is head_ or before->key < key
+  void find_splice_for_level(const Key &key, Node *before, int level, Node **out_prev, Node **out_next) const;
+
   // Return the last node in the list.
   // Return head_ if list is empty.
   Node *find_last() const;
@@ -163,15 +177,16 @@ private:
 
   Node *const head_;
 
-  // Modified only by insert().  Read racily by readers, but stale
-  // values are ok.
+  // Modified only by insert() and insert_concurrently().  Read racily by
+  // readers, but stale values are ok.
   atomic<int> max_height_;  // Height of the entire list
 
-  static common::RandomGenerator rnd;
+  // thread local, so that concurrent inserts don't share a generator
+  static thread_local common::RandomGenerator rnd;
 };
 
 template <typename Key, class ObComparator>
-common::RandomGenerator ObSkipList<Key, ObComparator>::rnd = common::RandomGenerator();
+thread_local common::RandomGenerator ObSkipList<Key, ObComparator>::rnd = common::RandomGenerator();
 
 // Implementation details follow
 template <typename Key, class ObComparator>
@@ -306,8 +321,25 @@ template <typename Key, class ObComparator>
 typename ObSkipList<Key, ObComparator>::Node *ObSkipList<Key, ObComparator>::find_greater_or_equal(
     const Key &key, Node **prev) const
 {
-  // your code here
-  return nullptr;
+  Node *x     = head_;
+  int   level = get_max_height() - 1;
+  while (true) {
+    Node *next = x->next(level);
+    if (next != nullptr && compare_(next->key, key) < 0) {
+      // Keep searching in this list
+      x = next;
+    } else {
+      if (prev != nullptr) {
+        prev[level] = x;
+      }
+      if (level == 0) {
+        return next;
+      } else {
+        // Switch to next list
+        level--;
+      }
+    }
+  }
 }
 
 template <typename Key, class ObComparator>
@@ -331,6 +363,21 @@ typename ObSkipList<Key, ObComparator>::Node *ObSkipList<Key, ObComparator>::fin
   }
 }
 
+template <typename Key, class ObComparator>
+void ObSkipList<Key, ObComparator>::find_splice_for_level(
+    const Key &key, Node *before, int level, Node **out_prev, Node **out_next) const
+{
+  while (true) {
+    Node *next = before->next(level);
+    if (next == nullptr || compare_(next->key, key) >= 0) {
+      *out_prev = before;
+      *out_next = next;
+      return;
+    }
+    before = next;
+  }
+}
+
 template <typename Key, class ObComparator>
 typename ObSkipList<Key, ObComparator>::Node *ObSkipList<Key, ObComparator>::find_last() const
 {
@@ -376,12 +423,76 @@ ObSkipList<Key, ObComparator>::~ObSkipList()
 
 template <typename Key, class ObComparator>
 void ObSkipList<Key, ObComparator>::insert(const Key &key)
-{}
+{
+  Node *prev[kMaxHeight];
+  Node *x = find_greater_or_equal(key, prev);
+
+  // Our data structure does not allow duplicate insertion
+  ASSERT(x == nullptr || !equal(key, x->key), "duplicate key in skiplist");
+
+  int height = random_height();
+  if (height > get_max_height()) {
+    for (int i = get_max_height(); i < height; i++) {
+      prev[i] = head_;
+    }
+    // It is ok to mutate max_height_ without any synchronization
+    // with concurrent readers.  A concurrent reader that observes
+    // the new value of max_height_ will see either the old value of
+    // new level pointers from head_ (nullptr), or a new value set in
+    // the loop below.
+    max_height_.store(height, std::memory_order_relaxed);
+  }
+
+  x = new_node(key, height);
+  for (int i = 0; i < height; i++) {
+    // nobarrier_set_next() suffices since we will add a barrier when
+    // we publish a pointer to "x" in prev[i].
+    x->nobarrier_set_next(i, prev[i]->nobarrier_next(i));
+    prev[i]->set_next(i, x);
+  }
+}
 
 template <typename Key, class ObComparator>
 void ObSkipList<Key, ObComparator>::insert_concurrently(const Key &key)
 {
-  // your code here
+  int height     = random_height();
+  int max_height = get_max_height();
+  while (height > max_height) {
+    // A reader that sees the new height before the new levels of head_ are
+    // linked just finds nullptr there, the same as in insert().
+    if (max_height_.compare_exchange_weak(max_height, height)) {
+      max_height = height;
+      break;
+    }
+  }
+
+  // Search the splice from the top level down, the predecessor found in
+  // a level is where the search in the next lower level starts.
+  Node *prev[kMaxHeight];
+  Node *next[kMaxHeight];
+  Node *before = head_;
+  for (int i = max_height - 1; i >= 0; i--) {
+    find_splice_for_level(key, before, i, &prev[i], &next[i]);
+    before = prev[i];
+  }
+
+  // Our data structure does not allow duplicate insertion
+  ASSERT(next[0] == nullptr || !equal(key, next[0]->key), "duplicate key in skiplist");
+
+  // Link the levels from the bottom up, so a node that can be reached from
+  // a higher level is always already in the lower levels.
+  Node *x = new_node(key, height);
+  for (int i = 0; i < height; i++) {
+    while (true) {
+      x->nobarrier_set_next(i, next[i]);
+      if (prev[i]->cas_next(i, next[i], x)) {
+        break;
+      }
+      // Another node was linked after prev[i]. Nodes are never removed, so
+      // prev[i] is still before key, search again from there.
+      find_splice_for_level(key, prev[i], i, &prev[i], &next[i]);
+    }
+  }
 }
 
 template <typename Key, class ObComparator>
@@ -26,4 +26,15 @@ enum class CompactionType
   UNKNOWN,
 };
 
+/**
+ * @enum CompressionType
+ * @brief The compression codecs of the sstable blocks, the value is stored in each block.
+ */
+enum class CompressionType
+{
+  NONE = 0,
+  LZ4,
+  UNKNOWN,
+};
+
 }  // namespace oceanbase
\ No newline at end of file
@@ -10,6 +10,9 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/ob_lsm_impl.h"
 
+#include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/lang/thread.h"
 #include "common/log/log.h"
 #include "common/sys/rc.h"
 #include "oblsm/include/ob_lsm.h"
@@ -36,8 +39,17 @@ ObLsmImpl::ObLsmImpl(const ObLsmOptions &options, const string &path)
   }
 
   executor_.init("ObLsmBackground", 1, 1, 60 * 1000);
-  block_cache_ =
-      std::unique_ptr<ObLRUCache<uint64_t, shared_ptr<ObBlock>>>{new ObLRUCache<uint64_t, shared_ptr<ObBlock>>(1024)};
+  // the background thread merges a range of the compaction itself
+  if (options_.max_subcompactions > 1) {
+    subcompaction_executor_.init("ObLsmSubCompaction", 1, options_.max_subcompactions - 1, 60 * 1000);
+  }
+  if (options_.compaction_rate_limit > 0) {
+    rate_limiter_ = make_unique<ObRateLimiter>(options_.compaction_rate_limit);
+  }
+  if (options_.block_cache_capacity > 0) {
+    block_cache_ = make_unique<ObLRUCache<uint64_t, shared_ptr<ObBlock>>>(
+        options_.block_cache_capacity, options_.block_cache_shard_num);
+  }
 }
 
 RC ObLsmImpl::recover()
@@ -76,8 +88,16 @@ RC ObLsmImpl::recover()
     return rc;
   }
 
+  if (new_memtable_record) {
+    memtable_id_ = new_memtable_record->memtable_id;
+  }
+
   // Recover memtable from WAL file.
-  wal_ = std::make_unique<WAL>();
+  rc = recover_from_wal();
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to recover from wal, rc=%s", strrc(rc));
+    return rc;
+  }
 
   // After recover from the old manifest file, write the snapshot into a new manifest file.
   if (!compaction_records.empty()) {
@@ -102,55 +122,246 @@ RC ObLsm::open(const ObLsmOptions &options, const string &path, ObLsm **dbptr)
 
 RC ObLsmImpl::put(const string_view &key, const string_view &value)
 {
-  // TODO: if put rate is too high, slow down writes is needed.
-  // currently, the writes is stopped when the memtable is full.
   LOG_TRACE("begin to put key=%s, value=%s", key.data(), value.data());
-  RC rc = RC::SUCCESS;
-  // TODO: currenttly the memtable use skiplist as the underlying data structure,
-  // and the skiplist concurently write is not thread safe, so we use mutex here,
-  // if the skiplist support `insert_concurrently()` interface, can we remove the mutex?
+  ObWriteBatch batch;
+  batch.put(key, value);
+  return write(batch);
+}
+
+RC ObLsmImpl::batch_put(const vector<pair<string, string>> &kvs)
+{
+  ObWriteBatch batch;
+  for (const auto &[key, value] : kvs) {
+    batch.put(key, value);
+  }
+  return write(batch);
+}
+
+RC ObLsmImpl::remove(const string_view &key)
+{
+  ObWriteBatch batch;
+  batch.remove(key);
+  return write(batch);
+}
+
+RC ObLsmImpl::write(const ObWriteBatch &batch)
+{
+  if (batch.empty()) {
+    return RC::SUCCESS;
+  }
+  Writer writer;
+  writer.batch = &batch;
+  writer.sync  = options_.force_sync_new_log;
+  return do_write(writer);
+}
+
+RC ObLsmImpl::do_write(Writer &writer)
+{
   unique_lock<mutex> lock(mu_);
-  uint64_t           seq = seq_.fetch_add(1);
-  // Write WAL
-  rc = wal_->put(seq, key, value);
-  if (rc != RC::SUCCESS) {
-    return rc;
+  writers_.push_back(&writer);
+  while (!writer.done && writer.mem == nullptr && &writer != writers_.front()) {
+    writer.cv.wait(lock);
+  }
+  if (!writer.done && writer.mem != nullptr) {
+    // The leader has written the WAL of the group, insert this batch into the memtable
+    // in parallel with the other writers of the group.
+    lock.unlock();
+    insert_into_memtable(writer.mem, writer.first_seq, *writer.batch);
+    lock.lock();
+    if (--writer.leader->pending_inserts == 0) {
+      writer.leader->cv.notify_one();
+    }
+    while (!writer.done) {
+      writer.cv.wait(lock);
+    }
+  }
+  if (writer.done) {
+    // a leader has written it
+    return writer.rc;
   }
 
-  if (options_.force_sync_new_log) {
-    rc = wal_->sync();
-    if (rc != RC::SUCCESS) {
-      LOG_ERROR("Failed to sync wal logs, rc=%s", strrc(rc));
-      return rc;
+  // This writer is the leader now. It writes the waiting writers behind it as a group,
+  // with one WAL append and at most one sync.
+  RC      rc          = make_room_for_write(lock);
+  Writer *last_writer = &writer;
+  if (OB_SUCC(rc)) {
+    vector<Writer *> group;
+    string           records;
+    uint64_t         last_seq = seq_.load();
+    for (Writer *w : writers_) {
+      // a sync write can't join a group that will not be synced
+      if (!group.empty() && ((w->sync && !writer.sync) || records.size() >= MAX_WRITE_GROUP_SIZE)) {
+        break;
+      }
+      w->first_seq = last_seq + 1;
+      WAL::encode(w->first_seq, *w->batch, &records);
+      last_seq += w->batch->count();
+      group.push_back(w);
+      last_writer = w;
+    }
+    shared_ptr<ObMemTable> mem = mem_table_;
+    shared_ptr<WAL>        wal = wal_;
+
+    // Only the leader appends to the WAL, so the lock can be released and the other
+    // writers can join the queue in the meantime.
+    lock.unlock();
+    rc = wal->append(records);
+    if (OB_SUCC(rc) && writer.sync) {
+      rc = wal->sync();
+    }
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to write wal logs, rc=%s", strrc(rc));
+      lock.lock();
+    } else if (options_.allow_concurrent_memtable_write && group.size() > 1) {
+      lock.lock();
+      writer.pending_inserts = group.size();
+      for (Writer *w : group) {
+        w->mem    = mem.get();
+        w->leader = &writer;
+        if (w != &writer) {
+          w->cv.notify_one();
+        }
+      }
+      lock.unlock();
+      insert_into_memtable(mem.get(), writer.first_seq, *writer.batch);
+      lock.lock();
+      writer.pending_inserts--;
+      while (writer.pending_inserts > 0) {
+        writer.cv.wait(lock);
+      }
+    } else {
+      for (Writer *w : group) {
+        insert_into_memtable(mem.get(), w->first_seq, *w->batch);
+      }
+      lock.lock();
+    }
+    // the group becomes visible to readers after it is all in the memtable
+    if (OB_SUCC(rc)) {
+      seq_.store(last_seq);
     }
   }
-  // write memtable
-  mem_table_->put(seq, key, value);
-  size_t mem_size = mem_table_->appro_memory_usage();
-  if (mem_size > options_.memtable_size) {
-    // Thinking point: here vector is used to store imems,
-    // but only one imem is stored at most. Is it possible
-    // to store more than one imem and what are the implications
-    // of storing more than one imem.
-    if (imem_tables_.size() >= 1) {
-      cv_.wait(lock);
+
+  while (true) {
+    Writer *ready = writers_.front();
+    writers_.pop_front();
+    if (ready != &writer) {
+      ready->rc   = rc;
+      ready->done = true;
+      ready->cv.notify_one();
+    }
+    if (ready == last_writer) {
+      break;
     }
-    // check again after get lock(maybe freeze memtable by another thread)
-    if (mem_table_->appro_memory_usage() > options_.memtable_size) {
-      manifest_.latest_seq = seq;
-      try_freeze_memtable();
+  }
+  // notify the new leader
+  if (!writers_.empty()) {
+    writers_.front()->cv.notify_one();
+  }
+  return rc;
+}
+
+void ObLsmImpl::insert_into_memtable(ObMemTable *mem, uint64_t first_seq, const ObWriteBatch &batch)
+{
+  uint64_t seq = first_seq;
+  batch.for_each([mem, &seq](const string_view &key, const string_view &value) {
+    mem->put(seq++, key, value);
+    return RC::SUCCESS;
+  });
+}
+
+RC ObLsmImpl::make_room_for_write(unique_lock<mutex> &lock)
+{
+  RC   rc          = RC::SUCCESS;
+  bool allow_delay = true;
+  while (OB_SUCC(rc)) {
+    uint64_t delay_us = allow_delay ? write_delay_us() : 0;
+    if (delay_us > 0) {
+      // The background thread is falling behind. Delay this write group a little rather than
+      // stop all the writes later when a limit is reached. The lock is released so the background
+      // thread can keep going, and a group is delayed at most once.
+      lock.unlock();
+      auto begin = chrono::steady_clock::now();
+      this_thread::sleep_for(chrono::microseconds(delay_us));
+      stall_stats_.slowdown_count++;
+      stall_stats_.slowdown_us += elapsed_us(begin);
+      lock.lock();
+      allow_delay = false;
+    } else if (mem_table_->appro_memory_usage() <= options_.memtable_size) {
+      // there is room in the memtable
+      break;
+    } else if (imem_tables_.size() >= std::max<size_t>(options_.max_immutable_memtables, 1)) {
+      // all the immutable memtables are waiting to be flushed
+      LOG_DEBUG("stop writes, too many immutable memtables. count=%lu", imem_tables_.size());
+      auto begin = chrono::steady_clock::now();
+      cv_.wait(lock);
+      stall_stats_.memtable_stop_count++;
+      stall_stats_.memtable_stop_us += elapsed_us(begin);
+    } else if (level0_file_num() >= options_.level0_stop_writes_trigger) {
+      // wait for the compaction of level 0, flushing more memtables only makes the reads slower
+      LOG_DEBUG("stop writes, too many level 0 files. count=%lu", level0_file_num());
+      schedule_compaction();
+      auto begin = chrono::steady_clock::now();
+      cv_.wait(lock);
+      stall_stats_.level0_stop_count++;
+      stall_stats_.level0_stop_us += elapsed_us(begin);
     } else {
-      // if there are multi put threads waiting here, need to notify one thread to
-      // continue to write to memtable.
-      cv_.notify_one();
+      manifest_.latest_seq = seq_.load();
+      rc                   = try_freeze_memtable();
     }
   }
   return rc;
 }
 
-RC ObLsmImpl::batch_put(const vector<pair<string, string>> &kvs) { return RC::UNIMPLEMENTED; }
+uint64_t ObLsmImpl::write_delay_us() const
+{
+  // the delay grows with how far the pressure is over the slowdown trigger
+  uint64_t delay_us = 0;
+  size_t   l0_num   = level0_file_num();
+  if (l0_num >= options_.level0_slowdown_writes_trigger) {
+    delay_us = options_.slowdown_delay_us * (1 + l0_num - options_.level0_slowdown_writes_trigger);
+  }
 
-RC ObLsmImpl::remove(const string_view &key) { return RC::UNIMPLEMENTED; }
+  size_t pending_bytes = 0;
+  for (const auto &imm : imem_tables_) {
+    pending_bytes += imm->appro_memory_usage();
+  }
+  const size_t memtable_size = std::max<size_t>(options_.memtable_size, 1);
+  size_t       slowdown_bytes = options_.pending_flush_slowdown_bytes;
+  if (slowdown_bytes == 0) {
+    slowdown_bytes = std::max<size_t>(options_.max_immutable_memtables / 2, 1) * memtable_size;
+  }
+  if (pending_bytes >= slowdown_bytes) {
+    delay_us = std::max<uint64_t>(
+        delay_us, options_.slowdown_delay_us * (1 + (pending_bytes - slowdown_bytes) / memtable_size));
+  }
+  return delay_us;
+}
+
+size_t ObLsmImpl::level0_file_num() const
+{
+  // for tired compaction, every run is like a level 0 file for the reads
+  if (options_.type == CompactionType::LEVELED) {
+    return sstables_->empty() ? 0 : sstables_->at(0).size();
+  }
+  return sstables_->size();
+}
+
+uint64_t ObLsmImpl::elapsed_us(chrono::steady_clock::time_point begin)
+{
+  return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - begin).count();
+}
+
+ObLsmWriteStallStats ObLsmImpl::write_stall_stats() const
+{
+  ObLsmWriteStallStats stats;
+  stats.slowdown_count      = stall_stats_.slowdown_count.load();
+  stats.slowdown_us         = stall_stats_.slowdown_us.load();
+  stats.memtable_stop_count = stall_stats_.memtable_stop_count.load();
+  stats.memtable_stop_us    = stall_stats_.memtable_stop_us.load();
+  stats.level0_stop_count   = stall_stats_.level0_stop_count.load();
+  stats.level0_stop_us      = stall_stats_.level0_stop_us.load();
+  return stats;
+}
 
 RC ObLsmImpl::try_freeze_memtable()
 {
@@ -167,9 +378,13 @@ RC ObLsmImpl::try_freeze_memtable()
   }
 
   frozen_wals_.emplace_back(std::move(wal_));
-  wal_                     = std::make_unique<WAL>();
+  wal_                     = std::make_shared<WAL>();
   uint64_t new_memtable_id = memtable_id_.fetch_add(1) + 1;
-  wal_->open(get_wal_path(new_memtable_id));
+  rc                       = wal_->open(get_wal_path(new_memtable_id));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open wal file, rc=%s", strrc(rc));
+    return rc;
+  }
   std::shared_ptr<ObLsmBgCompactCtx> background_compaction_ctx = make_shared<ObLsmBgCompactCtx>(new_memtable_id);
   auto bg_task = [this, background_compaction_ctx]() { this->background_compaction(background_compaction_ctx); };
   int  ret     = executor_.execute(bg_task);
@@ -183,31 +398,76 @@ RC ObLsmImpl::try_freeze_memtable()
 void ObLsmImpl::background_compaction(std::shared_ptr<ObLsmBgCompactCtx> ctx)
 {
   unique_lock<mutex> lock(mu_);
-  if (imem_tables_.size() >= 1) {
-    shared_ptr<ObMemTable> imem       = imem_tables_.back();
-    shared_ptr<WAL>        frozen_wal = frozen_wals_.back();
-
-    // TODO: build memtable to sst shouldn't in lock?
-    build_sstable(imem);
-    imem_tables_.pop_back();
-    frozen_wals_.pop_back();
-    manifest_.push(ObManifestNewMemtable{ctx->new_memtable_id});
+  if (ctx->flush_memtable && !imem_tables_.empty()) {
+    // flush the oldest immutable memtable, each background task flushes the memtable frozen by its freeze
+    shared_ptr<ObMemTable> imem       = imem_tables_.front();
+    shared_ptr<WAL>        frozen_wal = frozen_wals_.front();
 
-    ::remove(frozen_wal->filename().c_str());
+    // the memtable stays readable until its sstable is installed. if the flush fails, retry it rather than
+    // dropping the memtable: the memtables must be flushed in order, or an older one would shadow the newer
+    // data after recovery.
+    RC rc = RC::SUCCESS;
+    while (true) {
+      // the memtable is immutable, the writes and reads go on while it is being written
+      lock.unlock();
+      shared_ptr<ObSSTable> sstable;
+      rc = build_sstable(imem, sstable);
+      lock.lock();
+      if (OB_SUCC(rc)) {
+        rc = install_level0_sstable(sstable);
+        if (OB_FAIL(rc)) {
+          sstable->remove();
+        }
+      }
+      if (OB_SUCC(rc) || closing_) {
+        break;
+      }
+      LOG_WARN("Failed to flush memtable, retry in %d ms, rc=%s", FLUSH_RETRY_INTERVAL_MS, strrc(rc));
+      lock.unlock();
+      this_thread::sleep_for(chrono::milliseconds(FLUSH_RETRY_INTERVAL_MS));
+      lock.lock();
+    }
+    if (OB_SUCC(rc)) {
+      imem_tables_.erase(imem_tables_.begin());
+      frozen_wals_.erase(frozen_wals_.begin());
+      manifest_.push(ObManifestNewMemtable{ctx->new_memtable_id});
+      ::remove(frozen_wal->filename().c_str());
+    } else {
+      // the data can still be recovered from the wal file when the lsm is opened next time
+      LOG_ERROR("Failed to flush memtable, keep its wal file %s, rc=%s", frozen_wal->filename().c_str(), strrc(rc));
+    }
 
     lock.unlock();
-    cv_.notify_one();
+    cv_.notify_all();
+  } else {
+    lock.unlock();
+  }
 
-    // TODO: trig compaction at more scenarios, for example,
-    // seek compaction in
-    // leveldb(https://github.com/google/leveldb/blob/578eeb702ec0fbb6b9780f3d4147b1076630d633/db/version_set.cc#L650).
-    if (!compacting_) {
-      compacting_.store(true);
-      try_major_compaction();
-      compacting_.store(false);
-    }
+  // TODO: trig compaction at more scenarios, for example,
+  // seek compaction in
+  // leveldb(https://github.com/google/leveldb/blob/578eeb702ec0fbb6b9780f3d4147b1076630d633/db/version_set.cc#L650).
+  if (!compacting_) {
+    compacting_.store(true);
+    try_major_compaction();
+    compacting_.store(false);
+  }
+}
+
+void ObLsmImpl::schedule_compaction()
+{
+  if (compaction_scheduled_.exchange(true)) {
     return;
   }
+  // the flushes and compactions run in the background thread one by one
+  auto ctx     = make_shared<ObLsmBgCompactCtx>();
+  auto bg_task = [this, ctx]() {
+    compaction_scheduled_.store(false);
+    this->background_compaction(ctx);
+  };
+  if (executor_.execute(bg_task) != 0) {
+    compaction_scheduled_.store(false);
+    LOG_WARN("fail to execute background compaction task");
+  }
 }
 
 void ObLsmImpl::try_major_compaction()
@@ -220,7 +480,12 @@ void ObLsmImpl::try_major_compaction()
   if (picked == nullptr || picked->size() == 0) {
     return;
   }
-  vector<shared_ptr<ObSSTable>> results = do_compaction(picked.get());
+  vector<shared_ptr<ObSSTable>> results;
+  RC                            rc = do_compaction(picked.get(), results);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to do compaction, rc=%s", strrc(rc));
+    return;
+  }
 
   SSTablesPtr new_sstables = make_shared<vector<vector<shared_ptr<ObSSTable>>>>();
   lock.lock();
@@ -258,48 +523,351 @@ void ObLsmImpl::try_major_compaction()
       }
     }
   } else if (options_.type == CompactionType::LEVELED) {
-    // TODO: apply the compaction results to sstable
+    // the picked tables are removed from level and level + 1, and the results are put into level + 1.
+    // new tables may have been added to level 0 during the compaction, they are kept.
+    *new_sstables     = *sstables_;
+    const int level   = picked->level();
+    auto      discard = [&](int lvl) {
+      vector<shared_ptr<ObSSTable>> &tables = new_sstables->at(lvl);
+      for (auto iter = tables.begin(); iter != tables.end();) {
+        if (find_sstable(picked_sstables, *iter)) {
+          mf_record.deleted_tables.emplace_back((*iter)->sst_id(), lvl);
+          iter = tables.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+    };
+    discard(level);
+    discard(level + 1);
+
+    vector<shared_ptr<ObSSTable>> &next_level = new_sstables->at(level + 1);
+    for (const auto &sstable : results) {
+      mf_record.added_tables.emplace_back(sstable->sst_id(), level + 1);
+      next_level.emplace_back(sstable);
+    }
+    sort_sstables(next_level);
   }
 
   sstables_ = new_sstables;
   lock.unlock();
+  // the writers may be waiting for the compaction of level 0
+  cv_.notify_all();
 
   // remove from disk
   for (auto &sstable : picked_sstables) {
     sstable->remove();
   }
 
+  mf_record.compaction_type     = options_.type;
   mf_record.sstable_sequence_id = sstable_id_.load();
   mf_record.seq_id              = manifest_.latest_seq;
   manifest_.push(std::move(mf_record));
   try_major_compaction();
 }
 
-vector<shared_ptr<ObSSTable>> ObLsmImpl::do_compaction(ObCompaction *picked) { return {}; }
+RC ObLsmImpl::do_compaction(ObCompaction *picked, vector<shared_ptr<ObSSTable>> &results)
+{
+  results.clear();
+  if (picked == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  CompactionState state;
+  state.picked = picked;
+  unique_lock<mutex> lock(mu_);
+  state.smallest_snapshot = smallest_snapshot();
+  state.sstables          = sstables_;
+  lock.unlock();
+
+  // For tired compaction, the picker takes whole runs, a delete can be dropped if the oldest run is compacted.
+  if (options_.type == CompactionType::TIRED && !state.sstables->empty()) {
+    const vector<shared_ptr<ObSSTable>> &oldest_run = state.sstables->back();
+    const vector<shared_ptr<ObSSTable>> &inputs     = picked->inputs(0);
+    state.all_keys_in_base =
+        std::all_of(oldest_run.begin(), oldest_run.end(), [&inputs](const shared_ptr<ObSSTable> &sst) {
+          return std::any_of(inputs.begin(), inputs.end(), [&sst](const shared_ptr<ObSSTable> &input) {
+            return input->sst_id() == sst->sst_id();
+          });
+        });
+  }
+
+  vector<SubCompaction> subs = split_compaction(picked);
+
+  // the first range is merged by this thread, the others by the subcompaction threads
+  mutex              wait_mu;
+  condition_variable wait_cv;
+  size_t             pending = 0;
+  for (size_t i = 1; i < subs.size(); i++) {
+    SubCompaction &sub = subs[i];
+    {
+      lock_guard<mutex> wait_lock(wait_mu);
+      pending++;
+    }
+    int ret = subcompaction_executor_.execute([this, &state, &sub, &wait_mu, &wait_cv, &pending]() {
+      do_subcompaction(state, sub);
+      lock_guard<mutex> wait_lock(wait_mu);
+      pending--;
+      wait_cv.notify_one();
+    });
+    if (ret != 0) {
+      LOG_WARN("failed to submit subcompaction, run it in place. ret=%d", ret);
+      {
+        lock_guard<mutex> wait_lock(wait_mu);
+        pending--;
+      }
+      do_subcompaction(state, sub);
+    }
+  }
+  do_subcompaction(state, subs[0]);
+  unique_lock<mutex> wait_lock(wait_mu);
+  wait_cv.wait(wait_lock, [&pending]() { return pending == 0; });
+  wait_lock.unlock();
+
+  // the ranges are ordered, so are their results
+  RC     rc      = RC::SUCCESS;
+  size_t dropped = 0;
+  for (SubCompaction &sub : subs) {
+    if (OB_FAIL(sub.rc) && OB_SUCC(rc)) {
+      rc = sub.rc;
+    }
+    dropped += sub.dropped;
+    results.insert(results.end(), sub.results.begin(), sub.results.end());
+  }
+  LOG_DEBUG("compaction finished. subcompactions=%lu, dropped %lu obsolete entries, smallest snapshot=%lu",
+      subs.size(), dropped, state.smallest_snapshot);
 
-void ObLsmImpl::build_sstable(shared_ptr<ObMemTable> imem)
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to write compaction results, rc=%s", strrc(rc));
+    for (auto &sstable : results) {
+      sstable->remove();
+    }
+    results.clear();
+  }
+  return rc;
+}
+
+vector<ObLsmImpl::SubCompaction> ObLsmImpl::split_compaction(ObCompaction *picked) const
+{
+  // the blocks of the inputs sorted by their first user keys, the ranges are cut at block boundaries
+  // so that each range has about the same bytes to merge.
+  vector<pair<string, uint32_t>> blocks;
+  size_t                         total_size = 0;
+  for (int which = 0; which < 2; which++) {
+    for (const auto &sstable : picked->inputs(which)) {
+      for (uint32_t i = 0; i < sstable->block_count(); i++) {
+        const BlockMeta meta = sstable->block_meta(i);
+        blocks.emplace_back(string(extract_user_key(meta.first_key_)), meta.size_);
+        total_size += meta.size_;
+      }
+    }
+  }
+
+  // no need to split into ranges smaller than an output table
+  size_t sub_num = std::min(options_.max_subcompactions, total_size / std::max<size_t>(options_.table_size, 1));
+  vector<SubCompaction> subs(1);
+  if (sub_num <= 1) {
+    return subs;
+  }
+
+  std::sort(blocks.begin(), blocks.end(), [this](const pair<string, uint32_t> &a, const pair<string, uint32_t> &b) {
+    return default_comparator_.compare(a.first, b.first) < 0;
+  });
+  const size_t range_size = total_size / sub_num;
+  size_t       accum_size = 0;
+  for (size_t i = 0; i < blocks.size() && subs.size() < sub_num; i++) {
+    // a boundary is the first key of the next range, all versions of a user key are in the same range
+    if (accum_size >= range_size &&
+        (!subs.back().has_start || default_comparator_.compare(blocks[i].first, subs.back().start) > 0)) {
+      SubCompaction &last = subs.back();
+      last.end            = blocks[i].first;
+      last.has_end        = true;
+      SubCompaction next;
+      next.start     = blocks[i].first;
+      next.has_start = true;
+      subs.emplace_back(std::move(next));
+      accum_size = 0;
+    }
+    accum_size += blocks[i].second;
+  }
+  return subs;
+}
+
+bool ObLsmImpl::is_base_level_for_key(const CompactionState &state, const string_view &user_key) const
+{
+  // A delete can be dropped only if no sstable older than the compaction inputs may contain the key,
+  // otherwise the older versions would come back. For leveled compaction, the older sstables are the
+  // levels below the output level, which don't change during the compaction.
+  if (options_.type != CompactionType::LEVELED) {
+    return state.all_keys_in_base;
+  }
+  for (size_t level = state.picked->level() + 2; level < state.sstables->size(); level++) {
+    const vector<shared_ptr<ObSSTable>> &tables = state.sstables->at(level);
+    auto                                 iter   = std::lower_bound(
+        tables.begin(), tables.end(), user_key, [this](const shared_ptr<ObSSTable> &sstable, const string_view &key) {
+          return default_comparator_.compare(extract_user_key(sstable->last_key()), key) < 0;
+        });
+    if (iter != tables.end() && default_comparator_.compare(extract_user_key((*iter)->first_key()), user_key) <= 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void ObLsmImpl::do_subcompaction(const CompactionState &state, SubCompaction &sub)
+{
+  vector<unique_ptr<ObLsmIterator>> iters;
+  for (int which = 0; which < 2; which++) {
+    for (const auto &sstable : state.picked->inputs(which)) {
+      iters.emplace_back(sstable->new_iterator());
+    }
+  }
+  unique_ptr<ObLsmIterator> iter(new_merging_iterator(&internal_key_comparator_, std::move(iters)));
+
+  RC     rc       = RC::SUCCESS;
+  bool   building = false;
+  string building_file;
+  auto   tb = make_unique<ObSSTableBuilder>(
+      &default_comparator_, block_cache_.get(), options_.bloom_filter_bits_per_key);
+  tb->set_rate_limiter(rate_limiter_.get());
+  tb->set_compression(options_.compression);
+  auto finish_table = [&]() {
+    building = false;
+    RC rc    = tb->finish();
+    if (OB_SUCC(rc)) {
+      shared_ptr<ObSSTable> sstable = tb->get_built_table();
+      if (sstable == nullptr) {
+        return RC::IOERR_READ;
+      }
+      sub.results.emplace_back(sstable);
+    }
+    return rc;
+  };
+
+  if (sub.has_start) {
+    // the newest version of the start key
+    string lookup_key;
+    put_numeric<uint64_t>(&lookup_key, sub.start.size() + SEQ_SIZE);
+    lookup_key.append(sub.start);
+    put_numeric<uint64_t>(&lookup_key, UINT64_MAX);
+    iter->seek(lookup_key);
+  } else {
+    iter->seek_to_first();
+  }
+
+  string   current_user_key;
+  bool     has_current_user_key = false;
+  uint64_t last_seq_for_key     = UINT64_MAX;
+  for (; OB_SUCC(rc) && iter->valid(); iter->next()) {
+    string_view key      = iter->key();
+    string_view user_key = extract_user_key(key);
+    uint64_t    seq      = extract_sequence(key);
+    if (sub.has_end && default_comparator_.compare(user_key, sub.end) >= 0) {
+      break;
+    }
+    if (!has_current_user_key || user_key != current_user_key) {
+      current_user_key.assign(user_key.data(), user_key.size());
+      has_current_user_key = true;
+      last_seq_for_key     = UINT64_MAX;
+    }
+
+    bool drop = false;
+    if (last_seq_for_key <= state.smallest_snapshot) {
+      // hidden by a newer version of the same user key for all readers
+      drop = true;
+    } else if (iter->value().empty() && seq <= state.smallest_snapshot && is_base_level_for_key(state, user_key)) {
+      // a delete hides nothing if there is no older version, and the newer versions in this compaction
+      // are dropped by the rule above
+      drop = true;
+    }
+    last_seq_for_key = seq;
+    if (drop) {
+      sub.dropped++;
+      continue;
+    }
+
+    // don't split the versions of a user key into two tables
+    if (building && tb->appro_size() >= options_.table_size && user_key != tb->last_user_key()) {
+      rc = finish_table();
+    }
+    if (OB_SUCC(rc) && !building) {
+      uint64_t sstable_id = sstable_id_.fetch_add(1);
+      building_file       = get_sstable_path(sstable_id);
+      rc                  = tb->open(building_file, sstable_id);
+      building            = OB_SUCC(rc);
+    }
+    if (OB_SUCC(rc)) {
+      rc = tb->add(key, iter->value());
+    }
+  }
+  if (OB_SUCC(rc) && building) {
+    rc = finish_table();
+  }
+
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to write subcompaction results, rc=%s", strrc(rc));
+    tb->reset();
+    if (building) {
+      filesystem::remove(building_file);
+    }
+  }
+  sub.rc = rc;
+}
+
+void ObLsmImpl::sort_sstables(vector<shared_ptr<ObSSTable>> &sstables) const
 {
-  unique_ptr<ObSSTableBuilder> tb = make_unique<ObSSTableBuilder>(&default_comparator_, block_cache_.get());
+  std::sort(sstables.begin(), sstables.end(), [this](const shared_ptr<ObSSTable> &a, const shared_ptr<ObSSTable> &b) {
+    return internal_key_comparator_.compare(a->first_key(), b->first_key()) < 0;
+  });
+}
+
+RC ObLsmImpl::build_sstable(shared_ptr<ObMemTable> imem, shared_ptr<ObSSTable> &sstable)
+{
+  unique_ptr<ObSSTableBuilder> tb = make_unique<ObSSTableBuilder>(
+      &default_comparator_, block_cache_.get(), options_.bloom_filter_bits_per_key);
+  tb->set_compression(options_.compression);
 
   uint64_t sstable_id = sstable_id_.fetch_add(1);
-  tb->build(imem, get_sstable_path(sstable_id), sstable_id);
-  // unique_lock<mutex> lock(mu_);
+  RC       rc         = tb->build(imem, get_sstable_path(sstable_id), sstable_id);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to build sstable %lu, rc=%s", sstable_id, strrc(rc));
+    return rc;
+  }
+  sstable = tb->get_built_table();
+  if (sstable == nullptr) {
+    LOG_ERROR("Failed to open sstable %lu", sstable_id);
+    return RC::IOERR_READ;
+  }
+  return rc;
+}
 
+RC ObLsmImpl::install_level0_sstable(const shared_ptr<ObSSTable> &sstable)
+{
+  RC                   rc = RC::SUCCESS;
   ObManifestCompaction record;
   record.compaction_type     = options_.type;
   record.sstable_sequence_id = sstable_id_.load();
   record.seq_id              = manifest_.latest_seq;
 
+  // readers (get/new_iterator) may hold the current sstables without lock, so copy on write.
+  SSTablesPtr new_sstables = make_shared<vector<vector<shared_ptr<ObSSTable>>>>(*sstables_);
   // TODO: unify the build sstable logic in all compaction type
   if (options_.type == CompactionType::TIRED) {
     // TODO: record the changes for tired compaction
     // here we use `level_i` to store `run_i`
-    sstables_->insert(sstables_->begin(), {tb->get_built_table()});
+    new_sstables->insert(new_sstables->begin(), {sstable});
   } else if (options_.type == CompactionType::LEVELED) {
-    sstables_->at(0).emplace_back(tb->get_built_table());
-    record.added_tables.emplace_back(sstable_id, 0);
-    manifest_.push(std::move(record));
+    new_sstables->at(0).emplace_back(sstable);
+    record.added_tables.emplace_back(sstable->sst_id(), 0);
+    // publish the table only after it is recorded, so a failed install changes nothing and can be retried
+    rc = manifest_.push(std::move(record));
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to record level 0 sstable %u in manifest, rc=%s", sstable->sst_id(), strrc(rc));
+      return rc;
+    }
   }
+  sstables_ = new_sstables;
+  return rc;
 }
 
 string ObLsmImpl::get_sstable_path(uint64_t sstable_id)
@@ -312,19 +880,49 @@ string ObLsmImpl::get_wal_path(uint64_t memtable_id)
   return filesystem::path(path_) / (to_string(memtable_id) + WAL_SUFFIX);
 }
 
-RC ObLsmImpl::get(const string_view &key, string *value)
+RC ObLsmImpl::get(const string_view &key, string *value) { return get(ObLsmReadOptions(), key, value); }
+
+RC ObLsmImpl::get(const ObLsmReadOptions &options, const string_view &key, string *value)
 {
-  RC                 rc = RC::SUCCESS;
-  unique_lock<mutex> lock(mu_);
-  auto               iter = unique_ptr<ObLsmIterator>(new_iterator(ObLsmReadOptions{}));
-  iter->seek(key);
-  if (iter->valid() && iter->key() == key) {
-    if (iter->value().empty()) {
-      rc = RC::NOT_EXIST;
+  unique_lock<mutex>             lock(mu_);
+  uint64_t                       seq      = read_seq(options);
+  shared_ptr<ObMemTable>         mem      = mem_table_;
+  vector<shared_ptr<ObMemTable>> imms     = imem_tables_;
+  SSTablesPtr                    sstables = sstables_;
+  lock.unlock();
+
+  // search from the newest data to the oldest, the first version found wins.
+  RC rc = mem->get(seq, key, value);
+  for (auto iter = imms.rbegin(); rc == RC::NOTFOUND && iter != imms.rend(); ++iter) {
+    rc = (*iter)->get(seq, key, value);
+  }
+
+  // For leveled compaction, newer tables are appended to the back of level 0, and the tables of the deeper
+  // levels don't overlap with each other. For tired compaction, newer runs are inserted to the front.
+  // Each table checks its bloom filter before reading any block.
+  for (size_t level = 0; rc == RC::NOTFOUND && level < sstables->size(); level++) {
+    const vector<shared_ptr<ObSSTable>> &tables = sstables->at(level);
+    if (options_.type == CompactionType::LEVELED && level == 0) {
+      for (auto iter = tables.rbegin(); rc == RC::NOTFOUND && iter != tables.rend(); ++iter) {
+        rc = (*iter)->get(seq, key, value);
+      }
+    } else if (options_.type == CompactionType::LEVELED) {
+      // tables in the level are sorted and don't overlap, only one of them may contain the key
+      auto iter = std::lower_bound(
+          tables.begin(), tables.end(), key, [this](const shared_ptr<ObSSTable> &sstable, const string_view &key) {
+            return default_comparator_.compare(extract_user_key(sstable->last_key()), key) < 0;
+          });
+      if (iter != tables.end()) {
+        rc = (*iter)->get(seq, key, value);
+      }
     } else {
-      value->assign(iter->value());
+      for (auto iter = tables.begin(); rc == RC::NOTFOUND && iter != tables.end(); ++iter) {
+        rc = (*iter)->get(seq, key, value);
+      }
     }
-  } else {
+  }
+
+  if (rc == RC::NOTFOUND) {
     rc = RC::NOT_EXIST;
   }
   return rc;
@@ -335,10 +933,7 @@ ObLsmIterator *ObLsmImpl::new_iterator(ObLsmReadOptions options)
   unique_lock<mutex>     lock(mu_);
   shared_ptr<ObMemTable> mem = mem_table_;
 
-  shared_ptr<ObMemTable> imm = nullptr;
-  if (!imem_tables_.empty()) {
-    imm = imem_tables_.back();
-  }
+  vector<shared_ptr<ObMemTable>> imms = imem_tables_;
   vector<shared_ptr<ObSSTable>> sstables;
   for (auto &level : *sstables_) {
     sstables.insert(sstables.end(), level.begin(), level.end());
@@ -346,17 +941,49 @@ ObLsmIterator *ObLsmImpl::new_iterator(ObLsmReadOptions options)
   lock.unlock();
   vector<unique_ptr<ObLsmIterator>> iters;
   iters.emplace_back(mem->new_iterator());
-  if (imm != nullptr) {
+  for (const auto &imm : imms) {
     iters.emplace_back(imm->new_iterator());
   }
   for (const auto &sst : sstables) {
     iters.emplace_back(sst->new_iterator());
   }
 
-  return new_user_iterator(
-      new_merging_iterator(&internal_key_comparator_, std::move(iters)), options.seq == -1 ? seq_.load() : options.seq);
+  return new_user_iterator(new_merging_iterator(&internal_key_comparator_, std::move(iters)), read_seq(options));
+}
+
+uint64_t ObLsmImpl::read_seq(const ObLsmReadOptions &options) const
+{
+  if (options.snapshot != nullptr) {
+    return options.snapshot->seq();
+  }
+  return options.seq == -1 ? seq_.load() : options.seq;
+}
+
+const ObLsmSnapshot *ObLsmImpl::get_snapshot()
+{
+  lock_guard<mutex> lock(mu_);
+  uint64_t          seq = seq_.load();
+  snapshots_.insert(seq);
+  return new ObLsmSnapshot(seq);
+}
+
+void ObLsmImpl::release_snapshot(const ObLsmSnapshot *snapshot)
+{
+  if (snapshot == nullptr) {
+    return;
+  }
+  lock_guard<mutex> lock(mu_);
+  auto              iter = snapshots_.find(snapshot->seq());
+  if (iter != snapshots_.end()) {
+    snapshots_.erase(iter);
+  } else {
+    LOG_WARN("release an unknown snapshot. seq=%lu", snapshot->seq());
+  }
+  delete snapshot;
 }
 
+uint64_t ObLsmImpl::smallest_snapshot() const { return snapshots_.empty() ? seq_.load() : *snapshots_.begin(); }
+
 ObLsmTransaction *ObLsmImpl::begin_transaction() { return new ObLsmTransaction(this, seq_.load()); }
 
 void ObLsmImpl::dump_sstables()
@@ -372,6 +999,68 @@ void ObLsmImpl::dump_sstables()
     }
     cout << "level size " << level_size << endl;
   }
+  if (block_cache_ != nullptr) {
+    ObLRUCacheStats stats = block_cache_->stats();
+    cout << "block cache: capacity " << block_cache_->capacity() << ", usage " << stats.usage << ", hits "
+         << stats.hits << ", misses " << stats.misses << ", evictions " << stats.evictions << endl;
+  }
+}
+
+RC ObLsmImpl::recover_from_wal()
+{
+  // every wal file left belongs to a memtable that has not been flushed
+  vector<pair<uint64_t, string>> wal_files;
+  for (const auto &entry : filesystem::directory_iterator(path_)) {
+    if (entry.is_regular_file() && entry.path().extension() == WAL_SUFFIX) {
+      wal_files.emplace_back(std::stoull(entry.path().stem().string()), entry.path().string());
+    }
+  }
+  std::sort(wal_files.begin(), wal_files.end());
+
+  RC       rc           = RC::SUCCESS;
+  uint64_t max_seq      = seq_.load();
+  size_t   record_count = 0;
+  for (const auto &[memtable_id, wal_file] : wal_files) {
+    WAL               wal;
+    vector<WalRecord> records;
+    rc = wal.recover(wal_file, records);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to recover wal file %s, rc=%s", wal_file.c_str(), strrc(rc));
+      return rc;
+    }
+    for (const WalRecord &record : records) {
+      mem_table_->put(record.seq, record.key, record.val);
+      max_seq = std::max(max_seq, record.seq);
+    }
+    record_count += records.size();
+    memtable_id_ = std::max(memtable_id_.load(), memtable_id);
+  }
+  seq_.store(max_seq);
+
+  // write the recovered data into level 0, then the old wal files are not needed
+  if (record_count > 0) {
+    manifest_.latest_seq = max_seq;
+    shared_ptr<ObSSTable> sstable;
+    rc = build_sstable(mem_table_, sstable);
+    if (OB_SUCC(rc)) {
+      rc = install_level0_sstable(sstable);
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    mem_table_ = make_shared<ObMemTable>();
+  }
+  for (const auto &[memtable_id, wal_file] : wal_files) {
+    filesystem::remove(wal_file);
+  }
+
+  uint64_t new_memtable_id = memtable_id_.fetch_add(1) + 1;
+  wal_                     = std::make_shared<WAL>();
+  rc                       = wal_->open(get_wal_path(new_memtable_id));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return manifest_.push(ObManifestNewMemtable{new_memtable_id});
 }
 
 RC ObLsmImpl::recover_from_manifest_records(const std::vector<ObManifestCompaction> &records)
@@ -426,9 +1115,17 @@ RC ObLsmImpl::load_manifest_sstable(const std::vector<std::vector<uint64_t>> &ss
     for (auto &sst_id : sst_ids) {
       auto filename = get_sstable_path(sst_id);
       auto sstable  = std::make_shared<ObSSTable>(sst_id, filename, &default_comparator_, block_cache_.get());
-      sstable->init();
+      RC   rc       = sstable->init();
+      if (OB_FAIL(rc)) {
+        LOG_ERROR("Failed to open sstable %s, rc=%s", filename.c_str(), strrc(rc));
+        return rc;
+      }
       cur_level.emplace_back(sstable);
     }
+    // level 0 keeps the order of creation
+    if (options_.type == CompactionType::LEVELED && cur_level_idx > 1) {
+      sort_sstables(cur_level);
+    }
   }
   return RC::SUCCESS;
 }
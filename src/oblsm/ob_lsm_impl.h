@@ -14,14 +14,18 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/mutex.h"
 #include "common/lang/atomic.h"
+#include "common/lang/chrono.h"
 #include "common/lang/memory.h"
 #include "common/lang/condition_variable.h"
+#include "common/lang/deque.h"
+#include "common/lang/set.h"
 #include "common/lang/utility.h"
 #include "common/thread/thread_pool_executor.h"
 #include "oblsm/include/ob_lsm_transaction.h"
 #include "oblsm/memtable/ob_memtable.h"
 #include "oblsm/table/ob_sstable.h"
 #include "oblsm/util/ob_lru_cache.h"
+#include "oblsm/util/ob_rate_limiter.h"
 #include "oblsm/compaction/ob_compaction.h"
 #include "oblsm/ob_manifest.h"
 #include "oblsm/wal/ob_lsm_wal.h"
@@ -31,8 +35,10 @@ namespace oceanbase {
 struct ObLsmBgCompactCtx
 {
   ObLsmBgCompactCtx() = default;
-  ObLsmBgCompactCtx(uint64_t id) : new_memtable_id(id) {}
-  uint64_t new_memtable_id;
+  ObLsmBgCompactCtx(uint64_t id) : new_memtable_id(id), flush_memtable(true) {}
+  uint64_t new_memtable_id = 0;
+  // false if the task only runs the compaction
+  bool flush_memtable = false;
 };
 
 class ObLsmImpl : public ObLsm
@@ -41,28 +47,48 @@ public:
   ObLsmImpl(const ObLsmOptions &options, const string &path);
   ~ObLsmImpl() override
   {
-    if (!options_.force_sync_new_log) {
+    if (!options_.force_sync_new_log && wal_ != nullptr) {
       wal_->sync();
     }
+    closing_.store(true);
     executor_.shutdown();
     executor_.await_termination();
+    if (options_.max_subcompactions > 1) {
+      subcompaction_executor_.shutdown();
+      subcompaction_executor_.await_termination();
+    }
   }
 
   RC put(const string_view &key, const string_view &value) override;
 
   RC get(const string_view &key, string *value) override;
 
+  RC get(const ObLsmReadOptions &options, const string_view &key, string *value) override;
+
   RC remove(const string_view &key) override;
 
   ObLsmTransaction *begin_transaction() override;
 
   ObLsmIterator *new_iterator(ObLsmReadOptions options) override;
 
+  const ObLsmSnapshot *get_snapshot() override;
+
+  void release_snapshot(const ObLsmSnapshot *snapshot) override;
+
   SSTablesPtr get_sstables() { return sstables_; }
 
+  /**
+   * @brief The block cache shared by all sstables, nullptr if the block cache is disabled.
+   */
+  const ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache() const { return block_cache_.get(); }
+
   RC recover();
   RC batch_put(const std::vector<pair<string, string>> &kvs) override;
 
+  RC write(const ObWriteBatch &batch) override;
+
+  ObLsmWriteStallStats write_stall_stats() const override;
+
   // used for debug
   void dump_sstables() override;
 
@@ -73,7 +99,84 @@ private:
   RC load_manifest_sstable(const std::vector<std::vector<uint64_t>> &sstables);
   RC write_manifest_snapshot();
 
+  /**
+   * @brief The sequence that a read with `options` sees.
+   */
+  uint64_t read_seq(const ObLsmReadOptions &options) const;
+
+  /**
+   * @brief The sequence of the oldest live snapshot, or the latest sequence if there is no snapshot.
+   * The versions hidden by a newer version not greater than it are invisible to all readers.
+   * @note Called with `mu_` held.
+   */
+  uint64_t smallest_snapshot() const;
+
 private:
+  /**
+   * @brief A write waiting in the writer queue.
+   */
+  struct Writer
+  {
+    const ObWriteBatch *batch = nullptr;
+    bool                sync  = false;
+    bool                done  = false;
+    RC                  rc    = RC::SUCCESS;
+    condition_variable  cv;
+
+    // Set by the leader when this writer should insert its batch into `mem` by itself.
+    ObMemTable *mem       = nullptr;
+    uint64_t    first_seq = 0;
+    Writer     *leader    = nullptr;
+    // Used by the leader, the number of writers in the group that are still inserting into the memtable.
+    size_t pending_inserts = 0;
+  };
+
+  /**
+   * @brief Writes the batch of a writer into the WAL and the memtable.
+   *
+   * The writers are queued. The writer at the front of the queue becomes the leader: it
+   * takes the following writers as a group, appends their records to the WAL with one
+   * write and at most one sync. So concurrent puts share the cost of the WAL sync.
+   * Then every writer of the group inserts its own batch into the memtable in parallel
+   * (see `ObLsmOptions::allow_concurrent_memtable_write`), and the leader publishes the
+   * sequence of the group when all of them are done. `mu_` only covers the queue and
+   * the sequence allocation.
+   */
+  RC do_write(Writer &writer);
+
+  static void insert_into_memtable(ObMemTable *mem, uint64_t first_seq, const ObWriteBatch &batch);
+
+  /**
+   * @brief Freezes the memtable if it is full, slows down or stops the writes if the background
+   * thread can't keep up.
+   *
+   * A write group is delayed by `write_delay_us` when level 0 or the immutable memtables get close
+   * to their limits, so the writers see a little higher latency instead of a long stop. The writes
+   * stop only when the memtable is full and `options_.max_immutable_memtables` memtables are waiting
+   * to be flushed, or level 0 has `options_.level0_stop_writes_trigger` files.
+   * @note Called by the leader writer with `mu_` held.
+   */
+  RC make_room_for_write(unique_lock<mutex> &lock);
+
+  /**
+   * @brief The delay of a write group, 0 if the writes are not slowed down.
+   * @note Called with `mu_` held.
+   */
+  uint64_t write_delay_us() const;
+
+  /**
+   * @brief The number of level 0 files (leveled compaction) or runs (tired compaction).
+   * @note Called with `mu_` held.
+   */
+  size_t level0_file_num() const;
+
+  static uint64_t elapsed_us(chrono::steady_clock::time_point begin);
+
+  /**
+   * @brief Submits a compaction task to the background thread if there isn't one waiting.
+   */
+  void schedule_compaction();
+
   /**
    * @brief Attempts to freeze the current active MemTable.
    *
@@ -85,6 +188,34 @@ private:
    */
   RC try_freeze_memtable();
 
+  /**
+   * @brief The state shared by the subcompactions of a compaction.
+   */
+  struct CompactionState
+  {
+    ObCompaction *picked = nullptr;
+    // the sstables when the compaction starts
+    SSTablesPtr sstables;
+    uint64_t    smallest_snapshot = 0;
+    // tired compaction, whether the oldest run is compacted
+    bool all_keys_in_base = false;
+  };
+
+  /**
+   * @brief A user key range [start, end) of a compaction, merged into its own SSTables.
+   */
+  struct SubCompaction
+  {
+    string start;
+    bool   has_start = false;  ///< false means from the first key
+    string end;
+    bool   has_end = false;  ///< false means to the last key
+
+    vector<shared_ptr<ObSSTable>> results;
+    size_t                        dropped = 0;
+    RC                            rc      = RC::SUCCESS;
+  };
+
   /**
    * @brief Performs compaction on the SSTables selected by the compaction strategy.
    *
@@ -94,22 +225,54 @@ private:
    *
    * @param picked A pointer to the compaction plan that specifies the input SSTables to merge.
    *               If `picked` is `nullptr`, no compaction is performed and an empty result is returned.
+   * @param results The newly created SSTables resulting from the compaction process.
    *
-   * @return vector<shared_ptr<ObSSTable>> A vector of shared pointers to the newly created SSTables
-   *                                       resulting from the compaction process.
+   * @return RC Status code. If it fails, the created SSTables are removed and the inputs must be kept.
    *
    * @details
    * - The function retrieves the inputs (SSTables) from the `picked` compaction plan.
+   * - The inputs are split into at most `options_.max_subcompactions` user key ranges (see
+   *   `split_compaction`). The ranges are merged in parallel by `subcompaction_executor_` and the
+   *   background thread, each one writes its own SSTables, see `do_subcompaction`.
    * - For each SSTable, it creates a new iterator to sequentially scan its data.
    * - It merges the iterators using a merging iterator (`ObLsmIterator`).
    * - It writes the merged key-value pairs into new SSTable files using `ObSSTableBuilder`.
+   * - The versions that no reader can see are dropped: a version is dropped if a newer version of the
+   *   same user key is visible to the oldest snapshot (see `smallest_snapshot`), and a delete visible to
+   *   the oldest snapshot is dropped if no older sstable outside the compaction may contain the key.
    * - If the size of the new SSTable exceeds a predefined size (`options_.table_size`),
-   *   the builder finalizes the current SSTable and starts a new one.
+   *   the builder finalizes the current SSTable and starts a new one. All versions of a user key
+   *   are written into the same SSTable, so the SSTables of a level never overlap.
    *
    * @warning Ensure that the `picked` object is properly populated with valid inputs.
    *
    */
-  vector<shared_ptr<ObSSTable>> do_compaction(ObCompaction *compaction);
+  RC do_compaction(ObCompaction *compaction, vector<shared_ptr<ObSSTable>> &results);
+
+  /**
+   * @brief Splits a compaction into key ranges with about the same input bytes.
+   *
+   * A range is at least `options_.table_size` bytes, so small compactions are not split.
+   */
+  vector<SubCompaction> split_compaction(ObCompaction *picked) const;
+
+  /**
+   * @brief Merges the inputs of a compaction in the range of `sub` into `sub.results`.
+   *
+   * If it fails, `sub.rc` is set and the table being built is removed, the finished tables are
+   * kept in `sub.results` and removed by `do_compaction`.
+   */
+  void do_subcompaction(const CompactionState &state, SubCompaction &sub);
+
+  /**
+   * @brief Whether no sstable older than the compaction inputs may contain `user_key`.
+   */
+  bool is_base_level_for_key(const CompactionState &state, const string_view &user_key) const;
+
+  /**
+   * @brief Sorts the sstables of a level (except level 0) of leveled compaction by key.
+   */
+  void sort_sstables(vector<shared_ptr<ObSSTable>> &sstables) const;
 
   /**
    * @brief Initiates a major compaction process.
@@ -138,9 +301,17 @@ private:
    *
    * @param imem A shared pointer to the immutable MemTable (`ObMemTable`) to be converted
    *             into an SSTable.
+   * @param sstable The built SSTable, it is not added to `sstables_` yet.
    * @note The caller must ensure that `imem` is immutable and ready for conversion.
+   *       It doesn't need `mu_`, so the writes are not blocked while the SSTable is written.
+   */
+  RC build_sstable(shared_ptr<ObMemTable> imem, shared_ptr<ObSSTable> &sstable);
+
+  /**
+   * @brief Adds a SSTable built from a memtable to level 0 and records it in the manifest.
+   * @note Called with `mu_` held.
    */
-  void build_sstable(shared_ptr<ObMemTable> imem);
+  RC install_level0_sstable(const shared_ptr<ObSSTable> &sstable);
 
   /**
    * @brief Retrieves the file path for a given SSTable.
@@ -167,16 +338,40 @@ private:
   vector<shared_ptr<ObMemTable>>    imem_tables_;
   SSTablesPtr                       sstables_;
   common::ThreadPoolExecutor        executor_;
+  // merges the ranges of a compaction in parallel, see `do_compaction`
+  common::ThreadPoolExecutor        subcompaction_executor_;
   ObManifest                        manifest_;
   atomic<uint64_t>                  seq_{0};
   atomic<uint64_t>                  sstable_id_{0};
   atomic<uint64_t>                  memtable_id_{0};
   condition_variable                cv_;
+  deque<Writer *>                   writers_;
+  // the sequences of the live snapshots, protected by `mu_`
+  multiset<uint64_t> snapshots_;
+  // the max size of the WAL records written by a writer group
+  static constexpr size_t MAX_WRITE_GROUP_SIZE = 1 << 20;
   // TODO: use global variable?
   const ObDefaultComparator                                  default_comparator_;
   const ObInternalKeyComparator                              internal_key_comparator_;
   atomic<bool>                                               compacting_ = false;
+  // a compaction task has been submitted by `schedule_compaction` and has not started
+  atomic<bool> compaction_scheduled_ = false;
+  // set when the lsm is being destroyed, the background flush stops retrying
+  atomic<bool> closing_ = false;
+  static constexpr int FLUSH_RETRY_INTERVAL_MS = 100;
+
+  struct
+  {
+    atomic<uint64_t> slowdown_count{0};
+    atomic<uint64_t> slowdown_us{0};
+    atomic<uint64_t> memtable_stop_count{0};
+    atomic<uint64_t> memtable_stop_us{0};
+    atomic<uint64_t> level0_stop_count{0};
+    atomic<uint64_t> level0_stop_us{0};
+  } stall_stats_;
   std::unique_ptr<ObLRUCache<uint64_t, shared_ptr<ObBlock>>> block_cache_;
+  // limits the write rate of compaction, nullptr if there is no limit
+  std::unique_ptr<ObRateLimiter> rate_limiter_;
 };
 
 }  // namespace oceanbase
\ No newline at end of file
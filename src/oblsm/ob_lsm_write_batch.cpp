@@ -0,0 +1,76 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "oblsm/include/ob_lsm_write_batch.h"
+#include "common/log/log.h"
+#include "oblsm/util/ob_coding.h"
+
+namespace oceanbase {
+
+void ObWriteBatch::put(const string_view &key, const string_view &value)
+{
+  put_numeric<size_t>(&rep_, key.size());
+  rep_.append(key.data(), key.size());
+  put_numeric<size_t>(&rep_, value.size());
+  rep_.append(value.data(), value.size());
+  count_++;
+}
+
+void ObWriteBatch::clear()
+{
+  rep_.clear();
+  count_ = 0;
+}
+
+void ObWriteBatch::set_rep(string rep, size_t count)
+{
+  rep_   = std::move(rep);
+  count_ = count;
+}
+
+RC ObWriteBatch::for_each(const function<RC(const string_view &key, const string_view &value)> &handler) const
+{
+  const char *data  = rep_.data();
+  size_t      left  = rep_.size();
+  size_t      found = 0;
+  while (left > 0) {
+    string_view kv[2];
+    for (string_view &field : kv) {
+      if (left < sizeof(size_t)) {
+        LOG_WARN("write batch is broken. count=%lu, size=%lu", count_, rep_.size());
+        return RC::INVALID_ARGUMENT;
+      }
+      size_t len = get_numeric<size_t>(data);
+      data += sizeof(size_t);
+      left -= sizeof(size_t);
+      if (left < len) {
+        LOG_WARN("write batch is broken. count=%lu, size=%lu", count_, rep_.size());
+        return RC::INVALID_ARGUMENT;
+      }
+      field = string_view(data, len);
+      data += len;
+      left -= len;
+    }
+
+    RC rc = handler(kv[0], kv[1]);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    found++;
+  }
+
+  if (found != count_) {
+    LOG_WARN("write batch count mismatch. count=%lu, found=%lu", count_, found);
+    return RC::INVALID_ARGUMENT;
+  }
+  return RC::SUCCESS;
+}
+
+}  // namespace oceanbase
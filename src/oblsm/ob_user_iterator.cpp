@@ -42,6 +42,7 @@ public:
 
   void seek(const string_view &target) override
   {
+    lookup_key_.clear();
     put_numeric<uint64_t>(&lookup_key_, target.size() + SEQ_SIZE);
     lookup_key_.append(target.data(), target.size());
     put_numeric<uint64_t>(&lookup_key_, seq_);
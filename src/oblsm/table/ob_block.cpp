@@ -11,31 +11,118 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/table/ob_block.h"
 #include "oblsm/util/ob_coding.h"
 #include "common/lang/memory.h"
+#include "common/log/log.h"
 
 namespace oceanbase {
 
 RC ObBlock::decode(const string &data)
 {
-  return RC::UNIMPLEMENTED;
+  const size_t trailer_size = 2 * sizeof(uint32_t);
+  if (data.size() < trailer_size) {
+    LOG_WARN("block data is too short. size=%lu", data.size());
+    return RC::INVALID_ARGUMENT;
+  }
+  const char *data_ptr      = data.data();
+  uint32_t    restart_count = get_numeric<uint32_t>(data_ptr + data.size() - trailer_size);
+  uint32_t    entry_count   = get_numeric<uint32_t>(data_ptr + data.size() - sizeof(uint32_t));
+  if (restart_count > (data.size() - trailer_size) / sizeof(uint32_t) || (restart_count == 0) != (entry_count == 0)) {
+    LOG_WARN("invalid block data. size=%lu, restart count=%u, entry count=%u", data.size(), restart_count, entry_count);
+    return RC::INVALID_ARGUMENT;
+  }
+  const size_t data_size = data.size() - trailer_size - restart_count * sizeof(uint32_t);
+
+  restarts_.clear();
+  restarts_.reserve(restart_count);
+  const char *restart_ptr = data_ptr + data_size;
+  for (uint32_t i = 0; i < restart_count; i++) {
+    uint32_t restart = get_numeric<uint32_t>(restart_ptr + i * sizeof(uint32_t));
+    if (restart >= data_size) {
+      LOG_WARN("invalid block restart point. data size=%lu, restart=%u", data_size, restart);
+      return RC::INVALID_ARGUMENT;
+    }
+    restarts_.push_back(restart);
+  }
+  data_.assign(data_ptr, data_size);
+  count_ = entry_count;
+  return RC::SUCCESS;
 }
 
-string_view ObBlock::get_entry(uint32_t offset) const
+ObLsmIterator *ObBlock::new_iterator() const { return new BlockIterator(comparator_, this); }
+
+void BlockIterator::seek_to_restart_point(uint32_t index)
 {
-  uint32_t    curr_begin = offsets_[offset];
-  uint32_t    curr_end   = offset == offsets_.size() - 1 ? data_.size() : offsets_[offset + 1];
-  string_view curr       = string_view(data_.data() + curr_begin, curr_end - curr_begin);
-  return curr;
+  key_.clear();
+  next_offset_ = data_->restart_point(index);
 }
 
-ObLsmIterator *ObBlock::new_iterator() const { return new BlockIterator(comparator_, this, size()); }
+bool BlockIterator::parse_next_entry()
+{
+  const string_view entries = data_->entries();
+  current_                  = next_offset_;
+  if (current_ >= entries.size()) {
+    mark_invalid();
+    return false;
+  }
+
+  const size_t header_size = 3 * sizeof(uint32_t);
+  const char  *p           = entries.data() + current_;
+  const size_t left        = entries.size() - current_;
+  if (left < header_size) {
+    LOG_WARN("block entry is broken. offset=%u", current_);
+    mark_invalid();
+    return false;
+  }
+  uint32_t shared     = get_numeric<uint32_t>(p);
+  uint32_t non_shared = get_numeric<uint32_t>(p + sizeof(uint32_t));
+  uint32_t value_size = get_numeric<uint32_t>(p + 2 * sizeof(uint32_t));
+  if (shared > key_.size() || left - header_size < static_cast<size_t>(non_shared) + value_size) {
+    LOG_WARN("block entry is broken. offset=%u", current_);
+    mark_invalid();
+    return false;
+  }
 
-void BlockIterator::parse_entry()
+  key_.resize(shared);
+  key_.append(p + header_size, non_shared);
+  value_       = string_view(p + header_size + non_shared, value_size);
+  next_offset_ = current_ + header_size + non_shared + value_size;
+  return true;
+}
+
+string_view BlockIterator::restart_key(uint32_t index) const
 {
-  curr_entry_         = data_->get_entry(index_);
-  uint32_t key_size   = get_numeric<uint32_t>(curr_entry_.data());
-  key_                = string_view(curr_entry_.data() + sizeof(uint32_t), key_size);
-  uint32_t value_size = get_numeric<uint32_t>(curr_entry_.data() + sizeof(uint32_t) + key_size);
-  value_              = string_view(curr_entry_.data() + 2 * sizeof(uint32_t) + key_size, value_size);
+  const string_view entries = data_->entries();
+  const uint32_t    offset  = data_->restart_point(index);
+  const size_t      left    = entries.size() - offset;
+  if (left < 3 * sizeof(uint32_t)) {
+    return string_view();
+  }
+  uint32_t non_shared = get_numeric<uint32_t>(entries.data() + offset + sizeof(uint32_t));
+  if (left - 3 * sizeof(uint32_t) < non_shared) {
+    return string_view();
+  }
+  return string_view(entries.data() + offset + 3 * sizeof(uint32_t), non_shared);
+}
+
+void BlockIterator::seek_to_first()
+{
+  if (data_->restart_count() == 0) {
+    mark_invalid();
+    return;
+  }
+  seek_to_restart_point(0);
+  parse_next_entry();
+}
+
+void BlockIterator::seek_to_last()
+{
+  if (data_->restart_count() == 0) {
+    mark_invalid();
+    return;
+  }
+  seek_to_restart_point(data_->restart_count() - 1);
+  while (parse_next_entry() && next_offset_ < data_->entries().size()) {
+    // keep going to the last entry
+  }
 }
 
 string BlockMeta::encode() const
@@ -70,13 +157,36 @@ RC BlockMeta::decode(const string &data)
 
 void BlockIterator::seek(const string_view &lookup_key)
 {
-   index_ = 0;
-   while(valid()) {
-    parse_entry();
-    if (comparator_->compare(extract_user_key(key_), extract_user_key_from_lookup_key(lookup_key)) >= 0) {
-      break;
+  if (data_->restart_count() == 0) {
+    mark_invalid();
+    return;
+  }
+  const string_view target = extract_user_key_from_lookup_key(lookup_key);
+
+  // find the last restart point whose key is less than the target,
+  // the first key that is not less than the target is after it.
+  uint32_t left  = 0;
+  uint32_t right = data_->restart_count() - 1;
+  while (left < right) {
+    uint32_t          mid = left + (right - left + 1) / 2;
+    const string_view key = restart_key(mid);
+    if (key.size() < SEQ_SIZE) {
+      LOG_WARN("block restart point is broken. restart=%u", mid);
+      mark_invalid();
+      return;
+    }
+    if (comparator_->compare(extract_user_key(key), target) < 0) {
+      left = mid;
+    } else {
+      right = mid - 1;
+    }
+  }
+
+  seek_to_restart_point(left);
+  while (parse_next_entry()) {
+    if (comparator_->compare(extract_user_key(key_), target) >= 0) {
+      return;
     }
-    index_++;
-   }
+  }
 }
 }  // namespace oceanbase
@@ -25,26 +25,28 @@ namespace oceanbase {
 //      ├─────────────────┤    │
 //      │      ..         │    │
 //      ├─────────────────┤    │
-//      │    entry n      │◄─┐ │
-//      ├─────────────────┤  │ │
-// ┌───►│  offset size(n) │  │ │
-// │    ├─────────────────┤  │ │
-// │    │    offset 1     ├──┼─┘
-// │    ├─────────────────┤  │
-// │    │      ..         │  │
-// │    ├─────────────────┤  │
-// │    │    offset n     ├──┘
-// │    ├─────────────────┤
-// └────┤  offset start   │
+//      │    entry n      │    │
+//      ├─────────────────┤    │
+//      │   restart 1     ├────┘
+//      ├─────────────────┤
+//      │      ..         │
+//      ├─────────────────┤
+//      │   restart m     │
+//      ├─────────────────┤
+//      │ restart count(m)│
+//      ├─────────────────┤
+//      │ entry count(n)  │
 //      └─────────────────┘
+// entry: shared(uint32) | non_shared(uint32) | value size(uint32) | key[shared:] | value
+// `shared` is the length of the common prefix with the previous key, it is 0 at the
+// restart points, which are the offsets of every `ObBlockBuilder::RESTART_INTERVAL`th entry.
 /**
  * @class ObBlock
  * @brief Represents a data block in the LSM-Tree.
  *
  * The `ObBlock` class manages a block of serialized key-value pairs, along with
- * their offsets, for efficient storage and retrieval. It provides methods to decode
- * serialized data, access individual entries, and create iterators for traversing
- * the block contents.
+ * their restart points, for efficient storage and retrieval. It provides methods to decode
+ * serialized data and create iterators for traversing the block contents.
  */
 class ObBlock
 {
@@ -52,19 +54,29 @@ class ObBlock
 public:
   ObBlock(const ObComparator *comparator) : comparator_(comparator) {}
 
-  void add_offset(uint32_t offset) { offsets_.push_back(offset); }
+  /**
+   * @brief Number of entries in the block.
+   */
+  int size() const { return count_; }
 
-  uint32_t get_offset(int index) const { return offsets_[index]; }
+  uint32_t restart_count() const { return restarts_.size(); }
+  uint32_t restart_point(uint32_t index) const { return restarts_[index]; }
 
-  string_view get_entry(uint32_t offset) const;
+  /**
+   * @brief The entries of the block, without the restart points.
+   */
+  string_view entries() const { return data_; }
 
-  int size() const { return offsets_.size(); }
+  /**
+   * @brief Approximate memory used by the block, used as its charge in the block cache.
+   */
+  size_t memory_size() const { return sizeof(ObBlock) + data_.size() + restarts_.size() * sizeof(uint32_t); }
 
   /**
    * @brief Decodes serialized block data.
    *
    * This function parses and decodes the serialized string data to reconstruct
-   * the block's structure, including all key-value offsets and entries.
+   * the block's structure, including all entries and restart points.
    * The decoded data format can reference ObBlockBuilder.
    * @param data The serialized block data as a string.
    * @return RC The result code indicating the success or failure of the decode operation.
@@ -75,56 +87,68 @@ public:
 
 private:
   string           data_;
-  vector<uint32_t> offsets_;
+  vector<uint32_t> restarts_;
+  uint32_t         count_ = 0;
   // TODO: remove
   const ObComparator *comparator_;
 };
 
+/**
+ * @brief Iterates the entries of an ObBlock.
+ * @details `seek` binary searches the restart points by user key, then decodes the entries
+ * after the restart point. The key is rebuilt in the iterator, so it is valid until the
+ * iterator moves.
+ */
 class BlockIterator : public ObLsmIterator
 {
 public:
-  BlockIterator(const ObComparator *comparator, const ObBlock *data, uint32_t count)
-      : comparator_(comparator), data_(data), count_(count)
-  {}
+  BlockIterator(const ObComparator *comparator, const ObBlock *data) : comparator_(comparator), data_(data)
+  {
+    current_     = data_->entries().size();
+    next_offset_ = current_;
+  }
   BlockIterator(const BlockIterator &)            = delete;
   BlockIterator &operator=(const BlockIterator &) = delete;
 
   ~BlockIterator() override = default;
 
   void seek(const string_view &lookup_key) override;
-  void seek_to_first() override
-  {
-    index_ = 0;
-    parse_entry();
-  }
-  void seek_to_last() override
-  {
-    index_ = count_ - 1;
-    parse_entry();
-  }
+  void seek_to_first() override;
+  void seek_to_last() override;
 
-  bool valid() const override { return index_ < count_; }
-  void next() override
-  {
-    index_++;
-    if (valid()) {
-      parse_entry();
-    }
-  }
+  bool valid() const override { return current_ < data_->entries().size(); }
+  void next() override { parse_next_entry(); }
   string_view key() const override { return key_; };
   string_view value() const override { return value_; }
 
 private:
-  void parse_entry();
+  void seek_to_restart_point(uint32_t index);
+
+  /**
+   * @brief Decodes the entry after the current one.
+   * @return false if there are no more entries, and the iterator becomes invalid.
+   */
+  bool parse_next_entry();
+
+  /**
+   * @brief The key at a restart point, which is not prefix compressed.
+   */
+  string_view restart_key(uint32_t index) const;
+
+  void mark_invalid()
+  {
+    current_     = data_->entries().size();
+    next_offset_ = current_;
+  }
 
 private:
   const ObComparator  *comparator_;
   const ObBlock *const data_;
-  string_view          curr_entry_;
-  string_view          key_;
-  string_view          value_;
-  uint32_t             count_ = 0;
-  uint32_t             index_ = 0;
+  // offset of the current entry, it equals the entries size if the iterator is invalid
+  uint32_t    current_     = 0;
+  uint32_t    next_offset_ = 0;
+  string      key_;
+  string_view value_;
 };
 
 class BlockMeta
@@ -19,6 +19,10 @@ namespace oceanbase {
 
 /**
  * @brief Build a ObBlock in SSTable
+ * @details The keys are prefix compressed: an entry only stores the part of its key that
+ * differs from the previous key. Every `RESTART_INTERVAL` entries there is a restart
+ * point, whose key is stored entirely, so a lookup can binary search the restart points
+ * and then decode at most `RESTART_INTERVAL` entries. See `ObBlock` for the format.
  */
 class ObBlockBuilder
 {
@@ -30,20 +34,24 @@ public:
 
   void reset();
 
-  string last_key() const;
+  string last_key() const { return last_key_; }
 
-  uint32_t appro_size() { return data_.size() + offsets_.size() * sizeof(uint32_t); }
+  uint32_t appro_size() { return data_.size() + (restarts_.size() + 2) * sizeof(uint32_t); }
+
+  static const uint32_t RESTART_INTERVAL = 16;
 
 private:
   static const uint32_t BLOCK_SIZE = 4 * 1024;  // 4KB
-  // Offsets of key-value pairs.
-  vector<uint32_t> offsets_;
+  // Offsets of the restart points.
+  vector<uint32_t> restarts_;
+  // Number of entries since the last restart point.
+  uint32_t counter_ = 0;
+  // Number of entries in the block.
+  uint32_t count_ = 0;
   // key-value pairs
   // TODO: use block as data container
-  // TODO: add checksum
   string data_;
-
-  // string first_key_;
+  string last_key_;
 };
 
 }  // namespace oceanbase
@@ -12,47 +12,216 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/util/ob_coding.h"
 #include "common/log/log.h"
 #include "common/lang/filesystem.h"
+#include "common/math/crc.h"
+#include "oblsm/util/ob_compression.h"
 namespace oceanbase {
 
-void ObSSTable::init()
+RC ObSSTable::init()
 {
-  // your code here
+  file_reader_ = ObFileReader::create_file_reader(file_name_);
+  if (file_reader_ == nullptr) {
+    return RC::IOERR_OPEN;
+  }
+
+  const uint32_t footer_size = 2 * sizeof(uint32_t);
+  const uint32_t file_size   = file_reader_->file_size();
+  if (file_size < footer_size) {
+    LOG_WARN("sstable file is too short. file=%s, size=%u", file_name_.c_str(), file_size);
+    return RC::IOERR_READ;
+  }
+  string footer = file_reader_->read_pos(file_size - footer_size, footer_size);
+  if (footer.size() != footer_size) {
+    return RC::IOERR_READ;
+  }
+  uint32_t filter_offset = get_numeric<uint32_t>(footer.data());
+  uint32_t meta_offset   = get_numeric<uint32_t>(footer.data() + sizeof(uint32_t));
+  if (meta_offset > filter_offset || filter_offset > file_size - footer_size) {
+    LOG_WARN("invalid sstable footer. file=%s, meta offset=%u, filter offset=%u",
+        file_name_.c_str(), meta_offset, filter_offset);
+    return RC::IOERR_READ;
+  }
+
+  // block metas
+  string metas = file_reader_->read_pos(meta_offset, filter_offset - meta_offset);
+  if (metas.size() < sizeof(uint32_t)) {
+    LOG_WARN("failed to read block metas. file=%s", file_name_.c_str());
+    return RC::IOERR_READ;
+  }
+  const char *data_ptr   = metas.data();
+  uint32_t    meta_count = get_numeric<uint32_t>(data_ptr);
+  data_ptr += sizeof(uint32_t);
+  block_metas_.clear();
+  block_metas_.reserve(meta_count);
+  for (uint32_t i = 0; i < meta_count; i++) {
+    uint32_t meta_size = get_numeric<uint32_t>(data_ptr);
+    data_ptr += sizeof(uint32_t);
+    BlockMeta meta;
+    RC        rc = meta.decode(string(data_ptr, meta_size));
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to decode block meta. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+      return rc;
+    }
+    data_ptr += meta_size;
+    block_metas_.push_back(std::move(meta));
+  }
+
+  // bloom filter
+  filter_.reset();
+  uint32_t filter_size = file_size - footer_size - filter_offset;
+  if (filter_size > 0) {
+    string filter_data = file_reader_->read_pos(filter_offset, filter_size);
+    filter_            = make_unique<ObBloomfilter>();
+    RC rc              = filter_->decode(filter_data);
+    if (OB_FAIL(rc)) {
+      // the filter is only an optimization, the table is still readable without it
+      LOG_WARN("failed to decode bloom filter, ignore it. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+      filter_.reset();
+    }
+  }
+  return RC::SUCCESS;
 }
 
 shared_ptr<ObBlock> ObSSTable::read_block_with_cache(uint32_t block_idx) const
 {
-  // your code here
-  return nullptr;
+  if (block_cache_ == nullptr) {
+    return read_block(block_idx);
+  }
+
+  // sst ids are never reused, so (sst id, block index) identifies a block
+  uint64_t            cache_key = (static_cast<uint64_t>(sst_id_) << 32) | block_idx;
+  shared_ptr<ObBlock> block;
+  if (block_cache_->get(cache_key, block)) {
+    return block;
+  }
+  block = read_block(block_idx);
+  if (block != nullptr) {
+    block_cache_->put(cache_key, block, block->memory_size());
+  }
+  return block;
 }
 
 shared_ptr<ObBlock> ObSSTable::read_block(uint32_t block_idx) const
 {
-  // your code here
-  return nullptr;
+  const BlockMeta &meta = block_metas_[block_idx];
+  string           data = file_reader_->read_pos(meta.offset_, meta.size_);
+  if (data.size() != meta.size_ || data.size() < BLOCK_TRAILER_SIZE) {
+    LOG_WARN("failed to read block. file=%s, block=%u, size=%u, read=%lu",
+        file_name_.c_str(), block_idx, meta.size_, data.size());
+    return nullptr;
+  }
+
+  const size_t contents_size = data.size() - BLOCK_TRAILER_SIZE;
+  uint32_t     expected_crc  = get_numeric<uint32_t>(data.data() + contents_size + sizeof(uint8_t));
+  uint32_t     actual_crc    = crc32(data.data(), contents_size + sizeof(uint8_t));
+  if (expected_crc != actual_crc) {
+    LOG_WARN("block checksum mismatch. file=%s, block=%u, expected=%u, actual=%u",
+        file_name_.c_str(), block_idx, expected_crc, actual_crc);
+    return nullptr;
+  }
+
+  CompressionType     type       = static_cast<CompressionType>(static_cast<uint8_t>(data[contents_size]));
+  const ObCompressor *compressor = ObCompressor::get(type);
+  if (compressor == nullptr) {
+    LOG_WARN("unknown block compression type. file=%s, block=%u, type=%d",
+        file_name_.c_str(), block_idx, static_cast<int>(type));
+    return nullptr;
+  }
+  string contents;
+  if (type == CompressionType::NONE) {
+    data.resize(contents_size);
+    contents = std::move(data);
+  } else {
+    RC rc = compressor->decompress(string_view(data.data(), contents_size), &contents);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to decompress block. file=%s, block=%u, rc=%s", file_name_.c_str(), block_idx, strrc(rc));
+      return nullptr;
+    }
+  }
+
+  shared_ptr<ObBlock> block = make_shared<ObBlock>(comparator_);
+  RC                  rc    = block->decode(contents);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to decode block. file=%s, block=%u, rc=%s", file_name_.c_str(), block_idx, strrc(rc));
+    return nullptr;
+  }
+  return block;
 }
 
-void ObSSTable::remove() { filesystem::remove(file_name_); }
+RC ObSSTable::get(uint64_t seq, const string_view &key, string *value)
+{
+  if (block_metas_.empty() || !may_contain(key)) {
+    return RC::NOTFOUND;
+  }
+  if (comparator_->compare(key, extract_user_key(block_metas_.front().first_key_)) < 0 ||
+      comparator_->compare(key, extract_user_key(block_metas_.back().last_key_)) > 0) {
+    return RC::NOTFOUND;
+  }
+
+  string lookup_key;
+  put_numeric<uint64_t>(&lookup_key, key.size() + SEQ_SIZE);
+  lookup_key.append(key.data(), key.size());
+  put_numeric<uint64_t>(&lookup_key, seq);
+
+  // seek stops at the newest version of the key, skip the versions newer than `seq`
+  TableIterator iter(get_shared_ptr());
+  for (iter.seek(lookup_key); iter.valid(); iter.next()) {
+    string_view internal_key = iter.key();
+    if (comparator_->compare(extract_user_key(internal_key), key) != 0) {
+      break;
+    }
+    if (extract_sequence(internal_key) <= seq) {
+      if (iter.value().empty()) {  // for delete
+        return RC::NOT_EXIST;
+      }
+      value->assign(iter.value().data(), iter.value().size());
+      return RC::SUCCESS;
+    }
+  }
+  return RC::NOTFOUND;
+}
+
+void ObSSTable::remove()
+{
+  // blocks of a removed table will never be read again
+  if (block_cache_ != nullptr) {
+    for (uint32_t i = 0; i < block_metas_.size(); i++) {
+      block_cache_->erase((static_cast<uint64_t>(sst_id_) << 32) | i);
+    }
+  }
+  filesystem::remove(file_name_);
+}
 
 ObLsmIterator *ObSSTable::new_iterator() { return new TableIterator(get_shared_ptr()); }
 
-void TableIterator::read_block_with_cache()
+bool TableIterator::read_block_with_cache()
 {
   block_ = sst_->read_block_with_cache(curr_block_idx_);
+  if (block_ == nullptr) {
+    block_iterator_ = nullptr;
+    return false;
+  }
   block_iterator_.reset(block_->new_iterator());
+  return true;
 }
 
 void TableIterator::seek_to_first()
 {
   curr_block_idx_ = 0;
-  read_block_with_cache();
-  block_iterator_->seek_to_first();
+  if (block_cnt_ > 0 && read_block_with_cache()) {
+    block_iterator_->seek_to_first();
+  } else {
+    block_iterator_ = nullptr;
+  }
 }
 
 void TableIterator::seek_to_last()
 {
   curr_block_idx_ = block_cnt_ - 1;
-  read_block_with_cache();
-  block_iterator_->seek_to_last();
+  if (block_cnt_ > 0 && read_block_with_cache()) {
+    block_iterator_->seek_to_last();
+  } else {
+    block_iterator_ = nullptr;
+  }
 }
 
 void TableIterator::next()
@@ -61,27 +230,35 @@ void TableIterator::next()
   if (block_iterator_->valid()) {
   } else if (curr_block_idx_ < block_cnt_ - 1) {
     curr_block_idx_++;
-    read_block_with_cache();
-    block_iterator_->seek_to_first();
+    if (read_block_with_cache()) {
+      block_iterator_->seek_to_first();
+    }
   }
 }
 
 void TableIterator::seek(const string_view &lookup_key)
 {
-  curr_block_idx_ = 0;
-  // TODO: use binary search
-  for (; curr_block_idx_ < block_cnt_; curr_block_idx_++) {
-    const auto &block_meta = sst_->block_meta(curr_block_idx_);
-    if (sst_->comparator()->compare(extract_user_key(block_meta.last_key_), extract_user_key_from_lookup_key(lookup_key)) >= 0) {
-      break;
+  // find the first block whose last key is not less than the target
+  const string_view target = extract_user_key_from_lookup_key(lookup_key);
+  uint32_t          left   = 0;
+  uint32_t          right  = block_cnt_;
+  while (left < right) {
+    uint32_t    mid        = left + (right - left) / 2;
+    const auto &block_meta = sst_->block_meta(mid);
+    if (sst_->comparator()->compare(extract_user_key(block_meta.last_key_), target) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
     }
   }
+  curr_block_idx_ = left;
   if (curr_block_idx_ == block_cnt_) {
     block_iterator_ = nullptr;
     return;
   }
-  read_block_with_cache();
-  block_iterator_->seek(lookup_key);
-};
+  if (read_block_with_cache()) {
+    block_iterator_->seek(lookup_key);
+  }
+}
 
 }  // namespace oceanbase
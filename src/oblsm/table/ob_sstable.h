@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/memory.h"
 #include "common/sys/rc.h"
 #include "oblsm/table/ob_block.h"
+#include "oblsm/util/ob_bloomfilter.h"
 #include "oblsm/util/ob_comparator.h"
 #include "oblsm/util/ob_lru_cache.h"
 
@@ -40,8 +41,17 @@ namespace oceanbase {
 // │  ├─────────────────┤ │
 // │  │  block meta n   ┼─┘
 // │  ├─────────────────┤
-// └──┼                 │
+// │  │  bloom filter   │◄─┐
+// │  ├─────────────────┤  │
+// │  │  filter offset  ┼──┘
+// │  ├─────────────────┤
+// └──┼   meta offset   │
 //    └─────────────────┘
+// The bloom filter is built on user keys and may be empty.
+// block: | contents | compression type(uint8) | crc32(uint32) |
+// The contents are the `ObBlock` data compressed by the codec of the type, the crc32 covers the
+// contents and the type. The block cache holds the uncompressed blocks.
+static constexpr size_t BLOCK_TRAILER_SIZE = sizeof(uint8_t) + sizeof(uint32_t);
 
 /**
  * @class ObSSTable
@@ -72,9 +82,7 @@ public:
         comparator_(comparator),
         file_reader_(nullptr),
         block_cache_(block_cache)
-  {
-    (void)block_cache_;
-  }
+  {}
 
   ~ObSSTable() = default;
 
@@ -86,10 +94,12 @@ public:
    *
    * @warning This function must be called before performing any operations on the SSTable.
    */
-  void init();
+  RC init();
 
   uint32_t sst_id() const { return sst_id_; }
 
+  const string &file_name() const { return file_name_; }
+
   shared_ptr<ObSSTable> get_shared_ptr() { return shared_from_this(); }
 
   ObLsmIterator *new_iterator();
@@ -118,8 +128,30 @@ public:
    */
   shared_ptr<ObBlock> read_block(uint32_t block_idx) const;
 
+  /**
+   * @brief Looks up the newest version of `key` whose sequence number is not greater than `seq`.
+   *
+   * The bloom filter and the key range of the table are checked first, so a lookup of a key
+   * that isn't in the table usually reads no block.
+   *
+   * @return RC::SUCCESS if the key is found, RC::NOT_EXIST if the key has been deleted,
+   *         RC::NOTFOUND if the table doesn't contain the key.
+   */
+  RC get(uint64_t seq, const string_view &key, string *value);
+
   uint32_t block_count() const { return block_metas_.size(); }
 
+  /**
+   * @brief Checks the bloom filter of the SSTable.
+   *
+   * @param user_key The user key to look up.
+   * @return false if the SSTable definitely doesn't contain `user_key`, true if it may contain it.
+   */
+  bool may_contain(const string_view &user_key) const
+  {
+    return filter_ == nullptr || filter_->contains(user_key);
+  }
+
   uint32_t size() const { return file_reader_->file_size(); }
 
   const BlockMeta block_meta(int i) const { return block_metas_[i]; }
@@ -136,6 +168,7 @@ private:
   const ObComparator      *comparator_ = nullptr;
   unique_ptr<ObFileReader> file_reader_;
   vector<BlockMeta>        block_metas_;
+  unique_ptr<ObBloomfilter> filter_;
 
   ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache_;
 };
@@ -155,7 +188,7 @@ public:
   string_view value() const override { return block_iterator_->value(); }
 
 private:
-  void read_block_with_cache();
+  bool read_block_with_cache();
 
   const shared_ptr<ObSSTable> sst_;
   uint32_t                    block_cnt_      = 0;
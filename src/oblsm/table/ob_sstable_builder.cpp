@@ -10,31 +10,145 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/table/ob_sstable_builder.h"
 #include "oblsm/util/ob_coding.h"
+#include "oblsm/util/ob_bloomfilter.h"
+#include "common/log/log.h"
+#include "common/math/crc.h"
 
 namespace oceanbase {
 
-// TODO: refactor build with mem_table/iterator logic.
 RC ObSSTableBuilder::build(shared_ptr<ObMemTable> mem_table, const std::string &file_name, uint32_t sst_id)
 {
-  return RC::UNIMPLEMENTED;
+  RC rc = open(file_name, sst_id);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  unique_ptr<ObLsmIterator> iter(mem_table->new_iterator());
+  for (iter->seek_to_first(); iter->valid(); iter->next()) {
+    rc = add(iter->key(), iter->value());
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return finish();
+}
+
+RC ObSSTableBuilder::open(const string &file_name, uint32_t sst_id)
+{
+  reset();
+  sst_id_      = sst_id;
+  file_writer_ = ObFileWriter::create_file_writer(file_name, false);
+  if (file_writer_ == nullptr) {
+    LOG_WARN("failed to create sstable file %s", file_name.c_str());
+    return RC::IOERR_OPEN;
+  }
+  file_writer_->set_rate_limiter(rate_limiter_);
+  return RC::SUCCESS;
+}
+
+RC ObSSTableBuilder::add(const string_view &key, const string_view &value)
+{
+  if (curr_blk_first_key_.empty()) {
+    curr_blk_first_key_.assign(key.data(), key.size());
+  }
+  RC rc = block_builder_.add(key, value);
+  if (rc == RC::FULL) {
+    finish_build_block();
+    curr_blk_first_key_.assign(key.data(), key.size());
+    rc = block_builder_.add(key, value);
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to add entry into block. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // versions of a user key are adjacent, only the first one goes into the filter
+  string_view user_key = extract_user_key(key);
+  if (key_hashes_.empty() || user_key != last_user_key_) {
+    key_hashes_.push_back(ObBloomfilter::hash(user_key));
+    last_user_key_.assign(user_key.data(), user_key.size());
+  }
+  return rc;
+}
+
+RC ObSSTableBuilder::finish()
+{
+  if (!curr_blk_first_key_.empty()) {
+    finish_build_block();
+  }
+  return finish_build_table();
 }
 
 void ObSSTableBuilder::finish_build_block()
 {
   string      last_key       = block_builder_.last_key();
   string_view block_contents = block_builder_.finish();
-  file_writer_->write(block_contents);
-  block_metas_.push_back(BlockMeta(curr_blk_first_key_, last_key, curr_offset_, block_contents.size()));
+
+  // keep the block uncompressed if the codec doesn't save enough space
+  CompressionType     type       = CompressionType::NONE;
+  const ObCompressor *compressor = ObCompressor::get(compression_);
+  block_buf_.clear();
+  if (compressor != nullptr && compression_ != CompressionType::NONE &&
+      OB_SUCC(compressor->compress(block_contents, &block_buf_)) &&
+      block_buf_.size() < block_contents.size() - block_contents.size() / 8) {
+    type = compression_;
+  } else {
+    block_buf_.assign(block_contents.data(), block_contents.size());
+  }
+  block_buf_.push_back(static_cast<char>(type));
+  put_numeric<uint32_t>(&block_buf_, crc32(block_buf_.data(), block_buf_.size()));
+
+  file_writer_->write(block_buf_);
+  block_metas_.push_back(BlockMeta(curr_blk_first_key_, last_key, curr_offset_, block_buf_.size()));
   // TODO: block aligned to BLOCK_SIZE
-  curr_offset_ += block_contents.size();
+  curr_offset_ += block_buf_.size();
   block_builder_.reset();
+  curr_blk_first_key_.clear();
+}
+
+RC ObSSTableBuilder::finish_build_table()
+{
+  string buf;
+  put_numeric<uint32_t>(&buf, block_metas_.size());
+  for (const BlockMeta &block_meta : block_metas_) {
+    string meta = block_meta.encode();
+    put_numeric<uint32_t>(&buf, meta.size());
+    buf.append(meta);
+  }
+  uint32_t meta_offset   = curr_offset_;
+  uint32_t filter_offset = meta_offset + buf.size();
+
+  if (bloom_filter_bits_per_key_ > 0 && !key_hashes_.empty()) {
+    unique_ptr<ObBloomfilter> filter = ObBloomfilter::create(key_hashes_.size(), bloom_filter_bits_per_key_);
+    for (uint64_t hash_value : key_hashes_) {
+      filter->insert_hash(hash_value);
+    }
+    buf.append(filter->encode());
+  }
+  put_numeric<uint32_t>(&buf, filter_offset);
+  put_numeric<uint32_t>(&buf, meta_offset);
+
+  RC rc = file_writer_->write(buf);
+  if (OB_SUCC(rc)) {
+    rc = file_writer_->flush();
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write sstable %s. rc=%s", file_writer_->file_name().c_str(), strrc(rc));
+    return rc;
+  }
+  file_size_ = curr_offset_ + buf.size();
+  return rc;
 }
 
 shared_ptr<ObSSTable> ObSSTableBuilder::get_built_table()
 {
   // TODO: sstable should have more metadata
   shared_ptr<ObSSTable> sstable = make_shared<ObSSTable>(sst_id_, file_writer_->file_name(), comparator_, block_cache_);
-  sstable->init();
+  RC rc = sstable->init();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open built sstable %s. rc=%s", sstable->file_name().c_str(), strrc(rc));
+    return nullptr;
+  }
   return sstable;
 }
 
@@ -49,5 +163,7 @@ void ObSSTableBuilder::reset()
   curr_offset_ = 0;
   sst_id_      = 0;
   file_size_   = 0;
+  key_hashes_.clear();
+  last_user_key_.clear();
 }
 }  // namespace oceanbase
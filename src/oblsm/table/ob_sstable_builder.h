@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/table/ob_block.h"
 #include "oblsm/table/ob_sstable.h"
 #include "oblsm/util/ob_lru_cache.h"
+#include "oblsm/util/ob_compression.h"
 
 namespace oceanbase {
 
@@ -27,8 +28,12 @@ namespace oceanbase {
 class ObSSTableBuilder
 {
 public:
-  ObSSTableBuilder(const ObComparator *comparator, ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache)
-      : comparator_(comparator), block_cache_(block_cache)
+  /**
+   * @param bloom_filter_bits_per_key Bits of the bloom filter for each user key, 0 means no filter.
+   */
+  ObSSTableBuilder(const ObComparator *comparator, ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache,
+      size_t bloom_filter_bits_per_key = 10)
+      : comparator_(comparator), block_cache_(block_cache), bloom_filter_bits_per_key_(bloom_filter_bits_per_key)
   {}
   ~ObSSTableBuilder() = default;
 
@@ -45,13 +50,49 @@ public:
    * @return RC A result code indicating the success or failure of the SSTable creation process.
    *
    */
-  RC                    build(shared_ptr<ObMemTable> mem_table, const string &file_name, uint32_t sst_id);
+  RC build(shared_ptr<ObMemTable> mem_table, const string &file_name, uint32_t sst_id);
+
+  /**
+   * @brief Starts building a new SSTable, the entries are added by `add` and the table is
+   *        written out by `finish`.
+   */
+  RC open(const string &file_name, uint32_t sst_id);
+
+  /**
+   * @brief Appends an entry, the internal keys must be added in ascending order.
+   */
+  RC add(const string_view &key, const string_view &value);
+
+  RC finish();
+
+  /**
+   * @brief Size of the data added so far, before the table is finished.
+   */
+  size_t appro_size() { return curr_offset_ + block_builder_.appro_size(); }
+
+  /**
+   * @brief The user key of the last added entry.
+   */
+  const string &last_user_key() const { return last_user_key_; }
+
+  /**
+   * @brief Limits the write rate of the tables opened after this, nullptr means no limit.
+   */
+  void set_rate_limiter(ObRateLimiter *rate_limiter) { rate_limiter_ = rate_limiter; }
+
+  /**
+   * @brief Sets the codec of the blocks. A block is stored uncompressed if the codec saves
+   *        less than 1/8 of its size.
+   */
+  void set_compression(CompressionType compression) { compression_ = compression; }
+
   size_t                file_size() const { return file_size_; }
   shared_ptr<ObSSTable> get_built_table();
   void                  reset();
 
 private:
   void finish_build_block();
+  RC   finish_build_table();
 
   const ObComparator      *comparator_ = nullptr;
   ObBlockBuilder           block_builder_;
@@ -63,5 +104,14 @@ private:
   size_t                   file_size_   = 0;
 
   ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache_ = nullptr;
+  ObRateLimiter                             *rate_limiter_ = nullptr;
+  CompressionType                            compression_  = CompressionType::LZ4;
+  // the block being written, with its trailer
+  string block_buf_;
+
+  size_t bloom_filter_bits_per_key_ = 0;
+  // hash values of distinct user keys, the bloom filter is sized by the key count when the table is finished.
+  vector<uint64_t> key_hashes_;
+  string           last_user_key_;
 };
 }  // namespace oceanbase
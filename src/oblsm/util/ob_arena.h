@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 
 #include <cassert>
 #include "common/lang/atomic.h"
+#include "common/lang/mutex.h"
 #include "common/lang/vector.h"
 
 namespace oceanbase {
@@ -20,7 +21,7 @@ namespace oceanbase {
  * @brief a simple memory allocator.
  * @todo optimize fractional memory allocation
  * @note 1. alloc memory from arena, no need to free it.
- *       2. not thread-safe.
+ *       2. thread-safe, the memtable allocates from several writer threads at the same time.
  */
 class ObArena
 {
@@ -34,14 +35,17 @@ public:
 
   char *alloc(size_t bytes);
 
-  size_t memory_usage() const { return memory_usage_; }
+  size_t memory_usage() const { return memory_usage_.load(std::memory_order_relaxed); }
 
 private:
+  // Protects blocks_
+  mutex lock_;
+
   // Array of new[] allocated memory blocks
   vector<char *> blocks_;
 
   // Total memory usage of the arena.
-  size_t memory_usage_;
+  atomic<size_t> memory_usage_;
 };
 
 inline char *ObArena::alloc(size_t bytes)
@@ -50,8 +54,11 @@ inline char *ObArena::alloc(size_t bytes)
     return nullptr;
   }
   char *result = new char[bytes];
-  blocks_.push_back(result);
-  memory_usage_ += bytes + sizeof(char *);
+  {
+    lock_guard<mutex> guard(lock_);
+    blocks_.push_back(result);
+  }
+  memory_usage_.fetch_add(bytes + sizeof(char *), std::memory_order_relaxed);
   return result;
 }
 
@@ -9,5 +9,152 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "oblsm/util/ob_bloomfilter.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "oblsm/util/ob_coding.h"
 
-namespace oceanbase {}  // namespace oceanbase
+namespace oceanbase {
+
+ObBloomfilter::ObBloomfilter(size_t hash_func_count, size_t total_bits)
+{
+  reset(hash_func_count, (total_bits + BLOCK_BITS - 1) / BLOCK_BITS);
+}
+
+unique_ptr<ObBloomfilter> ObBloomfilter::create(size_t key_count, size_t bits_per_key)
+{
+  // k = ln2 * bits_per_key minimizes the false positive rate
+  size_t hash_func_count = static_cast<size_t>(bits_per_key * 69 / 100);
+  size_t total_bits      = max(key_count * bits_per_key, BLOCK_BITS);
+  return make_unique<ObBloomfilter>(hash_func_count, total_bits);
+}
+
+void ObBloomfilter::reset(size_t hash_func_count, size_t block_count)
+{
+  hash_func_count_ = min(max(hash_func_count, static_cast<size_t>(1)), MAX_HASH_FUNC);
+  block_count_     = max(block_count, static_cast<size_t>(1));
+  blocks_.reset(new Block[block_count_]);
+  clear();
+}
+
+uint64_t ObBloomfilter::hash(const string_view &object)
+{
+  // MurmurHash64A
+  const uint64_t m    = 0xc6a4a7935bd1e995ULL;
+  const int      r    = 47;
+  const char    *data = object.data();
+  const size_t   len  = object.size();
+  uint64_t       h    = 0x9747b28cULL ^ (len * m);
+
+  const size_t word_len = len / sizeof(uint64_t) * sizeof(uint64_t);
+  for (size_t i = 0; i < word_len; i += sizeof(uint64_t)) {
+    uint64_t k = get_numeric<uint64_t>(data + i);
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+
+  const unsigned char *tail = reinterpret_cast<const unsigned char *>(data + word_len);
+  switch (len & 7) {
+    case 7: h ^= static_cast<uint64_t>(tail[6]) << 48; [[fallthrough]];
+    case 6: h ^= static_cast<uint64_t>(tail[5]) << 40; [[fallthrough]];
+    case 5: h ^= static_cast<uint64_t>(tail[4]) << 32; [[fallthrough]];
+    case 4: h ^= static_cast<uint64_t>(tail[3]) << 24; [[fallthrough]];
+    case 3: h ^= static_cast<uint64_t>(tail[2]) << 16; [[fallthrough]];
+    case 2: h ^= static_cast<uint64_t>(tail[1]) << 8; [[fallthrough]];
+    case 1: h ^= static_cast<uint64_t>(tail[0]); h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+void ObBloomfilter::insert_hash(uint64_t hash_value)
+{
+  Block   &block = const_cast<Block &>(block_of(hash_value));
+  uint32_t h     = static_cast<uint32_t>(hash_value);
+  uint32_t delta = (h >> 17) | (h << 15);  // double hashing inside the block
+  for (size_t i = 0; i < hash_func_count_; i++) {
+    uint32_t bit = h % BLOCK_BITS;
+    block.words[bit / WORD_BITS].fetch_or(1ULL << (bit % WORD_BITS), std::memory_order_relaxed);
+    h += delta;
+  }
+  object_count_.fetch_add(1);
+}
+
+bool ObBloomfilter::contains_hash(uint64_t hash_value) const
+{
+  const Block &block = block_of(hash_value);
+  uint32_t     h     = static_cast<uint32_t>(hash_value);
+  uint32_t     delta = (h >> 17) | (h << 15);
+  for (size_t i = 0; i < hash_func_count_; i++) {
+    uint32_t bit = h % BLOCK_BITS;
+    if ((block.words[bit / WORD_BITS].load(std::memory_order_relaxed) & (1ULL << (bit % WORD_BITS))) == 0) {
+      return false;
+    }
+    h += delta;
+  }
+  return true;
+}
+
+void ObBloomfilter::clear()
+{
+  for (size_t i = 0; i < block_count_; i++) {
+    for (atomic<uint64_t> &word : blocks_[i].words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+  object_count_.store(0);
+}
+
+string ObBloomfilter::encode() const
+{
+  string ret;
+  ret.reserve(2 * sizeof(uint32_t) + sizeof(uint64_t) + block_count_ * BLOCK_BITS / 8);
+  put_numeric<uint32_t>(&ret, hash_func_count_);
+  put_numeric<uint32_t>(&ret, block_count_);
+  put_numeric<uint64_t>(&ret, object_count_.load());
+  for (size_t i = 0; i < block_count_; i++) {
+    for (const atomic<uint64_t> &word : blocks_[i].words) {
+      put_numeric<uint64_t>(&ret, word.load(std::memory_order_relaxed));
+    }
+  }
+  return ret;
+}
+
+RC ObBloomfilter::decode(const string_view &data)
+{
+  const size_t header_size = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+  if (data.size() < header_size) {
+    LOG_WARN("bloom filter data is too short. size=%lu", data.size());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const char *data_ptr        = data.data();
+  uint32_t    hash_func_count = get_numeric<uint32_t>(data_ptr);
+  data_ptr += sizeof(uint32_t);
+  uint32_t block_count = get_numeric<uint32_t>(data_ptr);
+  data_ptr += sizeof(uint32_t);
+  uint64_t object_count = get_numeric<uint64_t>(data_ptr);
+  data_ptr += sizeof(uint64_t);
+
+  if (block_count == 0 || data.size() != header_size + static_cast<size_t>(block_count) * BLOCK_BITS / 8) {
+    LOG_WARN("invalid bloom filter data. size=%lu, block count=%u", data.size(), block_count);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  reset(hash_func_count, block_count);
+  for (size_t i = 0; i < block_count_; i++) {
+    for (atomic<uint64_t> &word : blocks_[i].words) {
+      word.store(get_numeric<uint64_t>(data_ptr), std::memory_order_relaxed);
+      data_ptr += sizeof(uint64_t);
+    }
+  }
+  object_count_.store(object_count);
+  return RC::SUCCESS;
+}
+
+}  // namespace oceanbase
@@ -10,12 +10,21 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/atomic.h"
+#include "common/lang/memory.h"
 #include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/sys/rc.h"
+
 namespace oceanbase {
 
 /**
  * @class ObBloomfilter
- * @brief A simple Bloom filter implementation(Need to support concurrency).
+ * @brief A cache-line-blocked Bloom filter.
+ *
+ * The bits are split into 512-bit blocks (one cache line). All probes of a key fall into the
+ * same block, which is chosen by the high half of the key's hash, so a lookup touches only
+ * one cache line. `insert` and `contains` can be called concurrently.
  */
 class ObBloomfilter
 {
@@ -24,23 +33,43 @@ public:
    * @brief Constructs a Bloom filter with specified parameters.
    *
    * @param hash_func_count Number of hash functions to use. Default is 4.
-   * @param totoal_bits Total number of bits in the Bloom filter. Default is 65536.
+   * @param total_bits Total number of bits in the Bloom filter, rounded up to whole blocks. Default is 65536.
    */
-  ObBloomfilter(size_t hash_func_count = 4, size_t totoal_bits = 65536) {}
+  ObBloomfilter(size_t hash_func_count = 4, size_t total_bits = 65536);
+
+  ObBloomfilter(const ObBloomfilter &)            = delete;
+  ObBloomfilter &operator=(const ObBloomfilter &) = delete;
+
+  /**
+   * @brief Creates a filter sized for `key_count` keys with about `bits_per_key` bits each.
+   * @details The hash function count is chosen to minimize the false positive rate,
+   *          10 bits per key gives about 1%.
+   */
+  static unique_ptr<ObBloomfilter> create(size_t key_count, size_t bits_per_key);
+
+  /**
+   * @brief The hash used by the filter. It is persisted with SSTables, so it must never change.
+   */
+  static uint64_t hash(const string_view &object);
 
   /**
    * @brief Inserts an object into the Bloom filter.
    * @details This method computes hash values for the given object and sets corresponding bits in the filter.
    * @param object The object to be inserted.
    */
-  void insert(const string &object) {}
+  void insert(const string_view &object) { insert_hash(hash(object)); }
+
+  /**
+   * @brief Inserts an object by its hash value computed by `hash`.
+   */
+  void insert_hash(uint64_t hash_value);
 
   /**
    * @brief Clears all entries in the Bloom filter.
    *
    * @details Resets the filter, removing all previously inserted objects.
    */
-  void clear() {}
+  void clear();
 
   /**
    * @brief Checks if an object is possibly in the Bloom filter.
@@ -48,12 +77,17 @@ public:
    * @param object The object to be checked.
    * @return true if the object might be in the filter, false if definitely not.
    */
-  bool contains(const string &object) const { return false; }
+  bool contains(const string_view &object) const { return contains_hash(hash(object)); }
+
+  /**
+   * @brief Checks an object by its hash value computed by `hash`.
+   */
+  bool contains_hash(uint64_t hash_value) const;
 
   /**
    * @brief Returns the count of objects inserted into the Bloom filter.
    */
-  size_t object_count() const { return 0; }
+  size_t object_count() const { return object_count_.load(); }
 
   /**
    * @brief Checks if the Bloom filter is empty.
@@ -61,7 +95,44 @@ public:
    */
   bool empty() const { return 0 == object_count(); }
 
+  size_t hash_func_count() const { return hash_func_count_; }
+  size_t total_bits() const { return block_count_ * BLOCK_BITS; }
+
+  /**
+   * @brief Serializes the filter, the format is:
+   *        hash_func_count(uint32) | block_count(uint32) | object_count(uint64) | bits
+   */
+  string encode() const;
+
+  /**
+   * @brief Rebuilds the filter from the output of `encode`.
+   */
+  RC decode(const string_view &data);
+
+private:
+  static constexpr size_t WORD_BITS     = 64;
+  static constexpr size_t BLOCK_WORDS   = 8;
+  static constexpr size_t BLOCK_BITS    = WORD_BITS * BLOCK_WORDS;
+  static constexpr size_t MAX_HASH_FUNC = 30;
+
+  struct alignas(64) Block
+  {
+    atomic<uint64_t> words[BLOCK_WORDS];
+  };
+
+  void reset(size_t hash_func_count, size_t block_count);
+
+  const Block &block_of(uint64_t hash_value) const
+  {
+    // use the high half to pick the block and the low half to pick bits inside the block
+    return blocks_[((hash_value >> 32) * block_count_) >> 32];
+  }
+
 private:
+  size_t              hash_func_count_ = 0;
+  size_t              block_count_     = 0;
+  unique_ptr<Block[]> blocks_;
+  atomic<size_t>      object_count_{0};
 };
 
 }  // namespace oceanbase
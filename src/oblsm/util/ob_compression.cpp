@@ -0,0 +1,234 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <cstring>
+
+#include "oblsm/util/ob_compression.h"
+#include "oblsm/util/ob_coding.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+
+namespace oceanbase {
+
+namespace {
+
+constexpr size_t   MIN_MATCH     = 4;
+// the last 5 bytes are always literals, and the last match starts at least 12 bytes before the end
+constexpr size_t   LAST_LITERALS = 5;
+constexpr size_t   MF_LIMIT      = 12;
+constexpr size_t   MAX_OFFSET    = 65535;
+constexpr uint32_t HASH_BITS     = 12;
+// the search step grows by one every 2^SKIP_TRIGGER missed positions, so the incompressible data is
+// skipped quickly
+constexpr uint32_t SKIP_TRIGGER = 6;
+
+uint32_t read32(const char *p)
+{
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+uint32_t hash4(uint32_t v) { return (v * 2654435761U) >> (32 - HASH_BITS); }
+
+void put_length(string *output, size_t length)
+{
+  while (length >= 255) {
+    output->push_back(static_cast<char>(255));
+    length -= 255;
+  }
+  output->push_back(static_cast<char>(length));
+}
+
+void put_sequence(string *output, const char *literals, size_t literal_len, size_t offset, size_t match_len)
+{
+  const size_t ml    = match_len - MIN_MATCH;
+  uint8_t      token = static_cast<uint8_t>((std::min<size_t>(literal_len, 15) << 4) | std::min<size_t>(ml, 15));
+  output->push_back(static_cast<char>(token));
+  if (literal_len >= 15) {
+    put_length(output, literal_len - 15);
+  }
+  output->append(literals, literal_len);
+  output->push_back(static_cast<char>(offset & 0xFF));
+  output->push_back(static_cast<char>(offset >> 8));
+  if (ml >= 15) {
+    put_length(output, ml - 15);
+  }
+}
+
+void put_last_literals(string *output, const char *literals, size_t literal_len)
+{
+  output->push_back(static_cast<char>(std::min<size_t>(literal_len, 15) << 4));
+  if (literal_len >= 15) {
+    put_length(output, literal_len - 15);
+  }
+  output->append(literals, literal_len);
+}
+
+bool get_length(const uint8_t *src, size_t size, size_t *pos, size_t *length)
+{
+  uint8_t b = 0;
+  do {
+    if (*pos >= size) {
+      return false;
+    }
+    b = src[(*pos)++];
+    *length += b;
+  } while (b == 255);
+  return true;
+}
+
+}  // namespace
+
+const ObCompressor *ObCompressor::get(CompressionType type)
+{
+  static const ObNoneCompressor none_compressor;
+  static const ObLz4Compressor  lz4_compressor;
+  switch (type) {
+    case CompressionType::NONE: return &none_compressor;
+    case CompressionType::LZ4: return &lz4_compressor;
+    default: return nullptr;
+  }
+}
+
+RC ObNoneCompressor::compress(const string_view &input, string *output) const
+{
+  output->append(input.data(), input.size());
+  return RC::SUCCESS;
+}
+
+RC ObNoneCompressor::decompress(const string_view &input, string *output) const
+{
+  output->append(input.data(), input.size());
+  return RC::SUCCESS;
+}
+
+RC ObLz4Compressor::compress(const string_view &input, string *output) const
+{
+  const char  *src  = input.data();
+  const size_t size = input.size();
+  if (size > UINT32_MAX) {
+    return RC::INVALID_ARGUMENT;
+  }
+  put_numeric<uint32_t>(output, size);
+  if (size < MF_LIMIT + 1) {
+    put_last_literals(output, src, size);
+    return RC::SUCCESS;
+  }
+
+  // positions of the last 4 bytes with the same hash value
+  vector<uint32_t> table(1 << HASH_BITS, 0);
+  const size_t     match_limit = size - LAST_LITERALS;
+  const size_t     ip_limit    = size - MF_LIMIT;
+  size_t           anchor      = 0;
+  size_t           ip          = 0;
+  while (ip <= ip_limit) {
+    const uint32_t sequence  = read32(src + ip);
+    const uint32_t h         = hash4(sequence);
+    const size_t   candidate = table[h];
+    table[h]                 = ip;
+    if (candidate >= ip || ip - candidate > MAX_OFFSET || read32(src + candidate) != sequence) {
+      ip += 1 + ((ip - anchor) >> SKIP_TRIGGER);
+      continue;
+    }
+
+    size_t match_len = MIN_MATCH;
+    while (ip + match_len < match_limit && src[candidate + match_len] == src[ip + match_len]) {
+      match_len++;
+    }
+    put_sequence(output, src + anchor, ip - anchor, ip - candidate, match_len);
+    ip += match_len;
+    anchor = ip;
+    // the position before the next search point is likely to start another repeat
+    if (ip <= ip_limit) {
+      table[hash4(read32(src + ip - 2))] = ip - 2;
+    }
+  }
+  put_last_literals(output, src + anchor, size - anchor);
+  return RC::SUCCESS;
+}
+
+RC ObLz4Compressor::decompress(const string_view &input, string *output) const
+{
+  const uint8_t *src  = reinterpret_cast<const uint8_t *>(input.data());
+  const size_t   size = input.size();
+  if (size < sizeof(uint32_t)) {
+    LOG_WARN("lz4 data is too short. size=%lu", size);
+    return RC::INVALID_ARGUMENT;
+  }
+  const size_t raw_size = get_numeric<uint32_t>(input.data());
+  // a byte of the sequences decodes into at most 255 bytes, don't allocate for a broken size
+  if (raw_size > (size - sizeof(uint32_t)) * 255) {
+    LOG_WARN("lz4 data is broken. size=%lu, raw size=%lu", size, raw_size);
+    return RC::INVALID_ARGUMENT;
+  }
+  const size_t base     = output->size();
+  output->resize(base + raw_size);
+  char *dst = output->data() + base;
+
+  size_t ip     = sizeof(uint32_t);
+  size_t op     = 0;
+  bool   broken = false;
+  while (ip < size) {
+    const uint8_t token       = src[ip++];
+    size_t        literal_len = token >> 4;
+    if (literal_len == 15 && !get_length(src, size, &ip, &literal_len)) {
+      broken = true;
+      break;
+    }
+    if (literal_len > size - ip || literal_len > raw_size - op) {
+      broken = true;
+      break;
+    }
+    memcpy(dst + op, src + ip, literal_len);
+    ip += literal_len;
+    op += literal_len;
+    if (ip == size) {  // the last sequence
+      break;
+    }
+
+    if (size - ip < 2) {
+      broken = true;
+      break;
+    }
+    const size_t offset = src[ip] | (static_cast<size_t>(src[ip + 1]) << 8);
+    ip += 2;
+    size_t match_len = token & 0x0F;
+    if (match_len == 15 && !get_length(src, size, &ip, &match_len)) {
+      broken = true;
+      break;
+    }
+    match_len += MIN_MATCH;
+    if (offset == 0 || offset > op || match_len > raw_size - op) {
+      broken = true;
+      break;
+    }
+    // the match may overlap the bytes being written, e.g. a run of one byte has offset 1
+    const char *match = dst + op - offset;
+    if (offset >= match_len) {
+      memcpy(dst + op, match, match_len);
+    } else {
+      for (size_t i = 0; i < match_len; i++) {
+        dst[op + i] = match[i];
+      }
+    }
+    op += match_len;
+  }
+
+  if (broken || ip != size || op != raw_size) {
+    LOG_WARN("lz4 data is broken. size=%lu, raw size=%lu, decoded=%lu", size, raw_size, op);
+    output->resize(base);
+    return RC::INVALID_ARGUMENT;
+  }
+  return RC::SUCCESS;
+}
+
+}  // namespace oceanbase
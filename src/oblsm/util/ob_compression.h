@@ -0,0 +1,83 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/sys/rc.h"
+#include "oblsm/ob_lsm_define.h"
+
+namespace oceanbase {
+
+/**
+ * @class ObCompressor
+ * @brief Base class of the block compression codecs.
+ *
+ * A codec is looked up by the `CompressionType` stored in each sstable block, so the blocks
+ * written with different codecs can be read by the same table.
+ */
+class ObCompressor
+{
+public:
+  virtual ~ObCompressor() = default;
+
+  virtual CompressionType type() const = 0;
+
+  virtual const char *name() const = 0;
+
+  /**
+   * @brief Compresses `input` and appends the result to `output`.
+   */
+  virtual RC compress(const string_view &input, string *output) const = 0;
+
+  /**
+   * @brief Decompresses `input` and appends the result to `output`.
+   * @return RC::INVALID_ARGUMENT if `input` is broken.
+   */
+  virtual RC decompress(const string_view &input, string *output) const = 0;
+
+  /**
+   * @brief The codec of `type`, nullptr if `type` is unknown.
+   */
+  static const ObCompressor *get(CompressionType type);
+};
+
+/**
+ * @brief Stores the data as it is.
+ */
+class ObNoneCompressor : public ObCompressor
+{
+public:
+  CompressionType type() const override { return CompressionType::NONE; }
+  const char     *name() const override { return "none"; }
+  RC              compress(const string_view &input, string *output) const override;
+  RC              decompress(const string_view &input, string *output) const override;
+};
+
+/**
+ * @brief A fast LZ77 compressor that writes the LZ4 block format.
+ * @details The output is `uncompressed size(uint32) | lz4 sequences`. Each sequence is
+ * `token | literal length | literals | offset(uint16) | match length`: the high 4 bits of the
+ * token are the literal length and the low 4 bits are the match length minus 4, a length of 15
+ * continues in the following bytes, each adds up to 255. The last sequence has only literals.
+ * Matches are found by a hash table of 4 bytes, without a chain, which trades some compression
+ * ratio for speed.
+ */
+class ObLz4Compressor : public ObCompressor
+{
+public:
+  CompressionType type() const override { return CompressionType::LZ4; }
+  const char     *name() const override { return "lz4"; }
+  RC              compress(const string_view &input, string *output) const override;
+  RC              decompress(const string_view &input, string *output) const override;
+};
+
+}  // namespace oceanbase
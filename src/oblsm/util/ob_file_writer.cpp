@@ -9,6 +9,7 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "oblsm/util/ob_file_writer.h"
+#include "oblsm/util/ob_rate_limiter.h"
 
 namespace oceanbase {
 
@@ -17,7 +18,10 @@ ObFileWriter::~ObFileWriter() { close_file(); }
 RC ObFileWriter::write(const string_view &data)
 {
   RC rc = RC::SUCCESS;
-  file_  << data;
+  if (rate_limiter_ != nullptr) {
+    rate_limiter_->request(data.size());
+  }
+  file_ << data;
   if (!file_.good()) {
     rc = RC::IOERR_WRITE;
   }
@@ -18,6 +18,8 @@ See the Mulan PSL v2 for more details. */
 
 namespace oceanbase {
 
+class ObRateLimiter;
+
 /**
  * @class ObFileWriter
  * @brief A utility class for writing data to files.
@@ -98,6 +100,13 @@ public:
    */
   string file_name() const { return filename_; }
 
+  /**
+   * @brief Limits the write rate of the file by `rate_limiter`, nullptr means no limit.
+   *
+   * The rate limiter may be shared by several writers, it must outlive the writer.
+   */
+  void set_rate_limiter(ObRateLimiter *rate_limiter) { rate_limiter_ = rate_limiter; }
+
   /**
    * @brief Creates a new `ObFileWriter` instance.
    *
@@ -128,5 +137,10 @@ private:
    * @brief The file stream used for writing data.
    */
   ofstream file_;
+
+  /**
+   * @brief Blocks the writes if they are faster than the limit, not owned.
+   */
+  ObRateLimiter *rate_limiter_ = nullptr;
 };
 }  // namespace oceanbase
@@ -13,8 +13,30 @@ See the Mulan PSL v2 for more details. */
 #include <stdint.h>
 #include <cstddef>
 
+#include "common/lang/algorithm.h"
+#include "common/lang/atomic.h"
+#include "common/lang/functional.h"
+#include "common/lang/list.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/utility.h"
+#include "common/lang/vector.h"
+
 namespace oceanbase {
 
+/**
+ * @brief Statistics of an `ObLRUCache`.
+ */
+struct ObLRUCacheStats
+{
+  uint64_t hits      = 0;  ///< number of `get` calls that found the key
+  uint64_t misses    = 0;  ///< number of `get` calls that missed
+  uint64_t inserts   = 0;  ///< number of entries inserted by `put`
+  uint64_t evictions = 0;  ///< number of entries evicted to make room for new ones
+  size_t   usage     = 0;  ///< total charge of the entries in the cache
+};
+
 /**
  * @class ObLRUCache
  * @brief A thread-safe implementation of an LRU (Least Recently Used) cache.
@@ -23,6 +45,11 @@ namespace oceanbase {
  * entries when the cache exceeds its capacity. It supports thread-safe operations for
  * inserting, retrieving, and checking the existence of cache entries.
  *
+ * Each entry has a charge (1 by default) and the capacity bounds the total charge, so the
+ * cache can be bounded by bytes by passing the memory size of a value as its charge.
+ * The keys are spread over several shards, each with its own lock and LRU list and an equal
+ * part of the capacity, to reduce lock contention.
+ *
  * @tparam KeyType The type of keys used to identify cache entries.
  * @tparam ValueType The type of values stored in the cache.
  */
@@ -33,9 +60,16 @@ public:
   /**
    * @brief Constructs an `ObLRUCache` with a specified capacity.
    *
-   * @param capacity The maximum number of elements the cache can hold.
+   * @param capacity The maximum total charge of the elements the cache can hold.
+   * @param shard_num The number of shards. The capacity is divided evenly among the shards.
    */
-  ObLRUCache(size_t capacity) : capacity_(capacity) {}
+  ObLRUCache(size_t capacity, size_t shard_num = 1)
+      : capacity_(capacity), shards_(max(shard_num, static_cast<size_t>(1)))
+  {
+    for (size_t i = 0; i < shards_.size(); i++) {
+      shards_[i].capacity = (capacity + shards_.size() - 1) / shards_.size();
+    }
+  }
 
   /**
    * @brief Retrieves a value from the cache using the specified key.
@@ -48,7 +82,20 @@ public:
    * @param value A reference to store the value associated with the key.
    * @return `true` if the key is found and the value is retrieved; `false` otherwise.
    */
-  bool get(const KeyType &key, ValueType &value) { return false; }
+  bool get(const KeyType &key, ValueType &value)
+  {
+    Shard           &shard = shard_of(key);
+    lock_guard<mutex> guard(shard.lock);
+    auto             iter = shard.table.find(key);
+    if (iter == shard.table.end()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+    value = iter->second->value;
+    hits_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
 
   /**
    * @brief Inserts a key-value pair into the cache.
@@ -59,8 +106,36 @@ public:
    *
    * @param key The key to insert into the cache.
    * @param value The value to associate with the specified key.
+   * @param charge The charge of the entry against the capacity. An entry larger than the
+   *               capacity of a shard is not cached.
    */
-  void put(const KeyType &key, const ValueType &value) {}
+  void put(const KeyType &key, const ValueType &value, size_t charge = 1)
+  {
+    Shard           &shard = shard_of(key);
+    lock_guard<mutex> guard(shard.lock);
+    auto             iter = shard.table.find(key);
+    if (iter != shard.table.end()) {
+      shard.usage -= iter->second->charge;
+      shard.lru.erase(iter->second);
+      shard.table.erase(iter);
+    }
+    if (charge > shard.capacity) {
+      return;
+    }
+
+    shard.lru.push_front(Entry{key, value, charge});
+    shard.table.emplace(key, shard.lru.begin());
+    shard.usage += charge;
+    inserts_.fetch_add(1, std::memory_order_relaxed);
+
+    while (shard.usage > shard.capacity) {
+      Entry &victim = shard.lru.back();
+      shard.usage -= victim.charge;
+      shard.table.erase(victim.key);
+      shard.lru.pop_back();
+      evictions_.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
 
   /**
    * @brief Checks whether the specified key exists in the cache.
@@ -68,13 +143,96 @@ public:
    * @param key The key to check in the cache.
    * @return `true` if the key exists; `false` otherwise.
    */
-  bool contains(const KeyType &key) const { return false; }
+  bool contains(const KeyType &key) const
+  {
+    const Shard      &shard = shard_of(key);
+    lock_guard<mutex> guard(shard.lock);
+    return shard.table.count(key) > 0;
+  }
+
+  /**
+   * @brief Removes the specified key from the cache if it exists.
+   */
+  void erase(const KeyType &key)
+  {
+    Shard           &shard = shard_of(key);
+    lock_guard<mutex> guard(shard.lock);
+    auto             iter = shard.table.find(key);
+    if (iter != shard.table.end()) {
+      shard.usage -= iter->second->charge;
+      shard.lru.erase(iter->second);
+      shard.table.erase(iter);
+    }
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  /**
+   * @brief Returns the total charge of the entries in the cache.
+   */
+  size_t usage() const
+  {
+    size_t usage = 0;
+    for (const Shard &shard : shards_) {
+      lock_guard<mutex> guard(shard.lock);
+      usage += shard.usage;
+    }
+    return usage;
+  }
+
+  ObLRUCacheStats stats() const
+  {
+    ObLRUCacheStats stats;
+    stats.hits      = hits_.load(std::memory_order_relaxed);
+    stats.misses    = misses_.load(std::memory_order_relaxed);
+    stats.inserts   = inserts_.load(std::memory_order_relaxed);
+    stats.evictions = evictions_.load(std::memory_order_relaxed);
+    stats.usage     = usage();
+    return stats;
+  }
+
+private:
+  struct Entry
+  {
+    KeyType   key;
+    ValueType value;
+    size_t    charge;
+  };
+
+  struct Shard
+  {
+    mutable mutex                                          lock;
+    list<Entry>                                            lru;  // the front is the most recently used
+    unordered_map<KeyType, typename list<Entry>::iterator> table;
+    size_t                                                 capacity = 0;
+    size_t                                                 usage    = 0;
+  };
+
+  size_t shard_index(const KeyType &key) const
+  {
+    if (shards_.size() == 1) {
+      return 0;
+    }
+    // mix the hash value, std::hash of integers is the identity
+    uint64_t hash_value = static_cast<uint64_t>(std::hash<KeyType>()(key)) * 0x9E3779B97F4A7C15ULL;
+    return (hash_value >> 32) % shards_.size();
+  }
+
+  Shard       &shard_of(const KeyType &key) { return shards_[shard_index(key)]; }
+  const Shard &shard_of(const KeyType &key) const { return shards_[shard_index(key)]; }
 
 private:
   /**
-   * @brief The maximum number of elements the cache can hold.
+   * @brief The maximum total charge of the elements the cache can hold.
    */
   size_t capacity_;
+
+  vector<Shard> shards_;
+
+  atomic<uint64_t> hits_{0};
+  atomic<uint64_t> misses_{0};
+  atomic<uint64_t> inserts_{0};
+  atomic<uint64_t> evictions_{0};
 };
 
 /**
@@ -85,13 +243,14 @@ private:
  *
  * @tparam Key The type of keys used to identify cache entries.
  * @tparam Value The type of values stored in the cache.
- * @param capacity The maximum number of elements the cache can hold.
+ * @param capacity The maximum total charge of the elements the cache can hold.
+ * @param shard_num The number of shards.
  * @return A pointer to the newly created `ObLRUCache` instance.
  */
 template <typename Key, typename Value>
-ObLRUCache<Key, Value> *new_lru_cache(uint32_t capacity)
+ObLRUCache<Key, Value> *new_lru_cache(size_t capacity, size_t shard_num = 1)
 {
-  return nullptr;
+  return new ObLRUCache<Key, Value>(capacity, shard_num);
 }
 
 }  // namespace oceanbase
@@ -0,0 +1,82 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "oblsm/util/ob_rate_limiter.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/thread.h"
+
+namespace oceanbase {
+
+ObRateLimiter::ObRateLimiter(int64_t bytes_per_second, int64_t refill_period_us)
+    : bytes_per_second_(std::max<int64_t>(bytes_per_second, 1)),
+      refill_period_us_(std::max<int64_t>(refill_period_us, 1)),
+      last_refill_(chrono::steady_clock::now())
+{
+  available_bytes_ = refill_bytes_per_period();
+}
+
+void ObRateLimiter::request(int64_t bytes)
+{
+  unique_lock<mutex> lock(mu_);
+  total_bytes_ += bytes;
+  while (bytes > 0) {
+    refill();
+    if (available_bytes_ > 0) {
+      int64_t granted = std::min(bytes, available_bytes_);
+      available_bytes_ -= granted;
+      bytes -= granted;
+      continue;
+    }
+
+    // sleep without the lock, the other requesters may get the next tokens first
+    chrono::steady_clock::time_point next_refill = last_refill_ + chrono::microseconds(refill_period_us_);
+    lock.unlock();
+    this_thread::sleep_until(next_refill);
+    lock.lock();
+  }
+}
+
+void ObRateLimiter::refill()
+{
+  chrono::steady_clock::time_point now     = chrono::steady_clock::now();
+  int64_t                          elapsed = chrono::duration_cast<chrono::microseconds>(now - last_refill_).count();
+  int64_t                          periods = elapsed / refill_period_us_;
+  if (periods <= 0) {
+    return;
+  }
+  last_refill_ += chrono::microseconds(periods * refill_period_us_);
+  int64_t per_period = refill_bytes_per_period();
+  available_bytes_   = std::min(per_period, available_bytes_ + periods * per_period);
+}
+
+int64_t ObRateLimiter::refill_bytes_per_period() const
+{
+  return std::max<int64_t>(bytes_per_second_ * refill_period_us_ / 1000000, 1);
+}
+
+int64_t ObRateLimiter::bytes_per_second() const
+{
+  lock_guard<mutex> lock(mu_);
+  return bytes_per_second_;
+}
+
+void ObRateLimiter::set_bytes_per_second(int64_t bytes_per_second)
+{
+  lock_guard<mutex> lock(mu_);
+  bytes_per_second_ = std::max<int64_t>(bytes_per_second, 1);
+}
+
+int64_t ObRateLimiter::total_bytes() const
+{
+  lock_guard<mutex> lock(mu_);
+  return total_bytes_;
+}
+
+}  // namespace oceanbase
@@ -0,0 +1,71 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include <cstdint>
+
+#include "common/lang/chrono.h"
+#include "common/lang/mutex.h"
+
+namespace oceanbase {
+
+/**
+ * @class ObRateLimiter
+ * @brief A token bucket that limits the bytes written per second.
+ *
+ * Tokens (bytes) are added to the bucket every refill period, and the bucket holds at most the
+ * tokens of one period, so the writes can't burst over the rate after a long idle time.
+ * `request` blocks the caller until enough tokens are available. It is used by the background
+ * compaction, so the compaction writes don't take all the disk bandwidth from the foreground
+ * reads and the WAL syncs.
+ */
+class ObRateLimiter
+{
+public:
+  /**
+   * @param bytes_per_second The rate, must be positive.
+   * @param refill_period_us The period to add tokens, in microseconds.
+   */
+  explicit ObRateLimiter(int64_t bytes_per_second, int64_t refill_period_us = 100 * 1000);
+
+  /**
+   * @brief Blocks until `bytes` tokens are taken from the bucket.
+   *
+   * A request larger than the bucket is served in several periods.
+   */
+  void request(int64_t bytes);
+
+  int64_t bytes_per_second() const;
+  void    set_bytes_per_second(int64_t bytes_per_second);
+
+  /**
+   * @brief The total bytes requested through the limiter.
+   */
+  int64_t total_bytes() const;
+
+private:
+  /**
+   * @brief Adds the tokens of the past periods. Called with `mu_` held.
+   */
+  void refill();
+
+  int64_t refill_bytes_per_period() const;
+
+private:
+  mutable mutex                    mu_;
+  int64_t                          bytes_per_second_;
+  const int64_t                    refill_period_us_;
+  int64_t                          available_bytes_ = 0;
+  int64_t                          total_bytes_     = 0;
+  chrono::steady_clock::time_point last_refill_;
+};
+
+}  // namespace oceanbase
@@ -8,18 +8,138 @@
    MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
    See the Mulan PSL v2 for more details. */
 
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
 #include "oblsm/wal/ob_lsm_wal.h"
 #include "common/log/log.h"
+#include "oblsm/util/ob_coding.h"
 #include "oblsm/util/ob_file_reader.h"
 
 namespace oceanbase {
+
+RC WAL::open(const std::string &filename)
+{
+  close();
+  filename_ = filename;
+  fd_       = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+  if (fd_ < 0) {
+    LOG_WARN("failed to open wal file %s, errno=%d:%s", filename.c_str(), errno, strerror(errno));
+    return RC::IOERR_OPEN;
+  }
+  return RC::SUCCESS;
+}
+
+void WAL::close()
+{
+  if (fd_ >= 0) {
+    ::close(fd_);
+    fd_ = -1;
+  }
+}
+
 RC WAL::recover(const std::string &wal_file, std::vector<WalRecord> &wal_records)
 {
-  return RC::UNIMPLEMENTED;
+  unique_ptr<ObFileReader> reader = ObFileReader::create_file_reader(wal_file);
+  if (reader == nullptr) {
+    return RC::IOERR_OPEN;
+  }
+  const uint32_t file_size = reader->file_size();
+  if (file_size == 0) {
+    return RC::SUCCESS;
+  }
+  string data = reader->read_pos(0, file_size);
+  if (data.size() != file_size) {
+    LOG_WARN("failed to read wal file %s", wal_file.c_str());
+    return RC::IOERR_READ;
+  }
+
+  const size_t header_size = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint64_t);
+  size_t       pos         = 0;
+  while (pos < data.size()) {
+    if (data.size() - pos < header_size) {
+      break;
+    }
+    uint64_t seq      = get_numeric<uint64_t>(data.data() + pos);
+    uint32_t count    = get_numeric<uint32_t>(data.data() + pos + sizeof(uint64_t));
+    uint64_t rep_size = get_numeric<uint64_t>(data.data() + pos + sizeof(uint64_t) + sizeof(uint32_t));
+    size_t   rep_pos  = pos + header_size;
+    if (data.size() - rep_pos < rep_size) {
+      break;
+    }
+
+    ObWriteBatch batch;
+    batch.set_rep(data.substr(rep_pos, rep_size), count);
+    RC rc = batch.for_each([&wal_records, &seq](const string_view &key, const string_view &val) {
+      wal_records.emplace_back(seq++, string(key), string(val));
+      return RC::SUCCESS;
+    });
+    if (OB_FAIL(rc)) {
+      LOG_WARN("wal file %s is broken. offset=%lu", wal_file.c_str(), pos);
+      return rc;
+    }
+    pos = rep_pos + rep_size;
+  }
+
+  if (pos != data.size()) {
+    LOG_WARN("ignore incomplete record at the end of wal file %s. offset=%lu, file size=%u",
+        wal_file.c_str(), pos, file_size);
+  }
+  return RC::SUCCESS;
+}
+
+void WAL::encode(uint64_t seq, const ObWriteBatch &batch, std::string *dst)
+{
+  put_numeric<uint64_t>(dst, seq);
+  put_numeric<uint32_t>(dst, batch.count());
+  put_numeric<uint64_t>(dst, batch.byte_size());
+  dst->append(batch.rep());
 }
 
 RC WAL::put(uint64_t seq, string_view key, string_view val)
 {
-  return RC::UNIMPLEMENTED;
+  ObWriteBatch batch;
+  batch.put(key, val);
+  string record;
+  encode(seq, batch, &record);
+  return append(record);
+}
+
+RC WAL::append(std::string_view records)
+{
+  if (fd_ < 0) {
+    LOG_WARN("wal file is not opened");
+    return RC::IOERR_WRITE;
+  }
+  const char *data = records.data();
+  size_t      left = records.size();
+  while (left > 0) {
+    ssize_t ret = ::write(fd_, data, left);
+    if (ret < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_WARN("failed to write wal file %s, errno=%d:%s", filename_.c_str(), errno, strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+    data += ret;
+    left -= ret;
+  }
+  return RC::SUCCESS;
 }
-}  // namespace oceanbase
\ No newline at end of file
+
+RC WAL::sync()
+{
+  if (fd_ < 0) {
+    return RC::SUCCESS;
+  }
+  if (::fdatasync(fd_) != 0) {
+    LOG_WARN("failed to sync wal file %s, errno=%d:%s", filename_.c_str(), errno, strerror(errno));
+    return RC::IOERR_SYNC;
+  }
+  return RC::SUCCESS;
+}
+
+}  // namespace oceanbase
@@ -15,6 +15,7 @@
 
 #include "common/lang/mutex.h"
 #include "common/sys/rc.h"
+#include "oblsm/include/ob_lsm_write_batch.h"
 #include "oblsm/util/ob_file_writer.h"
 
 namespace oceanbase {
@@ -51,17 +52,17 @@ struct WalRecord
  * providing durability in case of system failures.
  *
  * ### Data Serialization Format:
- * The data is serialized as follows:
- * - Each entry in the WAL consists of a key-value pair.
- * - The data format is:
- *   - **Sequence Number (uint64_t)**: A 8-byte value representing the sequence of logs.
- *   - **Key Length (size_t)**: A value representing the length of the key.
- *   - **Key (string)**: The actual key, as a string.
- *   - **Value Length (size_t)**: A value representing the length of the value.
- *   - **Value (string)**: The actual value, as a string.
+ * Each record of the WAL holds the updates of an `ObWriteBatch`:
+ *   - **Sequence Number (uint64_t)**: The sequence number of the first update, the following
+ *     updates take the next sequence numbers.
+ *   - **Count (uint32_t)**: The number of updates.
+ *   - **Size (uint64_t)**: The size of the encoded updates.
+ *   - **Updates**: The encoded updates of the batch, see `ObWriteBatch`.
  *
- * The data is written to the file in the order: key length, key, value length, value.
- * After writing the data, the system performs a `flush()` operation to ensure the data is persisted.
+ * Several records can be encoded into one buffer by `encode` and appended by a single `append`,
+ * so a group of writes costs one write and one `sync`. An incomplete record at the end of the
+ * file (a crash during append) is ignored by `recover` as a whole, so a batch is either
+ * recovered entirely or not at all.
  */
 class WAL
 {
@@ -75,7 +76,10 @@ public:
    * @brief Destructor for the Wal class.
    * Ensures that the file writer is closed when the Wal object is destroyed.
    */
-  ~WAL() = default;
+  ~WAL() { close(); }
+
+  WAL(const WAL &)            = delete;
+  WAL &operator=(const WAL &) = delete;
 
   /**
    * @brief Opens the WAL file for writing.
@@ -85,7 +89,9 @@ public:
    * @param filename The name of the WAL file to write logs.
    * @return `RC::SUCCESS` if the file was successfully opened, or an error code if it failed.
    */
-  RC open(const std::string &filename) { return RC::UNIMPLEMENTED; }
+  RC open(const std::string &filename);
+
+  void close();
 
   /**
    * @brief Recovers data from a specified WAL file.
@@ -111,17 +117,29 @@ public:
    */
   RC put(uint64_t seq, std::string_view key, std::string_view val);
 
+  /**
+   * @brief Appends records encoded by `encode` to the WAL with one write.
+   */
+  RC append(std::string_view records);
+
+  /**
+   * @brief Encodes a batch as a record and appends it to `dst`.
+   * @param seq The sequence number of the first update of the batch.
+   */
+  static void encode(uint64_t seq, const ObWriteBatch &batch, std::string *dst);
+
   /**
    * @brief Synchronizes the WAL to disk.
    * Forces any buffered data in the WAL to be written to the underlying storage.
    *
    * @return `RC::SUCCESS` if the sync operation is successful, or an error code if it fails.
    */
-  RC sync() { return RC::UNIMPLEMENTED; }
+  RC sync();
 
   const string &filename() const { return filename_; }
 
 private:
   string filename_;
+  int    fd_ = -1;
 };
 }  // namespace oceanbase
@@ -16,6 +16,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/string.h"
 #include "common/lang/memory.h"
+#include "common/lang/vector.h"
+#include "common/value.h"
 #include "sql/operator/physical_operator.h"
 
 class SessionEvent;
@@ -44,10 +46,29 @@ public:
   void set_stmt(Stmt *stmt) { stmt_ = stmt; }
   void set_operator(unique_ptr<PhysicalOperator> oper) { operator_ = std::move(oper); }
 
+  const string        &plan_cache_key() const { return plan_cache_key_; }
+  const vector<Value> &plan_cache_params() const { return plan_cache_params_; }
+  uint64_t             plan_cache_version() const { return plan_cache_version_; }
+  void set_plan_cache_context(const string &key, vector<Value> &&params, uint64_t version)
+  {
+    plan_cache_key_     = key;
+    plan_cache_params_  = std::move(params);
+    plan_cache_version_ = version;
+  }
+
+  const string &query_cache_key() const { return query_cache_key_; }
+  void          set_query_cache_key(const string &key) { query_cache_key_ = key; }
+
 private:
   SessionEvent                *session_event_ = nullptr;
   string                       sql_;             ///< 处理的SQL语句
   unique_ptr<ParsedSqlNode>    sql_node_;        ///< 语法解析后的SQL命令
   Stmt                        *stmt_ = nullptr;  ///< Resolver之后生成的数据结构
   unique_ptr<PhysicalOperator> operator_;        ///< 生成的执行计划，也可能没有
+
+  string        plan_cache_key_;          ///< 参数化之后的SQL，为空表示不使用计划缓存
+  vector<Value> plan_cache_params_;       ///< SQL中的常量
+  uint64_t      plan_cache_version_ = 0;  ///< 查找计划缓存时缓存的版本号
+
+  string query_cache_key_;  ///< 查询缓存的key，为空表示不需要缓存这个查询的结果
 };
@@ -1025,7 +1025,7 @@ RC MysqlCommunicator::write_chunk_result(SqlResult *sql_result, vector<char> &pa
     if (column_num == 0) {
       continue;
     }
-    for (int i = 0; i < chunk.rows(); i++) {
+    for (int i = 0; i < chunk.selected_rows(); i++) {
       affected_rows++;
       // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset.html
       // https://dev.mysql.com/doc/dev/mysql-server/latest/page_protocol_com_query_response_text_resultset_row.html
@@ -1037,7 +1037,7 @@ RC MysqlCommunicator::write_chunk_result(SqlResult *sql_result, vector<char> &pa
       pos += store_int1(buf + pos, sequence_id_++);
 
       for (int col_idx = 0; col_idx < column_num; col_idx++) {
-        Value value = chunk.get_value(col_idx, i);
+        Value value = chunk.get_value(col_idx, chunk.row_index(i));
         pos += store_lenenc_string(buf + pos, value.to_string().c_str());
       }
 
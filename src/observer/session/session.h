@@ -85,6 +85,15 @@ public:
   void set_hash_join(bool hash_join) { hash_join_ = hash_join; }
   bool hash_join_on() const { return hash_join_; }
 
+  void    set_hash_join_memory_budget(int64_t budget) { hash_join_memory_budget_ = budget; }
+  int64_t hash_join_memory_budget() const { return hash_join_memory_budget_; }
+
+  void set_plan_cache(bool plan_cache) { plan_cache_ = plan_cache; }
+  bool plan_cache_on() const { return plan_cache_; }
+
+  void set_query_cache(bool query_cache) { query_cache_ = query_cache; }
+  bool query_cache_on() const { return query_cache_; }
+
   void set_use_cascade(bool use_cascade) { use_cascade_ = use_cascade; }
   bool use_cascade() const { return use_cascade_; }
 
@@ -117,6 +126,10 @@ private:
   bool sql_debug_   = false;  ///< 是否输出SQL调试信息
   bool hash_join_   = false;  ///< 是否使用hash join
   bool use_cascade_ = false;  ///< 是否使用 cascade 优化器
+  bool plan_cache_  = true;   ///< 是否使用执行计划缓存
+  bool query_cache_ = true;   ///< 是否使用查询结果缓存
+
+  int64_t hash_join_memory_budget_ = 64 * 1024 * 1024;  ///< 每个 hash join 可以使用的内存，超过后落盘。可以用 '4G' 这样的字符串设置超过 2G 的值
 
   // 是否使用了 `chunk_iterator` 模式。 只有在设置了 `chunk_iterator`
   // 并且可以生成相关物理执行计划时才会使用 `chunk_iterator` 模式。
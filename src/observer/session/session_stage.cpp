@@ -85,21 +85,42 @@ RC SessionStage::handle_sql(SQLStageEvent *sql_event)
     return rc;
   }
 
-  rc = parse_stage_.handle_request(sql_event);
+  rc = plan_cache_stage_.handle_request(sql_event);
   if (OB_FAIL(rc)) {
-    LOG_TRACE("failed to do parse. rc=%s", strrc(rc));
+    LOG_TRACE("failed to do plan cache. rc=%s", strrc(rc));
     return rc;
   }
 
-  rc = resolve_stage_.handle_request(sql_event);
-  if (OB_FAIL(rc)) {
-    LOG_TRACE("failed to do resolve. rc=%s", strrc(rc));
-    return rc;
+  // 命中查询缓存或者计划缓存时直接执行
+  if (nullptr == sql_event->physical_operator()) {
+    rc = parse_stage_.handle_request(sql_event);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to do parse. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    rc = resolve_stage_.handle_request(sql_event);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to do resolve. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    rc = optimize_stage_.handle_request(sql_event);
+    if (rc != RC::UNIMPLEMENTED && rc != RC::SUCCESS) {
+      LOG_TRACE("failed to do optimize. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    rc = plan_cache_stage_.handle_plan(sql_event);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to cache plan. rc=%s", strrc(rc));
+      return rc;
+    }
   }
 
-  rc = optimize_stage_.handle_request(sql_event);
-  if (rc != RC::UNIMPLEMENTED && rc != RC::SUCCESS) {
-    LOG_TRACE("failed to do optimize. rc=%s", strrc(rc));
+  rc = query_cache_stage_.handle_plan(sql_event);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to prepare query cache. rc=%s", strrc(rc));
     return rc;
   }
 
@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/optimizer/optimize_stage.h"
 #include "sql/parser/parse_stage.h"
 #include "sql/parser/resolve_stage.h"
+#include "sql/plan_cache/plan_cache_stage.h"
 #include "sql/query_cache/query_cache_stage.h"
 
 /**
@@ -51,6 +52,7 @@ public:
 
 private:
   QueryCacheStage query_cache_stage_;
+  PlanCacheStage  plan_cache_stage_;
   ParseStage      parse_stage_;
   ResolveStage    resolve_stage_;
   OptimizeStage   optimize_stage_;
@@ -18,6 +18,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/db/db.h"
 #include "storage/table/table.h"
 #include "catalog/catalog.h"
+#include "sql/plan_cache/plan_cache.h"
 #include "storage/record/record_scanner.h"
 
 using namespace std;
@@ -56,6 +57,7 @@ RC AnalyzeTableExecutor::execute(SQLStageEvent *sql_event)
   
     TableStats stats(row_nums);
     Catalog::get_instance().update_table_stats(table_id, stats);
+    db->plan_cache().invalidate();
   } else {
     sql_result->set_return_code(RC::SCHEMA_TABLE_NOT_EXIST);
     sql_result->set_state_string("Table not exists");
@@ -34,15 +34,22 @@ RC LoadDataExecutor::execute(SQLStageEvent *sql_event)
 }
 
 /**
- * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
+ * 导入数据时，每攒够这么多行就批量插入一次。
+ * LSM 引擎会把一批记录作为一个批次写入，只写一次 WAL。
+ */
+static constexpr size_t LOAD_DATA_BATCH_SIZE = 1024;
+
+/**
+ * 从文件中导入数据时使用。将解析后的一行数据转换成一条记录。
  * @param table  要导入的表
  * @param file_values 从文件中读取到的一行数据，使用分隔符拆分后的几个字段值
- * @param record_values Table::insert_record使用的参数，为了防止频繁的申请内存
+ * @param record_values Table::make_record使用的参数，为了防止频繁的申请内存
+ * @param record 生成的记录
  * @param errmsg 如果出现错误，通过这个参数返回错误信息
  * @return 成功返回RC::SUCCESS
  */
-RC insert_record_from_file(
-    Table *table, vector<string> &file_values, vector<Value> &record_values, stringstream &errmsg)
+RC make_record_from_file(
+    Table *table, vector<string> &file_values, vector<Value> &record_values, Record &record, stringstream &errmsg)
 {
 
   const int field_num     = record_values.size();
@@ -70,17 +77,34 @@ RC insert_record_from_file(
   }
 
   if (RC::SUCCESS == rc) {
-    Record record;
     rc = table->make_record(field_num, record_values.data(), record);
     if (rc != RC::SUCCESS) {
-      errmsg << "insert failed.";
-    } else if (RC::SUCCESS != (rc = table->insert_record(record))) {
-      errmsg << "insert failed.";
+      errmsg << "make record failed.";
     }
   }
   return rc;
 }
 
+/**
+ * 将攒下的记录批量插入到表中，并清空 records 和 record_lines
+ * @details 插入失败时，错误信息中的行号是第一条没有插入成功的记录所在的行，
+ * 之前已经写入的记录依然计入 insertion_count
+ */
+RC insert_records_from_file(Table *table, vector<Record> &records, vector<int> &record_lines, int &insertion_count,
+    stringstream &result_string)
+{
+  size_t inserted_count = 0;
+  RC     rc             = table->insert_records(records, inserted_count);
+  insertion_count += static_cast<int>(inserted_count);
+  if (rc != RC::SUCCESS) {
+    int failed_line = inserted_count < record_lines.size() ? record_lines[inserted_count] : record_lines.back();
+    result_string << "Line:" << failed_line << " insert record failed:insert failed. error:" << strrc(rc) << endl;
+  }
+  records.clear();
+  record_lines.clear();
+  return rc;
+}
+
 
 // TODO: pax format and row format
 void LoadDataExecutor::load_data(Table *table, const char *file_name, char terminated, char enclosed, SqlResult *sql_result)
@@ -103,6 +127,8 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, char termi
   const int field_num     = table->table_meta().field_num() - sys_field_num;
 
   vector<Value>       record_values(field_num);
+  vector<Record>      records;
+  vector<int>         record_lines;  // records 中每条记录在文件中的行号
   string              line;
   vector<string> file_values;
   const string        delim("|");
@@ -121,12 +147,27 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, char termi
     stringstream errmsg;
 
     if (table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
-      rc = insert_record_from_file(table, file_values, record_values, errmsg);
+      Record record;
+      rc = make_record_from_file(table, file_values, record_values, record, errmsg);
       if (rc != RC::SUCCESS) {
-        result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
-                      << endl;
+        // 先把出错行之前攒下的记录写入，与逐行插入时的行为保持一致。
+        // 如果写入失败，报告的是更早的那一行，出错行不再处理
+        RC flush_rc = RC::SUCCESS;
+        if (!records.empty()) {
+          flush_rc = insert_records_from_file(table, records, record_lines, insertion_count, result_string);
+        }
+        if (flush_rc != RC::SUCCESS) {
+          rc = flush_rc;
+        } else {
+          result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
+                        << endl;
+        }
       } else {
-        insertion_count++;
+        records.push_back(std::move(record));
+        record_lines.push_back(line_num);
+        if (records.size() >= LOAD_DATA_BATCH_SIZE) {
+          rc = insert_records_from_file(table, records, record_lines, insertion_count, result_string);
+        }
       }
     } else if (table->table_meta().storage_format() == StorageFormat::PAX_FORMAT) {
       // your code here
@@ -139,6 +180,10 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, char termi
   }
   fs.close();
 
+  if (RC::SUCCESS == rc && !records.empty()) {
+    rc = insert_records_from_file(table, records, record_lines, insertion_count, result_string);
+  }
+
   struct timespec end_time;
   clock_gettime(CLOCK_MONOTONIC, &end_time);
   if (RC::SUCCESS == rc) {
@@ -42,6 +42,27 @@ RC SetVariableExecutor::execute(SQLStageEvent *sql_event)
           session->set_hash_join(bool_value);
           LOG_TRACE("set hash_join to %d", bool_value);
         }
+      } else if (strcasecmp(var_name, "hash_join_memory_budget") == 0) {
+        int64_t budget = 0;
+        rc             = get_memory_size(var_value, budget);
+        if (rc == RC::SUCCESS) {
+          session->set_hash_join_memory_budget(budget);
+          LOG_TRACE("set hash_join_memory_budget to %" PRId64, budget);
+        }
+      } else if (strcasecmp(var_name, "plan_cache") == 0) {
+        bool bool_value = false;
+        rc              = var_value_to_boolean(var_value, bool_value);
+        if (rc == RC::SUCCESS) {
+          session->set_plan_cache(bool_value);
+          LOG_TRACE("set plan_cache to %d", bool_value);
+        }
+      } else if (strcasecmp(var_name, "query_cache") == 0) {
+        bool bool_value = false;
+        rc              = var_value_to_boolean(var_value, bool_value);
+        if (rc == RC::SUCCESS) {
+          session->set_query_cache(bool_value);
+          LOG_TRACE("set query_cache to %d", bool_value);
+        }
       } else if (strcasecmp(var_name, "use_cascade") == 0) {
         // TODO: remove this params, due to the dblab needed, likely to be long-existing
         bool bool_value = false;
@@ -112,3 +133,41 @@ RC SetVariableExecutor::get_execution_mode(const Value &var_value, ExecutionMode
 
     return rc;
 }
+
+RC SetVariableExecutor::get_memory_size(const Value &var_value, int64_t &size) const
+{
+    RC rc = RC::SUCCESS;
+
+    if (var_value.attr_type() == AttrType::INTS) {
+      size = var_value.get_int();
+    } else if (var_value.attr_type() == AttrType::CHARS) {
+      // 整数字面量最大只能表示 2G-1，更大的值使用带单位的字符串，比如 '4G'
+      const string str = var_value.get_string();
+      char        *end = nullptr;
+      errno            = 0;
+      size             = strtoll(str.c_str(), &end, 10);
+      if (errno != 0 || end == str.c_str()) {
+        return RC::VARIABLE_NOT_VALID;
+      }
+
+      int64_t unit = 1;
+      switch (toupper(*end)) {
+        case 'K': unit = 1LL << 10; end++; break;
+        case 'M': unit = 1LL << 20; end++; break;
+        case 'G': unit = 1LL << 30; end++; break;
+        case 'T': unit = 1LL << 40; end++; break;
+        default: break;
+      }
+      if (*end != '\0' || size > INT64_MAX / unit) {
+        return RC::VARIABLE_NOT_VALID;
+      }
+      size *= unit;
+    } else {
+      rc = RC::VARIABLE_NOT_VALID;
+    }
+
+    if (rc == RC::SUCCESS && size <= 0) {
+      rc = RC::VARIABLE_NOT_VALID;
+    }
+    return rc;
+}
@@ -36,4 +36,11 @@ private:
   RC var_value_to_boolean(const Value &var_value, bool &bool_value) const;
 
   RC get_execution_mode(const Value &var_value, ExecutionMode &execution_mode) const;
+
+  /**
+   * @brief 解析表示内存大小的变量值，单位是字节
+   * @details 可以是正整数，也可以是带 K/M/G/T 后缀的字符串，比如 '4G'。
+   * 整数字面量受 int 范围限制，超过 2G-1 的值需要使用字符串
+   */
+  RC get_memory_size(const Value &var_value, int64_t &size) const;
 };
@@ -28,6 +28,8 @@ RC SqlResult::open()
     return RC::INVALID_ARGUMENT;
   }
 
+  reach_eof_ = false;
+
   Trx *trx = session_->current_trx();
   trx->start_if_need();
   return operator_->open(trx);
@@ -43,6 +45,10 @@ RC SqlResult::close()
     LOG_WARN("failed to close operator. rc=%s", strrc(rc));
   }
 
+  if (rc == RC::SUCCESS && operator_recycler_) {
+    operator_recycler_(std::move(operator_));
+  }
+  operator_recycler_ = nullptr;
   operator_.reset();
 
   if (session_ && !session_->is_trx_multi_operation_mode()) {
@@ -56,6 +62,11 @@ RC SqlResult::close()
     }
     session_->destroy_trx();
   }
+
+  if (rc == RC::SUCCESS && reach_eof_ && result_collector_) {
+    result_collector_->finish(tuple_schema_);
+  }
+  result_collector_.reset();
   return rc;
 }
 
@@ -63,16 +74,28 @@ RC SqlResult::next_tuple(Tuple *&tuple)
 {
   RC rc = operator_->next();
   if (rc != RC::SUCCESS) {
+    reach_eof_ = (rc == RC::RECORD_EOF);
     return rc;
   }
 
   tuple = operator_->current_tuple();
+  if (result_collector_ && (nullptr == tuple || !result_collector_->collect(*tuple))) {
+    result_collector_.reset();
+  }
   return rc;
 }
 
 RC SqlResult::next_chunk(Chunk &chunk)
 {
   RC rc = operator_->next(chunk);
+  if (rc != RC::SUCCESS) {
+    reach_eof_ = (rc == RC::RECORD_EOF);
+    return rc;
+  }
+
+  if (result_collector_ && !result_collector_->collect(chunk)) {
+    result_collector_.reset();
+  }
   return rc;
 }
 
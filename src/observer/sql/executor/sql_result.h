@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/functional.h"
 #include "common/lang/string.h"
 #include "common/lang/memory.h"
 #include "sql/expr/tuple.h"
@@ -21,6 +22,23 @@ See the Mulan PSL v2 for more details. */
 
 class Session;
 
+/**
+ * @brief 收集返回给客户端的结果
+ * @details 比如查询缓存需要保存返回的每一行，在所有结果都返回之后放到缓存中
+ */
+class ResultCollector
+{
+public:
+  virtual ~ResultCollector() = default;
+
+  /// 返回 false 表示不再需要后面的结果，比如结果太大不能缓存
+  virtual bool collect(const Tuple &tuple) = 0;
+  virtual bool collect(const Chunk &chunk) = 0;
+
+  /// 所有结果都已经成功返回，并且事务已经提交
+  virtual void finish(const TupleSchema &schema) = 0;
+};
+
 /**
  * @brief SQL执行结果
  * @details
@@ -30,6 +48,10 @@ class Session;
  */
 class SqlResult
 {
+public:
+  /// 执行计划的回收函数，执行计划正常关闭后交给它而不是直接释放，比如放回计划缓存中
+  using OperatorRecycler = function<void(unique_ptr<PhysicalOperator>)>;
+
 public:
   SqlResult(Session *session);
   ~SqlResult() {}
@@ -40,6 +62,10 @@ public:
 
   void set_operator(unique_ptr<PhysicalOperator> oper);
 
+  void set_operator_recycler(OperatorRecycler recycler) { operator_recycler_ = std::move(recycler); }
+
+  void set_result_collector(unique_ptr<ResultCollector> collector) { result_collector_ = std::move(collector); }
+
   bool               has_operator() const { return operator_ != nullptr; }
   const TupleSchema &tuple_schema() const { return tuple_schema_; }
   RC                 return_code() const { return return_code_; }
@@ -53,6 +79,9 @@ public:
 private:
   Session                     *session_ = nullptr;  ///< 当前所属会话
   unique_ptr<PhysicalOperator> operator_;           ///< 执行计划
+  OperatorRecycler             operator_recycler_;  ///< 执行计划的回收函数
+  unique_ptr<ResultCollector>  result_collector_;   ///< 结果的收集者，可能没有
+  bool                         reach_eof_ = false;  ///< 是否已经返回了所有结果
   TupleSchema                  tuple_schema_;       ///< 返回的表头信息。可能有也可能没有
   RC                           return_code_ = RC::SUCCESS;
   string                       state_string_;
@@ -8,110 +8,294 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#include <cstring>
+
+#include "common/lang/algorithm.h"
 #include "sql/expr/aggregate_hash_table.h"
 #include "sql/expr/aggregate_state.h"
 
 // ----------------------------------StandardAggregateHashTable------------------
 
-RC StandardAggregateHashTable::add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk)
+namespace {
+
+inline uint64_t mix64(uint64_t h)
 {
-    if (groups_chunk.rows() != aggrs_chunk.rows()) {
-    LOG_WARN("groups_chunk and aggrs_chunk have different rows: %d, %d", groups_chunk.rows(), aggrs_chunk.rows());
-    return RC::INVALID_ARGUMENT;
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+/// 将一列的值混入哈希值，前一列的哈希值已经打散，所以列的顺序会影响结果
+inline uint64_t hash_combine(uint64_t h, const char *data, int len)
+{
+  if (len == 4) {
+    uint32_t v;
+    memcpy(&v, data, sizeof(v));
+    return mix64(h ^ v);
   }
-  for (int i = 0; i < groups_chunk.rows(); i++) {
-    vector<Value> group_by_values;
-    vector<void*> aggr_values;
+  h ^= static_cast<uint64_t>(len);
+  int i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t v;
+    memcpy(&v, data + i, sizeof(v));
+    h = mix64(h ^ v);
+  }
+  if (i < len) {
+    uint64_t v = 0;
+    memcpy(&v, data + i, len - i);
+    h = mix64(h ^ v);
+  }
+  return h;
+}
+
+int align_state(int offset) { return (offset + 7) & ~7; }
 
-    for (int j = 0; j < groups_chunk.column_num(); j++) {
-      group_by_values.emplace_back(groups_chunk.get_value(j, i));
+}  // namespace
+
+const int StandardAggregateHashTable::DEFAULT_CAPACITY = 1024;
+
+StandardAggregateHashTable::StandardAggregateHashTable(const vector<Expression *> aggregations)
+{
+  for (auto &expr : aggregations) {
+    ASSERT(expr->type() == ExprType::AGGREGATION, "expect aggregate expression");
+    auto *aggregation_expr = static_cast<AggregateExpr *>(expr);
+    aggr_types_.push_back(aggregation_expr->aggregate_type());
+    // 聚合状态按照聚合列的类型读取数据
+    aggr_child_types_.push_back(aggregation_expr->child()->value_type());
+  }
+  slots_.assign(DEFAULT_CAPACITY, Slot{0, 0});
+  mask_ = DEFAULT_CAPACITY - 1;
+}
+
+RC StandardAggregateHashTable::init_layout(const Chunk &groups_chunk)
+{
+  int offset = 0;
+  for (int i = 0; i < groups_chunk.column_num(); i++) {
+    const Column &column = groups_chunk.column(i);
+    key_types_.push_back(column.attr_type());
+    key_offsets_.push_back(offset);
+    key_lengths_.push_back(column.attr_len());
+    offset += column.attr_len();
+  }
+  key_width_ = offset;
+
+  offset = align_state(key_width_);
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    size_t size = aggregate_state_size(aggr_types_[i], aggr_child_types_[i]);
+    if (size == 0) {
+      LOG_WARN("unsupported aggregate. aggregate type=%d, value type=%s",
+               static_cast<int>(aggr_types_[i]), attr_type_to_string(aggr_child_types_[i]));
+      return RC::UNIMPLEMENTED;
     }
+    state_offsets_.push_back(offset);
+    offset = align_state(offset + size);
+  }
+  group_size_ = std::max(offset, 1);
 
-    auto it = aggr_values_.find(group_by_values);
-    if (it == aggr_values_.end()) {
-      for (size_t j = 0; j < aggr_types_.size(); j++) {
-        void * state_ptr = create_aggregate_state(aggr_types_[j], aggr_child_types_[j]);
-        if (state_ptr == nullptr) {
-          LOG_WARN("create aggregate state failed");
-          return RC::INTERNAL;
-        }   
-        aggr_values.emplace_back(state_ptr);
-      }
-      aggr_values_.emplace(group_by_values, aggr_values);
+  initial_states_.assign(group_size_ - key_width_, 0);
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    RC rc = init_aggregate_state(
+        initial_states_.data() + state_offsets_[i] - key_width_, aggr_types_[i], aggr_child_types_[i]);
+    if (OB_FAIL(rc)) {
+      return rc;
     }
-    auto &aggr = aggr_values_.find(group_by_values)->second;
-    for (size_t aggr_idx = 0; aggr_idx < aggr.size(); aggr_idx++) {
-      RC rc = aggregate_state_update_by_value(aggr[aggr_idx], aggr_types_[aggr_idx], aggr_child_types_[aggr_idx], aggrs_chunk.get_value(aggr_idx, i));
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("update aggregate state failed");
-        return rc;
+  }
+  return RC::SUCCESS;
+}
+
+void StandardAggregateHashTable::serialize_keys(const Chunk &groups_chunk, int rows)
+{
+  keys_.resize(static_cast<size_t>(rows) * key_width_);
+  for (int col = 0; col < groups_chunk.column_num(); col++) {
+    const Column &column   = groups_chunk.column(col);
+    const int     len      = key_lengths_[col];
+    const bool    constant = column.column_type() == Column::Type::CONSTANT_COLUMN;
+    const char   *src      = column.data();
+    char         *dst      = keys_.data() + key_offsets_[col];
+    for (int i = 0; i < rows; i++, dst += key_width_) {
+      const char *value = constant ? src : src + static_cast<size_t>(groups_chunk.row_index(i)) * len;
+      if (key_types_[col] == AttrType::CHARS) {
+        // 字符串 '\0' 之后的内容不属于值，补零后才能按字节比较
+        size_t str_len = strnlen(value, len);
+        memcpy(dst, value, str_len);
+        memset(dst + str_len, 0, len - str_len);
+      } else if (key_types_[col] == AttrType::FLOATS) {
+        float f;
+        memcpy(&f, value, sizeof(f));
+        if (f == 0) {
+          f = 0;  // -0.0 与 0.0 是同一个分组
+        }
+        memcpy(dst, &f, sizeof(f));
+      } else {
+        memcpy(dst, value, len);
       }
     }
   }
-  return RC::SUCCESS;
 }
 
-void StandardAggregateHashTable::Scanner::open_scan()
+void StandardAggregateHashTable::hash_keys(int rows)
 {
-  it_  = static_cast<StandardAggregateHashTable *>(hash_table_)->begin();
-  end_ = static_cast<StandardAggregateHashTable *>(hash_table_)->end();
+  hashes_.assign(rows, 0);
+  for (size_t col = 0; col < key_lengths_.size(); col++) {
+    const int   len = key_lengths_[col];
+    const char *key = keys_.data() + key_offsets_[col];
+    for (int i = 0; i < rows; i++, key += key_width_) {
+      hashes_[i] = hash_combine(hashes_[i], key, len);
+    }
+  }
 }
 
-RC StandardAggregateHashTable::Scanner::next(Chunk &output_chunk)
+uint64_t StandardAggregateHashTable::hash_key(const char *key) const
+{
+  uint64_t h = 0;
+  for (size_t col = 0; col < key_lengths_.size(); col++) {
+    h = hash_combine(h, key + key_offsets_[col], key_lengths_[col]);
+  }
+  return h;
+}
+
+char *StandardAggregateHashTable::find_or_create_group(const char *key, uint64_t hash)
+{
+  const uint32_t hash_tag = static_cast<uint32_t>(hash >> 32);
+  for (uint64_t pos = hash & mask_;; pos = (pos + 1) & mask_) {
+    Slot &slot = slots_[pos];
+    if (slot.group == 0) {
+      char *group = arena_.AllocateAligned(group_size_);
+      memcpy(group, key, key_width_);
+      memcpy(group + key_width_, initial_states_.data(), initial_states_.size());
+      groups_.push_back(group);
+      slot.hash_tag = hash_tag;
+      slot.group    = static_cast<uint32_t>(groups_.size());
+      return group;
+    }
+    char *group = groups_[slot.group - 1];
+    if (slot.hash_tag == hash_tag && memcmp(group, key, key_width_) == 0) {
+      return group;
+    }
+  }
+}
+
+void StandardAggregateHashTable::resize()
 {
+  vector<Slot> new_slots(slots_.size() * 2, Slot{0, 0});
+  const uint64_t new_mask = new_slots.size() - 1;
+  for (const Slot &slot : slots_) {
+    if (slot.group == 0) {
+      continue;
+    }
+    uint64_t pos = hash_key(groups_[slot.group - 1]) & new_mask;
+    while (new_slots[pos].group != 0) {
+      pos = (pos + 1) & new_mask;
+    }
+    new_slots[pos] = slot;
+  }
+  slots_ = std::move(new_slots);
+  mask_  = new_mask;
+}
+
+RC StandardAggregateHashTable::add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk)
+{
+  if (aggrs_chunk.column_num() > 0 && groups_chunk.rows() != aggrs_chunk.rows()) {
+    LOG_WARN("groups_chunk and aggrs_chunk have different rows: %d, %d", groups_chunk.rows(), aggrs_chunk.rows());
+    return RC::INVALID_ARGUMENT;
+  }
+  if (aggrs_chunk.column_num() != static_cast<int>(aggr_types_.size())) {
+    LOG_WARN("aggrs_chunk has %d columns, but there are %d aggregations",
+             aggrs_chunk.column_num(), static_cast<int>(aggr_types_.size()));
+    return RC::INVALID_ARGUMENT;
+  }
+
   RC rc = RC::SUCCESS;
-  if (it_ == end_) {
-    return RC::RECORD_EOF;
+  if (key_width_ < 0 && OB_FAIL(rc = init_layout(groups_chunk))) {
+    LOG_WARN("failed to init layout of aggregate hash table. rc=%s", strrc(rc));
+    return rc;
   }
-  while (it_ != end_ && output_chunk.rows() < output_chunk.capacity()) {
-    auto &group_by_values = it_->first;
-    auto &aggrs           = it_->second;
-    for (int i = 0; i < output_chunk.column_num(); i++) {
-      auto col_idx = output_chunk.column_ids(i);
-      if (col_idx >= static_cast<int>(group_by_values.size())) {
-        int aggr_real_idx = col_idx - group_by_values.size();
-        rc = finialize_aggregate_state(aggrs[aggr_real_idx], hash_table_->aggr_types_[aggr_real_idx],
-                                       hash_table_->aggr_child_types_[aggr_real_idx], output_chunk.column(i));
-        if (rc != RC::SUCCESS) {
-          LOG_WARN("finialize aggregate state failed");
-          return rc;
-        }
-      } else {
-        if (OB_FAIL(output_chunk.column(i).append_value(group_by_values[col_idx]))) {
-          LOG_WARN("append value failed");
-          return rc;
-        }
-      }
+  if (groups_chunk.column_num() != static_cast<int>(key_lengths_.size())) {
+    LOG_WARN("groups_chunk has %d columns, but expect %d", groups_chunk.column_num(), static_cast<int>(key_lengths_.size()));
+    return RC::INVALID_ARGUMENT;
+  }
+  for (int i = 0; i < groups_chunk.column_num(); i++) {
+    if (groups_chunk.column(i).attr_len() != key_lengths_[i]) {
+      LOG_WARN("group column %d has length %d, but expect %d", i, groups_chunk.column(i).attr_len(), key_lengths_[i]);
+      return RC::INVALID_ARGUMENT;
     }
-    it_++;
   }
-  if (it_ == end_) {
+
+  // 只处理选择向量中的行，键和 row_groups_ 按有效行的顺序排列
+  const int rows = groups_chunk.selected_rows();
+  if (rows == 0) {
     return RC::SUCCESS;
   }
 
-  return RC::SUCCESS;
-}
+  serialize_keys(groups_chunk, rows);
+  hash_keys(rows);
 
-size_t StandardAggregateHashTable::VectorHash::operator()(const vector<Value> &vec) const
-{
-  size_t hash_val = 0;
-  for (const auto &elem : vec) {
-    hash_val ^= hash<string>()(elem.to_string());
+  row_groups_.resize(rows);
+  const char *key = keys_.data();
+  for (int i = 0; i < rows; i++, key += key_width_) {
+    // 负载因子不超过 1/2
+    if ((groups_.size() + 1) * 2 > slots_.size()) {
+      resize();
+    }
+    row_groups_[i] = find_or_create_group(key, hashes_[i]);
+  }
+
+  for (size_t i = 0; i < aggr_types_.size(); i++) {
+    rc = aggregate_state_update_by_rows(
+        row_groups_.data(), state_offsets_[i], aggr_types_[i], aggr_child_types_[i], aggrs_chunk.column(i),
+        groups_chunk.selection());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("update aggregate state failed. rc=%s", strrc(rc));
+      return rc;
+    }
   }
-  return hash_val;
+  return RC::SUCCESS;
 }
 
-bool StandardAggregateHashTable::VectorEqual::operator()(const vector<Value> &lhs, const vector<Value> &rhs) const
+void StandardAggregateHashTable::Scanner::open_scan() { pos_ = 0; }
+
+RC StandardAggregateHashTable::Scanner::next(Chunk &output_chunk)
 {
-  if (lhs.size() != rhs.size()) {
-    return false;
+  auto *hash_table = static_cast<StandardAggregateHashTable *>(hash_table_);
+  if (pos_ >= hash_table->groups_.size()) {
+    return RC::RECORD_EOF;
   }
-  for (size_t i = 0; i < lhs.size(); ++i) {
-    if (rhs[i].compare(lhs[i]) != 0) {
-      return false;
+
+  const size_t end       = std::min(hash_table->groups_.size(), pos_ + output_chunk.capacity() - output_chunk.rows());
+  const int    group_num = static_cast<int>(hash_table->key_lengths_.size());
+  for (int i = 0; i < output_chunk.column_num(); i++) {
+    const int col_idx = output_chunk.column_ids(i);
+    Column   &column  = output_chunk.column(i);
+    if (col_idx >= group_num) {
+      const int aggr_idx = col_idx - group_num;
+      const int offset   = hash_table->state_offsets_[aggr_idx];
+      for (size_t g = pos_; g < end; g++) {
+        RC rc = finialize_aggregate_state(hash_table->groups_[g] + offset,
+            hash_table->aggr_types_[aggr_idx], hash_table->aggr_child_types_[aggr_idx], column);
+        if (OB_FAIL(rc)) {
+          LOG_WARN("finialize aggregate state failed. rc=%s", strrc(rc));
+          return rc;
+        }
+      }
+    } else {
+      const int offset = hash_table->key_offsets_[col_idx];
+      const int len    = hash_table->key_lengths_[col_idx];
+      for (size_t g = pos_; g < end; g++) {
+        char *key = hash_table->groups_[g] + offset;
+        RC    rc  = column.attr_len() == len ? column.append_one(key)
+                                             : column.append_value(Value(hash_table->key_types_[col_idx], key, len));
+        if (OB_FAIL(rc)) {
+          LOG_WARN("append value failed. rc=%s", strrc(rc));
+          return rc;
+        }
+      }
     }
   }
-  return true;
+  pos_ = end;
+  return RC::SUCCESS;
 }
 
 // ----------------------------------LinearProbingAggregateHashTable------------------
@@ -127,7 +311,25 @@ RC LinearProbingAggregateHashTable<V>::add_chunk(Chunk &group_chunk, Chunk &aggr
     LOG_WARN("group_chunk and aggr _chunk rows must be equal.");
     return RC::INVALID_ARGUMENT;
   }
-  add_batch((int *)group_chunk.column(0).data(), (V *)aggr_chunk.column(0).data(), group_chunk.rows());
+  const vector<int> *selection   = group_chunk.selection();
+  const Column      &aggr_column = aggr_chunk.column(0);
+  if (selection == nullptr && !aggr_column.has_nulls()) {
+    add_batch((int *)group_chunk.column(0).data(), (V *)aggr_column.data(), group_chunk.rows());
+    return RC::SUCCESS;
+  }
+
+  // 只聚合选择向量中的行，先将这些键值对收集到连续的内存中。sum 忽略 NULL 值，相当于加 0
+  const int   rows   = selection == nullptr ? group_chunk.rows() : static_cast<int>(selection->size());
+  const int  *keys   = (const int *)group_chunk.column(0).data();
+  const V    *values = (const V *)aggr_column.data();
+  vector<int> selected_keys(rows);
+  vector<V>   selected_values(rows);
+  for (int i = 0; i < rows; i++) {
+    const int index    = selection == nullptr ? i : (*selection)[i];
+    selected_keys[i]   = keys[index];
+    selected_values[i] = aggr_column.is_null(index) ? V() : values[index];
+  }
+  add_batch(selected_keys.data(), selected_values.data(), selected_keys.size());
   return RC::SUCCESS;
 }
 
@@ -138,16 +340,22 @@ void LinearProbingAggregateHashTable<V>::Scanner::open_scan()
   size_       = static_cast<LinearProbingAggregateHashTable *>(hash_table_)->size();
   scan_pos_   = 0;
   scan_count_ = 0;
+
+  empty_key_scanned_ = false;
 }
 
 template <typename V>
 RC LinearProbingAggregateHashTable<V>::Scanner::next(Chunk &output_chunk)
 {
-  if (scan_pos_ >= capacity_ || scan_count_ >= size_) {
+  auto linear_probing_hash_table = static_cast<LinearProbingAggregateHashTable *>(hash_table_);
+  int  empty_key                 = LinearProbingAggregateHashTable<V>::EMPTY_KEY;
+  V    empty_key_value;
+  bool has_empty_key = linear_probing_hash_table->get_empty_key_value(empty_key_value) && !empty_key_scanned_;
+  bool table_scanned = scan_pos_ >= capacity_ || scan_count_ >= size_;
+  if (table_scanned && !has_empty_key) {
     return RC::RECORD_EOF;
   }
-  auto linear_probing_hash_table = static_cast<LinearProbingAggregateHashTable *>(hash_table_);
-  while (scan_pos_ < capacity_ && scan_count_ < size_ && output_chunk.rows() <= output_chunk.capacity()) {
+  while (scan_pos_ < capacity_ && scan_count_ < size_ && output_chunk.rows() < output_chunk.capacity()) {
     int key;
     V   value;
     RC  rc = linear_probing_hash_table->iter_get(scan_pos_, key, value);
@@ -158,6 +366,12 @@ RC LinearProbingAggregateHashTable<V>::Scanner::next(Chunk &output_chunk)
     }
     scan_pos_++;
   }
+  table_scanned = scan_pos_ >= capacity_ || scan_count_ >= size_;
+  if (table_scanned && has_empty_key && output_chunk.rows() < output_chunk.capacity()) {
+    output_chunk.column(0).append_one((char *)&empty_key);
+    output_chunk.column(1).append_one((char *)&empty_key_value);
+    empty_key_scanned_ = true;
+  }
   return RC::SUCCESS;
 }
 
@@ -168,11 +382,16 @@ void LinearProbingAggregateHashTable<V>::Scanner::close_scan()
   size_       = -1;
   scan_pos_   = -1;
   scan_count_ = 0;
+
+  empty_key_scanned_ = false;
 }
 
 template <typename V>
 RC LinearProbingAggregateHashTable<V>::get(int key, V &value)
 {
+  if (key == EMPTY_KEY) {
+    return get_empty_key_value(value) ? RC::SUCCESS : RC::NOT_EXIST;
+  }
   RC  rc          = RC::SUCCESS;
   int index       = (key % capacity_ + capacity_) % capacity_;
   int iterate_cnt = 0;
@@ -223,7 +442,7 @@ template <typename V>
 void LinearProbingAggregateHashTable<V>::resize()
 {
   capacity_ *= 2;
-  vector<int> new_keys(capacity_);
+  vector<int> new_keys(capacity_, EMPTY_KEY);
   vector<V>   new_values(capacity_);
 
   for (size_t i = 0; i < keys_.size(); i++) {
@@ -252,31 +471,108 @@ void LinearProbingAggregateHashTable<V>::resize_if_need()
 }
 
 template <typename V>
-void LinearProbingAggregateHashTable<V>::add_batch(int *input_keys, V *input_values, int len)
+void LinearProbingAggregateHashTable<V>::add_one(int key, V value)
 {
-  // your code here
-  exit(-1);
+  if (key == EMPTY_KEY) {
+    if (has_empty_key_) {
+      aggregate(&empty_key_value_, value);
+    } else {
+      has_empty_key_   = true;
+      empty_key_value_ = value;
+    }
+    return;
+  }
 
+  resize_if_need();
+  int index = key & (capacity_ - 1);
+  while (true) {
+    if (keys_[index] == EMPTY_KEY) {
+      keys_[index]   = key;
+      values_[index] = value;
+      size_++;
+      return;
+    } else if (keys_[index] == key) {
+      aggregate(&values_[index], value);
+      return;
+    }
+    index = (index + 1) & (capacity_ - 1);
+  }
+}
+
+template <typename V>
+void LinearProbingAggregateHashTable<V>::add_batch(int *input_keys, V *input_values, int len)
+{
   // inv (invalid) 表示是否有效，inv[i] = -1 表示有效，inv[i] = 0 表示无效。
   // key[SIMD_WIDTH],value[SIMD_WIDTH] 表示当前循环中处理的键值对。
   // off (offset) 表示线性探测冲突时的偏移量，key[i] 每次遇到冲突键，则off[i]++，如果key[i] 已经完成聚合，则off[i] = 0，
   // i = 0 表示selective load 的起始位置。
-  // inv 全部初始化为 -1
-  // off 全部初始化为 0
-
-  // for (; i + SIMD_WIDTH <= len;) {
-    // 1: 根据 `inv` 变量的值，从 `input_keys` 中 `selective load` `SIMD_WIDTH` 个不同的输入键值对。
-    // 2. 计算 i += |inv|, `|inv|` 表示 `inv` 中有效的个数 
-    // 3. 计算 hash 值，
-    // 4. 根据聚合类型（目前只支持 sum），在哈希表中更新聚合结果。如果本次循环，没有找到key[i] 在哈希表中的位置，则不更新聚合结果。
-    // 5. gather 操作，根据 hash 值将 keys_ 的 gather 结果写入 table_key 中。
-    // 6. 更新 inv 和 off。如果本次循环key[i] 聚合完成，则inv[i]=-1，表示该位置在下次循环中读取新的键值对。
-    // 如果本次循环 key[i] 未在哈希表中聚合完成（table_key[i] != key[i]），则inv[i] = 0，表示该位置在下次循环中不需要读取新的键值对。
-    // 如果本次循环中，key[i]聚合完成，则off[i] 更新为 0，表示线性探测偏移量为 0，key[i] 未完成聚合，则off[i]++,表示线性探测偏移量加 1。
-  // }
-  //7. 通过标量线性探测，处理剩余键值对
-
-  // resize_if_need();
+  alignas(32) int key[SIMD_WIDTH];
+  alignas(32) V   value[SIMD_WIDTH];
+  alignas(32) int hash[SIMD_WIDTH];
+  alignas(32) int table_key[SIMD_WIDTH];
+  alignas(32) int inv_lanes[SIMD_WIDTH];
+  alignas(32) int off_lanes[SIMD_WIDTH];
+
+  __m256i inv = _mm256_set1_epi32(-1);
+  __m256i off = _mm256_setzero_si256();
+  int     i   = 0;
+  for (; i + SIMD_WIDTH <= len;) {
+    // 扩容后槽位全部变化，未完成聚合的键从头开始探测
+    int old_capacity = capacity_;
+    resize_if_need();
+    if (capacity_ != old_capacity) {
+      off = _mm256_setzero_si256();
+    }
+
+    // 1. selective load，inv[i] = -1 的位置读取新的键值对
+    selective_load(input_keys, i, key, inv);
+    selective_load(input_values, i, value, inv);
+    // 2. i += |inv|
+    i += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(inv)));
+
+    // 3. 计算 hash 值，容量是 2 的幂，(key + off) & (capacity - 1) 即为探测位置
+    __m256i keys   = _mm256_load_si256(reinterpret_cast<const __m256i *>(key));
+    __m256i hashes = _mm256_and_si256(_mm256_add_epi32(keys, off), _mm256_set1_epi32(capacity_ - 1));
+    // 5. gather，读取探测位置上的键
+    __m256i table_keys = _mm256_i32gather_epi32(keys_.data(), hashes, sizeof(int));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(hash), hashes);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(table_key), table_keys);
+
+    // 4 & 6. 更新聚合结果、inv 和 off。
+    // 槽位的键一旦写入就不会改变，所以 gather 的键与输入键相等时可以直接聚合；gather 到空槽位时需要重新读取，
+    // 因为同一批次中前面的键可能已经写入了该槽位。
+    _mm256_store_si256(reinterpret_cast<__m256i *>(off_lanes), off);
+    for (int j = 0; j < SIMD_WIDTH; j++) {
+      bool done = true;
+      if (key[j] == EMPTY_KEY) {
+        add_one(key[j], value[j]);
+      } else if (table_key[j] == key[j] || keys_[hash[j]] == key[j]) {
+        aggregate(&values_[hash[j]], value[j]);
+      } else if (keys_[hash[j]] == EMPTY_KEY) {
+        keys_[hash[j]]   = key[j];
+        values_[hash[j]] = value[j];
+        size_++;
+      } else {
+        done = false;
+      }
+      inv_lanes[j] = done ? -1 : 0;
+      off_lanes[j] = done ? 0 : off_lanes[j] + 1;
+    }
+    inv = _mm256_load_si256(reinterpret_cast<const __m256i *>(inv_lanes));
+    off = _mm256_load_si256(reinterpret_cast<const __m256i *>(off_lanes));
+  }
+
+  // 7. 通过标量线性探测，处理未完成聚合的键值对和剩余键值对
+  _mm256_store_si256(reinterpret_cast<__m256i *>(inv_lanes), inv);
+  for (int j = 0; j < SIMD_WIDTH; j++) {
+    if (inv_lanes[j] == 0) {
+      add_one(key[j], value[j]);
+    }
+  }
+  for (; i < len; i++) {
+    add_one(input_keys[i], input_values[i]);
+  }
+  resize_if_need();
 }
 
 template <typename V>
@@ -11,9 +11,9 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "common/lang/vector.h"
-#include "common/lang/unordered_map.h"
 #include "common/math/simd_util.h"
 #include "common/sys/rc.h"
+#include "storage/common/arena_allocator.h"
 #include "sql/expr/expression.h"
 
 /**
@@ -43,6 +43,7 @@ public:
 
   /**
    * @brief 将 groups_chunk 和 aggrs_chunk 写入到哈希表中。哈希表中记录了聚合结果。
+   * @details 两个 chunk 的行一一对应，groups_chunk 有选择向量时只处理其中记录的行。
    */
   virtual RC add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk) = 0;
 
@@ -51,21 +52,17 @@ public:
   vector<AttrType>            aggr_child_types_;
 };
 
+/**
+ * @brief 支持多个分组列和多个聚合的哈希表
+ * @details 分组列的值按行序列化为定长的键，键长是各分组列 attr_len 之和，字符串在第一个 '\0' 之后补零，
+ * 因此可以直接按字节比较。每个分组的键和所有聚合状态连续存放在 arena 中，
+ * 槽位数组使用开放寻址（线性探测），每个槽位只记录哈希值的高 32 位和分组编号，探测时很少访问分组的内存。
+ * 一个 chunk 按列处理：先逐列序列化键并计算哈希值，再逐行定位分组，最后逐个聚合列更新聚合状态。
+ * 扫描时按分组的插入顺序输出。
+ */
 class StandardAggregateHashTable : public AggregateHashTable
 {
-private:
-  struct VectorHash
-  {
-    size_t operator()(const vector<Value> &vec) const;
-  };
-
-  struct VectorEqual
-  {
-    bool operator()(const vector<Value> &lhs, const vector<Value> &rhs) const;
-  };
-
 public:
-  using StandardHashTable = unordered_map<vector<Value>, vector<void *>, VectorHash, VectorEqual>;
   class Scanner : public AggregateHashTable::Scanner
   {
   public:
@@ -77,39 +74,73 @@ public:
     RC next(Chunk &chunk) override;
 
   private:
-    StandardHashTable::iterator end_;
-    StandardHashTable::iterator it_;
+    size_t pos_ = 0;  /// 下一个输出的分组编号
   };
-  StandardAggregateHashTable(const vector<Expression *> aggregations)
-  {
-    for (auto &expr : aggregations) {
-      ASSERT(expr->type() == ExprType::AGGREGATION, "expect aggregate expression");
-      auto *aggregation_expr = static_cast<AggregateExpr *>(expr);
-      aggr_types_.push_back(aggregation_expr->aggregate_type());
-      aggr_child_types_.push_back(aggregation_expr->value_type());
-    }
-  }
-  virtual ~StandardAggregateHashTable()
-  {
-    for (auto &aggr : aggr_values_) {
-      for (auto &state : aggr.second) {
-        free(state);
-      }
-    }
-  }
+
+  StandardAggregateHashTable(const vector<Expression *> aggregations);
+  virtual ~StandardAggregateHashTable() = default;
 
   RC add_chunk(Chunk &groups_chunk, Chunk &aggrs_chunk) override;
 
-  StandardHashTable::iterator begin() { return aggr_values_.begin(); }
-  StandardHashTable::iterator end() { return aggr_values_.end(); }
+  /// 分组的个数
+  size_t size() const { return groups_.size(); }
+
+private:
+  /**
+   * @brief 槽位。group 为分组编号加 1，0 表示空槽位
+   */
+  struct Slot
+  {
+    uint32_t hash_tag;
+    uint32_t group;
+  };
+
+  /**
+   * @brief 根据第一个 chunk 的分组列确定键和聚合状态在分组内存中的布局
+   */
+  RC init_layout(const Chunk &groups_chunk);
 
-  /// group by values -> aggregate values
-  StandardHashTable aggr_values_;
+  /// 逐列将分组列写入 keys_，每行 key_width_ 字节
+  void serialize_keys(const Chunk &groups_chunk, int rows);
+
+  /// 逐列计算 keys_ 中每个键的哈希值
+  void hash_keys(int rows);
+
+  /// 单个键的哈希值，与 hash_keys 的结果相同，扩容时使用
+  uint64_t hash_key(const char *key) const;
+
+  /// 找到键所在的分组，没有时创建
+  char *find_or_create_group(const char *key, uint64_t hash);
+
+  void resize();
+
+private:
+  static const int DEFAULT_CAPACITY;
+
+  vector<AttrType> key_types_;
+  vector<int>      key_offsets_;
+  vector<int>      key_lengths_;
+  int              key_width_ = -1;  /// 在第一次 add_chunk 时确定
+
+  vector<int>  state_offsets_;  /// 各聚合状态在分组内存中的偏移
+  vector<char> initial_states_;  /// 初始化好的聚合状态，新分组直接复制
+  int          group_size_ = 0;
+
+  vector<Slot>   slots_;
+  uint64_t       mask_ = 0;
+  vector<char *> groups_;  /// 按插入顺序保存各分组的内存
+  Arena          arena_;
+
+  // 处理一个 chunk 的临时数据
+  vector<char>     keys_;
+  vector<uint64_t> hashes_;
+  vector<char *>   row_groups_;
 };
 
 /**
  * @brief 线性探测哈希表实现
- * @note 当前只支持group by 列为 char/char(4) 类型，且聚合列为单列。
+ * @note 当前只支持group by 列为 int 类型，且聚合列为单列、聚合类型为 sum。
+ * 容量总是 2 的幂，因此哈希值可以用位与计算。键 EMPTY_KEY 用于标记空槽位，该键的聚合结果单独保存。
  */
 #ifdef USE_SIMD
 template <typename V>
@@ -129,15 +160,23 @@ public:
     void close_scan() override;
 
   private:
-    int capacity_   = -1;
-    int size_       = -1;
-    int scan_pos_   = -1;
-    int scan_count_ = 0;
+    int  capacity_          = -1;
+    int  size_              = -1;
+    int  scan_pos_          = -1;
+    int  scan_count_        = 0;
+    bool empty_key_scanned_ = false;
   };
 
   LinearProbingAggregateHashTable(AggregateExpr::Type aggregate_type, int capacity = DEFAULT_CAPACITY)
-      : keys_(capacity, EMPTY_KEY), values_(capacity, 0), capacity_(capacity), aggregate_type_(aggregate_type)
-  {}
+      : aggregate_type_(aggregate_type)
+  {
+    capacity_ = 2 * SIMD_WIDTH;
+    while (capacity_ < capacity) {
+      capacity_ *= 2;
+    }
+    keys_.assign(capacity_, EMPTY_KEY);
+    values_.assign(capacity_, 0);
+  }
   virtual ~LinearProbingAggregateHashTable() {}
 
   RC get(int key, V &value);
@@ -149,6 +188,16 @@ public:
   int capacity() { return capacity_; }
   int size() { return size_; }
 
+  /**
+   * @brief 键 EMPTY_KEY 的聚合结果
+   * @return 没有该键时返回 false
+   */
+  bool get_empty_key_value(V &value) const
+  {
+    value = empty_key_value_;
+    return has_empty_key_;
+  }
+
 private:
   /**
    * @brief 将键值对以批量的形式写入哈希表中，这里参考了论文
@@ -161,6 +210,11 @@ private:
 
   void aggregate(V *value, V value_to_aggregate);
 
+  /**
+   * @brief 标量线性探测，将一个键值对写入哈希表中
+   */
+  void add_one(int key, V value);
+
   void resize();
 
   void resize_if_need();
@@ -174,5 +228,8 @@ private:
   int                 size_     = 0;
   int                 capacity_ = 0;
   AggregateExpr::Type aggregate_type_;
+
+  bool has_empty_key_   = false;
+  V    empty_key_value_ = 0;
 };
 #endif  // USE_SIMD
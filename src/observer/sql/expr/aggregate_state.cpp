@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/expr/aggregate_state.h"
 #include <stdint.h>
+#include "common/lang/algorithm.h"
 
 #ifdef USE_SIMD
 #include "common/math/simd_util.h"
@@ -45,34 +46,66 @@ void CountState<T>::update(const T *values, int size)
   value += size;
 }
 
-void* create_aggregate_state(AggregateExpr::Type aggr_type, AttrType attr_type)
+size_t aggregate_state_size(AggregateExpr::Type aggr_type, AttrType attr_type)
 {
-  void* state_ptr = nullptr;
   if (aggr_type == AggregateExpr::Type::SUM) {
     if (attr_type == AttrType::INTS) {
-      state_ptr = malloc(sizeof(SumState<int>));
-      new (state_ptr) SumState<int>();
+      return sizeof(SumState<int>);
+    } else if (attr_type == AttrType::FLOATS) {
+      return sizeof(SumState<float>);
+    }
+  } else if (aggr_type == AggregateExpr::Type::COUNT) {
+    return sizeof(CountState<int>);
+  } else if (aggr_type == AggregateExpr::Type::AVG) {
+    if (attr_type == AttrType::INTS) {
+      return sizeof(AvgState<int>);
     } else if (attr_type == AttrType::FLOATS) {
-      state_ptr = malloc(sizeof(SumState<float>));
-      new (state_ptr) SumState<float>();
+      return sizeof(AvgState<float>);
+    }
+  }
+  return 0;
+}
+
+RC init_aggregate_state(void *state, AggregateExpr::Type aggr_type, AttrType attr_type)
+{
+  if (aggr_type == AggregateExpr::Type::SUM) {
+    if (attr_type == AttrType::INTS) {
+      new (state) SumState<int>();
+    } else if (attr_type == AttrType::FLOATS) {
+      new (state) SumState<float>();
     } else {
       LOG_WARN("unsupported aggregate value type");
+      return RC::UNIMPLEMENTED;
     }
   } else if (aggr_type == AggregateExpr::Type::COUNT) {
-    state_ptr = malloc(sizeof(CountState<int>));
-    new (state_ptr) CountState<int>();
+    new (state) CountState<int>();
   } else if (aggr_type == AggregateExpr::Type::AVG) {
     if (attr_type == AttrType::INTS) {
-      state_ptr = malloc(sizeof(AvgState<int>));
-      new (state_ptr) AvgState<int>();
+      new (state) AvgState<int>();
     } else if (attr_type == AttrType::FLOATS) {
-      state_ptr = malloc(sizeof(AvgState<float>));
-      new (state_ptr) AvgState<float>();
+      new (state) AvgState<float>();
     } else {
       LOG_WARN("unsupported aggregate value type");
+      return RC::UNIMPLEMENTED;
     }
   } else {
     LOG_WARN("unsupported aggregator type");
+    return RC::UNIMPLEMENTED;
+  }
+  return RC::SUCCESS;
+}
+
+void* create_aggregate_state(AggregateExpr::Type aggr_type, AttrType attr_type)
+{
+  size_t size = aggregate_state_size(aggr_type, attr_type);
+  if (size == 0) {
+    LOG_WARN("unsupported aggregate type or value type");
+    return nullptr;
+  }
+  void* state_ptr = malloc(size);
+  if (OB_FAIL(init_aggregate_state(state_ptr, aggr_type, attr_type))) {
+    free(state_ptr);
+    return nullptr;
   }
   return state_ptr;
 }
@@ -145,33 +178,191 @@ RC finialize_aggregate_state(void *state, AggregateExpr::Type aggr_type, AttrTyp
   return rc;
 }
 
+/**
+ * @brief 统计 col 中不为 NULL 的有效行数
+ */
+static int count_not_null_rows(const Column &col, const vector<int> *selection)
+{
+  const int rows = selection == nullptr ? col.count() : static_cast<int>(selection->size());
+  if (!col.has_nulls()) {
+    return rows;
+  }
+  if (col.column_type() == Column::Type::CONSTANT_COLUMN) {
+    return col.is_null(0) ? 0 : rows;
+  }
+  if (selection != nullptr) {
+    int count = 0;
+    for (int index : *selection) {
+      count += col.is_null(index) ? 0 : 1;
+    }
+    return count;
+  }
+
+  const uint8_t *nulls      = col.nulls();
+  int            null_count = 0;
+  for (int byte = 0; byte < rows / 8; byte++) {
+    null_count += __builtin_popcount(nulls[byte]);
+  }
+  if (rows % 8 != 0) {
+    null_count += __builtin_popcount(nulls[rows / 8] & ((1 << (rows % 8)) - 1));
+  }
+  return rows - null_count;
+}
+
+/**
+ * @brief 聚合 column 中所有不为 NULL 的行
+ * @details 空值位图的一个字节对应 8 行，连续没有 NULL 的字节仍然批量聚合，可以使用向量化的 update，
+ * 有 NULL 的字节逐行跳过 NULL
+ */
+template <class STATE, typename T>
+void update_aggregate_state_with_nulls(STATE *state, const T *data, const uint8_t *nulls, int rows)
+{
+  const int bytes = (rows + 7) / 8;
+  int       byte  = 0;
+  while (byte < bytes) {
+    if (nulls[byte] == 0) {
+      int end = byte + 1;
+      while (end < bytes && nulls[end] == 0) {
+        end++;
+      }
+      const int begin_row = byte * 8;
+      const int end_row   = std::min(end * 8, rows);
+      state->update(data + begin_row, end_row - begin_row);
+      byte = end;
+      continue;
+    }
+
+    const int end_row = std::min(byte * 8 + 8, rows);
+    for (int i = byte * 8; i < end_row; i++) {
+      if (!((nulls[byte] >> (i % 8)) & 1)) {
+        state->update(data[i]);
+      }
+    }
+    byte++;
+  }
+}
+
 template <class STATE, typename T>
-void update_aggregate_state(void *state, const Column &column)
+void update_aggregate_state(void *state, const Column &column, const vector<int> *selection)
 {
   STATE *state_ptr = reinterpret_cast<STATE *>(state);
   T *    data      = (T *)column.data();
-  state_ptr->update(data, column.count());
+  if (column.column_type() == Column::Type::CONSTANT_COLUMN) {
+    // 常量列只有一个值
+    const int count = count_not_null_rows(column, selection);
+    for (int i = 0; i < count; i++) {
+      state_ptr->update(data[0]);
+    }
+  } else if (column.has_nulls()) {
+    // 聚合函数忽略 NULL 值
+    if (selection == nullptr) {
+      update_aggregate_state_with_nulls(state_ptr, data, column.nulls(), column.count());
+    } else {
+      for (int index : *selection) {
+        if (!column.is_null(index)) {
+          state_ptr->update(data[index]);
+        }
+      }
+    }
+  } else if (selection == nullptr) {
+    state_ptr->update(data, column.count());
+  } else {
+    for (int index : *selection) {
+      state_ptr->update(data[index]);
+    }
+  }
 }
 
-RC aggregate_state_update_by_column(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, Column& col)
+RC aggregate_state_update_by_column(
+    void *state, AggregateExpr::Type aggr_type, AttrType attr_type, Column& col, const vector<int> *selection)
 {
   RC rc = RC::SUCCESS;
   if (aggr_type == AggregateExpr::Type::SUM) {
     if (attr_type == AttrType::INTS) {
-      update_aggregate_state<SumState<int>, int>(state, col);
+      update_aggregate_state<SumState<int>, int>(state, col, selection);
     } else if (attr_type == AttrType::FLOATS) {
-      update_aggregate_state<SumState<float>, float>(state, col);
+      update_aggregate_state<SumState<float>, float>(state, col, selection);
     } else {
       LOG_WARN("unsupported aggregate value type");
       rc = RC::UNIMPLEMENTED;
     }
   } else if (aggr_type == AggregateExpr::Type::COUNT) {
-    update_aggregate_state<CountState<int>, int>(state, col);
+    static_cast<CountState<int> *>(state)->value += count_not_null_rows(col, selection);
+  } else if (aggr_type == AggregateExpr::Type::AVG) {
+    if (attr_type == AttrType::INTS) {
+      update_aggregate_state<AvgState<int>, int>(state, col, selection);
+    } else if (attr_type == AttrType::FLOATS) {
+      update_aggregate_state<AvgState<float>, float>(state, col, selection);
+    } else {
+      LOG_WARN("unsupported aggregate value type");
+      rc = RC::UNIMPLEMENTED;
+    }
+  } else {
+    LOG_WARN("unsupported aggregator type");
+    rc = RC::UNIMPLEMENTED;
+  }
+  return rc;
+}
+
+template <class STATE, typename T>
+void update_aggregate_states(char **states, int offset, const Column &column, const vector<int> *selection)
+{
+  const T *data = (const T *)column.data();
+  if (column.column_type() == Column::Type::CONSTANT_COLUMN) {
+    if (column.is_null(0)) {
+      return;
+    }
+    const int count = selection == nullptr ? column.count() : static_cast<int>(selection->size());
+    for (int i = 0; i < count; i++) {
+      reinterpret_cast<STATE *>(states[i] + offset)->update(data[0]);
+    }
+  } else if (column.has_nulls()) {
+    // 聚合函数忽略 NULL 值
+    const int count = selection == nullptr ? column.count() : static_cast<int>(selection->size());
+    for (int i = 0; i < count; i++) {
+      const int index = selection == nullptr ? i : (*selection)[i];
+      if (!column.is_null(index)) {
+        reinterpret_cast<STATE *>(states[i] + offset)->update(data[index]);
+      }
+    }
+  } else if (selection == nullptr) {
+    for (int i = 0; i < column.count(); i++) {
+      reinterpret_cast<STATE *>(states[i] + offset)->update(data[i]);
+    }
+  } else {
+    for (size_t i = 0; i < selection->size(); i++) {
+      reinterpret_cast<STATE *>(states[i] + offset)->update(data[(*selection)[i]]);
+    }
+  }
+}
+
+RC aggregate_state_update_by_rows(char **states, int offset, AggregateExpr::Type aggr_type, AttrType attr_type,
+    const Column &col, const vector<int> *selection)
+{
+  RC rc = RC::SUCCESS;
+  if (aggr_type == AggregateExpr::Type::SUM) {
+    if (attr_type == AttrType::INTS) {
+      update_aggregate_states<SumState<int>, int>(states, offset, col, selection);
+    } else if (attr_type == AttrType::FLOATS) {
+      update_aggregate_states<SumState<float>, float>(states, offset, col, selection);
+    } else {
+      LOG_WARN("unsupported aggregate value type");
+      rc = RC::UNIMPLEMENTED;
+    }
+  } else if (aggr_type == AggregateExpr::Type::COUNT) {
+    // count 不读取值，只需要行数和空值位图
+    const int count = selection == nullptr ? col.count() : static_cast<int>(selection->size());
+    for (int i = 0; i < count; i++) {
+      const int index = selection == nullptr ? i : (*selection)[i];
+      if (!col.is_null(index)) {
+        reinterpret_cast<CountState<int> *>(states[i] + offset)->value++;
+      }
+    }
   } else if (aggr_type == AggregateExpr::Type::AVG) {
     if (attr_type == AttrType::INTS) {
-      update_aggregate_state<AvgState<int>, int>(state, col);
+      update_aggregate_states<AvgState<int>, int>(states, offset, col, selection);
     } else if (attr_type == AttrType::FLOATS) {
-      update_aggregate_state<AvgState<float>, float>(state, col);
+      update_aggregate_states<AvgState<float>, float>(states, offset, col, selection);
     } else {
       LOG_WARN("unsupported aggregate value type");
       rc = RC::UNIMPLEMENTED;
@@ -62,7 +62,30 @@ public:
 
 void *create_aggregate_state(AggregateExpr::Type aggr_type, AttrType attr_type);
 
+/**
+ * @brief 聚合状态占用的内存大小，不支持的类型返回 0
+ * @note 聚合状态都是简单的数值，按 8 字节对齐即可，不需要析构
+ */
+size_t aggregate_state_size(AggregateExpr::Type aggr_type, AttrType attr_type);
+
+/**
+ * @brief 在 state 指向的内存上构造聚合状态，内存至少有 aggregate_state_size 字节
+ */
+RC init_aggregate_state(void *state, AggregateExpr::Type aggr_type, AttrType attr_type);
+
 RC aggregate_state_update_by_value(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, const Value &val);
-RC aggregate_state_update_by_column(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, Column &col);
+/**
+ * @brief 将 col 中的值聚合到 state 中，忽略 NULL 值
+ * @param selection 选择向量，不为空时只聚合其中记录的行
+ */
+RC aggregate_state_update_by_column(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, Column &col,
+    const vector<int> *selection = nullptr);
+
+/**
+ * @brief 将 col 的第 i 个有效行聚合到 states[i] + offset 处的聚合状态中，用于分组聚合，忽略 NULL 值
+ * @param selection 选择向量，为空时所有行都有效
+ */
+RC aggregate_state_update_by_rows(char **states, int offset, AggregateExpr::Type aggr_type, AttrType attr_type,
+    const Column &col, const vector<int> *selection = nullptr);
 
 RC finialize_aggregate_state(void *state, AggregateExpr::Type aggr_type, AttrType attr_type, Column &col);
\ No newline at end of file
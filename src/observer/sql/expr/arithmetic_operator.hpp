@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/math/simd_util.h"
 #endif
 
+#include "common/lang/algorithm.h"
 #include "storage/common/column.h"
 
 struct Equal
@@ -149,11 +150,11 @@ struct SubtractOperator
   {
     return left - right;
   }
-  // your code here
+
 #if defined(USE_SIMD)
-  static inline __m256 operation(__m256 left, __m256 right) { exit(-1); }
+  static inline __m256 operation(__m256 left, __m256 right) { return _mm256_sub_ps(left, right); }
 
-  static inline __m256i operation(__m256i left, __m256i right) { exit(-1); }
+  static inline __m256i operation(__m256i left, __m256i right) { return _mm256_sub_epi32(left, right); }
 #endif
 };
 
@@ -164,11 +165,11 @@ struct MultiplyOperator
   {
     return left * right;
   }
-// your code here
+
 #if defined(USE_SIMD)
-  static inline __m256 operation(__m256 left, __m256 right) { exit(-1); }
+  static inline __m256 operation(__m256 left, __m256 right) { return _mm256_mul_ps(left, right); }
 
-  static inline __m256i operation(__m256i left, __m256i right) { exit(-1); }
+  static inline __m256i operation(__m256i left, __m256i right) { return _mm256_mullo_epi32(left, right); }
 #endif
 };
 
@@ -331,6 +332,104 @@ void binary_operator(T *left_data, T *right_data, T *result_data, int size)
 #endif
 }
 
+/**
+ * @brief 合并两个输入的空值位图，任意一边为 NULL 时结果为 NULL
+ * @details 位图中第 i 位为 1 表示第 i 行为 NULL，nullptr 表示没有 NULL。常量输入只看第 0 位。
+ */
+template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT>
+void merge_nulls(const uint8_t *left_nulls, const uint8_t *right_nulls, uint8_t *result_nulls, int size)
+{
+  const int bytes     = (size + 7) / 8;
+  uint8_t   left_all  = 0;
+  uint8_t   right_all = 0;
+  if constexpr (LEFT_CONSTANT) {
+    left_all = (left_nulls != nullptr && (left_nulls[0] & 1)) ? 0xFF : 0;
+  }
+  if constexpr (RIGHT_CONSTANT) {
+    right_all = (right_nulls != nullptr && (right_nulls[0] & 1)) ? 0xFF : 0;
+  }
+  // 按字节合并，编译器可以自动向量化
+  for (int i = 0; i < bytes; i++) {
+    uint8_t left  = (LEFT_CONSTANT || left_nulls == nullptr) ? left_all : left_nulls[i];
+    uint8_t right = (RIGHT_CONSTANT || right_nulls == nullptr) ? right_all : right_nulls[i];
+    result_nulls[i] = left | right;
+  }
+}
+
+/**
+ * @brief 带空值位图的 binary_operator，NULL 行不做计算，结果填充为 0
+ * @details 空值位图的一个字节对应 8 行，正好是一个 SIMD 寄存器的宽度。连续没有 NULL 的字节
+ * 交给 binary_operator 做向量化计算，有 NULL 的字节逐行跳过 NULL，避免对 NULL 行做除零等运算。
+ * @param nulls 结果的空值位图，可以由 merge_nulls 得到，nullptr 表示没有 NULL
+ */
+template <bool LEFT_CONSTANT, bool RIGHT_CONSTANT, typename T, class OP>
+void binary_operator_with_nulls(T *left_data, T *right_data, T *result_data, int size, const uint8_t *nulls)
+{
+  if (nulls == nullptr) {
+    binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, T, OP>(left_data, right_data, result_data, size);
+    return;
+  }
+
+  const int bytes = (size + 7) / 8;
+  int       byte  = 0;
+  while (byte < bytes) {
+    if (nulls[byte] == 0) {
+      int end = byte + 1;
+      while (end < bytes && nulls[end] == 0) {
+        end++;
+      }
+      const int begin_row = byte * 8;
+      const int end_row   = std::min(end * 8, size);
+      binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, T, OP>(LEFT_CONSTANT ? left_data : left_data + begin_row,
+          RIGHT_CONSTANT ? right_data : right_data + begin_row,
+          result_data + begin_row,
+          end_row - begin_row);
+      byte = end;
+      continue;
+    }
+
+    const int end_row = std::min(byte * 8 + 8, size);
+    for (int i = byte * 8; i < end_row; i++) {
+      if ((nulls[byte] >> (i % 8)) & 1) {
+        result_data[i] = T();
+      } else {
+        result_data[i] = OP::template operation<T>(left_data[LEFT_CONSTANT ? 0 : i], right_data[RIGHT_CONSTANT ? 0 : i]);
+      }
+    }
+    byte++;
+  }
+}
+
+/**
+ * @brief 将 NULL 行的比较结果置为 0。NULL 与任何值比较的结果都不为真
+ * @param nulls 输入的空值位图，CONSTANT 为 true 时只看第 0 位
+ */
+template <bool CONSTANT>
+void filter_nulls(const uint8_t *nulls, int size, vector<uint8_t> &result)
+{
+  if (nulls == nullptr) {
+    return;
+  }
+  if constexpr (CONSTANT) {
+    if (nulls[0] & 1) {
+      std::fill(result.begin(), result.begin() + size, 0);
+    }
+    return;
+  }
+  const int bytes = (size + 7) / 8;
+  for (int byte = 0; byte < bytes; byte++) {
+    if (nulls[byte] == 0) {
+      continue;
+    }
+    const int end_row = std::min(byte * 8 + 8, size);
+    for (int i = byte * 8; i < end_row; i++) {
+      if ((nulls[byte] >> (i % 8)) & 1) {
+        result[i] = 0;
+      }
+    }
+  }
+}
+
 template <bool CONSTANT, typename T, class OP>
 void unary_operator(T *input, T *result_data, int size)
 {
@@ -35,15 +35,19 @@ bool FieldExpr::equal(const Expression &other) const
   return table_name() == other_field_expr.table_name() && field_name() == other_field_expr.field_name();
 }
 
-// TODO: 在进行表达式计算时，`chunk` 包含了所有列，因此可以通过 `field_id` 获取到对应列。
-// 后续可以优化成在 `FieldExpr` 中存储 `chunk` 中某列的位置信息。
+// 没有设置 `pos_` 时，`chunk` 是表扫描的结果，只包含查询用到的列，列 id 就是 `field_id`
 RC FieldExpr::get_column(Chunk &chunk, Column &column)
 {
   if (pos_ != -1) {
     column.reference(chunk.column(pos_));
-  } else {
-    column.reference(chunk.column(field().meta()->field_id()));
+    return RC::SUCCESS;
+  }
+  int index = chunk.column_index(field().meta()->field_id());
+  if (index < 0) {
+    LOG_WARN("no such column in chunk. field=%s.%s", table_name(), field_name());
+    return RC::NOTFOUND;
   }
+  column.reference(chunk.column(index));
   return RC::SUCCESS;
 }
 
@@ -108,6 +112,10 @@ RC CastExpr::get_column(Chunk &chunk, Column &column)
   }
   column.init(cast_type_, child_column.attr_len());
   for (int i = 0; i < child_column.count(); ++i) {
+    if (child_column.is_null(i)) {
+      column.append_null();
+      continue;
+    }
     Value value = child_column.get_value(i);
     Value cast_value;
     rc = cast(value, cast_value);
@@ -250,6 +258,10 @@ RC ComparisonExpr::eval(Chunk &chunk, vector<uint8_t> &select)
       rows = left_column.count();
     }
     for (int i = 0; i < rows; ++i) {
+      if (left_column.is_null(i) || right_column.is_null(i)) {
+        select[i] = 0;
+        continue;
+      }
       Value left_val = left_column.get_value(i);
       Value right_val = right_column.get_value(i);
       bool        result   = false;
@@ -284,6 +296,19 @@ RC ComparisonExpr::compare_column(const Column &left, const Column &right, vecto
   } else {
     compare_result<T, false, false>((T *)left.data(), (T *)right.data(), left.count(), result, comp_);
   }
+
+  // NULL 参与的比较结果都不为真
+  const int rows = left_const ? right.count() : left.count();
+  if (left_const) {
+    filter_nulls<true>(left.nulls(), rows, result);
+  } else {
+    filter_nulls<false>(left.nulls(), rows, result);
+  }
+  if (right_const) {
+    filter_nulls<true>(right.nulls(), rows, result);
+  } else {
+    filter_nulls<false>(right.nulls(), rows, result);
+  }
   return rc;
 }
 
@@ -396,47 +421,56 @@ RC ArithmeticExpr::execute_calc(
     const Column &left, const Column &right, Column &result, Type type, AttrType attr_type) const
 {
   RC rc = RC::SUCCESS;
+
+  // 任意一个输入为 NULL 时结果为 NULL
+  const uint8_t *nulls = nullptr;
+  if (left.has_nulls() || right.has_nulls()) {
+    uint8_t *result_nulls = result.mutable_nulls();
+    merge_nulls<LEFT_CONSTANT, RIGHT_CONSTANT>(left.nulls(), right.nulls(), result_nulls, result.capacity());
+    nulls = result_nulls;
+  }
+
   switch (type) {
     case Type::ADD: {
       if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, AddOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, int, AddOperator>(
+            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity(), nulls);
       } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, AddOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, float, AddOperator>(
+            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity(), nulls);
       } else {
         rc = RC::UNIMPLEMENTED;
       }
     } break;
     case Type::SUB:
       if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, SubtractOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, int, SubtractOperator>(
+            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity(), nulls);
       } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, SubtractOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, float, SubtractOperator>(
+            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity(), nulls);
       } else {
         rc = RC::UNIMPLEMENTED;
       }
       break;
     case Type::MUL:
       if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, MultiplyOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, int, MultiplyOperator>(
+            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity(), nulls);
       } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, MultiplyOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, float, MultiplyOperator>(
+            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity(), nulls);
       } else {
         rc = RC::UNIMPLEMENTED;
       }
       break;
     case Type::DIV:
       if (attr_type == AttrType::INTS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, int, DivideOperator>(
-            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, int, DivideOperator>(
+            (int *)left.data(), (int *)right.data(), (int *)result.data(), result.capacity(), nulls);
       } else if (attr_type == AttrType::FLOATS) {
-        binary_operator<LEFT_CONSTANT, RIGHT_CONSTANT, float, DivideOperator>(
-            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity());
+        binary_operator_with_nulls<LEFT_CONSTANT, RIGHT_CONSTANT, float, DivideOperator>(
+            (float *)left.data(), (float *)right.data(), (float *)result.data(), result.capacity(), nulls);
       } else {
         rc = RC::UNIMPLEMENTED;
       }
@@ -251,6 +251,7 @@ public:
 
   void         get_value(Value &value) const { value = value_; }
   const Value &get_value() const { return value_; }
+  Value       &mutable_value() { return value_; }
 
 private:
   Value value_;
@@ -0,0 +1,77 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/operator/physical_operator.h"
+#include "sql/query_cache/query_cache.h"
+
+/**
+ * @brief 返回查询缓存中的结果
+ * @ingroup PhysicalOperator
+ * @details 命中查询缓存时，用它代替原来的执行计划
+ */
+class CachedResultPhysicalOperator : public PhysicalOperator
+{
+public:
+  CachedResultPhysicalOperator(shared_ptr<const CachedResult> result) : result_(std::move(result))
+  {
+    vector<TupleCellSpec> specs;
+    for (int i = 0; i < result_->schema().cell_num(); i++) {
+      specs.push_back(result_->schema().cell_at(i));
+    }
+    tuple_.set_names(specs);
+  }
+
+  virtual ~CachedResultPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::CACHED_RESULT; }
+
+  RC open(Trx *) override
+  {
+    started_ = false;
+    index_   = 0;
+    return RC::SUCCESS;
+  }
+
+  RC next() override
+  {
+    if (!started_) {
+      started_ = true;
+    } else if (index_ < result_->rows().size()) {
+      index_++;
+    }
+    return index_ < result_->rows().size() ? RC::SUCCESS : RC::RECORD_EOF;
+  }
+
+  RC close() override { return RC::SUCCESS; }
+
+  Tuple *current_tuple() override
+  {
+    if (index_ >= result_->rows().size()) {
+      return nullptr;
+    }
+
+    tuple_.set_cells(result_->rows()[index_]);
+    return &tuple_;
+  }
+
+  RC tuple_schema(TupleSchema &schema) const override
+  {
+    schema = result_->schema();
+    return RC::SUCCESS;
+  }
+
+private:
+  shared_ptr<const CachedResult> result_;
+  bool                           started_ = false;
+  size_t                         index_   = 0;
+  ValueListTuple                 tuple_;
+};
@@ -49,6 +49,8 @@ RC ExprVecPhysicalOperator::next(Chunk &chunk)
       expressions_[i]->get_column(chunk_, *column);
       evaled_chunk_.add_column(std::move(column), i);
     }
+    // 表达式按列计算了所有的行，有效的行与下层算子的输出相同
+    evaled_chunk_.copy_selection(chunk_);
     chunk.reference(evaled_chunk_);
   }
   return rc;
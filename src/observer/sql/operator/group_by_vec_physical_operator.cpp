@@ -8,4 +8,136 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
-#include "sql/operator/group_by_vec_physical_operator.h"
\ No newline at end of file
+#include "common/log/log.h"
+#include "sql/operator/group_by_vec_physical_operator.h"
+
+using namespace common;
+
+GroupByVecPhysicalOperator::GroupByVecPhysicalOperator(
+    vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions)
+    : group_by_exprs_(std::move(group_by_exprs)), aggregate_expressions_(std::move(expressions))
+{
+  value_expressions_.reserve(aggregate_expressions_.size());
+  for (Expression *expr : aggregate_expressions_) {
+    ASSERT(expr->type() == ExprType::AGGREGATION, "expected an aggregation expression");
+    auto       *aggregate_expr = static_cast<AggregateExpr *>(expr);
+    Expression *child_expr     = aggregate_expr->child().get();
+    ASSERT(child_expr != nullptr, "aggregation expression must have a child expression");
+    value_expressions_.emplace_back(child_expr);
+  }
+
+  // 输出的列先是分组列，再是聚合列
+  int col_id = 0;
+  for (auto &expr : group_by_exprs_) {
+    output_chunk_.add_column(make_unique<Column>(expr->value_type(), expr->value_length()), col_id++);
+  }
+  for (Expression *expr : aggregate_expressions_) {
+    output_chunk_.add_column(make_unique<Column>(expr->value_type(), expr->value_length()), col_id++);
+  }
+
+#ifdef USE_SIMD
+  if (use_linear_probing()) {
+    auto *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[0]);
+    if (value_expressions_[0]->value_type() == AttrType::INTS) {
+      hash_table_ = make_unique<LinearProbingAggregateHashTable<int>>(aggregate_expr->aggregate_type());
+      scanner_    = make_unique<LinearProbingAggregateHashTable<int>::Scanner>(hash_table_.get());
+    } else {
+      hash_table_ = make_unique<LinearProbingAggregateHashTable<float>>(aggregate_expr->aggregate_type());
+      scanner_    = make_unique<LinearProbingAggregateHashTable<float>::Scanner>(hash_table_.get());
+    }
+  }
+#endif
+  if (hash_table_ == nullptr) {
+    hash_table_ = make_unique<StandardAggregateHashTable>(aggregate_expressions_);
+    scanner_    = make_unique<StandardAggregateHashTable::Scanner>(hash_table_.get());
+  }
+}
+
+bool GroupByVecPhysicalOperator::use_linear_probing() const
+{
+#ifdef USE_SIMD
+  // 线性探测哈希表直接读取列的内存，所以列不能是常量列
+  if (group_by_exprs_.size() != 1 || aggregate_expressions_.size() != 1) {
+    return false;
+  }
+  const Expression *group_by_expr  = group_by_exprs_[0].get();
+  auto             *aggregate_expr = static_cast<AggregateExpr *>(aggregate_expressions_[0]);
+  const Expression *value_expr     = value_expressions_[0];
+  return group_by_expr->type() == ExprType::FIELD && group_by_expr->value_type() == AttrType::INTS &&
+         aggregate_expr->aggregate_type() == AggregateExpr::Type::SUM && value_expr->type() == ExprType::FIELD &&
+         (value_expr->value_type() == AttrType::INTS || value_expr->value_type() == AttrType::FLOATS);
+#else
+  return false;
+#endif
+}
+
+RC GroupByVecPhysicalOperator::open(Trx *trx)
+{
+  ASSERT(children_.size() == 1, "group by operator only support one child, but got %d", children_.size());
+
+  PhysicalOperator &child = *children_[0];
+  RC                rc    = child.open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_INFO("failed to open child operator. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  while (OB_SUCC(rc = child.next(chunk_))) {
+    Chunk groups_chunk;
+    Chunk aggrs_chunk;
+    for (size_t i = 0; i < group_by_exprs_.size(); i++) {
+      auto column = make_unique<Column>();
+      rc          = group_by_exprs_[i]->get_column(chunk_, *column);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get column of group by expression. rc=%s", strrc(rc));
+        return rc;
+      }
+      groups_chunk.add_column(std::move(column), i);
+    }
+    for (size_t i = 0; i < value_expressions_.size(); i++) {
+      auto column = make_unique<Column>();
+      rc          = value_expressions_[i]->get_column(chunk_, *column);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get column of aggregate expression. rc=%s", strrc(rc));
+        return rc;
+      }
+      aggrs_chunk.add_column(std::move(column), i);
+    }
+    groups_chunk.copy_selection(chunk_);
+
+    rc = hash_table_->add_chunk(groups_chunk, aggrs_chunk);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to add chunk into aggregate hash table. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  if (rc == RC::RECORD_EOF) {
+    rc = RC::SUCCESS;
+  }
+  if (OB_SUCC(rc)) {
+    scanner_->open_scan();
+  }
+  return rc;
+}
+
+RC GroupByVecPhysicalOperator::next(Chunk &chunk)
+{
+  output_chunk_.reset_data();
+  RC rc = scanner_->next(output_chunk_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  if (output_chunk_.rows() == 0) {
+    return RC::RECORD_EOF;
+  }
+  return chunk.reference(output_chunk_);
+}
+
+RC GroupByVecPhysicalOperator::close()
+{
+  scanner_->close_scan();
+  children_[0]->close();
+  LOG_INFO("close group by(vec) operator");
+  return RC::SUCCESS;
+}
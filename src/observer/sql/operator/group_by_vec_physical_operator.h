@@ -16,19 +16,38 @@ See the Mulan PSL v2 for more details. */
 /**
  * @brief Group By 物理算子(vectorized)
  * @ingroup PhysicalOperator
+ * @details open 时消费下层算子的所有 chunk，计算分组列和聚合列后写入哈希表，next 时从哈希表中按 chunk 输出结果。
+ * 输出 chunk 中先是分组列，再是聚合列，与 LogicalPlanGenerator 中为表达式设置的 pos 一致。
+ * 只有一个 int 分组列和一个 sum 聚合时使用 LinearProbingAggregateHashTable（需要开启 USE_SIMD），
+ * 其它情况使用 StandardAggregateHashTable。
  */
 class GroupByVecPhysicalOperator : public PhysicalOperator
 {
 public:
-  GroupByVecPhysicalOperator(vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions){};
+  GroupByVecPhysicalOperator(vector<unique_ptr<Expression>> &&group_by_exprs, vector<Expression *> &&expressions);
 
   virtual ~GroupByVecPhysicalOperator() = default;
 
   PhysicalOperatorType type() const override { return PhysicalOperatorType::GROUP_BY_VEC; }
 
-  RC open(Trx *trx) override { return RC::UNIMPLEMENTED; }
-  RC next(Chunk &chunk) override { return RC::UNIMPLEMENTED; }
-  RC close() override { return RC::UNIMPLEMENTED; }
+  RC open(Trx *trx) override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
 
 private:
+  /**
+   * @brief 是否可以使用线性探测哈希表
+   */
+  bool use_linear_probing() const;
+
+private:
+  vector<unique_ptr<Expression>> group_by_exprs_;
+  vector<Expression *>           aggregate_expressions_;  /// 聚合表达式
+  vector<Expression *>           value_expressions_;      /// 聚合表达式的子表达式
+
+  unique_ptr<AggregateHashTable>          hash_table_;
+  unique_ptr<AggregateHashTable::Scanner> scanner_;
+
+  Chunk chunk_;
+  Chunk output_chunk_;
 };
@@ -8,4 +8,604 @@ EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
 MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
+#include <unistd.h>
+
 #include "sql/operator/hash_join_physical_operator.h"
+#include "common/lang/atomic.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/string_view.h"
+#include "common/log/log.h"
+
+static string make_spill_file_name(const string &directory)
+{
+  static atomic<uint64_t> sequence{0};
+
+  filesystem::path dir  = directory.empty() ? filesystem::temp_directory_path() : filesystem::path(directory);
+  string           name = "hash_join_" + std::to_string(getpid()) + "_" + std::to_string(sequence.fetch_add(1)) + ".spill";
+  return (dir / name).string();
+}
+
+HashJoinPhysicalOperator::HashJoinPhysicalOperator(
+    vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys, bool build_left)
+    : left_keys_(std::move(left_keys)), right_keys_(std::move(right_keys)), build_left_(build_left)
+{
+  ASSERT(left_keys_.size() == right_keys_.size(), "hash join keys should be paired");
+}
+
+double HashJoinPhysicalOperator::calculate_cost(
+    LogicalProperty *prop, const vector<LogicalProperty *> &child_log_props, CostModel *cm)
+{
+  if (child_log_props.size() != 2) {
+    return 0.0;
+  }
+
+  int build_card = child_log_props[build_left_ ? 0 : 1]->get_card();
+  int probe_card = child_log_props[build_left_ ? 1 : 0]->get_card();
+  return build_card * cm->hash_cost() + probe_card * cm->hash_probe() + prop->get_card() * cm->cpu_op();
+}
+
+RC HashJoinPhysicalOperator::open(Trx *trx)
+{
+  if (children_.size() != 2) {
+    LOG_WARN("hash join operator should have 2 children");
+    return RC::INTERNAL;
+  }
+
+  build_oper_ = children_[build_left_ ? 0 : 1].get();
+  probe_oper_ = children_[build_left_ ? 1 : 0].get();
+  spilled_    = false;
+
+  RC rc = build_oper_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open build side of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc = build();
+  RC close_rc = build_oper_->close();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to build hash table. rc=%s", strrc(rc));
+    return rc;
+  }
+  if (OB_FAIL(close_rc)) {
+    LOG_WARN("failed to close build side of hash join. rc=%s", strrc(close_rc));
+    return close_rc;
+  }
+
+  rc = probe_oper_->open(trx);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to open probe side of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+  probe_opened_ = true;
+
+  build_tuple_.set_names(build_specs_);
+  matched_rows_ = nullptr;
+  matched_pos_  = 0;
+
+  if (!spilled_) {
+    LOG_TRACE("hash join build done. build rows=%lu, distinct keys=%lu", build_rows_.size(), hash_table_.size());
+    return RC::SUCCESS;
+  }
+
+  // build 端已经落盘，probe 端也需要按照同样的方式分区
+  rc = spill_probe();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to spill probe side of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  rc            = probe_oper_->close();
+  probe_opened_ = false;
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to close probe side of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  probe_tuple_.set_names(probe_specs_);
+  pending_partitions_ = std::move(spill_partitions_);
+  spill_partitions_.clear();
+
+  rc = load_next_partition();
+  if (OB_FAIL(rc) && rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to load the first partition of hash join. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::build()
+{
+  const vector<unique_ptr<Expression>> &build_keys = build_left_ ? left_keys_ : right_keys_;
+
+  RC            rc = RC::SUCCESS;
+  vector<Value> keys;
+  vector<Value> row;
+  while (OB_SUCC(rc = build_oper_->next())) {
+    Tuple *tuple = build_oper_->current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get tuple from build side");
+      return RC::INTERNAL;
+    }
+
+    rc = eval_keys(build_keys, *tuple, keys);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    rc = materialize(*tuple, row, build_specs_.empty() ? &build_specs_ : nullptr);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (spilled_) {
+      rc = write_spill_row(*spill_partitions_[partition_of(keys, 0)].build_file, keys, row);
+    } else {
+      rc = add_build_row(keys, std::move(row));
+      if (OB_SUCC(rc) && memory_usage_ > memory_budget_) {
+        rc = start_spill();
+      }
+    }
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch tuple from build side. rc=%s", strrc(rc));
+    return rc;
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::add_build_row(vector<Value> &keys, vector<Value> &&row)
+{
+  memory_usage_ += row_memory(keys, row);
+  hash_table_[keys].push_back(build_rows_.size());
+  build_rows_.emplace_back(std::move(row));
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::materialize(Tuple &tuple, vector<Value> &row, vector<TupleCellSpec> *specs)
+{
+  const int cell_num = tuple.cell_num();
+  row.resize(cell_num);
+  for (int i = 0; i < cell_num; i++) {
+    RC rc = tuple.cell_at(i, row[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get cell from tuple. index=%d, rc=%s", i, strrc(rc));
+      return rc;
+    }
+  }
+
+  if (specs != nullptr) {
+    specs->resize(cell_num);
+    for (int i = 0; i < cell_num; i++) {
+      RC rc = tuple.spec_at(i, (*specs)[i]);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get spec from tuple. index=%d, rc=%s", i, strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::next()
+{
+  const vector<unique_ptr<Expression>> &probe_keys = build_left_ ? right_keys_ : left_keys_;
+
+  while (true) {
+    if (matched_rows_ != nullptr && matched_pos_ < matched_rows_->size()) {
+      build_tuple_.set_cells(build_rows_[(*matched_rows_)[matched_pos_]]);
+      matched_pos_++;
+      return RC::SUCCESS;
+    }
+
+    matched_rows_ = nullptr;
+
+    RC     rc          = RC::SUCCESS;
+    Tuple *probe_tuple = nullptr;
+    if (spilled_) {
+      rc = next_spilled_probe_row(probe_tuple);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    } else {
+      if (hash_table_.empty()) {
+        return RC::RECORD_EOF;
+      }
+
+      rc = probe_oper_->next();
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+
+      probe_tuple = probe_oper_->current_tuple();
+      if (nullptr == probe_tuple) {
+        LOG_WARN("failed to get tuple from probe side");
+        return RC::INTERNAL;
+      }
+
+      rc = eval_keys(probe_keys, *probe_tuple, probe_keys_);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+
+    auto iter = hash_table_.find(probe_keys_);
+    if (iter == hash_table_.end()) {
+      continue;
+    }
+
+    matched_rows_ = &iter->second;
+    matched_pos_  = 0;
+    if (build_left_) {
+      joined_tuple_.set_left(&build_tuple_);
+      joined_tuple_.set_right(probe_tuple);
+    } else {
+      joined_tuple_.set_left(probe_tuple);
+      joined_tuple_.set_right(&build_tuple_);
+    }
+  }
+}
+
+RC HashJoinPhysicalOperator::close()
+{
+  RC rc = RC::SUCCESS;
+  if (probe_opened_) {
+    rc = probe_oper_->close();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to close probe side of hash join. rc=%s", strrc(rc));
+    }
+    probe_opened_ = false;
+  }
+
+  clear_hash_table();
+  build_specs_.clear();
+  probe_specs_.clear();
+
+  // 分区文件在析构时删除
+  spill_partitions_.clear();
+  pending_partitions_.clear();
+  current_partition_ = SpillPartition();
+  return rc;
+}
+
+Tuple *HashJoinPhysicalOperator::current_tuple() { return &joined_tuple_; }
+
+void HashJoinPhysicalOperator::collect_constants(vector<Value *> &constants)
+{
+  for (const vector<unique_ptr<Expression>> *keys : {&left_keys_, &right_keys_}) {
+    for (const unique_ptr<Expression> &key : *keys) {
+      collect_expression_constants(*key, constants);
+    }
+  }
+}
+
+RC HashJoinPhysicalOperator::start_spill()
+{
+  LOG_INFO("hash join memory usage exceeds the budget, spill to disk. usage=%ld, budget=%ld, build rows=%lu",
+           memory_usage_, memory_budget_, build_rows_.size());
+
+  spilled_ = true;
+  RC rc    = create_partitions(0, spill_partitions_);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  for (const auto &[keys, row_indexes] : hash_table_) {
+    SpillFile &file = *spill_partitions_[partition_of(keys, 0)].build_file;
+    for (size_t row_index : row_indexes) {
+      rc = write_spill_row(file, keys, build_rows_[row_index]);
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+  }
+
+  clear_hash_table();
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::spill_probe()
+{
+  const vector<unique_ptr<Expression>> &probe_keys = build_left_ ? right_keys_ : left_keys_;
+
+  RC rc = RC::SUCCESS;
+  while (OB_SUCC(rc = probe_oper_->next())) {
+    Tuple *tuple = probe_oper_->current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get tuple from probe side");
+      return RC::INTERNAL;
+    }
+
+    rc = eval_keys(probe_keys, *tuple, probe_keys_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    // 对应的 build 分区没有数据时，这一行不可能匹配上
+    SpillPartition &partition = spill_partitions_[partition_of(probe_keys_, 0)];
+    if (partition.build_file->row_count() == 0) {
+      continue;
+    }
+
+    rc = materialize(*tuple, probe_row_, probe_specs_.empty() ? &probe_specs_ : nullptr);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    rc = write_spill_row(*partition.probe_file, probe_keys_, probe_row_);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to fetch tuple from probe side. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  return finish_partitions(spill_partitions_);
+}
+
+RC HashJoinPhysicalOperator::create_partitions(int depth, vector<SpillPartition> &partitions)
+{
+  partitions.clear();
+  partitions.resize(SPILL_PARTITION_NUM);
+  for (SpillPartition &partition : partitions) {
+    partition.depth      = depth;
+    partition.build_file = make_unique<SpillFile>();
+    partition.probe_file = make_unique<SpillFile>();
+
+    RC rc = partition.build_file->create(make_spill_file_name(spill_directory_));
+    if (OB_SUCC(rc)) {
+      rc = partition.probe_file->create(make_spill_file_name(spill_directory_));
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create spill partition of hash join. depth=%d, rc=%s", depth, strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::finish_partitions(vector<SpillPartition> &partitions)
+{
+  for (SpillPartition &partition : partitions) {
+    RC rc = partition.build_file->finish_write();
+    if (OB_SUCC(rc)) {
+      rc = partition.probe_file->finish_write();
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to flush spill partition of hash join. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+size_t HashJoinPhysicalOperator::partition_of(const vector<Value> &keys, int depth) const
+{
+  // 每一层使用不同的种子，并且再混合一次，避免和哈希表中桶的分布相关
+  uint64_t hash_val = KeyHash()(keys) ^ (static_cast<uint64_t>(depth + 1) * 0x9e3779b97f4a7c15ULL);
+  hash_val ^= hash_val >> 33;
+  hash_val *= 0xff51afd7ed558ccdULL;
+  hash_val ^= hash_val >> 33;
+  return hash_val % SPILL_PARTITION_NUM;
+}
+
+RC HashJoinPhysicalOperator::write_spill_row(SpillFile &file, const vector<Value> &keys, const vector<Value> &row)
+{
+  vector<Value> spill_row;
+  spill_row.reserve(keys.size() + row.size());
+  spill_row.insert(spill_row.end(), keys.begin(), keys.end());
+  spill_row.insert(spill_row.end(), row.begin(), row.end());
+  return file.write_row(spill_row);
+}
+
+void HashJoinPhysicalOperator::split_spill_row(vector<Value> &spill_row, vector<Value> &keys, vector<Value> &row) const
+{
+  const size_t key_num = left_keys_.size();
+  keys.assign(std::make_move_iterator(spill_row.begin()), std::make_move_iterator(spill_row.begin() + key_num));
+  row.assign(std::make_move_iterator(spill_row.begin() + key_num), std::make_move_iterator(spill_row.end()));
+}
+
+RC HashJoinPhysicalOperator::repartition(SpillPartition &partition)
+{
+  vector<SpillPartition> sub_partitions;
+  RC                     rc = create_partitions(partition.depth + 1, sub_partitions);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  vector<Value> keys;
+  vector<Value> row;
+  while (OB_SUCC(rc = partition.build_file->read_row(spill_row_))) {
+    split_spill_row(spill_row_, keys, row);
+    rc = write_spill_row(*sub_partitions[partition_of(keys, partition.depth + 1)].build_file, keys, row);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    return rc;
+  }
+
+  while (OB_SUCC(rc = partition.probe_file->read_row(spill_row_))) {
+    split_spill_row(spill_row_, keys, row);
+    SpillPartition &sub_partition = sub_partitions[partition_of(keys, partition.depth + 1)];
+    if (sub_partition.build_file->row_count() == 0) {
+      continue;
+    }
+    rc = write_spill_row(*sub_partition.probe_file, keys, row);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  if (rc != RC::RECORD_EOF) {
+    return rc;
+  }
+
+  rc = finish_partitions(sub_partitions);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  LOG_TRACE("hash join repartition done. depth=%d, build rows=%ld, probe rows=%ld",
+            partition.depth + 1, partition.build_file->row_count(), partition.probe_file->row_count());
+  partition.build_file->close();
+  partition.probe_file->close();
+  for (SpillPartition &sub_partition : sub_partitions) {
+    pending_partitions_.emplace_back(std::move(sub_partition));
+  }
+  return RC::SUCCESS;
+}
+
+RC HashJoinPhysicalOperator::load_next_partition()
+{
+  clear_hash_table();
+  current_partition_ = SpillPartition();
+
+  RC            rc = RC::SUCCESS;
+  vector<Value> keys;
+  vector<Value> row;
+  while (!pending_partitions_.empty()) {
+    SpillPartition partition = std::move(pending_partitions_.back());
+    pending_partitions_.pop_back();
+    if (partition.build_file->row_count() == 0 || partition.probe_file->row_count() == 0) {
+      continue;
+    }
+
+    bool need_repartition = false;
+    while (OB_SUCC(rc = partition.build_file->read_row(spill_row_))) {
+      split_spill_row(spill_row_, keys, row);
+      rc = add_build_row(keys, std::move(row));
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+
+      if (memory_usage_ > memory_budget_ && partition.depth < MAX_SPILL_DEPTH) {
+        need_repartition = true;
+        break;
+      }
+    }
+    if (OB_FAIL(rc) && rc != RC::RECORD_EOF) {
+      LOG_WARN("failed to load spill partition of hash join. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    if (need_repartition) {
+      // 这个分区仍然放不下，从头读一遍，拆分成更小的分区
+      clear_hash_table();
+      rc = partition.build_file->finish_write();
+      if (OB_SUCC(rc)) {
+        rc = repartition(partition);
+      }
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to repartition hash join partition. depth=%d, rc=%s", partition.depth, strrc(rc));
+        return rc;
+      }
+      continue;
+    }
+
+    if (memory_usage_ > memory_budget_) {
+      LOG_WARN("hash join partition exceeds memory budget after %d repartitions. usage=%ld, budget=%ld",
+               MAX_SPILL_DEPTH, memory_usage_, memory_budget_);
+    }
+    current_partition_ = std::move(partition);
+    return RC::SUCCESS;
+  }
+  return RC::RECORD_EOF;
+}
+
+RC HashJoinPhysicalOperator::next_spilled_probe_row(Tuple *&probe_tuple)
+{
+  while (true) {
+    if (current_partition_.probe_file) {
+      RC rc = current_partition_.probe_file->read_row(spill_row_);
+      if (OB_SUCC(rc)) {
+        split_spill_row(spill_row_, probe_keys_, probe_row_);
+        probe_tuple_.set_cells(probe_row_);
+        probe_tuple = &probe_tuple_;
+        return RC::SUCCESS;
+      }
+      if (rc != RC::RECORD_EOF) {
+        LOG_WARN("failed to read probe row from spill partition. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+
+    RC rc = load_next_partition();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+}
+
+void HashJoinPhysicalOperator::clear_hash_table()
+{
+  hash_table_.clear();
+  build_rows_.clear();
+  matched_rows_ = nullptr;
+  matched_pos_  = 0;
+  memory_usage_ = 0;
+}
+
+int64_t HashJoinPhysicalOperator::row_memory(const vector<Value> &keys, const vector<Value> &row) const
+{
+  // 粗略估算：行本身、哈希表中的键和下标，以及哈希表节点的开销
+  int64_t size = 2 * sizeof(vector<Value>) + (keys.size() + row.size()) * sizeof(Value) + sizeof(size_t) + 32;
+  for (const vector<Value> *values : {&keys, &row}) {
+    for (const Value &value : *values) {
+      if (value.attr_type() == AttrType::CHARS) {
+        size += value.length();
+      }
+    }
+  }
+  return size;
+}
+
+RC HashJoinPhysicalOperator::eval_keys(
+    const vector<unique_ptr<Expression>> &key_exprs, const Tuple &tuple, vector<Value> &keys)
+{
+  keys.resize(key_exprs.size());
+  for (size_t i = 0; i < key_exprs.size(); i++) {
+    RC rc = key_exprs[i]->get_value(tuple, keys[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to evaluate hash join key. index=%lu, rc=%s", i, strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+size_t HashJoinPhysicalOperator::KeyHash::operator()(const vector<Value> &keys) const
+{
+  size_t hash_val = 0;
+  for (const Value &value : keys) {
+    size_t value_hash = 0;
+    switch (value.attr_type()) {
+      case AttrType::CHARS: value_hash = std::hash<string>()(value.get_string()); break;
+      case AttrType::FLOATS: value_hash = std::hash<float>()(value.get_float()); break;
+      case AttrType::BOOLEANS: value_hash = std::hash<bool>()(value.get_boolean()); break;
+      default: value_hash = std::hash<string_view>()(string_view(value.data(), value.length())); break;
+    }
+    hash_val ^= value_hash + 0x9e3779b9 + (hash_val << 6) + (hash_val >> 2);
+  }
+  return hash_val;
+}
+
+bool HashJoinPhysicalOperator::KeyEqual::operator()(const vector<Value> &lhs, const vector<Value> &rhs) const
+{
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].compare(rhs[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -10,12 +10,161 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/unordered_map.h"
+#include "sql/expr/expression.h"
 #include "sql/operator/physical_operator.h"
+#include "sql/operator/spill_file.h"
 #include "sql/parser/parse.h"
 
 /**
  * @brief Hash Join 算子
  * @ingroup PhysicalOperator
+ * @details 等值连接。先把 build 端的所有数据读出来，按照连接键放到哈希表中，
+ * 然后遍历 probe 端的每一行，在哈希表中查找匹配的行。
+ * 不管哪一端作为 build 端，输出的 tuple 都是左表在前、右表在后。
+ * 支持多个等值连接条件，left_keys_[i] = right_keys_[i]。
+ *
+ * 如果 build 端的数据超过了内存上限，会退化成 grace hash join：把 build 端和 probe 端
+ * 都按照连接键的哈希值分区写到临时文件中，然后逐个分区做内存中的 hash join。
+ * 如果某个分区仍然超过内存上限，会换一个哈希种子继续分区，最多分 MAX_SPILL_DEPTH 层。
  */
-class HashJoinPhysicalOperator
-{};
\ No newline at end of file
+class HashJoinPhysicalOperator : public PhysicalOperator
+{
+public:
+  /**
+   * @param left_keys  左孩子上计算的连接键
+   * @param right_keys 右孩子上计算的连接键，与 left_keys 一一对应
+   * @param build_left 是否使用左孩子作为 build 端
+   */
+  HashJoinPhysicalOperator(
+      vector<unique_ptr<Expression>> &&left_keys, vector<unique_ptr<Expression>> &&right_keys, bool build_left);
+  virtual ~HashJoinPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::HASH_JOIN; }
+
+  OpType get_op_type() const override { return OpType::INNERHASHJOIN; }
+
+  uint64_t hash() const override { return OperatorNode::hash() ^ std::hash<bool>()(build_left_); }
+
+  bool operator==(const OperatorNode &other) const override
+  {
+    if (!OperatorNode::operator==(other)) {
+      return false;
+    }
+    const auto &other_join = static_cast<const HashJoinPhysicalOperator &>(other);
+    return build_left_ == other_join.build_left_;
+  }
+
+  double calculate_cost(LogicalProperty *prop, const vector<LogicalProperty *> &child_log_props, CostModel *cm) override;
+
+  string param() const override { return build_left_ ? "build=left" : "build=right"; }
+
+  RC     open(Trx *trx) override;
+  RC     next() override;
+  RC     close() override;
+  Tuple *current_tuple() override;
+
+  bool build_left() const { return build_left_; }
+
+  void collect_constants(vector<Value *> &constants) override;
+
+  /// 设置哈希表可以使用的内存，单位字节
+  void    set_memory_budget(int64_t memory_budget) { memory_budget_ = memory_budget; }
+  int64_t memory_budget() const { return memory_budget_; }
+
+  /// 设置落盘时临时文件存放的目录，为空时使用系统临时目录
+  void set_spill_directory(const string &spill_directory) { spill_directory_ = spill_directory; }
+
+  /// 最近一次执行是否落盘了
+  bool spilled() const { return spilled_; }
+
+  static constexpr int64_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+private:
+  /// 连接键的哈希函数，同样的值一定要有同样的哈希值
+  struct KeyHash
+  {
+    size_t operator()(const vector<Value> &keys) const;
+  };
+
+  struct KeyEqual
+  {
+    bool operator()(const vector<Value> &lhs, const vector<Value> &rhs) const;
+  };
+
+  /// 连接键 -> build 端匹配行在 build_rows_ 中的下标
+  using HashTable = unordered_map<vector<Value>, vector<size_t>, KeyHash, KeyEqual>;
+
+  /**
+   * @brief 落盘的一个分区
+   * @details 文件中的每一行都是连接键在前，原始数据在后
+   */
+  struct SpillPartition
+  {
+    unique_ptr<SpillFile> build_file;
+    unique_ptr<SpillFile> probe_file;
+    int                   depth = 0;  ///< 第几层分区，决定使用的哈希种子
+  };
+
+  static constexpr int SPILL_PARTITION_NUM = 16;
+  static constexpr int MAX_SPILL_DEPTH     = 3;
+
+private:
+  RC build();
+  RC add_build_row(vector<Value> &keys, vector<Value> &&row);
+  RC eval_keys(const vector<unique_ptr<Expression>> &key_exprs, const Tuple &tuple, vector<Value> &keys);
+  RC materialize(Tuple &tuple, vector<Value> &row, vector<TupleCellSpec> *specs);
+
+  RC     create_partitions(int depth, vector<SpillPartition> &partitions);
+  RC     finish_partitions(vector<SpillPartition> &partitions);
+  size_t partition_of(const vector<Value> &keys, int depth) const;
+  RC     write_spill_row(SpillFile &file, const vector<Value> &keys, const vector<Value> &row);
+  void   split_spill_row(vector<Value> &spill_row, vector<Value> &keys, vector<Value> &row) const;
+
+  /// build 端超过内存上限时，把已经放到哈希表中的数据写到分区文件中
+  RC start_spill();
+  /// 把 probe 端的数据全部读出来写到分区文件中
+  RC spill_probe();
+  /// 把一个分区重新划分成更小的分区
+  RC repartition(SpillPartition &partition);
+  /// 加载下一个分区的 build 数据到哈希表中，没有分区时返回 RECORD_EOF
+  RC load_next_partition();
+  /// 从当前分区的 probe 文件中读取下一行
+  RC next_spilled_probe_row(Tuple *&probe_tuple);
+
+  void    clear_hash_table();
+  int64_t row_memory(const vector<Value> &keys, const vector<Value> &row) const;
+
+private:
+  vector<unique_ptr<Expression>> left_keys_;
+  vector<unique_ptr<Expression>> right_keys_;
+  bool                           build_left_ = false;
+
+  PhysicalOperator *build_oper_  = nullptr;
+  PhysicalOperator *probe_oper_  = nullptr;
+  bool              probe_opened_ = false;
+
+  vector<TupleCellSpec> build_specs_;  ///< build 端所有行共用的列描述
+  vector<vector<Value>> build_rows_;   ///< build 端物化出来的数据
+  HashTable             hash_table_;
+
+  const vector<size_t> *matched_rows_ = nullptr;  ///< 当前 probe 行在哈希表中匹配到的行
+  size_t                matched_pos_  = 0;
+
+  vector<Value>  probe_keys_;
+  ValueListTuple build_tuple_;
+  JoinedTuple    joined_tuple_;
+
+  int64_t memory_budget_ = DEFAULT_MEMORY_BUDGET;
+  int64_t memory_usage_  = 0;  ///< 当前哈希表估算占用的内存
+  string  spill_directory_;
+
+  bool                   spilled_ = false;
+  vector<SpillPartition> spill_partitions_;   ///< build 阶段正在写入的分区
+  vector<SpillPartition> pending_partitions_;  ///< 还没有处理的分区
+  SpillPartition         current_partition_;   ///< 正在 probe 的分区
+  vector<TupleCellSpec>  probe_specs_;
+  vector<Value>          spill_row_;
+  vector<Value>          probe_row_;
+  ValueListTuple         probe_tuple_;  ///< 从分区文件中读出来的 probe 行
+};
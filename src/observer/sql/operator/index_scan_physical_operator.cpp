@@ -114,6 +114,15 @@ void IndexScanPhysicalOperator::set_predicates(vector<unique_ptr<Expression>> &&
   predicates_ = std::move(exprs);
 }
 
+void IndexScanPhysicalOperator::collect_constants(vector<Value *> &constants)
+{
+  constants.push_back(&left_value_);
+  constants.push_back(&right_value_);
+  for (unique_ptr<Expression> &expr : predicates_) {
+    collect_expression_constants(*expr, constants);
+  }
+}
+
 RC IndexScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
 {
   RC    rc = RC::SUCCESS;
@@ -42,6 +42,9 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  void collect_constants(vector<Value *> &constants) override;
+  void collect_tables(vector<Table *> &tables) override { tables.push_back(table_); }
+
 private:
   // 与TableScanPhysicalOperator代码相同，可以优化
   RC filter(RowTuple &tuple, bool &result);
@@ -53,7 +53,8 @@ public:
 
     LogicalProperty *left_log_prop  = log_props[0];
     LogicalProperty *right_log_prop = log_props[1];
-    int              card           = left_log_prop->get_card() * right_log_prop->get_card();
+    // 两表行数相乘可能超出 int 的范围
+    int64_t          card           = static_cast<int64_t>(left_log_prop->get_card()) * right_log_prop->get_card();
     for (auto &predicate : join_predicates_) {
       if (predicate->type() != ExprType::COMPARISON) {
         continue;
@@ -66,7 +67,7 @@ public:
         card /= std::max(std::max(left_log_prop->get_card(), right_log_prop->get_card()), 1);
       }
     }
-    return make_unique<LogicalProperty>(card);
+    return make_unique<LogicalProperty>(static_cast<int>(std::min<int64_t>(card, INT32_MAX)));
   }
 
 private:
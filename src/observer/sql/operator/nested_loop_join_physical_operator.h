@@ -35,7 +35,13 @@ public:
   virtual double calculate_cost(
       LogicalProperty *prop, const vector<LogicalProperty *> &child_log_props, CostModel *cm) override
   {
-    return 0.0;
+    if (child_log_props.size() != 2) {
+      return 0.0;
+    }
+    // 右表对左表的每一行都要完整地扫描一遍
+    double left_card  = child_log_props[0]->get_card();
+    double right_card = child_log_props[1]->get_card();
+    return left_card * right_card * cm->cpu_op() + left_card * right_card * cm->io();
   }
 
   RC     open(Trx *trx) override;
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "sql/operator/physical_operator.h"
+#include "sql/expr/expression_iterator.h"
 
 string physical_operator_type_name(PhysicalOperatorType type)
 {
@@ -35,6 +36,7 @@ string physical_operator_type_name(PhysicalOperatorType type)
     case PhysicalOperatorType::PROJECT_VEC: return "PROJECT_VEC";
     case PhysicalOperatorType::TABLE_SCAN_VEC: return "TABLE_SCAN_VEC";
     case PhysicalOperatorType::EXPR_VEC: return "EXPR_VEC";
+    case PhysicalOperatorType::CACHED_RESULT: return "CACHED_RESULT";
     default: return "UNKNOWN";
   }
 }
@@ -42,3 +44,16 @@ string physical_operator_type_name(PhysicalOperatorType type)
 string PhysicalOperator::name() const { return physical_operator_type_name(type()); }
 
 string PhysicalOperator::param() const { return ""; }
+
+void PhysicalOperator::collect_expression_constants(Expression &expr, vector<Value *> &constants)
+{
+  if (expr.type() == ExprType::VALUE) {
+    constants.push_back(&static_cast<ValueExpr &>(expr).mutable_value());
+    return;
+  }
+
+  ExpressionIterator::iterate_child_expr(expr, [&constants](unique_ptr<Expression> &child) {
+    collect_expression_constants(*child, constants);
+    return RC::SUCCESS;
+  });
+}
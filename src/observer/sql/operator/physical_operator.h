@@ -18,7 +18,9 @@ See the Mulan PSL v2 for more details. */
 #include "sql/expr/tuple.h"
 #include "sql/operator/operator_node.h"
 
+class Expression;
 class Record;
+class Table;
 class TupleCellSpec;
 class Trx;
 
@@ -54,6 +56,7 @@ enum class PhysicalOperatorType
   GROUP_BY_VEC,
   AGGREGATE_VEC,
   EXPR_VEC,
+  CACHED_RESULT,
 };
 
 /**
@@ -87,10 +90,26 @@ public:
 
   virtual RC tuple_schema(TupleSchema &schema) const { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 收集当前算子（不包括孩子）使用的常量
+   * @details 计划缓存复用执行计划时，会原地修改这些常量，换成新 SQL 中的参数
+   */
+  virtual void collect_constants(vector<Value *> &constants) {}
+
+  /**
+   * @brief 收集当前算子（不包括孩子）读取的表
+   * @details 查询缓存根据这些表的修改版本号判断缓存的结果是否失效
+   */
+  virtual void collect_tables(vector<Table *> &tables) {}
+
   void add_child(unique_ptr<PhysicalOperator> oper) { children_.emplace_back(std::move(oper)); }
 
   vector<unique_ptr<PhysicalOperator>> &children() { return children_; }
 
+protected:
+  /// 收集表达式中所有 ValueExpr 的常量
+  static void collect_expression_constants(Expression &expr, vector<Value *> &constants);
+
 protected:
   vector<unique_ptr<PhysicalOperator>> children_;
 };
@@ -41,6 +41,8 @@ public:
 
   RC tuple_schema(TupleSchema &schema) const override;
 
+  void collect_constants(vector<Value *> &constants) override { collect_expression_constants(*expression_, constants); }
+
 private:
   unique_ptr<Expression> expression_;
 };
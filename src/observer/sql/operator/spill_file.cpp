@@ -0,0 +1,187 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include "sql/operator/spill_file.h"
+#include "common/log/log.h"
+
+SpillFile::~SpillFile() { close(); }
+
+RC SpillFile::create(const string &file_name)
+{
+  RC rc = handler_.create_file(file_name.c_str());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create spill file. file=%s, rc=%s", file_name.c_str(), strrc(rc));
+    return rc;
+  }
+
+  file_name_ = file_name;
+  created_   = true;
+  return RC::SUCCESS;
+}
+
+RC SpillFile::write_row(const vector<Value> &row)
+{
+  common::Serializer row_buffer;
+  row_buffer.write_int32(static_cast<int32_t>(row.size()));
+  for (const Value &value : row) {
+    if (value.attr_type() == AttrType::UNDEFINED || value.attr_type() == AttrType::VECTORS) {
+      LOG_WARN("unsupported value type in spill file. type=%s", attr_type_to_string(value.attr_type()));
+      return RC::UNSUPPORTED;
+    }
+    row_buffer.write_int32(static_cast<int32_t>(value.attr_type()));
+    row_buffer.write_int32(value.length());
+    row_buffer.write(value.data(), value.length());
+  }
+
+  write_buffer_.write_int32(static_cast<int32_t>(row_buffer.size()));
+  write_buffer_.write(row_buffer.data().data(), row_buffer.size());
+  row_count_++;
+  data_size_ += row_buffer.size();
+
+  if (write_buffer_.size() >= BUFFER_SIZE) {
+    return flush_write_buffer();
+  }
+  return RC::SUCCESS;
+}
+
+RC SpillFile::flush_write_buffer()
+{
+  if (write_buffer_.size() == 0) {
+    return RC::SUCCESS;
+  }
+
+  RC rc = handler_.append(static_cast<int>(write_buffer_.size()), write_buffer_.data().data());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write spill file. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+    return rc;
+  }
+  file_size_ += write_buffer_.size();
+  write_buffer_.data().clear();
+  return RC::SUCCESS;
+}
+
+RC SpillFile::finish_write()
+{
+  RC rc = flush_write_buffer();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  read_buffer_.clear();
+  read_pos_    = 0;
+  file_offset_ = 0;
+  return RC::SUCCESS;
+}
+
+RC SpillFile::fill_read_buffer(int64_t need_size)
+{
+  int64_t remain = static_cast<int64_t>(read_buffer_.size()) - read_pos_;
+  if (remain >= need_size) {
+    return RC::SUCCESS;
+  }
+
+  read_buffer_.erase(read_buffer_.begin(), read_buffer_.begin() + read_pos_);
+  read_pos_ = 0;
+
+  int64_t read_size = std::min(std::max(need_size - remain, BUFFER_SIZE), file_size_ - file_offset_);
+  if (read_size < need_size - remain) {
+    return RC::RECORD_EOF;
+  }
+
+  read_buffer_.resize(remain + read_size);
+  int64_t done = 0;
+  while (done < read_size) {
+    int64_t out_size = 0;
+    RC      rc       = handler_.read_at(
+        file_offset_ + done, static_cast<int>(read_size - done), read_buffer_.data() + remain + done, &out_size);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to read spill file. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+      return rc;
+    }
+    if (out_size <= 0) {
+      LOG_WARN("spill file is truncated. file=%s, offset=%ld", file_name_.c_str(), file_offset_ + done);
+      return RC::IOERR_READ;
+    }
+    done += out_size;
+  }
+  file_offset_ += read_size;
+  return RC::SUCCESS;
+}
+
+RC SpillFile::read_row(vector<Value> &row)
+{
+  RC rc = fill_read_buffer(sizeof(int32_t));
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  int32_t row_size = 0;
+  memcpy(&row_size, read_buffer_.data() + read_pos_, sizeof(row_size));
+  rc = fill_read_buffer(sizeof(int32_t) + row_size);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("spill file is truncated. file=%s", file_name_.c_str());
+    return rc == RC::RECORD_EOF ? RC::IOERR_READ : rc;
+  }
+
+  common::Deserializer deserializer(read_buffer_.data() + read_pos_ + sizeof(int32_t), row_size);
+  read_pos_ += sizeof(int32_t) + row_size;
+
+  int32_t cell_num = 0;
+  if (deserializer.read_int32(cell_num) != 0) {
+    return RC::IOERR_READ;
+  }
+
+  row.resize(cell_num);
+  for (int32_t i = 0; i < cell_num; i++) {
+    int32_t attr_type = 0;
+    int32_t length    = 0;
+    if (deserializer.read_int32(attr_type) != 0 || deserializer.read_int32(length) != 0 || length < 0 ||
+        length > deserializer.remain()) {
+      LOG_WARN("invalid row in spill file. file=%s", file_name_.c_str());
+      return RC::IOERR_READ;
+    }
+
+    Value &value = row[i];
+    value.reset();
+    value.set_type(static_cast<AttrType>(attr_type));
+    if (value.attr_type() == AttrType::CHARS) {
+      vector<char> data(length);
+      deserializer.read(data.data(), length);
+      value.set_data(data.data(), length);
+    } else {
+      // 定长类型读到足够大的缓冲中，避免 set_data 越界读取
+      char data[sizeof(int64_t)] = {0};
+      if (length > static_cast<int32_t>(sizeof(data))) {
+        return RC::IOERR_READ;
+      }
+      deserializer.read(data, length);
+      value.set_data(data, length);
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC SpillFile::close()
+{
+  if (!created_) {
+    return RC::SUCCESS;
+  }
+
+  created_ = false;
+  write_buffer_.data().clear();
+  read_buffer_.clear();
+  RC rc = handler_.remove_file();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to remove spill file. file=%s, rc=%s", file_name_.c_str(), strrc(rc));
+  }
+  return rc;
+}
@@ -0,0 +1,72 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/serializer.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/value.h"
+#include "storage/persist/persist.h"
+
+/**
+ * @brief 算子落盘使用的临时文件
+ * @ingroup PhysicalOperator
+ * @details 按行顺序写入一组 Value，写完之后再从头顺序读出来。
+ * 写入和读取都经过内存缓冲，避免每行一次系统调用。文件在 close 时删除。
+ * 行格式: int32 行长度 | int32 列数 | 每列 (int32 类型, int32 长度, 数据)
+ */
+class SpillFile
+{
+public:
+  SpillFile() = default;
+  ~SpillFile();
+
+  SpillFile(const SpillFile &)            = delete;
+  SpillFile &operator=(const SpillFile &) = delete;
+
+  /// 创建临时文件，文件不能已经存在
+  RC create(const string &file_name);
+
+  RC write_row(const vector<Value> &row);
+
+  /// 把缓冲中的数据写到文件中，之后可以调用 read_row 从头读取
+  RC finish_write();
+
+  /// 读取下一行，没有数据时返回 RECORD_EOF
+  RC read_row(vector<Value> &row);
+
+  /// 关闭并删除文件
+  RC close();
+
+  int64_t row_count() const { return row_count_; }
+  /// 写入的数据量，用来估算这个文件的数据读回内存后的大小
+  int64_t data_size() const { return data_size_; }
+
+private:
+  RC flush_write_buffer();
+  RC fill_read_buffer(int64_t need_size);
+
+private:
+  static constexpr int64_t BUFFER_SIZE = 64 * 1024;
+
+  PersistHandler     handler_;
+  string             file_name_;
+  bool               created_ = false;
+  common::Serializer write_buffer_;
+
+  vector<char> read_buffer_;
+  int64_t      read_pos_    = 0;  ///< 下一行在 read_buffer_ 中的位置
+  int64_t      file_offset_ = 0;  ///< 下次从文件中读取的位置
+  int64_t      file_size_   = 0;
+
+  int64_t row_count_ = 0;
+  int64_t data_size_ = 0;
+};
@@ -80,6 +80,13 @@ void TableScanPhysicalOperator::set_predicates(vector<unique_ptr<Expression>> &&
   predicates_ = std::move(exprs);
 }
 
+void TableScanPhysicalOperator::collect_constants(vector<Value *> &constants)
+{
+  for (unique_ptr<Expression> &expr : predicates_) {
+    collect_expression_constants(*expr, constants);
+  }
+}
+
 RC TableScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
 {
   RC    rc = RC::SUCCESS;
@@ -69,6 +69,9 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  void collect_constants(vector<Value *> &constants) override;
+  void collect_tables(vector<Table *> &tables) override { tables.push_back(table_); }
+
 private:
   RC filter(RowTuple &tuple, bool &result);
 
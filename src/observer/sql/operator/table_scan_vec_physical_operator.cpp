@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/table_scan_vec_physical_operator.h"
 #include "event/sql_debug.h"
+#include "sql/expr/expression_iterator.h"
 #include "storage/table/table.h"
 
 using namespace std;
@@ -21,12 +22,28 @@ RC TableScanVecPhysicalOperator::open(Trx *trx)
     LOG_WARN("failed to get chunk scanner", strrc(rc));
     return rc;
   }
-  // TODO: don't need to fetch all columns from record manager
-  for (int i = 0; i < table_->table_meta().field_num(); ++i) {
-    all_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
-    filterd_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
+  // 只读扫描不会修改页面中的数据，可以直接引用
+  chunk_scanner_.set_zero_copy(mode_ == ReadWriteMode::READ_ONLY);
+
+  const TableMeta &table_meta = table_->table_meta();
+  all_columns_.reset();
+  if (!projected_) {
+    for (int i = 0; i < table_meta.field_num(); ++i) {
+      all_columns_.add_column(make_unique<Column>(*table_meta.field(i)), table_meta.field(i)->field_id());
+    }
+    return rc;
+  }
+
+  set<int> field_ids = field_ids_;
+  for (unique_ptr<Expression> &expr : predicates_) {
+    collect_field_ids(*expr, field_ids);
+  }
+  // 比如 count(*) 没有用到任何字段，仍然需要一列来得到行数
+  if (field_ids.empty()) {
+    field_ids.insert(table_meta.field(0)->field_id());
+  }
+  for (int field_id : field_ids) {
+    all_columns_.add_column(make_unique<Column>(*table_meta.field(field_id)), field_id);
   }
   return rc;
 }
@@ -36,29 +53,25 @@ RC TableScanVecPhysicalOperator::next(Chunk &chunk)
   RC rc = RC::SUCCESS;
 
   all_columns_.reset_data();
-  filterd_columns_.reset_data();
-  if (OB_SUCC(rc = chunk_scanner_.next_chunk(all_columns_))) {
-    select_.assign(all_columns_.rows(), 1);
-    if (predicates_.empty()) {
-      chunk.reference(all_columns_);
-    } else {
+  while (OB_SUCC(rc = chunk_scanner_.next_chunk(all_columns_))) {
+    if (!predicates_.empty()) {
+      select_.assign(all_columns_.rows(), 1);
       rc = filter(all_columns_);
       if (rc != RC::SUCCESS) {
         LOG_TRACE("filtered failed=%s", strrc(rc));
         return rc;
       }
-      // TODO: if all setted, it doesn't need to set one by one
-      for (int i = 0; i < all_columns_.rows(); i++) {
-        if (select_[i] == 0) {
-          continue;
-        }
-        for (int j = 0; j < all_columns_.column_num(); j++) {
-          filterd_columns_.column(j).append_value(
-              all_columns_.column(filterd_columns_.column_ids(j)).get_value(i));
-        }
-      }
-      chunk.reference(filterd_columns_);
+      // 不复制过滤后的行，只记录选择向量
+      all_columns_.select(select_);
+    }
+    // 空页面或者页面中的记录都被删除、过滤掉了
+    if (all_columns_.selected_rows() > 0) {
+      break;
     }
+    all_columns_.reset_data();
+  }
+  if (OB_SUCC(rc)) {
+    chunk.reference(all_columns_);
   }
   return rc;
 }
@@ -72,6 +85,26 @@ void TableScanVecPhysicalOperator::set_predicates(vector<unique_ptr<Expression>>
   predicates_ = std::move(exprs);
 }
 
+void TableScanVecPhysicalOperator::add_referenced_fields(Expression &expr)
+{
+  projected_ = true;
+  collect_field_ids(expr, field_ids_);
+}
+
+void TableScanVecPhysicalOperator::collect_field_ids(Expression &expr, set<int> &field_ids)
+{
+  if (expr.type() == ExprType::FIELD) {
+    field_ids.insert(static_cast<FieldExpr &>(expr).field().meta()->field_id());
+    return;
+  }
+  ExpressionIterator::iterate_child_expr(expr, [&field_ids](unique_ptr<Expression> &child) {
+    if (child != nullptr) {
+      collect_field_ids(*child, field_ids);
+    }
+    return RC::SUCCESS;
+  });
+}
+
 RC TableScanVecPhysicalOperator::filter(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
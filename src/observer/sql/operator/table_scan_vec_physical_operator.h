@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/set.h"
 #include "common/sys/rc.h"
 #include "sql/operator/physical_operator.h"
 #include "storage/record/record_manager.h"
@@ -20,6 +21,10 @@ class Table;
 /**
  * @brief 表扫描物理算子(vectorized)
  * @ingroup PhysicalOperator
+ * @details 过滤条件的结果记录在输出 chunk 的选择向量中，不会复制过滤后的行，没有选中任何行的 chunk 会被跳过。
+ * 通过 add_referenced_fields 告知上层算子用到的字段后，只读取这些字段和过滤条件用到的字段，
+ * 输出 chunk 中的列 id 就是字段的 field_id。只读扫描时，输出的列直接引用缓冲池页面中的数据，
+ * 在下一次调用 next 或 close 之前有效。
  */
 class TableScanVecPhysicalOperator : public PhysicalOperator
 {
@@ -38,15 +43,25 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 记录上层算子的表达式中用到的字段，没有调用过时读取所有字段
+   */
+  void add_referenced_fields(Expression &expr);
+
+  void collect_tables(vector<Table *> &tables) override { tables.push_back(table_); }
+
 private:
   RC filter(Chunk &chunk);
 
+  static void collect_field_ids(Expression &expr, set<int> &field_ids);
+
 private:
   Table                         *table_ = nullptr;
   ReadWriteMode                  mode_  = ReadWriteMode::READ_WRITE;
   ChunkFileScanner               chunk_scanner_;
   Chunk                          all_columns_;
-  Chunk                          filterd_columns_;
   vector<uint8_t>                select_;
   vector<unique_ptr<Expression>> predicates_;
+  bool                           projected_ = false;  ///< 是否只读取用到的字段
+  set<int>                       field_ids_;          ///< 上层算子用到的字段
 };
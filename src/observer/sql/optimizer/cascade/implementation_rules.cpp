@@ -29,6 +29,9 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/group_by_logical_operator.h"
 #include "sql/operator/scalar_group_by_physical_operator.h"
 #include "sql/operator/hash_group_by_physical_operator.h"
+#include "sql/operator/join_logical_operator.h"
+#include "sql/operator/nested_loop_join_physical_operator.h"
+#include "sql/operator/hash_join_physical_operator.h"
 
 // -------------------------------------------------------------------------------------------------
 // PhysicalSeqScan
@@ -259,6 +262,79 @@ void LogicalPredicateToPredicate::transform(OperatorNode* input,
   transformed->emplace_back(std::move(oper));
 }
 
+// -------------------------------------------------------------------------------------------------
+// Physical Nested Loop Join
+// -------------------------------------------------------------------------------------------------
+LogicalInnerJoinToNestedLoopJoin::LogicalInnerJoinToNestedLoopJoin()
+{
+  type_ = RuleType::INNER_JOIN_TO_NL_JOIN;
+  match_pattern_ = unique_ptr<Pattern>(new Pattern(OpType::LOGICALINNERJOIN));
+  match_pattern_->add_child(new Pattern(OpType::LEAF));
+  match_pattern_->add_child(new Pattern(OpType::LEAF));
+}
+
+void LogicalInnerJoinToNestedLoopJoin::transform(OperatorNode* input,
+                         std::vector<std::unique_ptr<OperatorNode>> *transformed,
+                         OptimizerContext *context) const
+{
+  auto join_oper = dynamic_cast<JoinLogicalOperator*>(input);
+
+  auto nlj_oper = make_unique<NestedLoopJoinPhysicalOperator>();
+  for (auto &child : join_oper->children()) {
+    nlj_oper->add_general_child(child.get());
+  }
+
+  transformed->emplace_back(std::move(nlj_oper));
+}
+
+// -------------------------------------------------------------------------------------------------
+// Physical Hash Join
+// -------------------------------------------------------------------------------------------------
+LogicalInnerJoinToHashJoin::LogicalInnerJoinToHashJoin()
+{
+  type_ = RuleType::INNER_JOIN_TO_HASH_JOIN;
+  match_pattern_ = unique_ptr<Pattern>(new Pattern(OpType::LOGICALINNERJOIN));
+  match_pattern_->add_child(new Pattern(OpType::LEAF));
+  match_pattern_->add_child(new Pattern(OpType::LEAF));
+}
+
+void LogicalInnerJoinToHashJoin::transform(OperatorNode* input,
+                         std::vector<std::unique_ptr<OperatorNode>> *transformed,
+                         OptimizerContext *context) const
+{
+  auto join_oper = dynamic_cast<JoinLogicalOperator*>(input);
+
+  vector<unique_ptr<Expression>> &join_predicates = join_oper->get_join_predicates();
+  if (join_predicates.empty()) {
+    return;
+  }
+  for (auto &predicate : join_predicates) {
+    if (predicate->type() != ExprType::COMPARISON ||
+        static_cast<ComparisonExpr *>(predicate.get())->comp() != CompOp::EQUAL_TO) {
+      return;
+    }
+  }
+
+  // build 端由代价模型根据两边的基数来选择
+  for (bool build_left : {true, false}) {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    for (auto &predicate : join_predicates) {
+      auto comparison_expr = static_cast<ComparisonExpr *>(predicate.get());
+      left_keys.emplace_back(comparison_expr->left()->copy());
+      right_keys.emplace_back(comparison_expr->right()->copy());
+    }
+
+    auto hash_join_oper =
+        make_unique<HashJoinPhysicalOperator>(std::move(left_keys), std::move(right_keys), build_left);
+    for (auto &child : join_oper->children()) {
+      hash_join_oper->add_general_child(child.get());
+    }
+
+    transformed->emplace_back(std::move(hash_join_oper));
+  }
+}
+
 // -------------------------------------------------------------------------------------------------
 // Physical Aggregation
 // -------------------------------------------------------------------------------------------------
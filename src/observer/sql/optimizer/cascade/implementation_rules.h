@@ -113,6 +113,31 @@ public:
       OptimizerContext *context) const override;
 };
 
+/**
+ * Rule transforms Logical inner join -> Physical nested loop join
+ */
+class LogicalInnerJoinToNestedLoopJoin : public Rule
+{
+public:
+  LogicalInnerJoinToNestedLoopJoin();
+
+  void transform(OperatorNode *input, std::vector<std::unique_ptr<OperatorNode>> *transformed,
+      OptimizerContext *context) const override;
+};
+
+/**
+ * Rule transforms Logical inner join -> Physical hash join
+ * @details 只处理全部是等值连接条件的 join。左右两边分别作为 build 端各生成一个物理算子，由代价模型挑选
+ */
+class LogicalInnerJoinToHashJoin : public Rule
+{
+public:
+  LogicalInnerJoinToHashJoin();
+
+  void transform(OperatorNode *input, std::vector<std::unique_ptr<OperatorNode>> *transformed,
+      OptimizerContext *context) const override;
+};
+
 /**
  * Rule transforms Logical Groupby -> Physical Aggregation(Scalar Groupby)
  * TODO: currently group by is competition problem, so we don't implement this rule
@@ -45,6 +45,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/update_logical_operator.h"
 #include "sql/operator/update_physical_operator.h"
 #include "sql/optimizer/physical_plan_generator.h"
+#include "storage/db/db.h"
 
 using namespace std;
 
@@ -313,30 +314,86 @@ RC PhysicalPlanGenerator::create_plan(JoinLogicalOperator &join_oper, unique_ptr
     LOG_WARN("join operator should have 2 children, but have %d", child_opers.size());
     return RC::INTERNAL;
   }
+
+  unique_ptr<PhysicalOperator> join_physical_oper;
   if (session->hash_join_on() && can_use_hash_join(join_oper)) {
-    // your code here
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    for (unique_ptr<Expression> &predicate : join_oper.get_join_predicates()) {
+      auto comparison_expr = static_cast<ComparisonExpr *>(predicate.get());
+      left_keys.emplace_back(comparison_expr->left()->copy());
+      right_keys.emplace_back(comparison_expr->right()->copy());
+    }
+
+    // 使用行数少的一边建哈希表
+    int  left_card  = estimate_cardinality(*child_opers[0]);
+    int  right_card = estimate_cardinality(*child_opers[1]);
+    bool build_left = left_card < right_card;
+    LOG_TRACE("use hash join. left card=%d, right card=%d, build %s",
+              left_card, right_card, build_left ? "left" : "right");
+
+    auto hash_join_oper =
+        make_unique<HashJoinPhysicalOperator>(std::move(left_keys), std::move(right_keys), build_left);
+    hash_join_oper->set_memory_budget(session->hash_join_memory_budget());
+    if (session->get_current_db() != nullptr) {
+      hash_join_oper->set_spill_directory(session->get_current_db()->path());
+    }
+    join_physical_oper = std::move(hash_join_oper);
   } else {
-    unique_ptr<PhysicalOperator> join_physical_oper(new NestedLoopJoinPhysicalOperator());
-    for (auto &child_oper : child_opers) {
-      unique_ptr<PhysicalOperator> child_physical_oper;
-      rc = create(*child_oper, child_physical_oper, session);
-      if (rc != RC::SUCCESS) {
-        LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
-        return rc;
-      }
+    join_physical_oper = make_unique<NestedLoopJoinPhysicalOperator>();
+  }
 
-      join_physical_oper->add_child(std::move(child_physical_oper));
+  for (auto &child_oper : child_opers) {
+    unique_ptr<PhysicalOperator> child_physical_oper;
+    rc = create(*child_oper, child_physical_oper, session);
+    if (rc != RC::SUCCESS) {
+      LOG_WARN("failed to create physical child oper. rc=%s", strrc(rc));
+      return rc;
     }
 
-    oper = std::move(join_physical_oper);
+    join_physical_oper->add_child(std::move(child_physical_oper));
   }
+
+  oper = std::move(join_physical_oper);
   return rc;
 }
 
 bool PhysicalPlanGenerator::can_use_hash_join(JoinLogicalOperator &join_oper)
 {
-  // your code here
-  return false;
+  // 连接条件由 PredicateToJoinRewriter 生成，都是左边对应左孩子、右边对应右孩子的等值比较
+  vector<unique_ptr<Expression>> &join_predicates = join_oper.get_join_predicates();
+  if (join_predicates.empty()) {
+    return false;
+  }
+
+  for (unique_ptr<Expression> &predicate : join_predicates) {
+    if (predicate->type() != ExprType::COMPARISON) {
+      return false;
+    }
+
+    auto comparison_expr = static_cast<ComparisonExpr *>(predicate.get());
+    if (comparison_expr->comp() != CompOp::EQUAL_TO) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int PhysicalPlanGenerator::estimate_cardinality(LogicalOperator &logical_oper)
+{
+  vector<unique_ptr<LogicalProperty>> child_props;
+  vector<LogicalProperty *>           child_prop_ptrs;
+  int                                 max_child_card = 0;
+  for (unique_ptr<LogicalOperator> &child : logical_oper.children()) {
+    int child_card = estimate_cardinality(*child);
+    max_child_card = std::max(max_child_card, child_card);
+    child_props.emplace_back(make_unique<LogicalProperty>(child_card));
+    child_prop_ptrs.push_back(child_props.back().get());
+  }
+
+  // 没有实现 find_log_prop 的算子（比如过滤），就按照孩子的最大行数估算
+  unique_ptr<LogicalProperty> prop = logical_oper.find_log_prop(child_prop_ptrs);
+  return prop ? prop->get_card() : max_child_card;
 }
 
 RC PhysicalPlanGenerator::create_plan(CalcLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
@@ -391,32 +448,40 @@ RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_ope
 
 RC PhysicalPlanGenerator::create_vec_plan(GroupByLogicalOperator &logical_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
-  RC rc = RC::SUCCESS;
-  unique_ptr<PhysicalOperator> physical_oper = nullptr;
-  if (logical_oper.group_by_expressions().empty()) {
-    physical_oper = make_unique<AggregateVecPhysicalOperator>(std::move(logical_oper.aggregate_expressions()));
-  } else {
-    physical_oper = make_unique<GroupByVecPhysicalOperator>(
-      std::move(logical_oper.group_by_expressions()), std::move(logical_oper.aggregate_expressions()));
-
-  }
-
   ASSERT(logical_oper.children().size() == 1, "group by operator should have 1 child");
 
   LogicalOperator             &child_oper = *logical_oper.children().front();
   unique_ptr<PhysicalOperator> child_physical_oper;
-  rc = create_vec(child_oper, child_physical_oper, session);
+  RC rc = create_vec(child_oper, child_physical_oper, session);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to create child physical operator of group by(vec) operator. rc=%s", strrc(rc));
     return rc;
   }
 
+  // 表扫描只需要读取分组和聚合用到的字段
+  if (child_physical_oper->type() == PhysicalOperatorType::TABLE_SCAN_VEC) {
+    auto *table_scan_oper = static_cast<TableScanVecPhysicalOperator *>(child_physical_oper.get());
+    for (unique_ptr<Expression> &expr : logical_oper.group_by_expressions()) {
+      table_scan_oper->add_referenced_fields(*expr);
+    }
+    for (Expression *expr : logical_oper.aggregate_expressions()) {
+      table_scan_oper->add_referenced_fields(*expr);
+    }
+  }
+
+  unique_ptr<PhysicalOperator> physical_oper = nullptr;
+  if (logical_oper.group_by_expressions().empty()) {
+    physical_oper = make_unique<AggregateVecPhysicalOperator>(std::move(logical_oper.aggregate_expressions()));
+  } else {
+    physical_oper = make_unique<GroupByVecPhysicalOperator>(
+      std::move(logical_oper.group_by_expressions()), std::move(logical_oper.aggregate_expressions()));
+
+  }
+
   physical_oper->add_child(std::move(child_physical_oper));
 
   oper = std::move(physical_oper);
   return rc;
-
-  return RC::SUCCESS;
 }
 
 RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
@@ -438,6 +503,14 @@ RC PhysicalPlanGenerator::create_vec_plan(ProjectLogicalOperator &project_oper,
   auto project_operator = make_unique<ProjectVecPhysicalOperator>(std::move(project_oper.expressions()));
 
   if (child_phy_oper != nullptr) {
+    // 表扫描只需要读取投影用到的字段
+    if (child_phy_oper->type() == PhysicalOperatorType::TABLE_SCAN_VEC) {
+      auto *table_scan_oper = static_cast<TableScanVecPhysicalOperator *>(child_phy_oper.get());
+      for (auto &expr : project_operator->expressions()) {
+        table_scan_oper->add_referenced_fields(*expr);
+      }
+    }
+
     vector<Expression *> expressions;
     for (auto &expr : project_operator->expressions()) {
       expressions.push_back(expr.get());
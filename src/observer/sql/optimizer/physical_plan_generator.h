@@ -63,4 +63,7 @@ private:
 
   // TODO: remove this and add CBO rules
   bool can_use_hash_join(JoinLogicalOperator &logical_oper);
+
+  /// 根据 TableStats 自底向上估算逻辑算子输出的行数，用来选择 hash join 的 build 端
+  int estimate_cardinality(LogicalOperator &logical_oper);
 };
\ No newline at end of file
@@ -9,3 +9,152 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "sql/optimizer/predicate_to_join_rule.h"
+#include "common/log/log.h"
+#include "sql/expr/expression.h"
+#include "sql/expr/expression_iterator.h"
+#include "sql/operator/join_logical_operator.h"
+#include "sql/operator/logical_operator.h"
+#include "sql/operator/table_get_logical_operator.h"
+
+RC PredicateToJoinRewriter::rewrite(unique_ptr<LogicalOperator> &oper, bool &change_made)
+{
+  if (oper->type() != LogicalOperatorType::PREDICATE || oper->children().size() != 1) {
+    return RC::SUCCESS;
+  }
+
+  LogicalOperator *child_oper = oper->children().front().get();
+  if (child_oper->type() != LogicalOperatorType::JOIN) {
+    return RC::SUCCESS;
+  }
+
+  vector<unique_ptr<Expression>> &predicate_exprs = oper->expressions();
+  if (predicate_exprs.size() != 1) {
+    return RC::SUCCESS;
+  }
+
+  vector<Expression *> equal_predicates;
+  collect_equal_predicates(predicate_exprs.front().get(), equal_predicates);
+  if (equal_predicates.empty()) {
+    return RC::SUCCESS;
+  }
+
+  push_to_joins(child_oper, equal_predicates, change_made);
+  return RC::SUCCESS;
+}
+
+/**
+ * @brief 收集 AND 连接起来的所有等值比较
+ * @details OR 下面的条件不能作为连接条件
+ */
+void PredicateToJoinRewriter::collect_equal_predicates(Expression *expr, vector<Expression *> &equal_predicates)
+{
+  if (expr->type() == ExprType::CONJUNCTION) {
+    auto conjunction_expr = static_cast<ConjunctionExpr *>(expr);
+    if (conjunction_expr->conjunction_type() != ConjunctionExpr::Type::AND) {
+      return;
+    }
+
+    for (unique_ptr<Expression> &child : conjunction_expr->children()) {
+      collect_equal_predicates(child.get(), equal_predicates);
+    }
+  } else if (expr->type() == ExprType::COMPARISON) {
+    auto comparison_expr = static_cast<ComparisonExpr *>(expr);
+    if (comparison_expr->comp() == CompOp::EQUAL_TO) {
+      equal_predicates.push_back(expr);
+    }
+  }
+}
+
+void PredicateToJoinRewriter::push_to_joins(
+    LogicalOperator *oper, const vector<Expression *> &equal_predicates, bool &change_made)
+{
+  if (oper->type() != LogicalOperatorType::JOIN) {
+    return;
+  }
+
+  auto join_oper = static_cast<JoinLogicalOperator *>(oper);
+  ASSERT(join_oper->children().size() == 2, "join operator should have 2 children");
+
+  // 连接条件只需要挂一次，重写器会反复执行直到没有变化
+  if (join_oper->get_join_predicates().empty()) {
+    unordered_set<const Table *> left_tables;
+    unordered_set<const Table *> right_tables;
+    collect_tables(join_oper->children()[0].get(), left_tables);
+    collect_tables(join_oper->children()[1].get(), right_tables);
+
+    for (Expression *expr : equal_predicates) {
+      auto                    comparison_expr = static_cast<ComparisonExpr *>(expr);
+      unique_ptr<Expression> &left            = comparison_expr->left();
+      unique_ptr<Expression> &right           = comparison_expr->right();
+
+      bool left_has_field  = false;
+      bool right_has_field = false;
+      if (expr_in_tables(*left, left_tables, left_has_field) && left_has_field &&
+          expr_in_tables(*right, right_tables, right_has_field) && right_has_field) {
+        join_oper->add_join_predicate(make_unique<ComparisonExpr>(CompOp::EQUAL_TO, left->copy(), right->copy()));
+        continue;
+      }
+
+      left_has_field  = false;
+      right_has_field = false;
+      if (expr_in_tables(*left, right_tables, left_has_field) && left_has_field &&
+          expr_in_tables(*right, left_tables, right_has_field) && right_has_field) {
+        // 保证比较表达式的左边总是对应连接的左孩子
+        join_oper->add_join_predicate(make_unique<ComparisonExpr>(CompOp::EQUAL_TO, right->copy(), left->copy()));
+      }
+    }
+
+    if (!join_oper->get_join_predicates().empty()) {
+      LOG_TRACE("push %d equal predicates to join operator", join_oper->get_join_predicates().size());
+      change_made = true;
+    }
+  }
+
+  for (unique_ptr<LogicalOperator> &child : join_oper->children()) {
+    push_to_joins(child.get(), equal_predicates, change_made);
+  }
+}
+
+void PredicateToJoinRewriter::collect_tables(LogicalOperator *oper, unordered_set<const Table *> &tables)
+{
+  if (oper->type() == LogicalOperatorType::TABLE_GET) {
+    tables.insert(static_cast<TableGetLogicalOperator *>(oper)->table());
+    return;
+  }
+
+  for (unique_ptr<LogicalOperator> &child : oper->children()) {
+    collect_tables(child.get(), tables);
+  }
+}
+
+/**
+ * @brief 表达式中引用的字段是否都来自指定的表
+ * @param has_field 表达式中是否引用了字段。只有常量的表达式不能作为连接键
+ */
+bool PredicateToJoinRewriter::expr_in_tables(
+    Expression &expr, const unordered_set<const Table *> &tables, bool &has_field)
+{
+  switch (expr.type()) {
+    case ExprType::FIELD: {
+      has_field = true;
+      return tables.count(static_cast<FieldExpr &>(expr).field().table()) > 0;
+    }
+    case ExprType::VALUE: {
+      return true;
+    }
+    case ExprType::CAST:
+    case ExprType::ARITHMETIC: {
+      bool in_tables = true;
+      ExpressionIterator::iterate_child_expr(expr, [&](unique_ptr<Expression> &child) {
+        if (!expr_in_tables(*child, tables, has_field)) {
+          in_tables = false;
+        }
+        return RC::SUCCESS;
+      });
+      return in_tables;
+    }
+    default: {
+      return false;
+    }
+  }
+}
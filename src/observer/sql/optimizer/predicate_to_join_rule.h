@@ -10,12 +10,31 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/unordered_set.h"
 #include "common/lang/vector.h"
 #include "sql/optimizer/rewrite_rule.h"
 
+class Table;
+class JoinLogicalOperator;
+
 /**
  * @brief 将一些谓词表达式下推到join中
  * @ingroup Rewriter
+ * @details 找出过滤条件中连接左右两边的等值比较（比如 t1.a = t2.b），复制一份挂到对应的
+ * JoinLogicalOperator 上，作为 hash join 的连接键和基数估算的依据。
+ * 原有的过滤条件保留不动，所以即使最后选择了 nested loop join，结果也是正确的。
  */
-class PredicateToJoinRewriter
-{};
+class PredicateToJoinRewriter : public RewriteRule
+{
+public:
+  PredicateToJoinRewriter()          = default;
+  virtual ~PredicateToJoinRewriter() = default;
+
+  RC rewrite(unique_ptr<LogicalOperator> &oper, bool &change_made) override;
+
+private:
+  void collect_equal_predicates(Expression *expr, vector<Expression *> &equal_predicates);
+  void push_to_joins(LogicalOperator *oper, const vector<Expression *> &equal_predicates, bool &change_made);
+  void collect_tables(LogicalOperator *oper, unordered_set<const Table *> &tables);
+  bool expr_in_tables(Expression &expr, const unordered_set<const Table *> &tables, bool &has_field);
+};
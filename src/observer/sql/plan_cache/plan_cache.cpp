@@ -0,0 +1,255 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "sql/plan_cache/plan_cache.h"
+#include "common/log/log.h"
+
+RC CachedPlan::bind(const vector<Value> &params)
+{
+  if (params.size() != params_.size()) {
+    LOG_WARN("param number mismatch. expect=%lu, actual=%lu", params_.size(), params.size());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  for (size_t i = 0; i < params.size(); i++) {
+    for (Value *slot : params_[i]) {
+      *slot = params[i];
+    }
+  }
+  return RC::SUCCESS;
+}
+
+PlanCache::~PlanCache() { invalidate(); }
+
+static bool is_identifier_char(char c) { return isalnum(static_cast<unsigned char>(c)) || c == '_'; }
+
+bool PlanCache::normalize(const string &sql, string &normalized_sql, vector<Value> &params)
+{
+  normalized_sql.clear();
+  params.clear();
+
+  size_t begin = 0;
+  size_t end   = sql.size();
+  while (begin < end && isspace(static_cast<unsigned char>(sql[begin]))) {
+    begin++;
+  }
+  while (end > begin && isspace(static_cast<unsigned char>(sql[end - 1]))) {
+    end--;
+  }
+
+  const char  *select_keyword = "select";
+  const size_t keyword_len    = strlen(select_keyword);
+  if (end - begin <= keyword_len || strncasecmp(sql.c_str() + begin, select_keyword, keyword_len) != 0 ||
+      is_identifier_char(sql[begin + keyword_len])) {
+    return false;
+  }
+
+  // 与 lex_sql.l 中的规则保持一致：标识符中的数字不是常量，数字和字符串常量替换成占位符。
+  // 除常量以外的文本保持原样，因为表达式的名字（结果的表头）直接来自 SQL 原文。
+  normalized_sql.reserve(end - begin);
+  size_t pos = begin;
+  while (pos < end) {
+    const char c = sql[pos];
+    if (isalpha(static_cast<unsigned char>(c)) || c == '_') {
+      size_t token_end = pos;
+      while (token_end < end && is_identifier_char(sql[token_end])) {
+        token_end++;
+      }
+      normalized_sql.append(sql, pos, token_end - pos);
+      pos = token_end;
+    } else if (isdigit(static_cast<unsigned char>(c))) {
+      size_t token_end = pos;
+      while (token_end < end && isdigit(static_cast<unsigned char>(sql[token_end]))) {
+        token_end++;
+      }
+
+      bool is_float = false;
+      if (token_end + 1 < end && sql[token_end] == '.' && isdigit(static_cast<unsigned char>(sql[token_end + 1]))) {
+        is_float = true;
+        token_end++;
+        while (token_end < end && isdigit(static_cast<unsigned char>(sql[token_end]))) {
+          token_end++;
+        }
+      }
+
+      string text = sql.substr(pos, token_end - pos);
+      if (is_float) {
+        params.emplace_back(static_cast<float>(atof(text.c_str())));
+        normalized_sql.append("?f");
+      } else {
+        params.emplace_back(atoi(text.c_str()));
+        normalized_sql.append("?i");
+      }
+      pos = token_end;
+    } else if (c == '\'' || c == '"') {
+      size_t quote_end = sql.find(c, pos + 1);
+      if (quote_end == string::npos || quote_end >= end) {
+        // 不完整的字符串，交给解析器报错
+        return false;
+      }
+      params.emplace_back(sql.substr(pos + 1, quote_end - pos - 1).c_str());
+      normalized_sql.append("?s");
+      pos = quote_end + 1;
+    } else {
+      normalized_sql.push_back(c);
+      pos++;
+    }
+  }
+  return true;
+}
+
+/// 只有这些算子在 close 之后可以重新 open，其它算子（比如聚合）会残留上次执行的状态
+static bool collect_reusable_constants(PhysicalOperator &oper, vector<Value *> &constants)
+{
+  switch (oper.type()) {
+    case PhysicalOperatorType::TABLE_SCAN:
+    case PhysicalOperatorType::INDEX_SCAN:
+    case PhysicalOperatorType::PREDICATE:
+    case PhysicalOperatorType::PROJECT:
+    case PhysicalOperatorType::NESTED_LOOP_JOIN:
+    case PhysicalOperatorType::HASH_JOIN: break;
+    default: return false;
+  }
+
+  oper.collect_constants(constants);
+  for (unique_ptr<PhysicalOperator> &child : oper.children()) {
+    if (!collect_reusable_constants(*child, constants)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool same_constant(const Value &left, const Value &right)
+{
+  return left.attr_type() == right.attr_type() && left.compare(right) == 0;
+}
+
+bool PlanCache::bind_params(PhysicalOperator &oper, const vector<Value> &params, vector<vector<Value *>> &param_slots)
+{
+  vector<Value *> constants;
+  if (!collect_reusable_constants(oper, constants)) {
+    return false;
+  }
+
+  // 有相同的常量时，无法区分计划中的常量来自哪个参数
+  for (size_t i = 0; i < params.size(); i++) {
+    for (size_t j = 0; j < i; j++) {
+      if (same_constant(params[i], params[j])) {
+        return false;
+      }
+    }
+  }
+
+  param_slots.clear();
+  param_slots.resize(params.size());
+  for (Value *constant : constants) {
+    size_t index = 0;
+    while (index < params.size() && !same_constant(*constant, params[index])) {
+      index++;
+    }
+
+    // 计划中的常量不是 SQL 中的原始常量，比如常量折叠的结果
+    if (index >= params.size()) {
+      return false;
+    }
+    param_slots[index].push_back(constant);
+  }
+
+  // SQL 中的常量被改写掉了，或者出现在投影中（投影的表头包含了常量原文）
+  for (const vector<Value *> &slots : param_slots) {
+    if (slots.empty()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+unique_ptr<CachedPlan> PlanCache::acquire(const string &key, uint64_t &version)
+{
+  lock_guard<mutex> guard(lock_);
+  version = version_.load();
+
+  auto iter = entries_.find(key);
+  if (iter == entries_.end() || iter->second->idle_plans.empty()) {
+    miss_count_++;
+    return nullptr;
+  }
+
+  Entry &entry = *iter->second;
+  lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+
+  unique_ptr<CachedPlan> plan = std::move(entry.idle_plans.back());
+  entry.idle_plans.pop_back();
+  hit_count_++;
+  return plan;
+}
+
+void PlanCache::release(const string &key, unique_ptr<CachedPlan> plan, uint64_t version)
+{
+  lock_guard<mutex> guard(lock_);
+  if (version != version_.load()) {
+    LOG_TRACE("drop stale plan. plan version=%lu, cache version=%lu", version, version_.load());
+    return;
+  }
+
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    lru_list_.push_front(Entry{key, {}});
+    iter = entries_.emplace(key, lru_list_.begin()).first;
+  } else {
+    lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+  }
+
+  Entry &entry = *iter->second;
+  if (entry.idle_plans.size() < MAX_IDLE_PLANS_PER_KEY) {
+    entry.idle_plans.emplace_back(std::move(plan));
+  }
+
+  evict_if_needed();
+}
+
+void PlanCache::invalidate()
+{
+  lock_guard<mutex> guard(lock_);
+  version_++;
+  if (!entries_.empty()) {
+    LOG_INFO("invalidate plan cache. entries=%lu, hits=%ld, misses=%ld",
+             entries_.size(), hit_count_.load(), miss_count_.load());
+  }
+  entries_.clear();
+  lru_list_.clear();
+}
+
+void PlanCache::set_capacity(size_t capacity)
+{
+  lock_guard<mutex> guard(lock_);
+  capacity_ = capacity;
+  evict_if_needed();
+}
+
+size_t PlanCache::size() const
+{
+  lock_guard<mutex> guard(lock_);
+  return entries_.size();
+}
+
+void PlanCache::evict_if_needed()
+{
+  while (entries_.size() > capacity_) {
+    entries_.erase(lru_list_.back().key);
+    lru_list_.pop_back();
+  }
+}
@@ -0,0 +1,121 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/list.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "common/value.h"
+#include "sql/operator/physical_operator.h"
+
+/**
+ * @brief 缓存中的一个执行计划实例
+ * @ingroup SQLStage
+ * @details 物理算子是有状态的，同一个实例同时只能被一个请求使用。
+ * params_[i] 记录了 SQL 中第 i 个常量在执行计划中的位置，复用时原地替换。
+ */
+class CachedPlan
+{
+public:
+  CachedPlan() = default;
+  CachedPlan(unique_ptr<PhysicalOperator> oper, vector<vector<Value *>> params, bool chunk_mode)
+      : oper_(std::move(oper)), params_(std::move(params)), chunk_mode_(chunk_mode)
+  {}
+
+  /// 把 SQL 中的常量设置到执行计划中
+  RC bind(const vector<Value> &params);
+
+  unique_ptr<PhysicalOperator>  &oper() { return oper_; }
+  const vector<vector<Value *>> &params() const { return params_; }
+  bool                           chunk_mode() const { return chunk_mode_; }
+
+private:
+  unique_ptr<PhysicalOperator> oper_;
+  vector<vector<Value *>>      params_;
+  bool                         chunk_mode_ = false;
+};
+
+/**
+ * @brief 执行计划缓存
+ * @ingroup SQLStage
+ * @details 每个 Db 一个。使用参数化之后的 SQL 作为 key，只有常量不同的 SQL 共享同一个模板。
+ * 一个 key 下面可以有多个空闲的计划实例，按照 key 做 LRU 淘汰。
+ * 表结构、索引或者统计信息变化时整个缓存失效，正在使用中的计划归还时会被丢弃。
+ */
+class PlanCache
+{
+public:
+  PlanCache() = default;
+  ~PlanCache();
+
+  /**
+   * @brief 把 SQL 参数化
+   * @details 把数字和字符串常量替换成带类型的占位符，常量按照出现的顺序放到 params 中。
+   * 只处理 select 语句，其它语句返回 false。
+   */
+  static bool normalize(const string &sql, string &normalized_sql, vector<Value> &params);
+
+  /**
+   * @brief 找到 SQL 中每个常量在执行计划中的位置
+   * @details 只有确定每个常量都原样出现在执行计划中，并且计划中的常量都来自 SQL 时才能缓存。
+   * 如果常量被改写过（比如常量折叠、类型转换），或者计划中包含不能重复打开的算子，返回 false。
+   */
+  static bool bind_params(PhysicalOperator &oper, const vector<Value> &params, vector<vector<Value *>> &param_slots);
+
+  /**
+   * @brief 取出一个空闲的执行计划
+   * @param[out] version 当前缓存的版本号，归还计划时使用
+   * @return 没有时返回 nullptr
+   */
+  unique_ptr<CachedPlan> acquire(const string &key, uint64_t &version);
+
+  /**
+   * @brief 把执行完的计划放回缓存
+   * @param version 计划生成时缓存的版本号，如果缓存已经失效过，这个计划会被丢弃
+   */
+  void release(const string &key, unique_ptr<CachedPlan> plan, uint64_t version);
+
+  /// 清空缓存，在 DDL 或者统计信息更新后调用
+  void invalidate();
+
+  uint64_t version() const { return version_.load(); }
+
+  void set_capacity(size_t capacity);
+
+  int64_t hit_count() const { return hit_count_.load(); }
+  int64_t miss_count() const { return miss_count_.load(); }
+  size_t  size() const;
+
+private:
+  void evict_if_needed();
+
+private:
+  /// 每个 key 最多保留的空闲计划数量
+  static constexpr size_t MAX_IDLE_PLANS_PER_KEY = 8;
+
+  struct Entry
+  {
+    string                         key;
+    vector<unique_ptr<CachedPlan>> idle_plans;
+  };
+
+  mutable mutex                                lock_;
+  list<Entry>                                  lru_list_;  ///< 头部是最近使用的
+  unordered_map<string, list<Entry>::iterator> entries_;
+  size_t                                       capacity_ = 1024;  ///< 最多缓存的 key 的数量
+
+  atomic<uint64_t> version_{0};
+  atomic<int64_t>  hit_count_{0};
+  atomic<int64_t>  miss_count_{0};
+};
@@ -20,5 +20,94 @@ See the Mulan PSL v2 for more details. */
 #include "common/io/io.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
+#include "event/session_event.h"
+#include "event/sql_event.h"
+#include "session/session.h"
+#include "sql/executor/sql_result.h"
+#include "sql/plan_cache/plan_cache.h"
+#include "sql/stmt/stmt.h"
+#include "storage/db/db.h"
 
 using namespace common;
+
+/// 会影响执行计划的会话变量也需要作为缓存key的一部分
+static string session_plan_options(Session *session)
+{
+  string options;
+  options.append("|cascade=").append(std::to_string(session->use_cascade()));
+  options.append("|hash_join=").append(std::to_string(session->hash_join_on()));
+  options.append("|hash_join_memory_budget=").append(std::to_string(session->hash_join_memory_budget()));
+  options.append("|execution_mode=").append(std::to_string(static_cast<int>(session->get_execution_mode())));
+  return options;
+}
+
+/// 执行结束后把执行计划放回缓存
+static void set_plan_recycler(SQLStageEvent *sql_event, PlanCache &plan_cache, vector<vector<Value *>> param_slots,
+    bool chunk_mode)
+{
+  SqlResult *sql_result = sql_event->session_event()->sql_result();
+  sql_result->set_operator_recycler([&plan_cache,
+                                        key     = sql_event->plan_cache_key(),
+                                        version = sql_event->plan_cache_version(),
+                                        param_slots,
+                                        chunk_mode](unique_ptr<PhysicalOperator> oper) {
+    plan_cache.release(key, make_unique<CachedPlan>(std::move(oper), param_slots, chunk_mode), version);
+  });
+}
+
+RC PlanCacheStage::handle_request(SQLStageEvent *sql_event)
+{
+  Session *session = sql_event->session_event()->session();
+  Db      *db      = session->get_current_db();
+  if (!session->plan_cache_on() || nullptr == db || nullptr != sql_event->physical_operator()) {
+    return RC::SUCCESS;
+  }
+
+  string        normalized_sql;
+  vector<Value> params;
+  if (!PlanCache::normalize(sql_event->sql(), normalized_sql, params)) {
+    return RC::SUCCESS;
+  }
+
+  PlanCache             &plan_cache = db->plan_cache();
+  uint64_t               version    = 0;
+  const string           key        = normalized_sql + session_plan_options(session);
+  unique_ptr<CachedPlan> plan       = plan_cache.acquire(key, version);
+  sql_event->set_plan_cache_context(key, std::move(params), version);
+  if (nullptr == plan) {
+    LOG_TRACE("plan cache miss. sql=%s", normalized_sql.c_str());
+    return RC::SUCCESS;
+  }
+
+  RC rc = plan->bind(sql_event->plan_cache_params());
+  if (OB_FAIL(rc)) {
+    // 丢弃这个计划，重新生成
+    LOG_WARN("failed to bind params to cached plan. rc=%s", strrc(rc));
+    return RC::SUCCESS;
+  }
+
+  LOG_TRACE("plan cache hit. sql=%s", normalized_sql.c_str());
+  session->set_used_chunk_mode(plan->chunk_mode());
+  set_plan_recycler(sql_event, plan_cache, plan->params(), plan->chunk_mode());
+  sql_event->set_operator(std::move(plan->oper()));
+  return RC::SUCCESS;
+}
+
+RC PlanCacheStage::handle_plan(SQLStageEvent *sql_event)
+{
+  unique_ptr<PhysicalOperator> &oper = sql_event->physical_operator();
+  if (sql_event->plan_cache_key().empty() || nullptr == oper || nullptr == sql_event->stmt() ||
+      sql_event->stmt()->type() != StmtType::SELECT) {
+    return RC::SUCCESS;
+  }
+
+  vector<vector<Value *>> param_slots;
+  if (!PlanCache::bind_params(*oper, sql_event->plan_cache_params(), param_slots)) {
+    LOG_TRACE("plan is not cacheable. sql=%s", sql_event->sql().c_str());
+    return RC::SUCCESS;
+  }
+
+  Session *session = sql_event->session_event()->session();
+  set_plan_recycler(sql_event, session->get_current_db()->plan_cache(), std::move(param_slots), session->used_chunk_mode());
+  return RC::SUCCESS;
+}
@@ -16,11 +16,30 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/sys/rc.h"
 
+class SQLStageEvent;
+
 /**
  * @brief 尝试从Plan的缓存中获取Plan，如果没有命中，则执行Optimizer
  * @ingroup SQLStage
- * @details 实际上现在什么都没做。不过PlanCache对数据库的优化提升明显，是一个非常有趣的功能，
- * 感兴趣的同学可以参考OceanBase的实现
+ * @details 缓存以参数化之后的SQL为key，只有常量不同的select语句可以复用同一个执行计划，
+ * 命中时跳过解析、语义分析和优化阶段。缓存放在Db中，参考 PlanCache。
  */
 class PlanCacheStage
-{};
+{
+public:
+  PlanCacheStage()          = default;
+  virtual ~PlanCacheStage() = default;
+
+public:
+  /**
+   * @brief 查找缓存的执行计划
+   * @details 命中时把执行计划设置到sql_event中
+   */
+  RC handle_request(SQLStageEvent *sql_event);
+
+  /**
+   * @brief 优化阶段之后调用
+   * @details 如果生成的执行计划可以复用，在执行结束后把它放到缓存中
+   */
+  RC handle_plan(SQLStageEvent *sql_event);
+};
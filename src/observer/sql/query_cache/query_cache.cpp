@@ -0,0 +1,224 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <string.h>
+
+#include "sql/query_cache/query_cache.h"
+#include "common/log/log.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+
+CachedResult::CachedResult(const TupleSchema &schema, vector<vector<Value>> rows, vector<QueryCacheTable> tables)
+    : schema_(schema), rows_(std::move(rows)), tables_(std::move(tables))
+{
+  memory_size_ = sizeof(*this);
+  for (const vector<Value> &row : rows_) {
+    memory_size_ += row_memory_size(row);
+  }
+  for (const QueryCacheTable &table : tables_) {
+    memory_size_ += sizeof(table) + table.name.size();
+  }
+  for (int i = 0; i < schema_.cell_num(); i++) {
+    const TupleCellSpec &spec = schema_.cell_at(i);
+    memory_size_ += sizeof(spec) + strlen(spec.table_name()) + strlen(spec.field_name()) + strlen(spec.alias());
+  }
+}
+
+size_t CachedResult::row_memory_size(const vector<Value> &row)
+{
+  size_t size = sizeof(row);
+  for (const Value &value : row) {
+    size += sizeof(value);
+    if (value.attr_type() == AttrType::CHARS) {
+      size += value.length();
+    }
+  }
+  return size;
+}
+
+QueryCache &QueryCache::instance()
+{
+  static QueryCache instance;
+  return instance;
+}
+
+static void snapshot_tables_recursive(PhysicalOperator &oper, vector<QueryCacheTable> &tables)
+{
+  vector<Table *> oper_tables;
+  oper.collect_tables(oper_tables);
+  for (Table *table : oper_tables) {
+    bool exists = false;
+    for (const QueryCacheTable &cache_table : tables) {
+      if (cache_table.table_id == table->table_id()) {
+        exists = true;
+        break;
+      }
+    }
+
+    if (!exists) {
+      tables.push_back(QueryCacheTable{table->name(), table->table_id(), table->modify_version()});
+    }
+  }
+
+  for (unique_ptr<PhysicalOperator> &child : oper.children()) {
+    snapshot_tables_recursive(*child, tables);
+  }
+}
+
+void QueryCache::snapshot_tables(PhysicalOperator &oper, vector<QueryCacheTable> &tables)
+{
+  tables.clear();
+  snapshot_tables_recursive(oper, tables);
+}
+
+/// 结果依赖的表都没有变化时，结果才有效
+static bool is_valid_result(const CachedResult &result, Db &db)
+{
+  for (const QueryCacheTable &cache_table : result.tables()) {
+    Table *table = db.find_table(cache_table.name.c_str());
+    if (nullptr == table || table->table_id() != cache_table.table_id ||
+        table->modify_version() != cache_table.modify_version) {
+      return false;
+    }
+  }
+  return true;
+}
+
+shared_ptr<const CachedResult> QueryCache::get(const string &key, Db &db)
+{
+  lock_guard<mutex> guard(lock_);
+  auto              iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    miss_count_++;
+    return nullptr;
+  }
+
+  shared_ptr<const CachedResult> result = iter->second->result;
+  if (!is_valid_result(*result, db)) {
+    LOG_TRACE("drop stale query result. key=%s", key.c_str());
+    erase(key);
+    miss_count_++;
+    return nullptr;
+  }
+
+  lru_list_.splice(lru_list_.begin(), lru_list_, iter->second);
+  hit_count_++;
+  return result;
+}
+
+void QueryCache::put(const string &key, shared_ptr<const CachedResult> result)
+{
+  if (result->memory_size() > max_result_size()) {
+    LOG_TRACE("query result is too large to cache. key=%s, size=%lu", key.c_str(), result->memory_size());
+    return;
+  }
+
+  lock_guard<mutex> guard(lock_);
+  erase(key);
+
+  memory_size_ += result->memory_size();
+  lru_list_.push_front(Entry{key, std::move(result)});
+  entries_.emplace(key, lru_list_.begin());
+  evict_if_needed();
+}
+
+void QueryCache::clear()
+{
+  lock_guard<mutex> guard(lock_);
+  entries_.clear();
+  lru_list_.clear();
+  memory_size_ = 0;
+}
+
+void QueryCache::set_capacity(size_t capacity)
+{
+  lock_guard<mutex> guard(lock_);
+  capacity_ = capacity;
+  evict_if_needed();
+}
+
+size_t QueryCache::size() const
+{
+  lock_guard<mutex> guard(lock_);
+  return entries_.size();
+}
+
+size_t QueryCache::memory_size() const
+{
+  lock_guard<mutex> guard(lock_);
+  return memory_size_;
+}
+
+void QueryCache::erase(const string &key)
+{
+  auto iter = entries_.find(key);
+  if (iter == entries_.end()) {
+    return;
+  }
+
+  memory_size_ -= iter->second->result->memory_size();
+  lru_list_.erase(iter->second);
+  entries_.erase(iter);
+}
+
+void QueryCache::evict_if_needed()
+{
+  while (!lru_list_.empty() && memory_size_ > capacity_.load()) {
+    erase(lru_list_.back().key);
+  }
+}
+
+QueryResultCollector::QueryResultCollector(QueryCache &cache, const string &key, vector<QueryCacheTable> tables)
+    : cache_(cache), key_(key), tables_(std::move(tables)), max_memory_size_(cache.max_result_size())
+{}
+
+bool QueryResultCollector::add_row(vector<Value> &&row)
+{
+  memory_size_ += CachedResult::row_memory_size(row);
+  if (memory_size_ > max_memory_size_) {
+    LOG_TRACE("query result is too large to cache. key=%s", key_.c_str());
+    return false;
+  }
+
+  rows_.emplace_back(std::move(row));
+  return true;
+}
+
+bool QueryResultCollector::collect(const Tuple &tuple)
+{
+  vector<Value> row(tuple.cell_num());
+  for (int i = 0; i < tuple.cell_num(); i++) {
+    RC rc = tuple.cell_at(i, row[i]);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get cell of tuple. index=%d, rc=%s", i, strrc(rc));
+      return false;
+    }
+  }
+  return add_row(std::move(row));
+}
+
+bool QueryResultCollector::collect(const Chunk &chunk)
+{
+  for (int i = 0; i < chunk.selected_rows(); i++) {
+    vector<Value> row(chunk.column_num());
+    for (int col_idx = 0; col_idx < chunk.column_num(); col_idx++) {
+      row[col_idx] = chunk.get_value(col_idx, chunk.row_index(i));
+    }
+    if (!add_row(std::move(row))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void QueryResultCollector::finish(const TupleSchema &schema)
+{
+  cache_.put(key_, make_shared<const CachedResult>(schema, std::move(rows_), std::move(tables_)));
+}
@@ -0,0 +1,149 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/list.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "common/value.h"
+#include "sql/executor/sql_result.h"
+
+class Db;
+
+/**
+ * @brief 查询结果依赖的一张表
+ * @details 记录查询执行之前表的修改版本号，版本号变化说明表被修改过，缓存的结果失效
+ */
+struct QueryCacheTable
+{
+  string   name;
+  int32_t  table_id       = -1;
+  uint64_t modify_version = 0;
+};
+
+/**
+ * @brief 缓存的查询结果
+ * @ingroup SQLStage
+ * @details 放到缓存之后不会再修改，多个请求可以同时读取
+ */
+class CachedResult
+{
+public:
+  CachedResult(const TupleSchema &schema, vector<vector<Value>> rows, vector<QueryCacheTable> tables);
+
+  const TupleSchema             &schema() const { return schema_; }
+  const vector<vector<Value>>   &rows() const { return rows_; }
+  const vector<QueryCacheTable> &tables() const { return tables_; }
+
+  /// 估算的内存占用
+  size_t memory_size() const { return memory_size_; }
+
+  static size_t row_memory_size(const vector<Value> &row);
+
+private:
+  TupleSchema             schema_;
+  vector<vector<Value>>   rows_;
+  vector<QueryCacheTable> tables_;
+  size_t                  memory_size_ = 0;
+};
+
+/**
+ * @brief 查询结果缓存
+ * @ingroup SQLStage
+ * @details 全局一个，缓存只读 select 语句的结果，key 由调用者决定（SQL原文、数据库和执行模式）。
+ * 按照结果的内存大小做 LRU 淘汰。缓存的结果不会主动失效，查找时检查它读取的每张表，
+ * 如果表被删除重建或者修改版本号变了，就丢弃这个结果。
+ */
+class QueryCache
+{
+public:
+  QueryCache() = default;
+
+  static QueryCache &instance();
+
+  /**
+   * @brief 收集执行计划读取的所有表，以及它们当前的修改版本号
+   * @details 需要在执行之前调用，执行过程中发生的修改都会让结果失效
+   */
+  static void snapshot_tables(PhysicalOperator &oper, vector<QueryCacheTable> &tables);
+
+  /**
+   * @brief 查找缓存的结果
+   * @param db 当前的数据库，用来检查结果依赖的表是否修改过
+   * @return 没有或者已经失效时返回 nullptr
+   */
+  shared_ptr<const CachedResult> get(const string &key, Db &db);
+
+  void put(const string &key, shared_ptr<const CachedResult> result);
+
+  void clear();
+
+  /// 缓存的总内存大小，单位字节
+  void   set_capacity(size_t capacity);
+  size_t capacity() const { return capacity_.load(); }
+  /// 单个结果最多占用的内存，避免一个大结果把缓存都挤掉
+  size_t max_result_size() const { return capacity_.load() / 16; }
+
+  int64_t hit_count() const { return hit_count_.load(); }
+  int64_t miss_count() const { return miss_count_.load(); }
+  size_t  size() const;
+  size_t  memory_size() const;
+
+private:
+  void erase(const string &key);
+  void evict_if_needed();
+
+private:
+  struct Entry
+  {
+    string                         key;
+    shared_ptr<const CachedResult> result;
+  };
+
+  mutable mutex                                lock_;
+  list<Entry>                                  lru_list_;  ///< 头部是最近使用的
+  unordered_map<string, list<Entry>::iterator> entries_;
+  size_t                                       memory_size_ = 0;
+
+  atomic<size_t>  capacity_{64 * 1024 * 1024};
+  atomic<int64_t> hit_count_{0};
+  atomic<int64_t> miss_count_{0};
+};
+
+/**
+ * @brief 把查询返回的结果收集起来，成功返回所有结果之后放到查询缓存中
+ * @ingroup SQLStage
+ */
+class QueryResultCollector : public ResultCollector
+{
+public:
+  QueryResultCollector(QueryCache &cache, const string &key, vector<QueryCacheTable> tables);
+  virtual ~QueryResultCollector() = default;
+
+  bool collect(const Tuple &tuple) override;
+  bool collect(const Chunk &chunk) override;
+  void finish(const TupleSchema &schema) override;
+
+private:
+  bool add_row(vector<Value> &&row);
+
+private:
+  QueryCache             &cache_;
+  string                  key_;
+  vector<QueryCacheTable> tables_;
+  vector<vector<Value>>   rows_;
+  size_t                  memory_size_     = 0;
+  size_t                  max_memory_size_ = 0;
+};
@@ -12,18 +12,80 @@ See the Mulan PSL v2 for more details. */
 // Created by Longda on 2021/4/13.
 //
 
+#include <ctype.h>
 #include <string.h>
+#include <strings.h>
 
 #include "query_cache_stage.h"
 
-#include "common/conf/ini.h"
-#include "common/io/io.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
+#include "event/session_event.h"
+#include "event/sql_event.h"
+#include "session/session.h"
+#include "sql/executor/sql_result.h"
+#include "sql/operator/cached_result_physical_operator.h"
+#include "sql/query_cache/query_cache.h"
+#include "sql/stmt/stmt.h"
+#include "storage/db/db.h"
 
 using namespace common;
 
+static bool is_select_sql(const string &sql)
+{
+  size_t pos = 0;
+  while (pos < sql.size() && isspace(static_cast<unsigned char>(sql[pos]))) {
+    pos++;
+  }
+
+  const char  *select_keyword = "select";
+  const size_t keyword_len    = strlen(select_keyword);
+  return sql.size() > pos + keyword_len && strncasecmp(sql.c_str() + pos, select_keyword, keyword_len) == 0 &&
+         !isalnum(static_cast<unsigned char>(sql[pos + keyword_len])) && sql[pos + keyword_len] != '_';
+}
+
 RC QueryCacheStage::handle_request(SQLStageEvent *sql_event)
 {
+  Session *session = sql_event->session_event()->session();
+  Db      *db      = session->get_current_db();
+  // sql_debug 需要输出执行过程中的调试信息，不能直接返回缓存的结果
+  if (!session->query_cache_on() || nullptr == db || session->is_trx_multi_operation_mode() ||
+      session->sql_debug_on() || !is_select_sql(sql_event->sql())) {
+    return RC::SUCCESS;
+  }
+
+  string key;
+  key.append("db=").append(db->name());
+  key.append("|execution_mode=").append(std::to_string(static_cast<int>(session->get_execution_mode())));
+  key.append("|").append(sql_event->sql());
+
+  shared_ptr<const CachedResult> result = QueryCache::instance().get(key, *db);
+  if (nullptr == result) {
+    LOG_TRACE("query cache miss. sql=%s", sql_event->sql().c_str());
+    sql_event->set_query_cache_key(key);
+    return RC::SUCCESS;
+  }
+
+  LOG_TRACE("query cache hit. sql=%s, rows=%lu", sql_event->sql().c_str(), result->rows().size());
+  session->set_used_chunk_mode(false);
+  sql_event->set_operator(make_unique<CachedResultPhysicalOperator>(std::move(result)));
+  return RC::SUCCESS;
+}
+
+RC QueryCacheStage::handle_plan(SQLStageEvent *sql_event)
+{
+  unique_ptr<PhysicalOperator> &oper = sql_event->physical_operator();
+  if (sql_event->query_cache_key().empty() || nullptr == oper ||
+      (nullptr != sql_event->stmt() && sql_event->stmt()->type() != StmtType::SELECT)) {
+    return RC::SUCCESS;
+  }
+
+  // 执行之前记录版本号，执行过程中发生的修改也会让这次的结果失效
+  vector<QueryCacheTable> tables;
+  QueryCache::snapshot_tables(*oper, tables);
+
+  SqlResult *sql_result = sql_event->session_event()->sql_result();
+  sql_result->set_result_collector(
+      make_unique<QueryResultCollector>(QueryCache::instance(), sql_event->query_cache_key(), std::move(tables)));
   return RC::SUCCESS;
 }
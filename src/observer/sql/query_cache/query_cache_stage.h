@@ -21,7 +21,9 @@ class SQLStageEvent;
 /**
  * @brief 查询缓存处理
  * @ingroup SQLStage
- * @details 当前什么都没做
+ * @details 缓存自动提交模式下只读 select 语句的结果，key 是 SQL 原文、当前数据库和执行模式。
+ * 命中时跳过后面所有的阶段，直接返回缓存的结果。缓存的结果在它读取的表被修改后失效，参考 QueryCache。
+ * 多语句事务中的查询可能看到自己未提交的修改，既不使用也不填充缓存。
  */
 class QueryCacheStage
 {
@@ -30,5 +32,15 @@ public:
   virtual ~QueryCacheStage() = default;
 
 public:
+  /**
+   * @brief 查找缓存的结果
+   * @details 命中时把返回缓存结果的算子设置到sql_event中
+   */
   RC handle_request(SQLStageEvent *sql_event);
+
+  /**
+   * @brief 生成执行计划之后调用
+   * @details 记录执行计划读取的表的版本号，查询成功结束后把结果放到缓存中
+   */
+  RC handle_plan(SQLStageEvent *sql_event);
 };
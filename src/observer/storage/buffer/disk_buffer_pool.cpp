@@ -17,8 +17,10 @@ See the Mulan PSL v2 for more details. */
 #include "common/io/io.h"
 #include "common/lang/mutex.h"
 #include "common/lang/algorithm.h"
+#include "common/lang/limits.h"
 #include "common/log/log.h"
 #include "common/math/crc.h"
+#include "common/thread/thread_pool_executor.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/buffer/buffer_pool_log.h"
 #include "storage/db/db.h"
@@ -51,82 +53,145 @@ RC BPFrameManager::init(int pool_num)
 
 RC BPFrameManager::cleanup()
 {
-  if (frames_.count() > 0) {
+  if (frame_num() > 0) {
     return RC::INTERNAL;
   }
 
-  frames_.destroy();
   return RC::SUCCESS;
 }
 
-int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
+BPFrameManager::Shard &BPFrameManager::shard_of(const FrameId &frame_id)
 {
-  lock_guard<mutex> lock_guard(lock_);
+  return shards_[frame_id.hash() % SHARD_NUM];
+}
 
-  vector<Frame *> frames_can_purge;
+void BPFrameManager::pick_victims(Shard &shard, int count, bool cold_only, vector<Frame *> &victims)
+{
+  auto pick_from = [&victims, count](list<Frame *> &frame_list) {
+    for (auto iter = frame_list.rbegin();
+         iter != frame_list.rend() && victims.size() < static_cast<size_t>(count); ++iter) {
+      Frame *frame = *iter;
+      if (frame->can_purge()) {
+        frame->pin();
+        victims.push_back(frame);
+      }
+    }
+  };
+
+  // 冷链表足够长时先淘汰冷链表中的页面，保护热链表
+  const size_t cold_min_size = shard.frames.size() * COLD_LIST_MIN_PERCENT / 100;
+  const bool   prefer_cold   = shard.cold_list.size() > cold_min_size || shard.hot_list.empty();
+  if (cold_only) {
+    if (prefer_cold) {
+      pick_from(shard.cold_list);
+    }
+  } else if (prefer_cold) {
+    pick_from(shard.cold_list);
+    pick_from(shard.hot_list);
+  } else {
+    pick_from(shard.hot_list);
+    pick_from(shard.cold_list);
+  }
+}
+
+int BPFrameManager::purge_frames(int count, function<RC(Frame *frame)> purger)
+{
   if (count <= 0) {
     count = 1;
   }
+
+  int             freed_count = 0;
+  vector<Frame *> frames_can_purge;
   frames_can_purge.reserve(count);
 
-  auto purge_finder = [&frames_can_purge, count](const FrameId &frame_id, Frame *const frame) {
-    if (frame->can_purge()) {
-      frame->pin();
-      frames_can_purge.push_back(frame);
-      if (frames_can_purge.size() >= static_cast<size_t>(count)) {
-        return false;  // false to break the progress
+  // 第一轮只淘汰各个分片冷链表中的页面，不够的时候才淘汰热页面
+  const int start_shard = purge_cursor_.fetch_add(1) % SHARD_NUM;
+  for (int round = 0; round < 2 && freed_count < count; round++) {
+    const bool cold_only = (round == 0);
+    for (int i = 0; i < SHARD_NUM && freed_count < count; i++) {
+      Shard &shard = shards_[(start_shard + i) % SHARD_NUM];
+
+      frames_can_purge.clear();
+      {
+        lock_guard<mutex> lock_guard(shard.lock);
+        pick_victims(shard, count - freed_count, cold_only, frames_can_purge);
       }
-    }
-    return true;  // true continue to look up
-  };
 
-  frames_.foreach_reverse(purge_finder);
-  LOG_INFO("purge frames find %ld pages total", frames_can_purge.size());
-
-  /// 当前还在frameManager的锁内，而 purger 是一个非常耗时的操作
-  /// 他需要把脏页数据刷新到磁盘上去，所以这里会极大地降低并发度
-  int freed_count = 0;
-  for (Frame *frame : frames_can_purge) {
-    RC rc = purger(frame);
-    if (RC::SUCCESS == rc) {
-      free_internal(frame->frame_id(), frame);
-      freed_count++;
-    } else {
-      frame->unpin();
-      LOG_WARN("failed to purge frame. frame_id=%s, rc=%s", 
-               frame->frame_id().to_string().c_str(), strrc(rc));
+      /// purger 需要把脏页数据刷新到磁盘上去，是一个非常耗时的操作，所以不持有分片的锁。
+      /// 选出来的页面已经被 pin 住，不会被其它线程淘汰
+      for (Frame *frame : frames_can_purge) {
+        RC rc = purger(frame);
+
+        lock_guard<mutex> lock_guard(shard.lock);
+        // 刷盘的过程中其它线程可能又访问了这个页面
+        if (RC::SUCCESS == rc && frame->pin_count() == 1 && !frame->dirty()) {
+          free_internal(shard, frame->frame_id(), frame);
+          freed_count++;
+        } else {
+          frame->unpin();
+          if (OB_FAIL(rc)) {
+            LOG_WARN("failed to purge frame. frame_id=%s, rc=%s", frame->frame_id().to_string().c_str(), strrc(rc));
+          }
+        }
+      }
     }
   }
-  LOG_INFO("purge frame done. number=%d", freed_count);
+
+  LOG_DEBUG("purge frame done. number=%d", freed_count);
   return freed_count;
 }
 
 Frame *BPFrameManager::get(int buffer_pool_id, PageNum page_num)
 {
-  FrameId                     frame_id(buffer_pool_id, page_num);
+  FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
-  return get_internal(frame_id);
+  lock_guard<mutex> lock_guard(shard.lock);
+  return get_internal(shard, frame_id);
 }
 
-Frame *BPFrameManager::get_internal(const FrameId &frame_id)
+Frame *BPFrameManager::get_internal(Shard &shard, const FrameId &frame_id)
 {
-  Frame *frame = nullptr;
-  (void)frames_.get(frame_id, frame);
-  if (frame != nullptr) {
-    frame->pin();
-    LOG_DEBUG("got a frame. frame=%s", frame->to_string().c_str());
+  auto iter = shard.frames.find(frame_id);
+  if (iter == shard.frames.end()) {
+    return nullptr;
+  }
+
+  // 再次访问的页面移动到热链表的头部。预读的页面第一次被访问时，只算作一次访问
+  FrameEntry &entry = iter->second;
+  if (entry.prefetched) {
+    shard.cold_list.splice(shard.cold_list.begin(), shard.cold_list, entry.pos);
+    entry.prefetched = false;
+  } else if (entry.hot) {
+    shard.hot_list.splice(shard.hot_list.begin(), shard.hot_list, entry.pos);
+  } else {
+    shard.hot_list.splice(shard.hot_list.begin(), shard.cold_list, entry.pos);
+    entry.hot = true;
   }
+
+  Frame *frame = entry.frame;
+  frame->pin();
+  LOG_DEBUG("got a frame. frame=%s", frame->to_string().c_str());
   return frame;
 }
 
-Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num)
+bool BPFrameManager::contains(int buffer_pool_id, PageNum page_num)
 {
   FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
+
+  lock_guard<mutex> lock_guard(shard.lock);
+  return shard.frames.find(frame_id) != shard.frames.end();
+}
 
-  lock_guard<mutex> lock_guard(lock_);
+Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num, bool prefetch /* = false */)
+{
+  FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
 
-  Frame                      *frame = get_internal(frame_id);
+  lock_guard<mutex> lock_guard(shard.lock);
+
+  Frame *frame = get_internal(shard, frame_id);
   if (frame != nullptr) {
     return frame;
   }
@@ -138,7 +203,9 @@ Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num)
     frame->set_buffer_pool_id(buffer_pool_id);
     frame->set_page_num(page_num);
     frame->pin();
-    frames_.put(frame_id, frame);
+
+    shard.cold_list.push_front(frame);
+    shard.frames.emplace(frame_id, FrameEntry{frame, false, shard.cold_list.begin(), prefetch});
     LOG_DEBUG("allocate a new frame. frame=%s", frame->to_string().c_str());
   }
   return frame;
@@ -147,46 +214,119 @@ Frame *BPFrameManager::alloc(int buffer_pool_id, PageNum page_num)
 RC BPFrameManager::free(int buffer_pool_id, PageNum page_num, Frame *frame)
 {
   FrameId frame_id(buffer_pool_id, page_num);
+  Shard  &shard = shard_of(frame_id);
 
-  lock_guard<mutex> lock_guard(lock_);
-  return free_internal(frame_id, frame);
+  lock_guard<mutex> lock_guard(shard.lock);
+  return free_internal(shard, frame_id, frame);
 }
 
-RC BPFrameManager::free_internal(const FrameId &frame_id, Frame *frame)
+RC BPFrameManager::free_internal(Shard &shard, const FrameId &frame_id, Frame *frame)
 {
-  Frame                *frame_source = nullptr;
-  [[maybe_unused]] bool found        = frames_.get(frame_id, frame_source);
-  ASSERT(found && frame == frame_source && frame->pin_count() == 1,
+  auto                  iter  = shard.frames.find(frame_id);
+  [[maybe_unused]] bool found = iter != shard.frames.end();
+  ASSERT(found && frame == iter->second.frame && frame->pin_count() == 1,
       "failed to free frame. found=%d, frameId=%s, frame_source=%p, frame=%p, pinCount=%d, lbt=%s",
-      found, frame_id.to_string().c_str(), frame_source, frame, frame->pin_count(), lbt());
+      found, frame_id.to_string().c_str(), found ? iter->second.frame : nullptr, frame, frame->pin_count(), lbt());
+
+  FrameEntry &entry = iter->second;
+  (entry.hot ? shard.hot_list : shard.cold_list).erase(entry.pos);
+  shard.frames.erase(iter);
 
   frame->set_page_num(-1);
   frame->unpin();
-  frames_.remove(frame_id);
   allocator_.free(frame);
   return RC::SUCCESS;
 }
 
 list<Frame *> BPFrameManager::find_list(int buffer_pool_id)
 {
-  lock_guard<mutex> lock_guard(lock_);
-
   list<Frame *> frames;
-  auto               fetcher = [&frames, buffer_pool_id](const FrameId &frame_id, Frame *const frame) -> bool {
-    if (buffer_pool_id == frame_id.buffer_pool_id()) {
-      frame->pin();
-      frames.push_back(frame);
+  for (Shard &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard.lock);
+    for (auto &[frame_id, entry] : shard.frames) {
+      if (buffer_pool_id == frame_id.buffer_pool_id()) {
+        entry.frame->pin();
+        frames.push_back(entry.frame);
+      }
     }
-    return true;
-  };
-  frames_.foreach (fetcher);
+  }
   return frames;
 }
 
+vector<Frame *> BPFrameManager::find_dirty_list()
+{
+  vector<Frame *> frames;
+  for (Shard &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard.lock);
+    for (auto &[frame_id, entry] : shard.frames) {
+      if (entry.frame->dirty()) {
+        entry.frame->pin();
+        frames.push_back(entry.frame);
+      }
+    }
+  }
+  return frames;
+}
+
+bool BPFrameManager::min_recovery_lsn(LSN &lsn)
+{
+  bool found          = false;
+  auto update_min_lsn = [&found, &lsn](const Frame *frame) {
+    const LSN recovery_lsn = frame->clean_lsn() + 1;
+    if (!found || recovery_lsn < lsn) {
+      lsn   = recovery_lsn;
+      found = true;
+    }
+  };
+
+  vector<Frame *> using_frames;
+  for (Shard &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard.lock);
+    for (auto &[frame_id, entry] : shard.frames) {
+      Frame *frame = entry.frame;
+      if (frame->dirty()) {
+        update_min_lsn(frame);
+      } else if (frame->pin_count() > 0) {
+        frame->pin();
+        using_frames.push_back(frame);
+      }
+    }
+  }
+
+  /// 正在使用的页面可能已经写了日志，但是还没有标记为脏页。
+  /// 修改页面时会一直持有页面的写锁，拿到读锁之后再检查一次就不会漏掉
+  for (Frame *frame : using_frames) {
+    frame->read_latch();
+    if (frame->dirty()) {
+      update_min_lsn(frame);
+    }
+    frame->read_unlatch();
+    frame->unpin();
+  }
+  return found;
+}
+
+size_t BPFrameManager::free_frame_num() const
+{
+  const size_t total_num = total_frame_num();
+  const size_t used_num  = frame_num();
+  return total_num > used_num ? total_num - used_num : 0;
+}
+
+size_t BPFrameManager::frame_num() const
+{
+  size_t count = 0;
+  for (const Shard &shard : shards_) {
+    lock_guard<mutex> lock_guard(shard.lock);
+    count += shard.frames.size();
+  }
+  return count;
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 BufferPoolIterator::BufferPoolIterator() {}
 BufferPoolIterator::~BufferPoolIterator() {}
-RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
+RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */, int read_ahead_pages /* = 0 */)
 {
   bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
   if (start_page <= 0) {
@@ -194,6 +334,11 @@ RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
   } else {
     current_page_num_ = start_page - 1;
   }
+
+  buffer_pool_        = &bp;
+  read_ahead_pages_   = read_ahead_pages;
+  read_ahead_trigger_ = current_page_num_ + 1;
+  read_ahead_end_     = current_page_num_;
   return RC::SUCCESS;
 }
 
@@ -204,13 +349,44 @@ PageNum BufferPoolIterator::next()
   PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
   if (next_page != -1) {
     current_page_num_ = next_page;
+    if (read_ahead_pages_ > 0 && next_page >= read_ahead_trigger_) {
+      read_ahead(next_page);
+    }
   }
   return next_page;
 }
 
+void BufferPoolIterator::read_ahead(PageNum page_num)
+{
+  // 预读从当前页面之后开始，已经预读过的页面不再重复预读
+  vector<PageNum> page_nums;
+  page_nums.reserve(read_ahead_pages_);
+  PageNum current = max(page_num, read_ahead_end_);
+  while (static_cast<int>(page_nums.size()) < read_ahead_pages_) {
+    current = bitmap_.next_setted_bit(current + 1);
+    if (current == -1) {
+      break;
+    }
+    page_nums.push_back(current);
+  }
+
+  if (page_nums.empty()) {
+    // 后面没有页面了，不用再预读
+    read_ahead_trigger_ = numeric_limits<PageNum>::max();
+    return;
+  }
+
+  // 预读失败不影响遍历
+  (void)buffer_pool_->read_ahead(page_nums);
+  read_ahead_trigger_ = page_nums.front();
+  read_ahead_end_     = page_nums.back();
+}
+
 RC BufferPoolIterator::reset()
 {
-  current_page_num_ = 0;
+  current_page_num_   = 0;
+  read_ahead_trigger_ = current_page_num_ + 1;
+  read_ahead_end_     = current_page_num_;
   return RC::SUCCESS;
 }
 
@@ -239,7 +415,7 @@ RC DiskBufferPool::open_file(const char *file_name)
   file_desc_ = fd;
 
   Page header_page;
-  int ret = readn(file_desc_, &header_page, sizeof(header_page));
+  int ret = preadn(file_desc_, &header_page, sizeof(header_page), 0);
   if (ret != 0) {
     LOG_ERROR("Failed to read first page of %s, due to %s.", file_name, strerror(errno));
     close(fd);
@@ -283,6 +459,12 @@ RC DiskBufferPool::close_file()
     return rc;
   }
 
+  // 预读任务会访问这个文件的页面，等它们结束
+  {
+    unique_lock<mutex> read_ahead_guard(read_ahead_lock_);
+    read_ahead_cond_.wait(read_ahead_guard, [this]() { return read_ahead_tasks_ == 0; });
+  }
+
   hdr_frame_->unpin();
 
   // TODO: 理论上是在回放时回滚未提交事务，但目前没有undo log，因此不下刷数据page，只通过redo log回放
@@ -323,23 +505,39 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
     return RC::SUCCESS;
   }
 
-  scoped_lock lock_guard(lock_);  // 直接加了一把大锁，其实可以根据访问的页面来细化提高并行度
-
   // Allocate one page and load the data into this page
   Frame *allocated_frame = nullptr;
+  {
+    scoped_lock lock_guard(lock_);
+
+    // 等锁的过程中，其它线程可能已经把这个页面加载进来了
+    used_match_frame = frame_manager_.get(id(), page_num);
+    if (used_match_frame != nullptr) {
+      used_match_frame->access();
+      *frame = used_match_frame;
+      return RC::SUCCESS;
+    }
 
-  rc = allocate_frame(page_num, &allocated_frame);
-  if (rc != RC::SUCCESS) {
-    LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
-    return rc;
-  }
+    rc = allocate_frame(page_num, &allocated_frame);
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to alloc frame %s:%d, due to failed to alloc page.", file_name_.c_str(), page_num);
+      return rc;
+    }
 
-  allocated_frame->set_buffer_pool_id(id());
-  // allocated_frame->pin(); // pined in manager::get
-  allocated_frame->access();
+    allocated_frame->set_buffer_pool_id(id());
+    // allocated_frame->pin(); // pined in manager::get
+    allocated_frame->access();
 
-  if ((rc = load_page(page_num, allocated_frame)) != RC::SUCCESS) {
+    // 加载完成之前一直持有写锁，其它线程拿到这个frame之后，加读写锁时会等待加载完成
+    allocated_frame->write_latch();
+  }
+
+  // 读磁盘时不持有 lock_，同一个文件中不同页面的加载可以并行
+  rc = load_page(page_num, allocated_frame);
+  allocated_frame->write_unlatch();
+  if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to load page %s:%d", file_name_.c_str(), page_num);
+    scoped_lock lock_guard(lock_);
     purge_frame(page_num, allocated_frame);
     return rc;
   }
@@ -348,6 +546,115 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
   return RC::SUCCESS;
 }
 
+RC DiskBufferPool::read_ahead(span<const PageNum> page_nums)
+{
+  vector<PageNum> absent_pages;
+  absent_pages.reserve(page_nums.size());
+  for (PageNum page_num : page_nums) {
+    if (!frame_manager_.contains(id(), page_num)) {
+      absent_pages.push_back(page_num);
+    }
+  }
+
+  if (absent_pages.empty()) {
+    return RC::SUCCESS;
+  }
+
+#ifdef POSIX_FADV_WILLNEED
+  // 页号连续的页面合并成一次请求，操作系统会在后台把它们读到 page cache 中
+  size_t start = 0;
+  for (size_t i = 1; i <= absent_pages.size(); i++) {
+    if (i < absent_pages.size() && absent_pages[i] == absent_pages[i - 1] + 1) {
+      continue;
+    }
+
+    const off_t offset = static_cast<off_t>(absent_pages[start]) * BP_PAGE_SIZE;
+    const off_t length = static_cast<off_t>(i - start) * BP_PAGE_SIZE;
+    int         ret    = posix_fadvise(file_desc_, offset, length, POSIX_FADV_WILLNEED);
+    if (ret != 0) {
+      LOG_TRACE("failed to advise file. file=%s, offset=%ld, length=%ld, error=%s",
+                file_name_.c_str(), offset, length, strerror(ret));
+    }
+    start = i;
+  }
+#endif
+
+  ThreadPoolExecutor *executor = bp_manager_.read_ahead_executor();
+  if (executor == nullptr) {
+    return RC::SUCCESS;
+  }
+
+  {
+    lock_guard<mutex> read_ahead_guard(read_ahead_lock_);
+    read_ahead_tasks_++;
+  }
+
+  auto task = [this, absent_pages = std::move(absent_pages)]() {
+    for (PageNum page_num : absent_pages) {
+      if (OB_FAIL(prefetch_page(page_num))) {
+        break;
+      }
+    }
+
+    lock_guard<mutex> read_ahead_guard(read_ahead_lock_);
+    read_ahead_tasks_--;
+    read_ahead_cond_.notify_all();
+  };
+
+  if (executor->execute(task) != 0) {
+    LOG_WARN("failed to submit read ahead task. file=%s", file_name_.c_str());
+    lock_guard<mutex> read_ahead_guard(read_ahead_lock_);
+    read_ahead_tasks_--;
+    read_ahead_cond_.notify_all();
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::prefetch_page(PageNum page_num)
+{
+  Frame *allocated_frame = nullptr;
+  {
+    scoped_lock lock_guard(lock_);
+
+    if (frame_manager_.contains(id(), page_num)) {
+      return RC::SUCCESS;
+    }
+
+    allocated_frame = frame_manager_.alloc(id(), page_num, true /*prefetch*/);
+    if (allocated_frame == nullptr) {
+      // 预读不应该为了腾出页帧而等待，只尝试淘汰一次
+      (void)frame_manager_.purge_frames(1 /*count*/, [this](Frame *frame) {
+        if (!frame->dirty()) {
+          return RC::SUCCESS;
+        }
+        return frame->buffer_pool_id() == id() ? flush_page_internal(*frame) : bp_manager_.flush_page(*frame);
+      });
+      allocated_frame = frame_manager_.alloc(id(), page_num, true /*prefetch*/);
+    }
+
+    if (allocated_frame == nullptr) {
+      LOG_TRACE("no free frame for read ahead. file=%s, page num=%d", file_name_.c_str(), page_num);
+      return RC::BUFFERPOOL_NOBUF;
+    }
+
+    allocated_frame->set_buffer_pool_id(id());
+    allocated_frame->write_latch();
+  }
+
+  RC rc = load_page(page_num, allocated_frame);
+  allocated_frame->write_unlatch();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to prefetch page. file=%s, page num=%d, rc=%s", file_name_.c_str(), page_num, strrc(rc));
+    scoped_lock lock_guard(lock_);
+    purge_frame(page_num, allocated_frame);
+    return rc;
+  }
+
+  allocated_frame->unpin();
+  return RC::SUCCESS;
+}
+
 RC DiskBufferPool::allocate_page(Frame **frame)
 {
   RC rc = RC::SUCCESS;
@@ -389,6 +696,8 @@ RC DiskBufferPool::allocate_page(Frame **frame)
     return RC::BUFFERPOOL_NOBUF;
   }
 
+  // 先标记为脏页再写日志，做检查点时就不会漏掉这次修改
+  hdr_frame_->mark_dirty();
   LSN lsn = 0;
   rc = log_handler_.allocate_page(file_header_->page_count, lsn);
   if (OB_FAIL(rc)) {
@@ -414,7 +723,6 @@ RC DiskBufferPool::allocate_page(Frame **frame)
   byte = page_num / 8;
   bit  = page_num % 8;
   file_header_->bitmap[byte] |= (1 << bit);
-  hdr_frame_->mark_dirty();
 
   allocated_frame->set_buffer_pool_id(id());
   allocated_frame->access();
@@ -450,6 +758,7 @@ RC DiskBufferPool::dispose_page(PageNum page_num)
     LOG_DEBUG("page not found in memory while disposing it. pageNum=%d", page_num);
   }
 
+  hdr_frame_->mark_dirty();
   LSN lsn = 0;
   RC rc = log_handler_.deallocate_page(page_num, lsn);
   if (OB_FAIL(rc)) {
@@ -458,7 +767,6 @@ RC DiskBufferPool::dispose_page(PageNum page_num)
   }
 
   hdr_frame_->set_lsn(lsn);
-  hdr_frame_->mark_dirty();
   file_header_->allocated_pages--;
   char tmp = 1 << (page_num % 8);
   file_header_->bitmap[page_num / 8] &= ~tmp;
@@ -598,19 +906,34 @@ RC DiskBufferPool::recover_page(PageNum page_num)
 
 RC DiskBufferPool::write_page(PageNum page_num, Page &page)
 {
-  scoped_lock lock_guard(wr_lock_);
-  int64_t     offset = ((int64_t)page_num) * sizeof(Page);
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to write page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
+  int64_t offset = ((int64_t)page_num) * sizeof(Page);
+  int     ret    = pwriten(file_desc_, &page, sizeof(Page), offset);
+  if (ret != 0) {
+    LOG_ERROR("Failed to write page %lld of %d due to %s.", offset, file_desc_, strerror(ret));
+    return RC::IOERR_WRITE;
   }
 
-  if (writen(file_desc_, &page, sizeof(Page)) != 0) {
-    LOG_ERROR("Failed to write page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
+  LOG_TRACE("write_page: buffer_pool_id:%d, page_num:%d, lsn=%d, check_sum=%d", id(), page_num, page.lsn, page.check_sum);
+  return RC::SUCCESS;
+}
+
+RC DiskBufferPool::write_pages(PageNum page_num, const vector<Page *> &pages)
+{
+  vector<struct iovec> iovs(pages.size());
+  for (size_t i = 0; i < pages.size(); i++) {
+    iovs[i].iov_base = pages[i];
+    iovs[i].iov_len  = sizeof(Page);
+  }
+
+  int64_t offset = ((int64_t)page_num) * sizeof(Page);
+  int     ret    = pwritevn(file_desc_, iovs.data(), static_cast<int>(iovs.size()), offset);
+  if (ret != 0) {
+    LOG_ERROR("Failed to write pages %lld of %d due to %s. page count=%lu",
+              offset, file_desc_, strerror(ret), pages.size());
     return RC::IOERR_WRITE;
   }
 
-  LOG_TRACE("write_page: buffer_pool_id:%d, page_num:%d, lsn=%d, check_sum=%d", id(), page_num, page.lsn, page.check_sum);
+  LOG_TRACE("write_pages: buffer_pool_id:%d, page_num:%d, page count=%lu", id(), page_num, pages.size());
   return RC::SUCCESS;
 }
 
@@ -737,25 +1060,20 @@ RC DiskBufferPool::load_page(PageNum page_num, Frame *frame)
   Page &page = frame->page();
   RC rc = dblwr_manager_.read_page(this, page_num, page);
   if (OB_SUCC(rc)) {
+    frame->set_clean_lsn(page.lsn);
     return rc;
   }
 
-  scoped_lock lock_guard(wr_lock_);
-  int64_t          offset = ((int64_t)page_num) * BP_PAGE_SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page %s:%d, due to failed to lseek:%s.", file_name_.c_str(), page_num, strerror(errno));
-
-    return RC::IOERR_SEEK;
-  }
-
-  int ret = readn(file_desc_, &page, BP_PAGE_SIZE);
+  int64_t offset = ((int64_t)page_num) * BP_PAGE_SIZE;
+  int     ret    = preadn(file_desc_, &page, BP_PAGE_SIZE, offset);
   if (ret != 0) {
     LOG_ERROR("Failed to load page %s, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
-              file_name_.c_str(), file_desc_, page_num, strerror(errno), ret, file_header_->allocated_pages);
+              file_name_.c_str(), file_desc_, page_num, ret == -1 ? "eof" : strerror(ret), ret, file_header_->allocated_pages);
     return RC::IOERR_READ;
   }
 
   frame->set_page_num(page_num);
+  frame->set_clean_lsn(page.lsn);
 
   LOG_DEBUG("Load page %s:%d, file_desc:%d, frame=%s",
             file_name_.c_str(), page_num, file_desc_, frame->to_string().c_str());
@@ -778,6 +1096,11 @@ BufferPoolManager::BufferPoolManager(int memory_size /* = 0 */)
 
 BufferPoolManager::~BufferPoolManager()
 {
+  if (read_ahead_executor_) {
+    read_ahead_executor_->shutdown();
+    read_ahead_executor_->await_termination();
+  }
+
   unordered_map<string, DiskBufferPool *> tmp_bps;
   tmp_bps.swap(buffer_pools_);
 
@@ -789,6 +1112,16 @@ BufferPoolManager::~BufferPoolManager()
 RC BufferPoolManager::init(unique_ptr<DoubleWriteBuffer> dblwr_buffer)
 {
   dblwr_buffer_ = std::move(dblwr_buffer);
+
+#ifdef CONCURRENCY
+  // 页帧的锁只有在 CONCURRENCY 模式下才生效，其它线程才能安全地等待预读的页面加载完成
+  read_ahead_executor_ = make_unique<ThreadPoolExecutor>();
+  int ret = read_ahead_executor_->init("ReadAhead", 2 /*core_size*/, 2 /*max_size*/, 60 * 1000 /*keep_alive_time_ms*/);
+  if (ret != 0) {
+    LOG_WARN("failed to init read ahead executor. ret=%d", ret);
+    read_ahead_executor_.reset();
+  }
+#endif
   return RC::SUCCESS;
 }
 
@@ -821,13 +1154,7 @@ RC BufferPoolManager::create_file(const char *file_name)
 
   char *bitmap = file_header->bitmap;
   bitmap[0] |= 0x01;
-  if (lseek(fd, 0, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to seek file %s to position 0, due to %s .", file_name, strerror(errno));
-    close(fd);
-    return RC::IOERR_SEEK;
-  }
-
-  if (writen(fd, (char *)&page, BP_PAGE_SIZE) != 0) {
+  if (pwriten(fd, (char *)&page, BP_PAGE_SIZE, 0) != 0) {
     LOG_ERROR("Failed to write header to file %s, due to %s.", file_name, strerror(errno));
     close(fd);
     return RC::IOERR_WRITE;
@@ -25,11 +25,15 @@ See the Mulan PSL v2 for more details. */
 #include <time.h>
 #include <optional>
 
+#include "common/lang/atomic.h"
 #include "common/lang/bitmap.h"
-#include "common/lang/lru_cache.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/list.h"
 #include "common/lang/mutex.h"
 #include "common/lang/memory.h"
+#include "common/lang/span.h"
 #include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
 #include "common/mm/mem_pool.h"
 #include "common/sys/rc.h"
 #include "common/types.h"
@@ -43,6 +47,10 @@ class DoubleWriteBuffer;
 class LogHandler;
 class BufferPoolLogHandler;
 
+namespace common {
+class ThreadPoolExecutor;
+}
+
 /**
  * @brief BufferPool 的实现
  * @defgroup BufferPool
@@ -84,6 +92,11 @@ struct BPFileHeader
  * 当内存中的页帧不够用时，需要从内存中淘汰一些页帧，以便为新的页帧腾出空间。
  * 这个管理器负责为所有的BufferPool提供页帧管理服务，也就是所有的BufferPool磁盘文件
  * 在访问时都使用这个管理器映射到内存。
+ *
+ * 页帧按照 FrameId 的哈希值分散到多个分片中，每个分片有自己的锁，减少多线程访问时的锁冲突。
+ * 淘汰策略使用简化的 2Q：新加载的页面放在冷链表中，再次被访问时移到热链表中。
+ * 淘汰时优先淘汰冷链表中的页面，除非冷链表已经很短了。这样全表扫描只访问一次的页面
+ * 不会把经常访问的页面（比如索引的上层节点）挤出内存。
  */
 class BPFrameManager
 {
@@ -102,6 +115,12 @@ public:
    */
   Frame *get(int buffer_pool_id, PageNum page_num);
 
+  /**
+   * @brief 页面是否已经在内存中
+   * @details 不会 pin 页面，也不算作一次访问
+   */
+  bool contains(int buffer_pool_id, PageNum page_num);
+
   /**
    * @brief 列出所有指定文件的页面
    *
@@ -110,14 +129,29 @@ public:
    */
   list<Frame *> find_list(int buffer_pool_id);
 
+  /**
+   * @brief 列出所有的脏页
+   * @details 返回的页帧都会被 pin 住，使用完之后需要 unpin
+   */
+  vector<Frame *> find_dirty_list();
+
+  /**
+   * @brief 计算所有脏页中最小的恢复LSN
+   * @details 从这个LSN开始重做日志，就可以恢复所有还没有写到磁盘的修改，也就是页帧的 clean_lsn + 1。
+   * 正在被修改的页面会等待修改完成再检查。
+   * @return 没有脏页时返回 false
+   */
+  bool min_recovery_lsn(LSN &lsn);
+
   /**
    * @brief 分配一个新的页面
    *
    * @param buffer_pool_id buffer Pool标识
    * @param page_num 页面编号
+   * @param prefetch 是否是预读的页面。预读页面第一次被访问时还留在冷链表中
    * @return Frame* 页帧指针
    */
-  Frame *alloc(int buffer_pool_id, PageNum page_num);
+  Frame *alloc(int buffer_pool_id, PageNum page_num, bool prefetch = false);
 
   /**
    * 尽管frame中已经包含了buffer_pool_id和page_num，但是依然要求
@@ -129,21 +163,21 @@ public:
    * 如果不能从空闲链表中分配新的页面，就使用这个接口，
    * 尝试从pin count=0的页面中淘汰一些
    * @param count 想要purge多少个页面
-   * @param purger 需要在释放frame之前，对页面做些什么操作。当前是刷新脏数据到磁盘
+   * @param purger 需要在释放frame之前，对页面做些什么操作。当前是刷新脏数据到磁盘。
+   *               调用 purger 时不持有分片的锁
    * @return 返回本次清理了多少个页面
    */
   int purge_frames(int count, function<RC(Frame *frame)> purger);
 
-  size_t frame_num() const { return frames_.count(); }
+  size_t frame_num() const;
 
   /**
    * 测试使用。返回已经从内存申请的个数
    */
   size_t total_frame_num() const { return allocator_.get_size(); }
 
-private:
-  Frame *get_internal(const FrameId &frame_id);
-  RC     free_internal(const FrameId &frame_id, Frame *frame);
+  /// 还可以直接分配的页帧数量，不需要淘汰页面
+  size_t free_frame_num() const;
 
 private:
   class BPFrameIdHasher
@@ -152,11 +186,44 @@ private:
     size_t operator()(const FrameId &frame_id) const { return frame_id.hash(); }
   };
 
-  using FrameLruCache  = common::LruCache<FrameId, Frame *, BPFrameIdHasher>;
+  struct FrameEntry
+  {
+    Frame                  *frame = nullptr;
+    bool                    hot   = false;  ///< 是否在热链表中
+    list<Frame *>::iterator pos;            ///< 在冷链表或者热链表中的位置
+    bool                    prefetched = false;  ///< 预读进来之后还没有被访问过
+  };
+
+  /**
+   * @brief 一个分片
+   * @details 冷热链表的头部都是最近访问的页面，淘汰时从尾部开始查找
+   */
+  struct Shard
+  {
+    mutable mutex                                        lock;
+    unordered_map<FrameId, FrameEntry, BPFrameIdHasher> frames;
+    list<Frame *>                                        cold_list;  ///< 只被访问过一次的页面
+    list<Frame *>                                        hot_list;   ///< 被访问过多次的页面
+  };
+
+  Shard &shard_of(const FrameId &frame_id);
+
+  Frame *get_internal(Shard &shard, const FrameId &frame_id);
+  RC     free_internal(Shard &shard, const FrameId &frame_id, Frame *frame);
+
+  /// 按照淘汰策略从分片中选出最多 count 个可以淘汰的页面，选出的页面会被 pin 住。cold_only 时只从冷链表中选
+  void pick_victims(Shard &shard, int count, bool cold_only, vector<Frame *> &victims);
+
+private:
   using FrameAllocator = common::MemPoolSimple<Frame>;
 
-  mutex          lock_;
-  FrameLruCache  frames_;
+  static constexpr int SHARD_NUM = 16;
+
+  /// 冷链表中的页面数量不超过分片中页面数量的这个比例时，优先淘汰热链表中的页面
+  static constexpr int COLD_LIST_MIN_PERCENT = 25;
+
+  Shard          shards_[SHARD_NUM];
+  atomic<int>    purge_cursor_{0};  ///< 下次从哪个分片开始淘汰，让各个分片轮流淘汰
   FrameAllocator allocator_;
 };
 
@@ -166,18 +233,34 @@ private:
  */
 class BufferPoolIterator
 {
+public:
+  /// 顺序扫描时默认预读的页面个数
+  static constexpr int DEFAULT_READ_AHEAD_PAGES = 32;
+
 public:
   BufferPoolIterator();
   ~BufferPoolIterator();
 
-  RC      init(DiskBufferPool &bp, PageNum start_page = 0);
+  /**
+   * @param read_ahead_pages 预读窗口的大小，0 表示不预读
+   * @details 开启预读时，遍历到上一个预读窗口的第一个页面，就发起下一个窗口的预读，
+   * 这样扫描到后面的页面时，这些页面已经在内存中了
+   */
+  RC      init(DiskBufferPool &bp, PageNum start_page = 0, int read_ahead_pages = 0);
   bool    has_next();
   PageNum next();
   RC      reset();
 
 private:
-  common::Bitmap bitmap_;
-  PageNum        current_page_num_ = -1;
+  void read_ahead(PageNum page_num);
+
+private:
+  common::Bitmap  bitmap_;
+  PageNum         current_page_num_ = -1;
+  DiskBufferPool *buffer_pool_      = nullptr;
+  int             read_ahead_pages_ = 0;
+  PageNum         read_ahead_trigger_ = -1;  ///< 遍历到这个页面时发起下一次预读
+  PageNum         read_ahead_end_     = -1;  ///< 已经预读到了哪个页面
 };
 
 /**
@@ -208,6 +291,20 @@ public:
    */
   RC get_this_page(PageNum page_num, Frame **frame);
 
+  /**
+   * @brief 预读一批页面
+   * @details 先通知操作系统异步读取这些页面（posix_fadvise）。在 CONCURRENCY 模式下，
+   * 还会由后台线程把页面加载到缓冲区中。已经在缓冲区中的页面会被跳过。
+   * 预读只是一个提示，出错时不影响正常的读取。
+   */
+  RC read_ahead(span<const PageNum> page_nums);
+
+  /**
+   * @brief 把页面加载到缓冲区中，但是不 pin 住它
+   * @details 页面已经在缓冲区中时什么都不做。没有空闲页帧并且淘汰不出页面时放弃加载
+   */
+  RC prefetch_page(PageNum page_num);
+
   /**
    * @brief 在指定文件中分配一个新的页面，并将其放入缓冲区，返回页面句柄指针。
    * @details 分配页面时，如果文件中有空闲页，就直接分配一个空闲页；
@@ -266,6 +363,12 @@ public:
    */
   RC write_page(PageNum page_num, Page &page);
 
+  /**
+   * 把页号连续的多个页面一次写入磁盘
+   * @param page_num 第一个页面的页号
+   */
+  RC write_pages(PageNum page_num, const vector<Page *> &pages);
+
   RC redo_allocate_page(LSN lsn, PageNum page_num);
   RC redo_deallocate_page(LSN lsn, PageNum page_num);
 
@@ -309,7 +412,10 @@ private:
   string file_name_;  /// 文件名
 
   common::Mutex lock_;
-  common::Mutex wr_lock_;
+
+  mutex              read_ahead_lock_;
+  condition_variable read_ahead_cond_;
+  int                read_ahead_tasks_ = 0;  /// 还没有执行完的预读任务，关闭文件前要等待它们结束
 
 private:
   friend class BufferPoolIterator;
@@ -336,6 +442,9 @@ public:
   BPFrameManager    &get_frame_manager() { return frame_manager_; }
   DoubleWriteBuffer *get_dblwr_buffer() { return dblwr_buffer_.get(); }
 
+  /// 执行预读任务的线程池，只有 CONCURRENCY 模式下才有
+  common::ThreadPoolExecutor *read_ahead_executor() { return read_ahead_executor_.get(); }
+
   /**
    * @brief 根据ID获取对应的BufferPool对象
    * @details 在做redo时，需要根据ID获取对应的BufferPool对象，然后让bufferPool对象自己做redo
@@ -349,6 +458,8 @@ private:
 
   unique_ptr<DoubleWriteBuffer> dblwr_buffer_;
 
+  unique_ptr<common::ThreadPoolExecutor> read_ahead_executor_;
+
   common::Mutex                            lock_;
   unordered_map<string, DiskBufferPool *>  buffer_pools_;
   unordered_map<int32_t, DiskBufferPool *> id_to_buffer_pools_;
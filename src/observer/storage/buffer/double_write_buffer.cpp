@@ -74,19 +74,32 @@ RC DiskDoubleWriteBuffer::open_file(const char *filename)
 }
 
 RC DiskDoubleWriteBuffer::flush_page()
+{
+  scoped_lock lock_guard(lock_);
+  return flush_page_internal();
+}
+
+RC DiskDoubleWriteBuffer::flush_page_internal()
 {
   sync();
 
+  vector<DoubleWritePage *> pages;
+  pages.reserve(dblwr_pages_.size());
   for (const auto &pair : dblwr_pages_) {
-    RC rc = write_page(pair.second);
-    if (rc != RC::SUCCESS) {
-      return rc;
-    }
-    pair.second->valid = false;
-    write_page_internal(pair.second);
-    delete pair.second;
+    pages.push_back(pair.second);
   }
 
+  RC rc = write_pages(pages);
+  if (rc != RC::SUCCESS) {
+    return rc;
+  }
+
+  for (DoubleWritePage *page : pages) {
+    page->valid = false;
+  }
+  write_pages_internal(pages);
+  for_each(pages.begin(), pages.end(), [](DoubleWritePage *dbl_page) { delete dbl_page; });
+
   dblwr_pages_.clear();
   header_.page_cnt = 0;
 
@@ -120,19 +133,14 @@ RC DiskDoubleWriteBuffer::add_page(DiskBufferPool *bp, PageNum page_num, Page &p
 
   if (page_cnt + 1 > header_.page_cnt) {
     header_.page_cnt = page_cnt + 1;
-    if (lseek(file_desc_, 0, SEEK_SET) == -1) {
-      LOG_ERROR("Failed to add page header due to failed to seek %s.", strerror(errno));
-      return RC::IOERR_SEEK;
-    }
-
-    if (writen(file_desc_, &header_, sizeof(header_)) != 0) {
+    if (pwriten(file_desc_, &header_, sizeof(header_), 0) != 0) {
       LOG_ERROR("Failed to add page header due to %s.", strerror(errno));
       return RC::IOERR_WRITE;
     }
   }
 
   if (static_cast<int>(dblwr_pages_.size()) >= max_pages_) {
-    RC rc = flush_page();
+    RC rc = flush_page_internal();
     if (rc != RC::SUCCESS) {
       LOG_ERROR("Failed to flush pages in double write buffer");
       return rc;
@@ -146,35 +154,92 @@ RC DiskDoubleWriteBuffer::write_page_internal(DoubleWritePage *page)
 {
   int32_t page_index = page->page_index;
   int64_t offset = page_index * DoubleWritePage::SIZE + DoubleWriteBufferHeader::SIZE;
-  if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to add page %lld of %d due to failed to seek %s.", offset, file_desc_, strerror(errno));
-    return RC::IOERR_SEEK;
-  }
-
-  if (writen(file_desc_, page, DoubleWritePage::SIZE) != 0) {
-    LOG_ERROR("Failed to add page %lld of %d due to %s.", offset, file_desc_, strerror(errno));
+  int     ret    = pwriten(file_desc_, page, DoubleWritePage::SIZE, offset);
+  if (ret != 0) {
+    LOG_ERROR("Failed to add page %lld of %d due to %s.", offset, file_desc_, strerror(ret));
     return RC::IOERR_WRITE;
   }
 
   return RC::SUCCESS;
 }
 
-RC DiskDoubleWriteBuffer::write_page(DoubleWritePage *dblwr_page)
+RC DiskDoubleWriteBuffer::write_pages_internal(vector<DoubleWritePage *> &pages)
 {
-  DiskBufferPool *disk_buffer = nullptr;
-  // skip invalid page
-  if (!dblwr_page->valid) {
-    LOG_TRACE("double write buffer write page invalid. buffer_pool_id:%d,page_num:%d,lsn=%d",
-              dblwr_page->key.buffer_pool_id, dblwr_page->key.page_num, dblwr_page->page.lsn);
-    return RC::SUCCESS;
+  sort(pages.begin(), pages.end(), [](DoubleWritePage *a, DoubleWritePage *b) {
+    return a->page_index < b->page_index;
+  });
+
+  vector<struct iovec> iovs;
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end]->page_index == pages[end - 1]->page_index + 1) {
+      end++;
+    }
+
+    iovs.resize(end - begin);
+    for (size_t i = begin; i < end; i++) {
+      iovs[i - begin].iov_base = pages[i];
+      iovs[i - begin].iov_len  = DoubleWritePage::SIZE;
+    }
+
+    int64_t offset = pages[begin]->page_index * DoubleWritePage::SIZE + DoubleWriteBufferHeader::SIZE;
+    int     ret    = pwritevn(file_desc_, iovs.data(), static_cast<int>(iovs.size()), offset);
+    if (ret != 0) {
+      LOG_ERROR("Failed to write pages %lld of %d due to %s. page count=%lu",
+                offset, file_desc_, strerror(ret), iovs.size());
+      return RC::IOERR_WRITE;
+    }
+    begin = end;
   }
-  RC rc = bp_manager_.get_buffer_pool(dblwr_page->key.buffer_pool_id, disk_buffer);
-  ASSERT(OB_SUCC(rc) && disk_buffer != nullptr, "failed to get disk buffer pool of %d", dblwr_page->key.buffer_pool_id);
+  return RC::SUCCESS;
+}
+
+RC DiskDoubleWriteBuffer::write_pages(vector<DoubleWritePage *> &pages)
+{
+  // 页面从小到大排序，防止出现小页面还没有写入，而页面编号更大的seek失败的情况
+  sort(pages.begin(), pages.end(), [](DoubleWritePage *a, DoubleWritePage *b) {
+    if (a->key.buffer_pool_id != b->key.buffer_pool_id) {
+      return a->key.buffer_pool_id < b->key.buffer_pool_id;
+    }
+    return a->key.page_num < b->key.page_num;
+  });
 
-  LOG_TRACE("double write buffer write page. buffer_pool_id:%d,page_num:%d,lsn=%d",
-            dblwr_page->key.buffer_pool_id, dblwr_page->key.page_num, dblwr_page->page.lsn);
+  vector<Page *> run_pages;
+  for (size_t begin = 0; begin < pages.size();) {
+    if (!pages[begin]->valid) {
+      LOG_TRACE("double write buffer write page invalid. buffer_pool_id:%d,page_num:%d,lsn=%d",
+                pages[begin]->key.buffer_pool_id, pages[begin]->key.page_num, pages[begin]->page.lsn);
+      begin++;
+      continue;
+    }
+
+    const DoubleWritePageKey &first_key = pages[begin]->key;
+
+    run_pages.clear();
+    run_pages.push_back(&pages[begin]->page);
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end]->valid && pages[end]->key.buffer_pool_id == first_key.buffer_pool_id &&
+           pages[end]->key.page_num == pages[end - 1]->key.page_num + 1) {
+      run_pages.push_back(&pages[end]->page);
+      end++;
+    }
 
-  return disk_buffer->write_page(dblwr_page->key.page_num, dblwr_page->page);
+    DiskBufferPool *disk_buffer = nullptr;
+    RC rc = bp_manager_.get_buffer_pool(first_key.buffer_pool_id, disk_buffer);
+    ASSERT(OB_SUCC(rc) && disk_buffer != nullptr, "failed to get disk buffer pool of %d", first_key.buffer_pool_id);
+
+    LOG_TRACE("double write buffer write pages. buffer_pool_id:%d,page_num:%d,page count=%lu",
+              first_key.buffer_pool_id, first_key.page_num, run_pages.size());
+
+    rc = disk_buffer->write_pages(first_key.page_num, run_pages);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("Failed to write pages %s:%d to disk buffer pool. rc=%s",
+               disk_buffer->filename(), first_key.page_num, strrc(rc));
+      return rc;
+    }
+    begin = end;
+  }
+  return RC::SUCCESS;
 }
 
 RC DiskDoubleWriteBuffer::read_page(DiskBufferPool *bp, PageNum page_num, Page &page)
@@ -211,21 +276,12 @@ RC DiskDoubleWriteBuffer::clear_pages(DiskBufferPool *buffer_pool)
   LOG_INFO("clear pages in double write buffer. file name=%s, page count=%d",
            buffer_pool->filename(), spec_pages.size());
 
-  // 页面从小到大排序，防止出现小页面还没有写入，而页面编号更大的seek失败的情况
-  sort(spec_pages.begin(), spec_pages.end(), [](DoubleWritePage *a, DoubleWritePage *b) {
-    return a->key.page_num < b->key.page_num;
-  });
-
-  RC rc = RC::SUCCESS;
-  for (DoubleWritePage *dbl_page : spec_pages) {
-    rc = buffer_pool->write_page(dbl_page->key.page_num, dbl_page->page);
-    if (OB_FAIL(rc)) {
-      LOG_WARN("Failed to write page %s:%d to disk buffer pool. rc=%s",
-               buffer_pool->filename(), dbl_page->key.page_num, strrc(rc));
-      break;
+  RC rc = write_pages(spec_pages);
+  if (OB_SUCC(rc)) {
+    for (DoubleWritePage *dbl_page : spec_pages) {
+      dbl_page->valid = false;
     }
-    dbl_page->valid = false;
-    write_page_internal(dbl_page);
+    write_pages_internal(spec_pages);
   }
 
   for_each(spec_pages.begin(), spec_pages.end(), [](DoubleWritePage *dbl_page) { delete dbl_page; });
@@ -245,12 +301,7 @@ RC DiskDoubleWriteBuffer::load_pages()
     return RC::BUFFERPOOL_OPEN;
   }
 
-  if (lseek(file_desc_, 0, SEEK_SET) == -1) {
-    LOG_ERROR("Failed to load page header, due to failed to lseek:%s.", strerror(errno));
-    return RC::IOERR_SEEK;
-  }
-
-  int ret = readn(file_desc_, &header_, sizeof(header_));
+  int ret = preadn(file_desc_, &header_, sizeof(header_), 0);
   if (ret != 0 && ret != -1) {
     LOG_ERROR("Failed to load page header, file_desc:%d, due to failed to read data:%s, ret=%d",
                 file_desc_, strerror(errno), ret);
@@ -260,16 +311,11 @@ RC DiskDoubleWriteBuffer::load_pages()
   for (int page_num = 0; page_num < header_.page_cnt; page_num++) {
     int64_t offset = ((int64_t)page_num) * DoubleWritePage::SIZE + DoubleWriteBufferHeader::SIZE;
 
-    if (lseek(file_desc_, offset, SEEK_SET) == -1) {
-      LOG_ERROR("Failed to load page %d, offset=%ld, due to failed to lseek:%s.", page_num, offset, strerror(errno));
-      return RC::IOERR_SEEK;
-    }
-
     auto dblwr_page = make_unique<DoubleWritePage>();
     Page &page     = dblwr_page->page;
     page.check_sum = (CheckSum)-1;
 
-    ret = readn(file_desc_, dblwr_page.get(), DoubleWritePage::SIZE);
+    ret = preadn(file_desc_, dblwr_page.get(), DoubleWritePage::SIZE, offset);
     if (ret != 0) {
       LOG_ERROR("Failed to load page, file_desc:%d, page num:%d, due to failed to read data:%s, ret=%d, page count=%d",
                 file_desc_, page_num, strerror(errno), ret, page_num);
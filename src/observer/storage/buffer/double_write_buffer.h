@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/mutex.h"
 #include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
 #include "common/types.h"
 #include "common/sys/rc.h"
 #include "storage/buffer/page.h"
@@ -123,10 +124,13 @@ public:
   RC recover();
 
 private:
+  RC flush_page_internal();
+
   /**
-   * 将buffer中的页面写入对应的磁盘
+   * 将buffer中的多个页面写入对应的磁盘
+   * @details 同一个文件中页号连续的页面合并成一次写入。无效的页面会跳过
    */
-  RC write_page(DoubleWritePage *page);
+  RC write_pages(vector<DoubleWritePage *> &pages);
 
   /**
    * 将页面写到当前double write buffer文件中
@@ -135,6 +139,11 @@ private:
    */
   RC write_page_internal(DoubleWritePage *page);
 
+  /**
+   * 将多个页面写到当前double write buffer文件中，位置连续的页面合并成一次写入
+   */
+  RC write_pages_internal(vector<DoubleWritePage *> &pages);
+
   /**
    * @brief 将磁盘文件中的内容加载到内存中。在启动时调用
    */
@@ -75,7 +75,11 @@ public:
    * @details 在 MemPoolSimple 分配和释放一个Frame对象时，不会调用构造函数和析构函数，
    * 而是调用reinit和reset。
    */
-  void reinit() {}
+  void reinit()
+  {
+    dirty_.store(false);
+    clean_lsn_.store(0);
+  }
   void reset() {}
 
   void clear_page() { memset(&page_, 0, sizeof(page_)); }
@@ -126,14 +130,27 @@ public:
    * @details 如果修改了页面的内容，则应调用此函数，
    * 以便该页面被淘汰出缓冲区时系统将新的页面数据写入磁盘文件
    */
-  void mark_dirty() { dirty_ = true; }
+  void mark_dirty() { dirty_.store(true); }
 
   /**
    * @brief 重置“脏”标记
    * @details 如果页面已经被写入磁盘文件，则应调用此函数。
    */
-  void clear_dirty() { dirty_ = false; }
-  bool dirty() const { return dirty_; }
+  void clear_dirty()
+  {
+    clean_lsn_.store(page_.lsn);
+    dirty_.store(false);
+  }
+  bool dirty() const { return dirty_.load(); }
+
+  /**
+   * @brief 页面上一次与磁盘一致时的LSN
+   * @details 页面从磁盘加载或者刷新到磁盘之后，后面的修改对应的日志LSN都比它大。
+   * 所以从 clean_lsn + 1 开始重做日志，就可以恢复这个页面上所有还没有写到磁盘的修改。
+   * 刷脏页和做检查点时使用。
+   */
+  LSN  clean_lsn() const { return clean_lsn_.load(); }
+  void set_clean_lsn(LSN lsn) { clean_lsn_.store(lsn); }
 
   char *data() { return page_.data; }
 
@@ -171,7 +188,8 @@ public:
 private:
   friend class BufferPool;
 
-  bool          dirty_ = false;
+  atomic<bool>  dirty_{false};
+  atomic<LSN>   clean_lsn_{0};
   atomic<int>   pin_count_{0};
   unsigned long acc_time_ = 0;
   FrameId       frame_id_;
@@ -0,0 +1,181 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/buffer/page_flusher.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/log/log.h"
+#include "common/thread/thread_util.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/clog/log_handler.h"
+
+using namespace common;
+
+PageFlusher::PageFlusher(BufferPoolManager &bp_manager, LogHandler &log_handler, const PageFlusherOptions &options)
+    : bp_manager_(bp_manager), log_handler_(log_handler), options_(options)
+{}
+
+PageFlusher::~PageFlusher() { stop(); }
+
+RC PageFlusher::start(function<RC()> checkpointer)
+{
+  if (thread_) {
+    LOG_ERROR("page flusher has been started");
+    return RC::INTERNAL;
+  }
+
+  checkpointer_ = std::move(checkpointer);
+  running_.store(true);
+  thread_ = make_unique<thread>(&PageFlusher::thread_func, this);
+  LOG_INFO("page flusher started. free frame num=%d, flush batch size=%d",
+           options_.free_frame_num, options_.flush_batch_size);
+  return RC::SUCCESS;
+}
+
+RC PageFlusher::stop()
+{
+  if (!thread_) {
+    return RC::SUCCESS;
+  }
+
+  {
+    lock_guard<mutex> guard(lock_);
+    running_.store(false);
+  }
+  cond_.notify_all();
+
+  thread_->join();
+  thread_.reset();
+  LOG_INFO("page flusher stopped");
+  return RC::SUCCESS;
+}
+
+RC PageFlusher::run_once()
+{
+  int freed_count = 0;
+  RC  rc          = reserve_free_frames(freed_count);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to reserve free frames. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  int flushed_count = 0;
+  rc = flush_dirty_pages(options_.flush_batch_size, flushed_count);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush dirty pages. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (freed_count > 0 || flushed_count > 0) {
+    LOG_TRACE("page flusher done. freed frames=%d, flushed pages=%d", freed_count, flushed_count);
+  }
+  return RC::SUCCESS;
+}
+
+RC PageFlusher::reserve_free_frames(int &freed_count)
+{
+  freed_count = 0;
+
+  BPFrameManager &frame_manager = bp_manager_.get_frame_manager();
+  const int free_frame_num = min(options_.free_frame_num, static_cast<int>(frame_manager.total_frame_num() / 4));
+
+  auto purger = [this](Frame *frame) {
+    if (!frame->dirty()) {
+      return RC::SUCCESS;
+    }
+    return bp_manager_.flush_page(*frame);
+  };
+
+  int current_free_num = static_cast<int>(frame_manager.free_frame_num());
+  while (current_free_num < free_frame_num) {
+    int purged_count = frame_manager.purge_frames(free_frame_num - current_free_num, purger);
+    if (purged_count <= 0) {
+      break;
+    }
+
+    freed_count += purged_count;
+    current_free_num = static_cast<int>(frame_manager.free_frame_num());
+  }
+  return RC::SUCCESS;
+}
+
+RC PageFlusher::flush_dirty_pages(int max_count, int &flushed_count)
+{
+  flushed_count = 0;
+
+  vector<Frame *> frames = bp_manager_.get_frame_manager().find_dirty_list();
+  sort(frames.begin(), frames.end(), [](const Frame *left, const Frame *right) {
+    return left->clean_lsn() < right->clean_lsn();
+  });
+
+  const size_t flush_num = min(frames.size(), static_cast<size_t>(max(max_count, 0)));
+
+  // WAL: 页面写到磁盘之前，修改页面的日志必须先落盘。这里一次性等待这一批页面的日志
+  LSN max_lsn = 0;
+  for (size_t i = 0; i < flush_num; i++) {
+    max_lsn = max(max_lsn, frames[i]->lsn());
+  }
+
+  RC rc = log_handler_.wait_lsn(max_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to wait lsn before flushing pages. lsn=%ld, rc=%s", max_lsn, strrc(rc));
+  }
+
+  for (size_t i = 0; i < flush_num && OB_SUCC(rc); i++) {
+    Frame *frame = frames[i];
+    // 页面正在被修改，下一轮再刷
+    if (!frame->try_read_latch()) {
+      continue;
+    }
+
+    if (frame->dirty()) {
+      rc = bp_manager_.flush_page(*frame);
+      if (OB_SUCC(rc)) {
+        flushed_count++;
+      } else {
+        LOG_WARN("failed to flush page. frame=%s, rc=%s", frame->to_string().c_str(), strrc(rc));
+      }
+    }
+    frame->read_unlatch();
+  }
+
+  for (Frame *frame : frames) {
+    frame->unpin();
+  }
+  return rc;
+}
+
+void PageFlusher::thread_func()
+{
+  thread_set_name("PageFlusher");
+  LOG_INFO("page flusher thread started");
+
+  auto last_checkpoint_time = chrono::steady_clock::now();
+  while (running_.load()) {
+    {
+      lock_guard<mutex> work_guard(work_lock_);
+      (void)run_once();
+
+      auto now = chrono::steady_clock::now();
+      if (checkpointer_ && now - last_checkpoint_time >= chrono::milliseconds(options_.checkpoint_interval_ms)) {
+        RC rc = checkpointer_();
+        if (OB_FAIL(rc)) {
+          LOG_WARN("failed to do checkpoint. rc=%s", strrc(rc));
+        }
+        last_checkpoint_time = now;
+      }
+    }
+
+    unique_lock<mutex> guard(lock_);
+    cond_.wait_for(guard, chrono::milliseconds(options_.interval_ms), [this]() { return !running_.load(); });
+  }
+
+  LOG_INFO("page flusher thread stopped");
+}
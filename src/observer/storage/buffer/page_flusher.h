@@ -0,0 +1,107 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/functional.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/thread.h"
+#include "common/sys/rc.h"
+
+class BufferPoolManager;
+class LogHandler;
+
+/**
+ * @brief 后台刷脏页的参数
+ * @ingroup BufferPool
+ */
+struct PageFlusherOptions
+{
+  int free_frame_num         = 64;     ///< 保持多少个空闲页帧，分配页帧时不需要同步刷脏页
+  int flush_batch_size       = 64;     ///< 每一轮最多刷多少个脏页
+  int interval_ms            = 100;    ///< 每一轮之间的间隔
+  int checkpoint_interval_ms = 10000;  ///< 做检查点的间隔
+};
+
+/**
+ * @brief 后台刷脏页
+ * @ingroup BufferPool
+ * @details 没有这个线程时，脏页只有在被淘汰或者 sync 时才写到磁盘，查询在分配页帧时经常要同步写一次
+ * 脏页和 double write buffer。这个线程在后台做三件事情：
+ * 1. 提前淘汰一些页面，保持一定数量的空闲页帧；
+ * 2. 按照页面变脏的先后顺序（clean_lsn从小到大）刷新脏页，刷新之前先等待相关的日志落盘(WAL)；
+ * 3. 定期调用 checkpointer 做模糊检查点。最老的脏页刷出去之后，检查点才能往前推进，
+ *    检查点之前的日志就可以删除，重启时也只需要从检查点开始回放。
+ *
+ * 刷新脏页时只尝试加页面的读锁，拿不到说明页面正在被修改，就留给下一轮。
+ * 页面的锁在没有打开 CONCURRENCY 编译选项时什么都不做，所以这时不应该启动后台线程，
+ * 但是可以直接调用 run_once 等接口。
+ */
+class PageFlusher final
+{
+public:
+  PageFlusher(BufferPoolManager &bp_manager, LogHandler &log_handler, const PageFlusherOptions &options = {});
+  ~PageFlusher();
+
+  /**
+   * @brief 启动后台线程
+   * @param checkpointer 做检查点的函数，可以为空
+   */
+  RC start(function<RC()> checkpointer);
+
+  /**
+   * @brief 停止后台线程并等待它结束
+   */
+  RC stop();
+
+  /**
+   * @brief 执行一轮：保持空闲页帧，再刷新一批脏页
+   */
+  RC run_once();
+
+  /**
+   * @brief 淘汰一些页面，让空闲页帧的数量不少于 options.free_frame_num
+   * @details 最多保留总页帧数的四分之一，避免把缓存的页面都淘汰掉
+   * @param[out] freed_count 淘汰的页面个数
+   */
+  RC reserve_free_frames(int &freed_count);
+
+  /**
+   * @brief 按照 clean_lsn 从小到大，刷新最多 max_count 个脏页
+   * @param[out] flushed_count 刷新的页面个数
+   */
+  RC flush_dirty_pages(int max_count, int &flushed_count);
+
+  /**
+   * @brief 暂停后台线程，返回的锁释放之后继续
+   * @details 关闭 buffer pool 之前调用，避免后台线程还 pin 着要关闭的页面
+   */
+  unique_lock<mutex> pause() { return unique_lock<mutex>(work_lock_); }
+
+  const PageFlusherOptions &options() const { return options_; }
+
+private:
+  void thread_func();
+
+private:
+  BufferPoolManager &bp_manager_;
+  LogHandler        &log_handler_;
+  PageFlusherOptions options_;
+  function<RC()>     checkpointer_;
+
+  unique_ptr<thread> thread_;
+  atomic_bool        running_{false};
+  mutex              work_lock_;  ///< 后台线程每一轮工作时持有
+  mutex              lock_;  ///< 配合 cond_ 使用，停止时可以马上唤醒后台线程
+  condition_variable cond_;
+};
@@ -161,6 +161,21 @@ RC DiskLogHandler::wait_lsn(LSN lsn)
   }
 }
 
+RC DiskLogHandler::truncate(LSN checkpoint_lsn)
+{
+  int removed_count = 0;
+  RC  rc            = file_manager_.remove_files_before(checkpoint_lsn, removed_count);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to remove clog files. checkpoint_lsn=%ld, rc=%s", checkpoint_lsn, strrc(rc));
+    return rc;
+  }
+
+  if (removed_count > 0) {
+    LOG_INFO("truncate clog files done. checkpoint_lsn=%ld, removed files=%d", checkpoint_lsn, removed_count);
+  }
+  return RC::SUCCESS;
+}
+
 void DiskLogHandler::thread_func()
 {
   /*
@@ -97,6 +97,12 @@ public:
    */
   RC wait_lsn(LSN lsn) override;
 
+  /**
+   * @brief 删除所有日志都在检查点之前的日志文件
+   * @details 正在写入的最后一个日志文件不会被删除
+   */
+  RC truncate(LSN checkpoint_lsn) override;
+
   /// @brief 当前的LSN
   LSN current_lsn() const override { return entry_buffer_.current_lsn(); }
   /// @brief 当前刷新到哪个日志
@@ -298,6 +298,7 @@ RC LogFileManager::list_files(vector<string> &files, LSN start_lsn)
 {
   files.clear();
 
+  lock_guard<mutex> guard(lock_);
   // 这里的代码是AI自动生成的
   // 其实写的不好，我们只需要找到比start_lsn相等或者小的第一个日志文件就可以了
   for (auto &file : log_files_) {
@@ -311,7 +312,9 @@ RC LogFileManager::list_files(vector<string> &files, LSN start_lsn)
 
 RC LogFileManager::last_file(LogFileWriter &file_writer)
 {
+  unique_lock<mutex> guard(lock_);
   if (log_files_.empty()) {
+    guard.unlock();
     return next_file(file_writer);
   }
 
@@ -326,6 +329,7 @@ RC LogFileManager::next_file(LogFileWriter &file_writer)
 {
   file_writer.close();
 
+  lock_guard<mutex> guard(lock_);
   LSN lsn = 0;
   if (!log_files_.empty()) {
     lsn = log_files_.rbegin()->first + max_entry_number_per_file_;
@@ -337,3 +341,27 @@ RC LogFileManager::next_file(LogFileWriter &file_writer)
 
   return file_writer.open(file_path.c_str(), lsn + max_entry_number_per_file_ - 1);
 }
+
+RC LogFileManager::remove_files_before(LSN lsn, int &removed_count)
+{
+  removed_count = 0;
+
+  lock_guard<mutex> guard(lock_);
+  while (log_files_.size() > 1) {
+    auto iter = log_files_.begin();
+    if (iter->first + max_entry_number_per_file_ - 1 >= lsn) {
+      break;
+    }
+
+    error_code ec;
+    if (!filesystem::remove(iter->second, ec) && ec) {
+      LOG_WARN("failed to remove log file. file=%s, error=%s", iter->second.c_str(), ec.message().c_str());
+      return RC::FILE_REMOVE;
+    }
+
+    LOG_INFO("remove log file. file=%s", iter->second.c_str());
+    log_files_.erase(iter);
+    removed_count++;
+  }
+  return RC::SUCCESS;
+}
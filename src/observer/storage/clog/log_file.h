@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/sys/rc.h"
 #include "common/types.h"
 #include "common/lang/map.h"
+#include "common/lang/mutex.h"
 #include "common/lang/functional.h"
 #include "common/lang/filesystem.h"
 #include "common/lang/fstream.h"
@@ -137,6 +138,14 @@ public:
    */
   RC next_file(LogFileWriter &file_writer);
 
+  /**
+   * @brief 删除所有日志的LSN都小于lsn的日志文件
+   * @details 最后一个日志文件总是保留，因为它可能正在被写入，重启时也需要从中获取最大的LSN
+   * @param lsn 比这个LSN小的日志都不再需要
+   * @param[out] removed_count 删除的文件数
+   */
+  RC remove_files_before(LSN lsn, int &removed_count);
+
 private:
   /**
    * @brief 从文件名称中获取LSN
@@ -151,5 +160,6 @@ private:
   filesystem::path directory_;                  /// 日志文件存放的目录
   int              max_entry_number_per_file_;  /// 一个文件最大允许存放多少条日志
 
+  mutex                      lock_;       /// 后台做检查点时会删除文件，与日志刷新线程并发访问
   map<LSN, filesystem::path> log_files_;  /// 日志文件名和第一个LSN的映射
 };
@@ -94,6 +94,13 @@ public:
    */
   virtual RC wait_lsn(LSN lsn) = 0;
 
+  /**
+   * @brief 删除不再需要的日志
+   * @details 做完检查点之后，检查点之前的日志不会再回放，可以删除掉
+   * @param checkpoint_lsn 检查点LSN，重启时从这里开始回放
+   */
+  virtual RC truncate(LSN checkpoint_lsn) = 0;
+
   virtual LSN current_lsn() const = 0;
 
   static RC create(const char *name, LogHandler *&handler);
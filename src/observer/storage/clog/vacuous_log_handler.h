@@ -35,6 +35,7 @@ public:
   RC iterate(function<RC(LogEntry &)> consumer, LSN start_lsn) override { return RC::SUCCESS; }
 
   RC wait_lsn(LSN lsn) override { return RC::SUCCESS; }
+  RC truncate(LSN checkpoint_lsn) override { return RC::SUCCESS; }
 
   LSN current_lsn() const override { return 0; }
 
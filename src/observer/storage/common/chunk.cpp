@@ -10,6 +10,20 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/common/chunk.h"
 
+int Chunk::column_index(int col_id) const
+{
+  // 读取了所有列时，列的下标就是列 id
+  if (col_id >= 0 && col_id < static_cast<int>(column_ids_.size()) && column_ids_[col_id] == col_id) {
+    return col_id;
+  }
+  for (size_t i = 0; i < column_ids_.size(); i++) {
+    if (column_ids_[i] == col_id) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
 void Chunk::add_column(unique_ptr<Column> col, int col_id)
 {
   columns_.push_back(std::move(col));
@@ -27,9 +41,42 @@ RC Chunk::reference(Chunk &chunk)
     columns_[i]->reference(chunk.column(i));
     column_ids_.push_back(chunk.column_ids(i));
   }
+  copy_selection(chunk);
   return RC::SUCCESS;
 }
 
+void Chunk::select(const vector<uint8_t> &select)
+{
+  if (has_selection_) {
+    int count = 0;
+    for (int index : selection_) {
+      if (select[index] != 0) {
+        selection_[count++] = index;
+      }
+    }
+    selection_.resize(count);
+    return;
+  }
+
+  const int rows = this->rows();
+  selection_.clear();
+  for (int i = 0; i < rows; i++) {
+    if (select[i] != 0) {
+      selection_.push_back(i);
+    }
+  }
+  has_selection_ = static_cast<int>(selection_.size()) != rows;
+  if (!has_selection_) {
+    selection_.clear();
+  }
+}
+
+void Chunk::copy_selection(const Chunk &chunk)
+{
+  has_selection_ = chunk.has_selection_;
+  selection_     = chunk.selection_;
+}
+
 int Chunk::rows() const
 {
   if (!columns_.empty()) {
@@ -51,10 +98,14 @@ void Chunk::reset_data()
   for (auto &col : columns_) {
     col->reset_data();
   }
+  has_selection_ = false;
+  selection_.clear();
 }
 
 void Chunk::reset()
 {
   columns_.clear();
   column_ids_.clear();
+  has_selection_ = false;
+  selection_.clear();
 }
\ No newline at end of file
@@ -18,6 +18,9 @@ See the Mulan PSL v2 for more details. */
 
 /**
  * @brief A Chunk represents a set of columns.
+ * @details Chunk 可以带有选择向量，记录列中哪些行是有效的。过滤时只需要设置选择向量，不需要复制列数据，
+ * 下层算子输出的 chunk 带有选择向量时，上层的向量化算子只处理选择向量中的行。
+ * rows() 总是列中数据的行数，有效的行是 row_index(0) ... row_index(selected_rows() - 1)。
  */
 class Chunk
 {
@@ -29,12 +32,16 @@ public:
     for (size_t i = 0; i < other.columns_.size(); ++i) {
       columns_.emplace_back(other.columns_[i]->clone());
     }
-    column_ids_ = other.column_ids_;
+    column_ids_    = other.column_ids_;
+    has_selection_ = other.has_selection_;
+    selection_     = other.selection_;
   }
   Chunk(Chunk &&chunk)
   {
-    columns_    = std::move(chunk.columns_);
-    column_ids_ = std::move(chunk.column_ids_);
+    columns_       = std::move(chunk.columns_);
+    column_ids_    = std::move(chunk.column_ids_);
+    has_selection_ = chunk.has_selection_;
+    selection_     = std::move(chunk.selection_);
   }
 
   int column_num() const { return columns_.size(); }
@@ -57,12 +64,17 @@ public:
     return &column(idx);
   }
 
-  int column_ids(size_t i)
+  int column_ids(size_t i) const
   {
     ASSERT(i < column_ids_.size(), "invalid column index");
     return column_ids_[i];
   }
 
+  /**
+   * @brief 列 id 为 col_id 的列的下标，没有该列时返回 -1
+   */
+  int column_index(int col_id) const;
+
   void add_column(unique_ptr<Column> col, int col_id);
 
   RC reference(Chunk &chunk);
@@ -77,6 +89,32 @@ public:
    */
   int capacity() const;
 
+  /**
+   * @brief 根据过滤的结果设置选择向量，select[i] 为 0 的行被过滤掉
+   * @details 已经有选择向量时，结果是两次过滤的交集。所有行都被选中时不记录选择向量。
+   */
+  void select(const vector<uint8_t> &select);
+
+  /**
+   * @brief 使用另一个 chunk 的选择向量，两个 chunk 的行需要一一对应
+   */
+  void copy_selection(const Chunk &chunk);
+
+  /**
+   * @brief 选择向量，记录有效行在列中的下标，所有行都有效时返回 nullptr
+   */
+  const vector<int> *selection() const { return has_selection_ ? &selection_ : nullptr; }
+
+  /**
+   * @brief 有效的行数
+   */
+  int selected_rows() const { return has_selection_ ? static_cast<int>(selection_.size()) : rows(); }
+
+  /**
+   * @brief 第 i 个有效行在列中的下标
+   */
+  int row_index(int i) const { return has_selection_ ? selection_[i] : i; }
+
   /**
    * @brief 从 Chunk 中获得指定行指定列的 Value
    * @param col_idx 列索引
@@ -88,7 +126,7 @@ public:
   Value get_value(int col_idx, int row_idx) const { return columns_[col_idx]->get_value(row_idx); }
 
   /**
-   * @brief 重置 Chunk 中的数据，不会修改 Chunk 的列属性。
+   * @brief 重置 Chunk 中的数据和选择向量，不会修改 Chunk 的列属性。
    */
   void reset_data();
 
@@ -99,4 +137,7 @@ private:
   // TODO: remove it and support multi-tables,
   // `columnd_ids` store the ids of child operator that need to be output
   vector<int> column_ids_;
+
+  bool        has_selection_ = false;
+  vector<int> selection_;
 };
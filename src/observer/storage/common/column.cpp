@@ -94,6 +94,7 @@ void Column::reset()
   count_     = 0;
   capacity_  = 0;
   own_       = false;
+  nulls_     = nullptr;
   attr_type_ = AttrType::UNDEFINED;
   attr_len_  = -1;
 }
@@ -138,6 +139,36 @@ RC Column::append_value(const Value &value)
   return RC::SUCCESS;
 }
 
+RC Column::append_null()
+{
+  if (!own_) {
+    LOG_WARN("append data to non-owned column");
+    return RC::INTERNAL;
+  }
+  if (count_ >= capacity_) {
+    LOG_WARN("append data to full column");
+    return RC::INTERNAL;
+  }
+
+  uint8_t *nulls = mutable_nulls();
+  memset(data_ + count_ * attr_len_, 0, attr_len_);
+  nulls[count_ / 8] |= 1 << (count_ % 8);
+  count_ += 1;
+  return RC::SUCCESS;
+}
+
+uint8_t *Column::mutable_nulls()
+{
+  const int size = null_bitmap_size(capacity_);
+  if (nulls_ == nullptr) {
+    null_buffer_.assign(size, 0);
+  } else if (nulls_ != null_buffer_.data()) {
+    null_buffer_.assign(nulls_, nulls_ + size);
+  }
+  nulls_ = null_buffer_.data();
+  return null_buffer_.data();
+}
+
 string_t Column::add_text(const char *data, int length)
 {
   if (vector_buffer_ == nullptr) {
@@ -151,7 +182,7 @@ Value Column::get_value(int index) const
   if (column_type_ == Type::CONSTANT_COLUMN) {
     index  = 0;
   }
-  if (index >= count_ || index < 0) {
+  if (index >= count_ || index < 0 || is_null(index)) {
     return Value();
   }
   return Value(attr_type_, &data_[index * attr_len_], attr_len_);
@@ -168,8 +199,24 @@ void Column::reference(const Column &column)
   this->capacity_ = column.capacity();
   this->count_    = column.count();
   this->own_      = false;
+  this->nulls_    = column.nulls();
 
   this->column_type_ = column.column_type();
   this->attr_type_   = column.attr_type();
   this->attr_len_    = column.attr_len();
 }
+
+void Column::reference(char *data, int count)
+{
+  if (data_ != nullptr && own_) {
+    delete[] data_;
+  }
+  vector_buffer_ = nullptr;
+
+  this->data_        = data;
+  this->nulls_       = nullptr;
+  this->count_       = count;
+  this->capacity_    = count;
+  this->own_         = false;
+  this->column_type_ = Type::NORMAL_COLUMN;
+}
@@ -12,11 +12,15 @@ See the Mulan PSL v2 for more details. */
 
 #include <string.h>
 
+#include "common/lang/vector.h"
 #include "storage/field/field_meta.h"
 #include "storage/common/vector_buffer.h"
 
 /**
  * @brief A column contains multiple values in contiguous memory with a specified type.
+ * @details NULL values are recorded in a validity bitmap, bit i is set if row i is NULL. The bitmap is
+ * absent if the column has no NULL, so the kernels can take the fast path without checking it.
+ * The value of a NULL row is undefined, usually zero.
  */
 // TODO: `Column` currently only support fixed-length type.
 class Column
@@ -41,6 +45,10 @@ public:
     data_        = new char[capacity_ * attr_len_];
     memcpy(data_, other.data_, capacity_ * attr_len_);
     vector_buffer_ = make_unique<VectorBuffer>();
+    if (other.nulls_ != nullptr) {
+      null_buffer_.assign(other.nulls_, other.nulls_ + null_bitmap_size(capacity_));
+      nulls_ = null_buffer_.data();
+    }
   }
   Column(Column &&other)
   {
@@ -52,7 +60,10 @@ public:
     attr_len_       = other.attr_len_;
     column_type_    = other.column_type_;
     vector_buffer_  = std::move(other.vector_buffer_);
+    nulls_          = other.nulls_;
+    null_buffer_    = std::move(other.null_buffer_);
     other.data_     = nullptr;
+    other.nulls_    = nullptr;
     other.count_    = 0;
     other.capacity_ = 0;
     other.own_      = false;
@@ -75,6 +86,11 @@ public:
 
   RC append_value(const Value &val);
 
+  /**
+   * @brief 追加一个 NULL 值，值的内容填充为 0
+   */
+  RC append_null();
+
   /**
    * @brief 向 Column 追加写入数据
    * @param data 要被写入数据的起始地址
@@ -83,10 +99,50 @@ public:
   RC append(const char *data, int count);
 
   /**
-   * @brief 获取 index 位置的列值
+   * @brief 获取 index 位置的列值，NULL 值返回未定义类型的 Value
    */
   Value get_value(int index) const;
 
+  /**
+   * @brief 列中是否可能有 NULL 值。为 false 时 nulls() 为空
+   */
+  bool has_nulls() const { return nulls_ != nullptr; }
+
+  /**
+   * @brief index 位置是否为 NULL，常量列只看第 0 个值
+   */
+  bool is_null(int index) const
+  {
+    if (nulls_ == nullptr) {
+      return false;
+    }
+    if (column_type_ == Type::CONSTANT_COLUMN) {
+      index = 0;
+    }
+    return (nulls_[index / 8] >> (index % 8)) & 1;
+  }
+
+  /**
+   * @brief 空值位图，没有 NULL 值时为空
+   */
+  const uint8_t *nulls() const { return nulls_; }
+
+  /**
+   * @brief 获取可以修改的空值位图，覆盖 capacity() 行。
+   * @details 没有位图时分配一个所有行都不为 NULL 的位图，引用的外部位图会先复制出来
+   */
+  uint8_t *mutable_nulls();
+
+  /**
+   * @brief 引用外部的空值位图，比如页面中的位图，nullptr 表示没有 NULL 值
+   */
+  void reference_nulls(const uint8_t *nulls) { nulls_ = nulls; }
+
+  /**
+   * @brief 存放 rows 行的空值位图需要的字节数
+   */
+  static int null_bitmap_size(int rows) { return (rows + 7) / 8; }
+
   RC copy_to(void *dest, int start_rows, int insert_rows) const
   {
     memcpy(dest, data_ + start_rows * attr_len_, insert_rows * attr_len_);
@@ -109,6 +165,7 @@ public:
   {
     count_         = 0;
     vector_buffer_ = nullptr;
+    nulls_         = nullptr;
   }
 
   /**
@@ -116,6 +173,12 @@ public:
    */
   void reference(const Column &column);
 
+  /**
+   * @brief 引用外部内存中连续的 count 个值，比如缓冲池页面中的一列，不复制数据
+   * @details 列的类型和长度不变，调用者需要保证在使用该列期间外部内存有效
+   */
+  void reference(char *data, int count);
+
   void set_column_type(Type column_type) { column_type_ = column_type; }
   void set_attr_type(AttrType attr_type) { attr_type_ = attr_type; }
   void set_count(int count) { count_ = count; }
@@ -142,4 +205,8 @@ private:
   /// 列类型
   Type                     column_type_   = Type::NORMAL_COLUMN;
   unique_ptr<VectorBuffer> vector_buffer_ = nullptr;
+  /// 空值位图，可能指向 null_buffer_ 或者引用的外部内存，为空时没有 NULL 值
+  const uint8_t *nulls_ = nullptr;
+  /// 列自己持有的空值位图
+  vector<uint8_t> null_buffer_;
 };
@@ -19,10 +19,13 @@ See the Mulan PSL v2 for more details. */
 #include <filesystem>
 #include <cstdio>
 
+#include "common/lang/algorithm.h"
 #include "common/lang/string.h"
 #include "common/log/log.h"
 #include "common/os/path.h"
 #include "common/global_context.h"
+#include "sql/plan_cache/plan_cache.h"
+#include "storage/buffer/page_flusher.h"
 #include "storage/common/meta_util.h"
 #include "storage/table/table.h"
 #include "storage/table/table_meta.h"
@@ -32,8 +35,18 @@ See the Mulan PSL v2 for more details. */
 
 using namespace common;
 
+Db::Db() : plan_cache_(make_unique<PlanCache>()) {}
+
 Db::~Db()
 {
+  // 后台线程会访问表的页面，最先停止
+  if (page_flusher_) {
+    page_flusher_->stop();
+  }
+
+  // 缓存的执行计划引用了表对象，需要先释放
+  plan_cache_.reset();
+
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
@@ -149,6 +162,16 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
     return rc;
   }
 
+  page_flusher_ = make_unique<PageFlusher>(*buffer_pool_manager_, *log_handler_);
+#ifdef CONCURRENCY
+  // 没有打开并发编译选项时，页面的锁什么都不做，不能在后台刷页面
+  rc = page_flusher_->start([this]() { return checkpoint(); });
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to start page flusher. dbpath=%s, rc=%s", dbpath, strrc(rc));
+    return rc;
+  }
+#endif
+
   return rc;
 }
 
@@ -174,6 +197,7 @@ RC Db::create_table(const char *table_name, span<const AttrInfoSqlNode> attribut
   }
 
   opened_tables_[table_name] = table;
+  plan_cache_->invalidate();
   LOG_INFO("Create table success. table name=%s, table_id:%d", table_name, table_id);
   return RC::SUCCESS;
 }
@@ -274,16 +298,72 @@ RC Db::sync()
     return rc;
   }
 
+  lock_guard<mutex> guard(checkpoint_lock_);
   check_point_lsn_ = current_lsn;
   rc               = flush_meta();
   if (OB_FAIL(rc)) {
     LOG_ERROR("Failed to flush meta. db=%s, rc=%d:%s", name_.c_str(), rc, strrc(rc));
     return rc;
   }
+
+  (void)log_handler_->truncate(check_point_lsn_);
   LOG_INFO("Successfully sync db. db=%s", name_.c_str());
   return rc;
 }
 
+RC Db::checkpoint()
+{
+  lock_guard<mutex> guard(checkpoint_lock_);
+
+  // 先拿到当前的LSN，之后开始的事务和之后才修改的页面，对应的日志都比它大
+  LSN checkpoint_lsn = log_handler_->current_lsn();
+
+  LSN lsn = 0;
+  if (trx_kit_->min_active_trx_lsn(lsn)) {
+    checkpoint_lsn = min(checkpoint_lsn, lsn);
+  }
+  if (buffer_pool_manager_->get_frame_manager().min_recovery_lsn(lsn)) {
+    checkpoint_lsn = min(checkpoint_lsn, lsn);
+  }
+
+  if (checkpoint_lsn <= check_point_lsn_) {
+    return RC::SUCCESS;
+  }
+
+  // 刷出去的页面可能还在 double write buffer 中，要先写到数据文件
+  auto dblwr_buffer = static_cast<DiskDoubleWriteBuffer *>(buffer_pool_manager_->get_dblwr_buffer());
+  RC   rc           = dblwr_buffer->flush_page();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush double write buffer. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // 重启时从检查点开始回放，要保证这条日志已经落盘，才能得到正确的最大LSN
+  rc = log_handler_->wait_lsn(checkpoint_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to wait lsn. lsn=%ld, rc=%s", checkpoint_lsn, strrc(rc));
+    return rc;
+  }
+
+  LSN old_checkpoint_lsn = check_point_lsn_;
+  check_point_lsn_       = checkpoint_lsn;
+  rc                     = flush_meta();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to flush meta. db=%s, rc=%s", name_.c_str(), strrc(rc));
+    check_point_lsn_ = old_checkpoint_lsn;
+    return rc;
+  }
+
+  rc = log_handler_->truncate(checkpoint_lsn);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to truncate log. checkpoint_lsn=%ld, rc=%s", checkpoint_lsn, strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("checkpoint done. db=%s, checkpoint_lsn=%ld", name_.c_str(), checkpoint_lsn);
+  return RC::SUCCESS;
+}
+
 RC Db::recover()
 {
   LOG_TRACE("db recover begin. check_point_lsn=%d", check_point_lsn_);
@@ -433,7 +513,10 @@ RC Db::drop_table(const char *table_name)
   }
 
   Table *table = iter->second;
-  
+
+  // 表的页面可能正在被后台刷新，关闭表之前先暂停
+  unique_lock<mutex> flusher_guard = page_flusher_->pause();
+
   // 同步表数据到磁盘
   RC rc = table->sync();
   if (rc != RC::SUCCESS) {
@@ -458,6 +541,7 @@ RC Db::drop_table(const char *table_name)
   
   // 从内存中删除表对象
   opened_tables_.erase(iter);
+  plan_cache_->invalidate();
   
   // 删除表文件
   string table_meta_file_path = table_meta_file(path_.c_str(), table_name);
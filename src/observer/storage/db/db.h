@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/string.h"
 #include "common/lang/unordered_map.h"
 #include "common/lang/memory.h"
+#include "common/lang/mutex.h"
 #include "common/lang/span.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -30,6 +31,8 @@ class Table;
 class LogHandler;
 class BufferPoolManager;
 class TrxKit;
+class PlanCache;
+class PageFlusher;
 
 /**
  * @brief 一个DB实例负责管理一批表
@@ -45,7 +48,7 @@ class TrxKit;
 class Db
 {
 public:
-  Db() = default;
+  Db();
   ~Db();
 
   /**
@@ -97,6 +100,13 @@ public:
    */
   RC sync();
 
+  /**
+   * @brief 做一次模糊检查点
+   * @details 不需要停止事务。检查点取当前LSN、所有脏页的恢复LSN和活跃事务的开始LSN中最小的一个，
+   * 写到元数据中，并删除检查点之前的日志文件。后台刷脏页的线程会定期调用。
+   */
+  RC checkpoint();
+
   /// @brief 获取当前数据库的日志处理器
   LogHandler &log_handler();
 
@@ -108,6 +118,9 @@ public:
 
   string path() const { return path_; }
 
+  /// @brief 获取当前数据库的执行计划缓存
+  PlanCache &plan_cache() { return *plan_cache_; }
+
   oceanbase::ObLsm *lsm() { return lsm_; }
 
 private:
@@ -146,11 +159,14 @@ private:
   unique_ptr<BufferPoolManager>  buffer_pool_manager_;  ///< 当前数据库的buffer pool管理器
   unique_ptr<LogHandler>         log_handler_;          ///< 当前数据库的日志处理器
   unique_ptr<TrxKit>             trx_kit_;              ///< 当前数据库的事务管理器
+  unique_ptr<PlanCache>          plan_cache_;           ///< 当前数据库的执行计划缓存
+  unique_ptr<PageFlusher>        page_flusher_;         ///< 后台刷脏页和做检查点
   oceanbase::ObLsm              *lsm_;                  ///< 当前数据库的 LSM-Tree 存储引擎
 
   /// 给每个table都分配一个ID，用来记录日志。这里假设所有的DDL都不会并发操作，所以相关的数据都不上锁
   int32_t next_table_id_ = 0;
 
+  mutex  checkpoint_lock_;      ///< sync 和后台检查点可能同时修改检查点
   LSN    check_point_lsn_ = 0;  ///< 当前数据库的检查点LSN。会记录到磁盘中。
   string storage_engine_;
 };
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 #include <unistd.h>
 
+#include "common/io/io.h"
 #include "common/log/log.h"
 #include "persist.h"
 
@@ -158,20 +159,35 @@ RC PersistHandler::write_at(uint64_t offset, int size, const char *data, int64_t
     LOG_ERROR("Failed to write, because file is not opened.");
     rc = RC::FILE_NOT_OPENED;
   } else {
-    if (lseek(file_desc_, offset, SEEK_SET) == off_t(-1)) {
-      LOG_ERROR("Failed to write %lld of %d:%s due to failed to seek %s.",
-          offset, file_desc_, file_name_.c_str(), strerror(errno));
-      rc = RC::IOERR_SEEK;
-    } else {
-      int64_t write_size = 0;
-      if ((write_size = write(file_desc_, data, size)) != size) {
-        LOG_ERROR("Failed to write %llu of %d:%s due to %s. Write size: %lld",
-            offset, file_desc_, file_name_.c_str(), strerror(errno), write_size);
-        rc = RC::IOERR_WRITE;
-      }
-      if (out_size != nullptr) {
-        *out_size = write_size;
-      }
+    int64_t write_size = 0;
+    if ((write_size = pwrite(file_desc_, data, size, offset)) != size) {
+      LOG_ERROR("Failed to write %llu of %d:%s due to %s. Write size: %lld",
+          offset, file_desc_, file_name_.c_str(), strerror(errno), write_size);
+      rc = RC::IOERR_WRITE;
+    }
+    if (out_size != nullptr) {
+      *out_size = write_size;
+    }
+  }
+
+  return rc;
+}
+
+RC PersistHandler::write_at(uint64_t offset, const struct iovec *iov, int iovcnt)
+{
+  RC rc = RC::SUCCESS;
+  if (file_name_.empty()) {
+    LOG_ERROR("Failed to write, because file is not exist.");
+    rc = RC::FILE_NOT_EXIST;
+  } else if (file_desc_ < 0) {
+    LOG_ERROR("Failed to write, because file is not opened.");
+    rc = RC::FILE_NOT_OPENED;
+  } else {
+    int ret = common::pwritevn(file_desc_, iov, iovcnt, offset);
+    if (ret != 0) {
+      LOG_ERROR("Failed to write %llu of %d:%s due to %s. iovcnt=%d",
+          offset, file_desc_, file_name_.c_str(), strerror(ret), iovcnt);
+      rc = RC::IOERR_WRITE;
     }
   }
 
@@ -245,21 +261,39 @@ RC PersistHandler::read_at(uint64_t offset, int size, char *data, int64_t *out_s
     LOG_ERROR("Failed to read, because file is not opened.");
     rc = RC::FILE_NOT_OPENED;
   } else {
-    if (lseek(file_desc_, offset, SEEK_SET) == off_t(-1)) {
-      LOG_ERROR("Failed to read %llu of %d:%s due to failed to seek %s.",
-          offset, file_desc_, file_name_.c_str(), strerror(errno));
-      return RC::IOERR_SEEK;
-    } else {
-      ssize_t read_size = read(file_desc_, data, size);
-      if (read_size == 0) {
-        LOG_TRACE("read file touch the end. file name=%s", file_name_.c_str());
-      } else if (read_size < 0) {
-        LOG_WARN("failed to read file. file name=%s, offset=%lld, size=%d, error=%s",
-          file_name_.c_str(), offset, size, strerror(errno));
-        rc = RC::IOERR_READ;
-      } else if (out_size != nullptr) {
-        *out_size = read_size;
-      }
+    ssize_t read_size = pread(file_desc_, data, size, offset);
+    if (read_size == 0) {
+      LOG_TRACE("read file touch the end. file name=%s", file_name_.c_str());
+    } else if (read_size < 0) {
+      LOG_WARN("failed to read file. file name=%s, offset=%lld, size=%d, error=%s",
+        file_name_.c_str(), offset, size, strerror(errno));
+      rc = RC::IOERR_READ;
+    } else if (out_size != nullptr) {
+      *out_size = read_size;
+    }
+  }
+
+  return rc;
+}
+
+RC PersistHandler::read_at(uint64_t offset, const struct iovec *iov, int iovcnt)
+{
+  RC rc = RC::SUCCESS;
+  if (file_name_.empty()) {
+    LOG_ERROR("Failed to read, because file is not exist.");
+    rc = RC::FILE_NOT_EXIST;
+  } else if (file_desc_ < 0) {
+    LOG_ERROR("Failed to read, because file is not opened.");
+    rc = RC::FILE_NOT_OPENED;
+  } else {
+    int ret = common::preadvn(file_desc_, iov, iovcnt, offset);
+    if (ret == -1) {
+      LOG_TRACE("read file touch the end. file name=%s, offset=%llu", file_name_.c_str(), offset);
+      rc = RC::RECORD_EOF;
+    } else if (ret != 0) {
+      LOG_WARN("failed to read file. file name=%s, offset=%llu, iovcnt=%d, error=%s",
+        file_name_.c_str(), offset, iovcnt, strerror(ret));
+      rc = RC::IOERR_READ;
     }
   }
 
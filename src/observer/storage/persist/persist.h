@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #include "common/sys/rc.h"
 #include "common/lang/string.h"
@@ -48,6 +49,9 @@ public:
   /** 在指定位置写入一段数据，并返回实际写入的数据大小out_size */
   RC write_at(uint64_t offset, int size, const char *data, int64_t *out_size = nullptr);
 
+  /** 把多段数据写入到从指定位置开始的连续区域，尽量一次系统调用完成，需要写完所有数据 */
+  RC write_at(uint64_t offset, const struct iovec *iov, int iovcnt);
+
   /** 在文件末尾写入一段数据，并返回实际写入的数据大小out_size */
   RC append(int size, const char *data, int64_t *out_size = nullptr, int64_t *out_offset = nullptr);
 
@@ -57,6 +61,9 @@ public:
   /** 在指定位置读取一段数据，并返回实际读取的数据大小out_size */
   RC read_at(uint64_t offset, int size, char *data, int64_t *out_size = nullptr);
 
+  /** 从指定位置开始读取连续的数据到多段内存中，需要读满所有内存，数据不够时返回 RECORD_EOF */
+  RC read_at(uint64_t offset, const struct iovec *iov, int iovcnt);
+
   /** 将文件描述符移动到指定位置 */
   RC seek(uint64_t offset);
 
@@ -12,6 +12,7 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include "storage/record/record_manager.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
@@ -185,7 +186,8 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
       BP_PAGE_DATA_SIZE, page_header_->record_size, column_num * sizeof(int) /* other fixed size*/);
   page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
   page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity)) +
-                              column_num * sizeof(int) /* column index*/;
+                              column_num * sizeof(int) /* column index*/ +
+                              column_num * page_bitmap_size(page_header_->record_capacity) /* null bitmaps */;
   this->fix_record_capacity();
   ASSERT(page_header_->data_offset + page_header_->record_capacity * page_header_->record_size 
               <= BP_PAGE_DATA_SIZE, 
@@ -193,6 +195,10 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
 
   bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
   memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+  // 每列的空值位图紧跟在列索引后面
+  memset(frame_->data() + page_header_->col_idx_offset + column_num * sizeof(int),
+      0,
+      column_num * page_bitmap_size(page_header_->record_capacity));
   // column_index[i] store the end offset of column `i` or the start offset of column `i+1`
 
   // 计算列偏移
@@ -236,7 +242,8 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
       page_record_capacity(BP_PAGE_DATA_SIZE, page_header_->record_size, page_header_->column_num * sizeof(int));
   page_header_->col_idx_offset = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
   page_header_->data_offset    = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity)) +
-                              column_num * sizeof(int) /* column index*/;
+                              column_num * sizeof(int) /* column index*/ +
+                              column_num * page_bitmap_size(page_header_->record_capacity) /* null bitmaps */;
   this->fix_record_capacity();
   ASSERT(page_header_->data_offset + page_header_->record_capacity * page_header_->record_size 
               <= BP_PAGE_DATA_SIZE, 
@@ -244,6 +251,9 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
 
   bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
   memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+  memset(frame_->data() + page_header_->col_idx_offset + column_num * sizeof(int),
+      0,
+      column_num * page_bitmap_size(page_header_->record_capacity));
   // column_index[i] store the end offset of column `i` the start offset of column `i+1`
   int *column_index = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
   memcpy(column_index, col_idx_data, column_num * sizeof(int));
@@ -423,18 +433,93 @@ bool RecordPageHandler::is_full() const { return page_header_->record_num >= pag
 
 RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
 {
-  // your code here
-  // Todo:
-  // 1.参考RowRecordPageHandler::insert_record完成大体实现
-  // 2.将一行数据拆分成不同的列插入到不同偏移中
-  // 对应列的偏移可以参照RecordPageHandler::init_empty_page
-  return RC::UNIMPLEMENTED;
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 找到空闲位置
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(0);
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  // 记录日志，与数据库恢复相关
+  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  // 将一行数据按列拆分，写入每列各自的区域。行数据中没有 NULL 值
+  int data_offset = 0;
+  for (int i = 0; i < page_header_->column_num; i++) {
+    int field_len = get_field_len(i);
+    memcpy(get_field_data(index, i), data + data_offset, field_len);
+    Bitmap(get_null_bitmap(i), page_header_->record_capacity).clear_bit(index);
+    data_offset += field_len;
+  }
+
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+
+  return RC::SUCCESS;
 }
 
 RC PaxRecordPageHandler::insert_chunk(const Chunk &chunk, int start_row, int &insert_rows)
 {
-  // your code here
-  return RC::UNIMPLEMENTED;
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert chunk into page while the page is readonly");
+
+  insert_rows = 0;
+  if (chunk.column_num() != page_header_->column_num) {
+    LOG_WARN("column number mismatch. chunk column num=%d, page column num=%d",
+             chunk.column_num(), page_header_->column_num);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Bitmap       bitmap(bitmap_, page_header_->record_capacity);
+  vector<char> record(page_header_->record_real_size);
+  for (int row = start_row; row < chunk.rows() && page_header_->record_num < page_header_->record_capacity; row++) {
+    int index = bitmap.next_unsetted_bit(0);
+    bitmap.set_bit(index);
+    page_header_->record_num++;
+
+    // 按列写入数据和空值位图，同时拼出整行数据用于记录日志
+    int data_offset = 0;
+    for (int i = 0; i < page_header_->column_num; i++) {
+      const Column &column    = chunk.column(i);
+      const int     field_len = get_field_len(i);
+      Bitmap        nulls(get_null_bitmap(i), page_header_->record_capacity);
+      if (column.is_null(row)) {
+        memset(record.data() + data_offset, 0, field_len);
+        nulls.set_bit(index);
+      } else {
+        const int value_row = column.column_type() == Column::Type::CONSTANT_COLUMN ? 0 : row;
+        memcpy(record.data() + data_offset, column.data() + value_row * field_len, field_len);
+        nulls.clear_bit(index);
+      }
+      memcpy(get_field_data(index, i), record.data() + data_offset, field_len);
+      data_offset += field_len;
+    }
+
+    RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), record.data());
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+      // return rc; // ignore errors
+    }
+    insert_rows++;
+  }
+
+  frame_->mark_dirty();
+  return RC::SUCCESS;
 }
 
 RC PaxRecordPageHandler::delete_record(const RID *rid)
@@ -494,6 +579,7 @@ RC PaxRecordPageHandler::update_record(const RID &rid, const char *data)
     int field_len = get_field_len(i);
     char *field_data = get_field_data(rid.slot_num, i);
     memcpy(field_data, data + data_offset, field_len);
+    Bitmap(get_null_bitmap(i), page_header_->record_capacity).clear_bit(rid.slot_num);
     data_offset += field_len;
   }
 
@@ -517,14 +603,73 @@ RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
   return RC::UNIMPLEMENTED;
 }
 
-// TODO: specify the column_ids that chunk needed. currenly we get all columns
-RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk, bool zero_copy)
 {
-  // your code here
-  // Todo:
-  // 参照PaxRecordPageHandler::get_record
-  // 一次性获得一个page的所有record
-  return RC::UNIMPLEMENTED;
+  // 只需要处理到最后一个有效的槽位
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    rows = 0;
+  for (int i = page_header_->record_capacity - 1; i >= 0; i--) {
+    if (bitmap.get_bit(i)) {
+      rows = i + 1;
+      break;
+    }
+  }
+  const bool has_hole = rows != page_header_->record_num;
+
+  for (int i = 0; i < chunk.column_num(); i++) {
+    int col_id = chunk.column_ids(i);
+    if (col_id < 0 || col_id >= page_header_->column_num) {
+      LOG_WARN("invalid column id. col_id=%d, column_num=%d", col_id, page_header_->column_num);
+      return RC::INVALID_ARGUMENT;
+    }
+    Column &column = chunk.column(i);
+    if (column.attr_len() != get_field_len(col_id)) {
+      LOG_WARN("column length mismatch. col_id=%d, column len=%d, field len=%d",
+               col_id, column.attr_len(), get_field_len(col_id));
+      return RC::INVALID_ARGUMENT;
+    }
+
+    // 同一列的数据在页面中是连续存放的，可以直接引用或者整段复制
+    char          *data      = get_field_data(0, col_id);
+    const uint8_t *nulls     = reinterpret_cast<const uint8_t *>(get_null_bitmap(col_id));
+    const bool     has_nulls = std::any_of(nulls, nulls + page_bitmap_size(rows), [](uint8_t b) { return b != 0; });
+    if (zero_copy) {
+      column.reference(data, rows);
+      column.reference_nulls(has_nulls ? nulls : nullptr);
+      continue;
+    }
+
+    RC rc = RC::SUCCESS;
+    if (!has_hole && !has_nulls) {
+      rc = column.append(data, rows);
+    } else {
+      const int field_len = get_field_len(col_id);
+      for (int slot = 0; slot < rows && OB_SUCC(rc); slot++) {
+        if (!bitmap.get_bit(slot)) {
+          continue;
+        }
+        if ((nulls[slot / 8] >> (slot % 8)) & 1) {
+          rc = column.append_null();
+        } else {
+          rc = column.append_one(data + slot * field_len);
+        }
+      }
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to append column data. col_id=%d, rc=%s", col_id, strrc(rc));
+      return rc;
+    }
+  }
+
+  // 引用页面数据时，已删除的槽位也在列中，通过选择向量跳过
+  if (zero_copy && has_hole) {
+    vector<uint8_t> select(rows);
+    for (int slot = 0; slot < rows; slot++) {
+      select[slot] = bitmap.get_bit(slot) ? 1 : 0;
+    }
+    chunk.select(select);
+  }
+  return RC::SUCCESS;
 }
 
 char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
@@ -537,6 +682,12 @@ char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
   }
 }
 
+char *PaxRecordPageHandler::get_null_bitmap(int col_id)
+{
+  return frame_->data() + page_header_->col_idx_offset + page_header_->column_num * sizeof(int) +
+         col_id * page_bitmap_size(page_header_->record_capacity);
+}
+
 int PaxRecordPageHandler::get_field_len(int col_id)
 {
   int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
@@ -589,7 +740,7 @@ RC RecordFileHandler::init_free_pages()
   RC rc = RC::SUCCESS;
 
   BufferPoolIterator bp_iterator;
-  bp_iterator.init(*disk_buffer_pool_, 1);
+  bp_iterator.init(*disk_buffer_pool_, 1, BufferPoolIterator::DEFAULT_READ_AHEAD_PAGES);
   unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
   PageNum                       current_page_num = 0;
 
@@ -826,7 +977,7 @@ RC ChunkFileScanner::open_scan_chunk(
   log_handler_      = &log_handler;
   rw_mode_          = mode;
 
-  RC rc = bp_iterator_.init(buffer_pool, 1);
+  RC rc = bp_iterator_.init(buffer_pool, 1, BufferPoolIterator::DEFAULT_READ_AHEAD_PAGES);
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
@@ -852,7 +1003,7 @@ RC ChunkFileScanner::next_chunk(Chunk &chunk)
       LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
       return rc;
     }
-    rc = record_page_handler_->get_chunk(chunk);
+    rc = record_page_handler_->get_chunk(chunk, zero_copy_);
     if (rc == RC::SUCCESS) {
       return rc;
     } else if (rc == RC::RECORD_EOF) {
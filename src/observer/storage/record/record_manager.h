@@ -16,6 +16,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/bitmap.h"
 #include "common/lang/sstream.h"
+#include "common/lang/unordered_set.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/common/chunk.h"
 #include "storage/record/record.h"
@@ -217,10 +218,11 @@ public:
   /**
    * @brief 获取整个页面中指定列的所有记录。
    *
-   * @param chunk 由 chunk.column(i).col_id() 指定列。
+   * @param chunk 由 chunk.column_ids(i) 指定列，只读取 chunk 中已有的列。
+   * @param zero_copy 是否直接引用页面中的数据而不复制。只有在页面被固定并加锁期间才能使用结果。
    * 只需由 PaxRecordPageHandler 实现。
    */
-  virtual RC get_chunk(Chunk &chunk) { return RC::UNIMPLEMENTED; }
+  virtual RC get_chunk(Chunk &chunk, bool zero_copy = false) { return RC::UNIMPLEMENTED; }
 
   /**
    * @brief 返回该记录页的页号
@@ -309,10 +311,11 @@ public:
  * @ingroup RecordManager
  * @details PAX 格式实现，当前定长记录模式下每个页面的组织大概是这样的：
  * @code
- * | PageHeader | record allocate bitmap | column index  |
- * |------------|------------------------| ------------- |
+ * | PageHeader | record allocate bitmap | column index  | column1 null bitmap | ... | columnN null bitmap |
+ * |------------|------------------------| ------------- | ------------------------------------------------|
  * | column1 | column2 | ..................... | columnN |
  * @endcode
+ * 每列的空值位图与 record allocate bitmap 一样大，第 i 位为 1 表示第 i 个槽位上该列的值为 NULL。
  * 更多细节可参考：docs/design/miniob-pax-storage.md
  */
 class PaxRecordPageHandler : public RecordPageHandler
@@ -329,7 +332,13 @@ public:
    */
   virtual RC insert_record(const char *data, RID *rid) override;
 
-  // TODO: insert chunk only used in load_data
+  /**
+   * @brief 从 chunk 的第 start_row 行开始插入，直到页面写满或者 chunk 中没有更多的行
+   *
+   * @param chunk 与表中字段一一对应的所有列，列中的 NULL 值记录在页面的空值位图中
+   * @param insert_rows 返回插入的行数
+   * TODO: insert chunk only used in load_data
+   */
   virtual RC insert_chunk(const Chunk &chunk, int start_row, int &insert_rows) override;
 
   virtual RC delete_record(const RID *rid) override;
@@ -348,9 +357,11 @@ public:
   /**
    * @brief 以 Chunk 格式获取整个页面中指定列的所有记录。
    *
-   * @param chunk 由 chunk.column(i).col_id() 指定列。
+   * @param chunk 由 chunk.column_ids(i) 指定列，其它列的数据不会被读取。
+   * @param zero_copy 为 true 时，列直接引用页面中该列的连续数据，已删除的槽位通过 chunk 的选择向量过滤；
+   * 否则将有效的记录复制到列中。
    */
-  virtual RC get_chunk(Chunk &chunk) override;
+  virtual RC get_chunk(Chunk &chunk, bool zero_copy = false) override;
 
 private:
   // get the field data by `slot_num` and `column id`
@@ -358,6 +369,9 @@ private:
 
   // get the field length by `column id`, all columns are fixed length.
   int get_field_len(int col_id);
+
+  // get the null bitmap of the column `col_id`, a bit is set if the field of the slot is NULL
+  char *get_null_bitmap(int col_id);
 };
 /**
  * @brief 管理整个文件中记录的增删改查
@@ -459,15 +473,23 @@ public:
 
   /**
    * @brief 每次调用获取一个页面中的所有记录。
+   * @details 只读取 chunk 中已有的列
    */
   RC next_chunk(Chunk &chunk);
 
+  /**
+   * @brief 返回的 chunk 是否直接引用页面中的数据
+   * @details 页面在下一次调用 next_chunk 或 close_scan 之前保持固定，只能用于只读的扫描
+   */
+  void set_zero_copy(bool zero_copy) { zero_copy_ = zero_copy; }
+
 private:
   Table *table_ = nullptr;  ///< 当前遍历的是哪张表。
 
   DiskBufferPool *disk_buffer_pool_ = nullptr;  ///< 当前访问的文件
   LogHandler     *log_handler_      = nullptr;
   ReadWriteMode   rw_mode_ = ReadWriteMode::READ_WRITE;  ///< 遍历出来的数据，是否可能对它做修改
+  bool            zero_copy_ = false;  ///< 是否直接引用页面中的数据
 
   BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
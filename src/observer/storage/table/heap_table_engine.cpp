@@ -62,6 +62,20 @@ RC HeapTableEngine::insert_record(Record &record)
   return rc;
 }
 
+RC HeapTableEngine::insert_records(vector<Record> &records, size_t &inserted_count)
+{
+  RC rc          = RC::SUCCESS;
+  inserted_count = 0;
+  for (Record &record : records) {
+    rc = insert_record(record);
+    if (rc != RC::SUCCESS) {
+      return rc;
+    }
+    inserted_count++;
+  }
+  return rc;
+}
+
 RC HeapTableEngine::insert_chunk(const Chunk& chunk)
 {
   RC rc = RC::SUCCESS;
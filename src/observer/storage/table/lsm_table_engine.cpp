@@ -29,6 +29,25 @@ RC LsmTableEngine::insert_record(Record &record)
   return rc;
 }
 
+RC LsmTableEngine::insert_records(vector<Record> &records, size_t &inserted_count)
+{
+  inserted_count = 0;
+  // 一次性分配一段连续的自增 id
+  uint64_t     id = inc_id_.fetch_add(records.size());
+  ObWriteBatch batch;
+  bytes        lsm_key;
+  for (Record &record : records) {
+    lsm_key.clear();
+    Codec::encode(table_->table_id(), id++, lsm_key);
+    batch.put(string_view((char *)lsm_key.data(), lsm_key.size()), string_view(record.data(), record.len()));
+  }
+  RC rc = lsm_->write(batch);
+  if (rc == RC::SUCCESS) {
+    inserted_count = records.size();
+  }
+  return rc;
+}
+
 RC LsmTableEngine::get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode)
 {
   scanner = new LsmRecordScanner(table_, db_->lsm(), trx);
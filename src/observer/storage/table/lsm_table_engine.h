@@ -29,6 +29,11 @@ public:
   ~LsmTableEngine() override = default;
 
   RC insert_record(Record &record) override;
+  /**
+   * @brief 批量插入记录
+   * @details 所有记录放在一个 ObWriteBatch 中写入 oblsm，只写一次 WAL，并且原子生效
+   */
+  RC insert_records(vector<Record> &records, size_t &inserted_count) override;
   RC insert_chunk(const Chunk &chunk) override { return RC::UNIMPLEMENTED; }
   RC delete_record(const Record &record) override { return RC::UNIMPLEMENTED; }
   RC insert_record_with_trx(Record &record, Trx *trx) override { return RC::UNIMPLEMENTED; }
@@ -21,6 +21,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "common/global_context.h"
+#include "sql/plan_cache/plan_cache.h"
 #include "storage/db/db.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/common/condition_filter.h"
@@ -174,31 +175,50 @@ RC Table::open(Db *db, const char *meta_file, const char *base_dir)
 
 RC Table::insert_record(Record &record)
 {
-  return engine_->insert_record(record);
+  RC rc = engine_->insert_record(record);
+  increase_modify_version();
+  return rc;
+}
+
+RC Table::insert_records(vector<Record> &records, size_t &inserted_count)
+{
+  RC rc = engine_->insert_records(records, inserted_count);
+  increase_modify_version();
+  return rc;
 }
 
 RC Table::insert_chunk(const Chunk& chunk)
 {
-  return engine_->insert_chunk(chunk);
+  RC rc = engine_->insert_chunk(chunk);
+  increase_modify_version();
+  return rc;
 }
 
 RC Table::visit_record(const RID &rid, function<bool(Record &)> visitor)
 {
-  return engine_->visit_record(rid, visitor);
+  RC rc = engine_->visit_record(rid, visitor);
+  increase_modify_version();
+  return rc;
 }
 
 RC Table::insert_record_with_trx(Record &record, Trx *trx)
 {
-  return engine_->insert_record_with_trx(record, trx);
+  RC rc = engine_->insert_record_with_trx(record, trx);
+  increase_modify_version();
+  return rc;
 }
 RC Table::delete_record_with_trx(const Record &record, Trx *trx)
 {
-  return engine_->delete_record_with_trx(record, trx);
+  RC rc = engine_->delete_record_with_trx(record, trx);
+  increase_modify_version();
+  return rc;
 }
 
 RC Table::update_record_with_trx(Trx *trx, const Record &old_record, const Record &new_record)
 {
-  return engine_->update_record_with_trx(trx, old_record, new_record);
+  RC rc = engine_->update_record_with_trx(trx, old_record, new_record);
+  increase_modify_version();
+  return rc;
 }
 
 RC Table::get_record(const RID &rid, Record &record)
@@ -276,12 +296,19 @@ RC Table::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode m
 
 RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name)
 {
-  return engine_->create_index(trx, field_meta, index_name);
+  RC rc = engine_->create_index(trx, field_meta, index_name);
+  if (OB_SUCC(rc) && db_ != nullptr) {
+    // 新的索引可能让查询使用不同的执行计划
+    db_->plan_cache().invalidate();
+  }
+  return rc;
 }
 
 RC Table::delete_record(const Record &record)
 {
-  return engine_->delete_record(record);
+  RC rc = engine_->delete_record(record);
+  increase_modify_version();
+  return rc;
 }
 
 Index *Table::find_index(const char *index_name) const
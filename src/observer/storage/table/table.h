@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/record/lob_handler.h"
 #include "common/types.h"
 #include "common/lang/span.h"
+#include "common/lang/atomic.h"
 #include "common/lang/functional.h"
 
 struct RID;
@@ -85,6 +86,15 @@ public:
    */
   RC insert_record(Record &record);
 
+  /**
+   * @brief 在当前的表中批量插入记录
+   * @details 存储引擎可以合并这些记录的写入，比如 LSM 引擎将它们作为一个批次原子写入。
+   * 与 insert_record 一样不关心事务相关操作。
+   * @param inserted_count[out] 实际插入成功的记录数。失败时前 inserted_count 条记录已经写入，
+   * 原子写入的引擎（如 LSM）失败时为 0
+   */
+  RC insert_records(vector<Record> &records, size_t &inserted_count);
+
   RC insert_chunk(const Chunk &chunk);
   RC delete_record(const Record &record);
 
@@ -119,9 +129,18 @@ public:
 
   LobFileHandler *lob_handler() const { return lob_handler_; }
 
+  /**
+   * @brief 表数据的修改版本号
+   * @details 每次插入、删除、更新记录后都会增加，查询缓存用它判断缓存的结果是否还有效。
+   * 修改完成之后才增加版本号，这样在修改之前读到的版本号一定会失效。
+   */
+  uint64_t modify_version() const { return modify_version_.load(); }
+
   RC sync();
 
 private:
+  void increase_modify_version() { modify_version_.fetch_add(1); }
+
   RC set_value_to_record(char *record_data, const Value &value, const FieldMeta *field);
 
 private:
@@ -139,4 +158,5 @@ private:
   // vector<Index *>    indexes_;
   unique_ptr<TableEngine> engine_      = nullptr;
   LobFileHandler         *lob_handler_ = nullptr;
+  atomic<uint64_t>        modify_version_{0};  ///< 参考 modify_version
 };
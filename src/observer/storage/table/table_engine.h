@@ -39,6 +39,7 @@ public:
   virtual ~TableEngine() = default;
 
   virtual RC insert_record(Record &record)                                                        = 0;
+  virtual RC insert_records(vector<Record> &records, size_t &inserted_count)                      = 0;
   virtual RC insert_chunk(const Chunk &chunk)                                                     = 0;
   virtual RC delete_record(const Record &record)                                                  = 0;
   virtual RC insert_record_with_trx(Record &record, Trx *trx)                                     = 0;
@@ -93,6 +93,22 @@ void MvccTrxKit::all_trxes(vector<Trx *> &trxes)
   lock_.unlock();
 }
 
+bool MvccTrxKit::min_active_trx_lsn(LSN &lsn)
+{
+  bool found = false;
+
+  lock_.lock();
+  for (Trx *trx : trxes_) {
+    LSN trx_lsn = 0;
+    if (static_cast<MvccTrx *>(trx)->begin_lsn(trx_lsn) && (!found || trx_lsn < lsn)) {
+      lsn   = trx_lsn;
+      found = true;
+    }
+  }
+  lock_.unlock();
+  return found;
+}
+
 LogReplayer *MvccTrxKit::create_log_replayer(Db &db, LogHandler &log_handler)
 {
   return new MvccTrxLogReplayer(db, *this, log_handler);
@@ -316,12 +332,19 @@ RC MvccTrx::start_if_need()
   if (!started_) {
     ASSERT(operations_.empty(), "try to start a new trx while operations is not empty");
     trx_id_ = trx_kit_.next_trx_id();
+    begin_lsn_.store(log_handler_.current_lsn());
     LOG_DEBUG("current thread change to new trx with %d", trx_id_);
     started_ = true;
   }
   return RC::SUCCESS;
 }
 
+bool MvccTrx::begin_lsn(LSN &lsn) const
+{
+  lsn = begin_lsn_.load();
+  return lsn >= 0;
+}
+
 RC MvccTrx::commit()
 {
   int32_t commit_id = trx_kit_.next_trx_id();
@@ -391,6 +414,7 @@ RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
   }
 
   operations_.clear();
+  begin_lsn_.store(-1);
 
   LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
   return rc;
@@ -470,6 +494,7 @@ RC MvccTrx::rollback()
   if (!recovering_) {
     rc = log_handler_.rollback(trx_id_);
   }
+  begin_lsn_.store(-1);
   LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
   return rc;
 }
@@ -38,6 +38,8 @@ public:
 
   void all_trxes(vector<Trx *> &trxes) override;
 
+  bool min_active_trx_lsn(LSN &lsn) override;
+
   LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) override;
 
 public:
@@ -96,6 +98,12 @@ public:
 
   int32_t id() const override { return trx_id_; }
 
+  /**
+   * @brief 事务开始时的LSN，事务写的日志都比它大
+   * @return 事务没有开始或者已经结束时返回 false
+   */
+  bool begin_lsn(LSN &lsn) const;
+
 private:
   RC   commit_with_trx_id(int32_t commit_id);
   void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
@@ -134,6 +142,7 @@ private:
   int32_t           trx_id_     = -1;
   bool              started_    = false;
   bool              recovering_ = false;
+  atomic<LSN>       begin_lsn_{-1};  ///< 提交或回滚的日志写完之后才重置，做检查点时读取
   OperationSet      operations_;
   LockMap           intra_transaction_locks_;  // 同一事务内已获取的锁
   common::Mutex     lock_mutex_;               // 保护intra_transaction_locks_的互斥锁
@@ -134,6 +134,11 @@ public:
    */
   RC rollback(int32_t trx_id);
 
+  /**
+   * @brief 当前最新日志的LSN
+   */
+  LSN current_lsn() const;
+
 private:
   LogHandler &log_handler_;
 };
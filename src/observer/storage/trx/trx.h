@@ -127,6 +127,13 @@ public:
 
   virtual void destroy_trx(Trx *trx) = 0;
 
+  /**
+   * @brief 所有还没有结束的事务中，最小的开始LSN
+   * @details 做检查点时使用。检查点不能越过还没有结束的事务写的日志，否则重启时无法回放或回滚这些事务。
+   * @return 没有活跃事务时返回 false
+   */
+  virtual bool min_active_trx_lsn(LSN &lsn) { return false; }
+
   virtual LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) = 0;
 
 public:
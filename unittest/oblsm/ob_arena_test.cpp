@@ -12,10 +12,11 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/util/ob_arena.h"
 #include "common/math/random_generator.h"
+#include "common/lang/thread.h"
 
 using namespace oceanbase;
 
-TEST(arena_test, DISABLED_arena_test_basic)
+TEST(arena_test, arena_test_basic)
 {
   ObArena arena;
   const int count = 1000;
@@ -39,6 +40,26 @@ TEST(arena_test, DISABLED_arena_test_basic)
   }
 }
 
+TEST(arena_test, arena_test_concurrent_alloc)
+{
+  ObArena   arena;
+  const int thread_num = 8;
+  const int count      = 10000;
+  vector<thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&arena, t]() {
+      for (int i = 0; i < count; i++) {
+        char *r = arena.alloc(16);
+        memset(r, t, 16);
+      }
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+  ASSERT_EQ(arena.memory_usage(), thread_num * count * (16 + sizeof(char *)));
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
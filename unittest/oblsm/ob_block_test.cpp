@@ -13,10 +13,11 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/table/ob_block.h"
 #include "oblsm/table/ob_block_builder.h"
 #include "oblsm/util/ob_comparator.h"
+#include "oblsm/util/ob_coding.h"
 
 using namespace oceanbase;
 
-TEST(block_test, DISABLED_block_builder_test_basic)
+TEST(block_test, block_builder_test_basic)
 {
   ObBlockBuilder builder;
   ObDefaultComparator comparator;
@@ -33,7 +34,7 @@ TEST(block_test, DISABLED_block_builder_test_basic)
   ASSERT_EQ(block.size(), 4);
 }
 
-TEST(block_test, DISABLED_block_iterator_test_basic)
+TEST(block_test, block_iterator_test_basic)
 {
   ObBlockBuilder builder;
   ObDefaultComparator comparator;
@@ -48,7 +49,7 @@ TEST(block_test, DISABLED_block_iterator_test_basic)
   ObBlock block(&comparator);
   block.decode(string(block_contents.data(), block_contents.size()));
   ASSERT_EQ(block.size(), 4);
-  BlockIterator iter(&comparator, &block, block.size());
+  BlockIterator iter(&comparator, &block);
   iter.seek_to_first();
   ASSERT_TRUE(iter.valid());
   ASSERT_EQ(iter.key(), "key1");
@@ -59,6 +60,65 @@ TEST(block_test, DISABLED_block_iterator_test_basic)
   }
 }
 
+TEST(block_test, block_iterator_test_seek)
+{
+  // internal keys sharing a long prefix, spanning several restart points
+  ObBlockBuilder builder;
+  ObDefaultComparator comparator;
+  const int count = 100;
+  auto internal_key = [](int i) {
+    string key = "common_prefix_key" + to_string(1000 + i);
+    put_numeric<uint64_t>(&key, i);
+    return key;
+  };
+  size_t raw_size = 0;
+  for (int i = 0; i < count; i += 2) {
+    string key = internal_key(i);
+    ASSERT_EQ(builder.add(key, "value" + to_string(i)), RC::SUCCESS);
+    raw_size += key.size() + ("value" + to_string(i)).size();
+  }
+  ASSERT_EQ(builder.last_key(), internal_key(count - 2));
+  string_view block_contents = builder.finish();
+  // the shared prefixes are not stored
+  ASSERT_LT(block_contents.size(), raw_size);
+
+  ObBlock block(&comparator);
+  ASSERT_EQ(block.decode(string(block_contents.data(), block_contents.size())), RC::SUCCESS);
+  ASSERT_EQ(block.size(), count / 2);
+  ASSERT_EQ(block.restart_count(), (count / 2 + ObBlockBuilder::RESTART_INTERVAL - 1) / ObBlockBuilder::RESTART_INTERVAL);
+
+  BlockIterator iter(&comparator, &block);
+  int           entries = 0;
+  for (iter.seek_to_first(); iter.valid(); iter.next()) {
+    ASSERT_EQ(iter.key(), internal_key(entries * 2));
+    ASSERT_EQ(iter.value(), "value" + to_string(entries * 2));
+    entries++;
+  }
+  ASSERT_EQ(entries, count / 2);
+
+  iter.seek_to_last();
+  ASSERT_TRUE(iter.valid());
+  ASSERT_EQ(iter.key(), internal_key(count - 2));
+
+  for (int i = -1; i <= count; i++) {
+    // "common_prefix_key" is less than all the keys
+    string user_key = "common_prefix_key" + (i < 0 ? string() : to_string(1000 + i));
+    string lookup_key;
+    put_numeric<uint64_t>(&lookup_key, user_key.size() + SEQ_SIZE);
+    lookup_key.append(user_key);
+    put_numeric<uint64_t>(&lookup_key, 0);
+    iter.seek(lookup_key);
+    // the first key that is not less than the target
+    int expected = i < 0 ? 0 : (i + 1) / 2 * 2;
+    if (expected >= count) {
+      ASSERT_FALSE(iter.valid());
+    } else {
+      ASSERT_TRUE(iter.valid());
+      ASSERT_EQ(iter.key(), internal_key(expected));
+    }
+  }
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
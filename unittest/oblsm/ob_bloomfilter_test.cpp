@@ -15,13 +15,13 @@ See the Mulan PSL v2 for more details. */
 
 using namespace oceanbase;
 
-TEST(BloomfilterTest, DISABLED_ConstructorTest) {
+TEST(BloomfilterTest, ConstructorTest) {
     ObBloomfilter bf(4);
     EXPECT_TRUE(bf.empty());
     EXPECT_EQ(bf.object_count(), 0);
 }
 
-TEST(BloomfilterTest, DISABLED_InsertAndContainsTest) {
+TEST(BloomfilterTest, InsertAndContainsTest) {
     ObBloomfilter bf(4);
 
     bf.insert("database");
@@ -34,7 +34,7 @@ TEST(BloomfilterTest, DISABLED_InsertAndContainsTest) {
     EXPECT_EQ(bf.object_count(), 2);
 }
 
-TEST(BloomfilterTest, DISABLED_ClearTest) {
+TEST(BloomfilterTest, ClearTest) {
     ObBloomfilter bf(4);
 
     bf.insert("bloom");
@@ -47,7 +47,7 @@ TEST(BloomfilterTest, DISABLED_ClearTest) {
     EXPECT_EQ(bf.object_count(), 0);
 }
 
-TEST(BloomfilterTest, DISABLED_EmptyTest) {
+TEST(BloomfilterTest, EmptyTest) {
     ObBloomfilter bf(4);
 
     EXPECT_TRUE(bf.empty());
@@ -59,7 +59,7 @@ TEST(BloomfilterTest, DISABLED_EmptyTest) {
     EXPECT_TRUE(bf.empty());
 }
 
-TEST(BloomFilterTest, DISABLED_MultiThreadInsertTest) {
+TEST(BloomFilterTest, MultiThreadInsertTest) {
     ObBloomfilter bloom_filter;
     const size_t thread_count = 10;
     const size_t insertions_per_thread = 1000;
@@ -85,6 +85,45 @@ TEST(BloomFilterTest, DISABLED_MultiThreadInsertTest) {
     EXPECT_FALSE(bloom_filter.contains("non_existent_item"));
 }
 
+TEST(BloomfilterTest, FalsePositiveRateTest) {
+    const size_t key_count = 10000;
+    std::unique_ptr<ObBloomfilter> bf = ObBloomfilter::create(key_count, 10);
+    for (size_t i = 0; i < key_count; ++i) {
+        bf->insert("key_" + std::to_string(i));
+    }
+    for (size_t i = 0; i < key_count; ++i) {
+        ASSERT_TRUE(bf->contains("key_" + std::to_string(i)));
+    }
+
+    size_t false_positive = 0;
+    for (size_t i = 0; i < key_count; ++i) {
+        if (bf->contains("missing_" + std::to_string(i))) {
+            false_positive++;
+        }
+    }
+    // about 1% with 10 bits per key
+    EXPECT_LT(false_positive, key_count * 2 / 100);
+}
+
+TEST(BloomfilterTest, EncodeDecodeTest) {
+    ObBloomfilter bf(7, 4096);
+    for (size_t i = 0; i < 300; ++i) {
+        bf.insert("key_" + std::to_string(i));
+    }
+
+    ObBloomfilter decoded;
+    ASSERT_EQ(decoded.decode(bf.encode()), RC::SUCCESS);
+    EXPECT_EQ(decoded.object_count(), bf.object_count());
+    EXPECT_EQ(decoded.hash_func_count(), bf.hash_func_count());
+    EXPECT_EQ(decoded.total_bits(), bf.total_bits());
+    for (size_t i = 0; i < 1000; ++i) {
+        std::string key = "key_" + std::to_string(i);
+        EXPECT_EQ(decoded.contains(key), bf.contains(key));
+    }
+
+    EXPECT_NE(decoded.decode("short"), RC::SUCCESS);
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
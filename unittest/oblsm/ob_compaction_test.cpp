@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/include/ob_lsm.h"
 #include "oblsm/ob_lsm_impl.h"
 #include "unittest/oblsm/ob_lsm_test_base.h"
+#include "oblsm/compaction/ob_compaction_picker.h"
+#include "oblsm/table/ob_sstable_builder.h"
 
 using namespace oceanbase;
 
@@ -70,7 +72,7 @@ bool check_compaction(ObLsm* lsm)
   return true;
 }
 
-TEST_P(ObLsmCompactionTest, DISABLED_oblsm_compaction_test_basic1)
+TEST_P(ObLsmCompactionTest, oblsm_compaction_test_basic1)
 {
   size_t num_entries = GetParam();
   auto data = KeyValueGenerator::generate_data(num_entries);
@@ -100,7 +102,7 @@ void thread_put(ObLsm *db, int start, int end) {
   }
 }
 
-TEST_P(ObLsmCompactionTest, DISABLED_ConcurrentPutAndGetTest) {
+TEST_P(ObLsmCompactionTest, ConcurrentPutAndGetTest) {
   const int num_entries = GetParam();
   const int num_threads = 4;
   const int batch_size = num_entries / num_threads;
@@ -142,6 +144,181 @@ TEST_P(ObLsmCompactionTest, DISABLED_ConcurrentPutAndGetTest) {
   ASSERT_TRUE(check_compaction(db));
 }
 
+// builds a sstable with keys "key<begin>" ... "key<end - 1>", each value has `value_size` bytes
+shared_ptr<ObSSTable> build_sstable(const ObComparator *comparator, const string &dir, uint32_t sst_id,
+    int begin, int end, size_t value_size = 16)
+{
+  shared_ptr<ObMemTable> mem = make_shared<ObMemTable>();
+  for (int i = begin; i < end; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%06d", i);
+    mem->put(i, key, string(value_size, 'v'));
+  }
+  // the picker tests depend on the table sizes, keep the blocks uncompressed
+  ObSSTableBuilder tb(comparator, nullptr);
+  tb.set_compression(CompressionType::NONE);
+  EXPECT_EQ(tb.build(mem, dir + "/" + to_string(sst_id) + SSTABLE_SUFFIX, sst_id), RC::SUCCESS);
+  return tb.get_built_table();
+}
+
+TEST(LeveledCompactionPickerTest, pick)
+{
+  string dir = "./leveled_picker_test";
+  filesystem::remove_all(dir);
+  filesystem::create_directory(dir);
+
+  ObDefaultComparator comparator;
+  ObLsmOptions        options;
+  options.default_levels        = 3;
+  options.default_l0_file_num   = 3;
+  options.default_l1_level_size = 16 * 1024;
+  options.default_level_ratio   = 10;
+  LeveledCompactionPicker picker(&options);
+
+  SSTablesPtr sstables = make_shared<vector<vector<shared_ptr<ObSSTable>>>>(options.default_levels);
+  // level 1: [0, 100) [100, 200) [200, 300)
+  for (int i = 0; i < 3; i++) {
+    sstables->at(1).emplace_back(build_sstable(&comparator, dir, 10 + i, i * 100, (i + 1) * 100));
+  }
+  // level 2: [0, 1000)
+  sstables->at(2).emplace_back(build_sstable(&comparator, dir, 20, 0, 1000));
+
+  // level 0 has 2 tables, level 1 is smaller than its target size
+  sstables->at(0).emplace_back(build_sstable(&comparator, dir, 1, 50, 120));
+  sstables->at(0).emplace_back(build_sstable(&comparator, dir, 2, 60, 150));
+  ASSERT_LT(picker.level_score(sstables->at(1), 1), 1);
+  ASSERT_EQ(picker.pick(sstables), nullptr);
+
+  // level 0 is full, all its tables and the overlapping tables of level 1 are picked
+  sstables->at(0).emplace_back(build_sstable(&comparator, dir, 3, 70, 80));
+  unique_ptr<ObCompaction> compaction = picker.pick(sstables);
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->level(), 0);
+  ASSERT_EQ(compaction->inputs(0).size(), 3);
+  ASSERT_EQ(compaction->inputs(1).size(), 2);
+  ASSERT_EQ(compaction->inputs(1)[0]->sst_id(), 10);
+  ASSERT_EQ(compaction->inputs(1)[1]->sst_id(), 11);
+
+  // level 1 exceeds its target size, the largest table and the overlapping table of level 2 are picked
+  sstables->at(0).clear();
+  sstables->at(1).emplace_back(build_sstable(&comparator, dir, 13, 300, 400, 200));
+  ASSERT_GE(picker.level_score(sstables->at(1), 1), 1);
+  compaction = picker.pick(sstables);
+  ASSERT_NE(compaction, nullptr);
+  ASSERT_EQ(compaction->level(), 1);
+  ASSERT_EQ(compaction->inputs(0).size(), 1);
+  ASSERT_EQ(compaction->inputs(0)[0]->sst_id(), 13);
+  ASSERT_EQ(compaction->inputs(1).size(), 1);
+  ASSERT_EQ(compaction->inputs(1)[0]->sst_id(), 20);
+
+  filesystem::remove_all(dir);
+}
+
+// the number of entries (all versions) in the sstables
+size_t count_sstable_entries(ObLsm *lsm)
+{
+  ObLsmImpl *lsm_impl = dynamic_cast<ObLsmImpl *>(lsm);
+  size_t     count    = 0;
+  for (const auto &level : *lsm_impl->get_sstables()) {
+    for (const auto &sstable : level) {
+      unique_ptr<ObLsmIterator> iter(sstable->new_iterator());
+      for (iter->seek_to_first(); iter->valid(); iter->next()) {
+        count++;
+      }
+    }
+  }
+  return count;
+}
+
+TEST_P(ObLsmCompactionTest, DropObsoleteVersionsTest) {
+  const int num_entries = std::min<int>(GetParam(), 1000);
+  const int rounds      = 20;
+  auto      write_round = [&](int round) {
+    for (int i = 0; i < num_entries; ++i) {
+      ASSERT_EQ(db->put("key" + to_string(i), "value" + to_string(round)), RC::SUCCESS);
+    }
+  };
+
+  write_round(0);
+  const ObLsmSnapshot *snapshot = db->get_snapshot();
+  for (int round = 1; round < rounds; round++) {
+    write_round(round);
+  }
+  sleep(1);
+
+  // the versions visible to the snapshot survive the compactions
+  ObLsmReadOptions snapshot_options;
+  snapshot_options.snapshot = snapshot;
+  for (int i = 0; i < num_entries; ++i) {
+    string value;
+    ASSERT_EQ(db->get(snapshot_options, "key" + to_string(i), &value), RC::SUCCESS);
+    EXPECT_EQ(value, "value0");
+  }
+  db->release_snapshot(snapshot);
+
+  // without snapshots, the overwritten versions are dropped by the following compactions
+  for (int round = rounds; round < 2 * rounds; round++) {
+    write_round(round);
+  }
+  for (int i = 0; i < num_entries; ++i) {
+    ASSERT_EQ(db->remove("key" + to_string(i)), RC::SUCCESS);
+  }
+  sleep(1);
+  for (int i = 0; i < num_entries; ++i) {
+    string value;
+    ASSERT_EQ(db->get("key" + to_string(i), &value), RC::NOT_EXIST);
+  }
+  if (num_entries >= 1000) {
+    EXPECT_LT(count_sstable_entries(db), static_cast<size_t>(num_entries * rounds));
+  }
+  ASSERT_TRUE(check_compaction(db));
+}
+
+TEST_P(ObLsmCompactionTest, SubCompactionTest) {
+  // reopen with parallel subcompactions and a compaction rate limit
+  delete db;
+  filesystem::remove_all(path);
+  filesystem::create_directory(path);
+  options.max_subcompactions    = 4;
+  options.compaction_rate_limit = 16 * 1024 * 1024;
+  ASSERT_EQ(ObLsm::open(options, path, &db), RC::SUCCESS);
+
+  const int num_entries = GetParam();
+  const int num_threads = 4;
+  vector<thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([this, t, num_entries]() {
+      // every key is written twice, the second value wins
+      for (int round = 0; round < 2; round++) {
+        for (int i = t; i < num_entries; i += num_threads) {
+          ASSERT_EQ(db->put("key" + to_string(i), "value" + to_string(round) + "_" + to_string(i)), RC::SUCCESS);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  sleep(1);
+
+  for (int i = 0; i < num_entries; i++) {
+    string value;
+    ASSERT_EQ(db->get("key" + to_string(i), &value), RC::SUCCESS);
+    EXPECT_EQ(value, "value1_" + to_string(i));
+  }
+  ObLsmIterator *it    = db->new_iterator(ObLsmReadOptions());
+  int            count = 0;
+  string         last_key;
+  for (it->seek_to_first(); it->valid(); it->next()) {
+    EXPECT_LT(last_key, string(it->key()));
+    last_key = it->key();
+    ++count;
+  }
+  EXPECT_EQ(count, num_entries);
+  delete it;
+  ASSERT_TRUE(check_compaction(db));
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ObLsmCompactionTests,
     ObLsmCompactionTest,
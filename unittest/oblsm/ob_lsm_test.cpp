@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/filesystem.h"
 #include "common/lang/thread.h"
 #include "common/lang/utility.h"
+#include "common/lang/map.h"
 #include "oblsm/include/ob_lsm.h"
 #include "oblsm/ob_lsm_define.h"
 #include "unittest/oblsm/ob_lsm_test_base.h"
@@ -23,7 +24,7 @@ class ObLsmTest : public ObLsmTestBase {
 };
 
 // TODO: add update/delete case
-TEST_P(ObLsmTest, DISABLED_oblsm_test_basic1)
+TEST_P(ObLsmTest, oblsm_test_basic1)
 {
   size_t num_entries = GetParam();
   auto data = KeyValueGenerator::generate_data(num_entries);
@@ -67,7 +68,7 @@ void thread_put(ObLsm *db, int start, int end) {
   }
 }
 
-TEST_P(ObLsmTest, DISABLED_ConcurrentPutAndGetTest) {
+TEST_P(ObLsmTest, ConcurrentPutAndGetTest) {
   const int num_entries = GetParam();
   const int num_threads = 4;
   const int batch_size = num_entries / num_threads;
@@ -104,7 +105,7 @@ TEST_P(ObLsmTest, DISABLED_ConcurrentPutAndGetTest) {
   delete iterator;
 }
 
-TEST_P(ObLsmTest, DISABLED_ConcurrentPutAndRecoverTest) {
+TEST_P(ObLsmTest, ConcurrentPutAndRecoverTest) {
   const int num_entries = GetParam();
   const int num_threads = 4;
   const int batch_size = num_entries / num_threads;
@@ -148,6 +149,146 @@ TEST_P(ObLsmTest, DISABLED_ConcurrentPutAndRecoverTest) {
   delete iterator;
 }
 
+TEST_P(ObLsmTest, WriteBatchTest) {
+  const size_t num_entries = GetParam();
+  auto         data        = KeyValueGenerator::generate_data(num_entries);
+  ASSERT_EQ(db->batch_put(data), RC::SUCCESS);
+
+  // delete the even keys and update the odd keys in one batch
+  ObWriteBatch batch;
+  for (size_t i = 0; i < num_entries; ++i) {
+    if (i % 2 == 0) {
+      batch.remove(data[i].first);
+    } else {
+      batch.put(data[i].first, "new_value" + to_string(i));
+    }
+  }
+  ASSERT_EQ(batch.count(), num_entries);
+  ASSERT_EQ(db->write(batch), RC::SUCCESS);
+
+  auto check = [&]() {
+    for (size_t i = 0; i < num_entries; ++i) {
+      string value;
+      if (i % 2 == 0) {
+        ASSERT_NE(db->get(data[i].first, &value), RC::SUCCESS);
+      } else {
+        ASSERT_EQ(db->get(data[i].first, &value), RC::SUCCESS);
+        EXPECT_EQ(value, "new_value" + to_string(i));
+      }
+    }
+  };
+  check();
+
+  delete db;
+  ASSERT_EQ(ObLsm::open(this->options, this->path, &db), RC::SUCCESS);
+  check();
+}
+
+TEST_P(ObLsmTest, SnapshotTest) {
+  const size_t num_entries = GetParam();
+  auto         data        = KeyValueGenerator::generate_data(num_entries);
+  ASSERT_EQ(db->batch_put(data), RC::SUCCESS);
+
+  const ObLsmSnapshot *snapshot = db->get_snapshot();
+  ASSERT_NE(snapshot, nullptr);
+
+  // delete the even keys and update the odd keys after the snapshot
+  for (size_t i = 0; i < num_entries; ++i) {
+    if (i % 2 == 0) {
+      ASSERT_EQ(db->remove(data[i].first), RC::SUCCESS);
+    } else {
+      ASSERT_EQ(db->put(data[i].first, "new_value" + to_string(i)), RC::SUCCESS);
+    }
+  }
+
+  ObLsmReadOptions snapshot_options;
+  snapshot_options.snapshot = snapshot;
+  for (size_t i = 0; i < num_entries; ++i) {
+    string value;
+    ASSERT_EQ(db->get(snapshot_options, data[i].first, &value), RC::SUCCESS);
+    EXPECT_EQ(value, data[i].second);
+    if (i % 2 == 0) {
+      ASSERT_NE(db->get(data[i].first, &value), RC::SUCCESS);
+    } else {
+      ASSERT_EQ(db->get(data[i].first, &value), RC::SUCCESS);
+      EXPECT_EQ(value, "new_value" + to_string(i));
+    }
+  }
+
+  map<string, string> expected(data.begin(), data.end());
+  ObLsmIterator      *iterator = db->new_iterator(snapshot_options);
+  size_t              count    = 0;
+  for (iterator->seek_to_first(); iterator->valid(); iterator->next()) {
+    EXPECT_EQ(iterator->value(), expected[string(iterator->key())]);
+    ++count;
+  }
+  EXPECT_EQ(count, num_entries);
+  // seek twice, the second seek must not depend on the first one
+  iterator->seek(data.back().first);
+  ASSERT_TRUE(iterator->valid());
+  iterator->seek(data.front().first);
+  ASSERT_TRUE(iterator->valid());
+  EXPECT_EQ(iterator->key(), data.front().first);
+  EXPECT_EQ(iterator->value(), data.front().second);
+  delete iterator;
+
+  iterator = db->new_iterator(ObLsmReadOptions());
+  count    = 0;
+  for (iterator->seek_to_first(); iterator->valid(); iterator->next()) {
+    ++count;
+  }
+  EXPECT_EQ(count, num_entries / 2);
+  delete iterator;
+
+  db->release_snapshot(snapshot);
+}
+
+TEST_P(ObLsmTest, WriteStallTest) {
+  // a small memtable and only one immutable memtable, so the writers often wait for the flush
+  delete db;
+  filesystem::remove_all(path);
+  filesystem::create_directory(path);
+  options.memtable_size           = 4 * 1024;
+  options.max_immutable_memtables = 1;
+  ASSERT_EQ(ObLsm::open(options, path, &db), RC::SUCCESS);
+
+  const size_t   num_entries = GetParam();
+  const size_t   num_threads = 4;
+  auto           data        = KeyValueGenerator::generate_data(num_entries);
+  vector<thread> threads;
+  for (size_t t = 0; t < num_threads; ++t) {
+    threads.emplace_back([this, t, &data]() {
+      for (size_t i = t; i < data.size(); i += num_threads) {
+        ASSERT_EQ(db->put(data[i].first, data[i].second), RC::SUCCESS);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (const auto &[key, value] : data) {
+    string got;
+    ASSERT_EQ(db->get(key, &got), RC::SUCCESS);
+    EXPECT_EQ(got, value);
+  }
+
+  // every write group is slowed down if level 0 is always over the trigger
+  delete db;
+  options.level0_slowdown_writes_trigger = 0;
+  options.slowdown_delay_us              = 100;
+  ASSERT_EQ(ObLsm::open(options, path, &db), RC::SUCCESS);
+  const size_t num_delayed = std::min<size_t>(num_entries, 1000);
+  for (size_t i = 0; i < num_delayed; ++i) {
+    ASSERT_EQ(db->put(data[i].first, "new_" + data[i].second), RC::SUCCESS);
+  }
+  ObLsmWriteStallStats stats = db->write_stall_stats();
+  EXPECT_EQ(stats.slowdown_count, num_delayed);
+  EXPECT_GE(stats.slowdown_us, num_delayed * options.slowdown_delay_us);
+  string got;
+  ASSERT_EQ(db->get(data[0].first, &got), RC::SUCCESS);
+  EXPECT_EQ(got, "new_" + data[0].second);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     ObLsmTests,
     ObLsmTest,
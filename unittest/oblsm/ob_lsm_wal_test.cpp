@@ -20,7 +20,7 @@ See the Mulan PSL v2 for more details. */
 
 using namespace oceanbase;
 
-TEST(wal, DISABLED_basic_test)
+TEST(wal, basic_test)
 {
   filesystem::remove_all("oblsm_tmp");
   filesystem::create_directory("oblsm_tmp");
@@ -53,7 +53,42 @@ TEST(wal, DISABLED_basic_test)
   EXPECT_EQ(p, count);
 }
 
-TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_small_amount_of_data)
+TEST(wal, write_batch_test)
+{
+  filesystem::remove_all("oblsm_tmp");
+  filesystem::create_directory("oblsm_tmp");
+  auto rw_file = filesystem::path("oblsm_tmp") / "tmp.wal";
+  WAL  wal;
+  ASSERT_EQ(wal.open(rw_file), RC::SUCCESS);
+
+  ObWriteBatch batch1;
+  batch1.put("key1", "val1");
+  batch1.remove("key2");
+  ObWriteBatch batch2;
+  batch2.put("key3", "val3");
+  batch2.put("key4", "val4");
+
+  std::string records;
+  WAL::encode(10, batch1, &records);
+  size_t first_size = records.size();
+  WAL::encode(12, batch2, &records);
+  // the second batch is cut off in the middle, as if the process crashed while writing it
+  ASSERT_EQ(wal.append(std::string_view(records).substr(0, records.size() - 3)), RC::SUCCESS);
+  ASSERT_EQ(wal.sync(), RC::SUCCESS);
+  ASSERT_GT(records.size() - 3, first_size);
+
+  std::vector<WalRecord> wal_records;
+  ASSERT_EQ(wal.recover(rw_file, wal_records), RC::SUCCESS);
+  ASSERT_EQ(wal_records.size(), 2);
+  EXPECT_EQ(wal_records[0].seq, 10);
+  EXPECT_EQ(wal_records[0].key, "key1");
+  EXPECT_EQ(wal_records[0].val, "val1");
+  EXPECT_EQ(wal_records[1].seq, 11);
+  EXPECT_EQ(wal_records[1].key, "key2");
+  EXPECT_EQ(wal_records[1].val, "");
+}
+
+TEST(oblsm_wal_test, oblsm_recover_with_small_amount_of_data)
 {
   filesystem::remove_all("oblsm_tmp");
   filesystem::create_directory("oblsm_tmp");
@@ -87,7 +122,7 @@ TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_small_amount_of_data)
   delete lsm;
 }
 
-TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_single_thread)
+TEST(oblsm_wal_test, oblsm_recover_with_single_thread)
 {
   filesystem::remove_all("oblsm_tmp");
   filesystem::create_directory("oblsm_tmp");
@@ -121,7 +156,7 @@ TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_single_thread)
   delete lsm;
 }
 
-TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_concurrent_put_no_sync)
+TEST(oblsm_wal_test, oblsm_recover_with_concurrent_put_no_sync)
 {
   filesystem::remove_all("oblsm_tmp");
   filesystem::create_directory("oblsm_tmp");
@@ -169,7 +204,7 @@ TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_concurrent_put_no_sync)
   delete lsm;
 }
 
-TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_concurrent_put_sync)
+TEST(oblsm_wal_test, oblsm_recover_with_concurrent_put_sync)
 {
   filesystem::remove_all("oblsm_tmp");
   filesystem::create_directory("oblsm_tmp");
@@ -217,6 +252,54 @@ TEST(oblsm_wal_test, DISABLED_oblsm_recover_with_concurrent_put_sync)
   delete lsm;
 }
 
+TEST(oblsm_wal_test, oblsm_group_commit_recover_without_flush)
+{
+  filesystem::remove_all("oblsm_tmp");
+  filesystem::create_directory("oblsm_tmp");
+  ObLsmOptions options;
+  options.force_sync_new_log = true;
+
+  ObLsm *lsm = nullptr;
+  ASSERT_EQ(ObLsm::open(options, "oblsm_tmp", &lsm), RC::SUCCESS);
+
+  // the concurrent puts are written as groups, every put returns after its group is synced
+  const int                kv_count     = 2000;
+  const int                thread_count = 8;
+  std::vector<std::thread> threads;
+  for (auto i = 0; i < thread_count; ++i) {
+    threads.emplace_back([i, lsm]() {
+      for (auto j = 0; j < kv_count; ++j) {
+        int seq = i * kv_count + j;
+        ASSERT_EQ(lsm->put("key" + std::to_string(seq), "val" + std::to_string(seq)), RC::SUCCESS);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  delete lsm;
+
+  // the data is all in the memtable, reopen recovers it from the wal
+  lsm = nullptr;
+  ASSERT_EQ(ObLsm::open(options, "oblsm_tmp", &lsm), RC::SUCCESS);
+  for (int seq = 0; seq < kv_count * thread_count; ++seq) {
+    std::string value;
+    ASSERT_EQ(lsm->get("key" + std::to_string(seq), &value), RC::SUCCESS);
+    EXPECT_EQ(value, "val" + std::to_string(seq));
+  }
+  ASSERT_EQ(lsm->put("key_after_recover", "val"), RC::SUCCESS);
+  delete lsm;
+
+  lsm = nullptr;
+  ASSERT_EQ(ObLsm::open(options, "oblsm_tmp", &lsm), RC::SUCCESS);
+  std::string value;
+  ASSERT_EQ(lsm->get("key_after_recover", &value), RC::SUCCESS);
+  EXPECT_EQ(value, "val");
+  ASSERT_EQ(lsm->get("key0", &value), RC::SUCCESS);
+  EXPECT_EQ(value, "val0");
+  delete lsm;
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
@@ -31,7 +31,7 @@ struct Comparator {
   }
 };
 
-TEST(skiplist_test, DISABLED_skiplist_test_basic)
+TEST(skiplist_test, skiplist_test_basic)
 {
   common::RandomGenerator rnd;
   const int N = 2000;
@@ -267,8 +267,39 @@ static void RunConcurrentInsert(int write_parallelism = 4) {
   }
 }
 
-TEST_F(InlineSkipTest, DISABLED_ConcurrentInsert2) { RunConcurrentInsert(2); }
-TEST_F(InlineSkipTest, DISABLED_ConcurrentInsert3) { RunConcurrentInsert(4); }
+TEST(skiplist_test, skiplist_test_insert_concurrently)
+{
+  const int                   thread_num = 8;
+  const Key                   count      = 20000;
+  ObSkipList<Key, Comparator> list(Comparator{});
+  std::vector<std::thread>    threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&list, t]() {
+      // the keys of the threads interleave, so they are linked next to each other
+      for (Key i = 0; i < count; i++) {
+        list.insert_concurrently(i * thread_num + t);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  ObSkipList<Key, Comparator>::Iterator iter(&list);
+  iter.seek_to_first();
+  for (Key expected = 0; expected < count * thread_num; expected++) {
+    ASSERT_TRUE(iter.valid());
+    ASSERT_EQ(iter.key(), expected);
+    iter.next();
+  }
+  ASSERT_FALSE(iter.valid());
+  for (Key i = 0; i < count * thread_num; i += 97) {
+    ASSERT_TRUE(list.contains(i));
+  }
+}
+
+TEST_F(InlineSkipTest, ConcurrentInsert2) { RunConcurrentInsert(2); }
+TEST_F(InlineSkipTest, ConcurrentInsert3) { RunConcurrentInsert(4); }
 
 int main(int argc, char **argv)
 {
@@ -11,13 +11,17 @@ See the Mulan PSL v2 for more details. */
 #include "gtest/gtest.h"
 
 #include "common/lang/filesystem.h"
+#include "common/lang/fstream.h"
+#include "common/lang/random.h"
+#include "oblsm/util/ob_compression.h"
+#include "oblsm/util/ob_coding.h"
 #include "oblsm/util/ob_comparator.h"
 #include "oblsm/table/ob_sstable_builder.h"
 #include "oblsm/table/ob_sstable.h"
 
 using namespace oceanbase;
 
-TEST(table_test, DISABLED_table_test_basic)
+TEST(table_test, table_test_basic)
 {
   ObDefaultComparator comparator;
   shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
@@ -40,6 +44,201 @@ TEST(table_test, DISABLED_table_test_basic)
 
 }
 
+TEST(table_test, table_test_bloom_filter)
+{
+  ObDefaultComparator    comparator;
+  shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
+  uint64_t               seq   = 0;
+  const int              count = 2000;
+  for (int i = 0; i < count; i++) {
+    string key("key_" + to_string(i * 2));
+    table->put(seq++, key, "v1");
+    table->put(seq++, key, "v2");
+  }
+  table->put(seq++, "key_0", "");  // delete
+
+  ObSSTableBuilder tb(&comparator, nullptr, 10);
+  ASSERT_EQ(tb.build(table, "bloom_filter_test.sst", 0), RC::SUCCESS);
+  ASSERT_NE(tb.get_built_table(), nullptr);
+
+  // reopen the table, the filter is loaded from the file
+  shared_ptr<ObSSTable> sst = make_shared<ObSSTable>(0, "bloom_filter_test.sst", &comparator, nullptr);
+  ASSERT_EQ(sst->init(), RC::SUCCESS);
+  ASSERT_GT(sst->block_count(), 1);
+
+  string value;
+  ASSERT_EQ(sst->get(seq, "key_0", &value), RC::NOT_EXIST);
+  ASSERT_EQ(sst->get(1, "key_0", &value), RC::SUCCESS);
+  ASSERT_EQ(value, "v2");
+  ASSERT_EQ(sst->get(0, "key_0", &value), RC::SUCCESS);
+  ASSERT_EQ(value, "v1");
+  for (int i = 1; i < count; i++) {
+    string key("key_" + to_string(i * 2));
+    ASSERT_TRUE(sst->may_contain(key));
+    ASSERT_EQ(sst->get(seq, key, &value), RC::SUCCESS);
+    ASSERT_EQ(value, "v2");
+  }
+
+  // most of the missing keys in the key range are rejected by the filter
+  int false_positive = 0;
+  for (int i = 0; i < count; i++) {
+    string key("key_" + to_string(i * 2 + 1));
+    if (sst->may_contain(key)) {
+      false_positive++;
+    }
+    ASSERT_EQ(sst->get(seq, key, &value), RC::NOTFOUND);
+  }
+  ASSERT_LT(false_positive, count * 2 / 100);
+
+  // table without filter
+  ObSSTableBuilder no_filter_tb(&comparator, nullptr, 0);
+  ASSERT_EQ(no_filter_tb.build(table, "no_filter_test.sst", 1), RC::SUCCESS);
+  shared_ptr<ObSSTable> no_filter_sst = no_filter_tb.get_built_table();
+  ASSERT_NE(no_filter_sst, nullptr);
+  ASSERT_TRUE(no_filter_sst->may_contain("key_1"));
+  ASSERT_EQ(no_filter_sst->get(seq, "key_1", &value), RC::NOTFOUND);
+  ASSERT_EQ(no_filter_sst->get(seq, "key_2", &value), RC::SUCCESS);
+
+  filesystem::remove("bloom_filter_test.sst");
+  filesystem::remove("no_filter_test.sst");
+}
+
+TEST(table_test, table_test_block_cache)
+{
+  ObDefaultComparator    comparator;
+  shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
+  uint64_t               seq   = 0;
+  const int              count = 1000;
+  for (int i = 0; i < count; i++) {
+    string key("key_" + to_string(i));
+    table->put(seq++, key, string(100, 'v'));
+  }
+
+  ObLRUCache<uint64_t, shared_ptr<ObBlock>> cache(64 * 1024, 4);
+  ObSSTableBuilder                          tb(&comparator, &cache);
+  ASSERT_EQ(tb.build(table, "block_cache_test.sst", 0), RC::SUCCESS);
+  shared_ptr<ObSSTable> sst = tb.get_built_table();
+  ASSERT_NE(sst, nullptr);
+  ASSERT_GT(sst->block_count() * 4 * 1024, cache.capacity());
+
+  // the first block is read from the file, then from the cache
+  string value;
+  ASSERT_EQ(sst->get(seq, "key_0", &value), RC::SUCCESS);
+  ASSERT_EQ(cache.stats().misses, 1);
+  ASSERT_EQ(sst->get(seq, "key_1", &value), RC::SUCCESS);
+  ASSERT_EQ(cache.stats().hits, 1);
+
+  // a full scan doesn't fit in the cache, the usage is bounded by the capacity in bytes
+  unique_ptr<ObLsmIterator> iter(sst->new_iterator());
+  int                       scanned = 0;
+  for (iter->seek_to_first(); iter->valid(); iter->next()) {
+    scanned++;
+  }
+  ASSERT_EQ(scanned, count);
+  ObLRUCacheStats stats = cache.stats();
+  ASSERT_GT(stats.evictions, 0);
+  ASSERT_LE(stats.usage, cache.capacity());
+
+  sst->remove();
+  ASSERT_EQ(cache.usage(), 0);
+}
+
+TEST(table_test, compression_codec)
+{
+  mt19937        gen(1);
+  vector<string> inputs = {"", "a", "abcabcabcabcabcabc", string(10000, 'x')};
+  string         text;
+  for (int i = 0; i < 2000; i++) {
+    text += "key_" + to_string(i % 97) + "value_" + to_string(gen() % 10);
+  }
+  inputs.push_back(text);
+  string random_data;
+  for (int i = 0; i < 5000; i++) {
+    random_data.push_back(static_cast<char>(gen()));
+  }
+  inputs.push_back(random_data);
+
+  for (CompressionType type : {CompressionType::NONE, CompressionType::LZ4}) {
+    const ObCompressor *compressor = ObCompressor::get(type);
+    ASSERT_NE(compressor, nullptr);
+    for (const string &input : inputs) {
+      string compressed;
+      string output;
+      ASSERT_EQ(compressor->compress(input, &compressed), RC::SUCCESS);
+      ASSERT_EQ(compressor->decompress(compressed, &output), RC::SUCCESS);
+      ASSERT_EQ(output, input);
+    }
+  }
+  ASSERT_EQ(ObCompressor::get(CompressionType::UNKNOWN), nullptr);
+
+  const ObCompressor *lz4 = ObCompressor::get(CompressionType::LZ4);
+  string              compressed;
+  lz4->compress(text, &compressed);
+  ASSERT_LT(compressed.size(), text.size() / 2);
+
+  // broken data is rejected instead of read out of bounds
+  string output;
+  ASSERT_NE(lz4->decompress(string_view(compressed.data(), compressed.size() / 2), &output), RC::SUCCESS);
+  ASSERT_TRUE(output.empty());
+  // 1 literal, then a match 5 bytes back
+  string bad_offset;
+  put_numeric<uint32_t>(&bad_offset, 5);
+  bad_offset.append("\x10"
+                    "a"
+                    "\x05\x00",
+      4);
+  ASSERT_EQ(lz4->decompress(bad_offset, &output), RC::INVALID_ARGUMENT);
+  ASSERT_TRUE(output.empty());
+}
+
+TEST(table_test, table_test_compression)
+{
+  ObDefaultComparator    comparator;
+  shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
+  uint64_t               seq   = 0;
+  const int              count = 2000;
+  for (int i = 0; i < count; i++) {
+    table->put(seq++, "key_" + to_string(i), "value_" + string(100, 'a' + i % 26));
+  }
+
+  ObLRUCache<uint64_t, shared_ptr<ObBlock>> cache(1024 * 1024, 1);
+  ObSSTableBuilder                          lz4_tb(&comparator, &cache);
+  lz4_tb.set_compression(CompressionType::LZ4);
+  ASSERT_EQ(lz4_tb.build(table, "lz4_test.sst", 0), RC::SUCCESS);
+  shared_ptr<ObSSTable> lz4_sst = lz4_tb.get_built_table();
+  ASSERT_NE(lz4_sst, nullptr);
+
+  ObSSTableBuilder none_tb(&comparator, nullptr);
+  none_tb.set_compression(CompressionType::NONE);
+  ASSERT_EQ(none_tb.build(table, "none_test.sst", 1), RC::SUCCESS);
+  shared_ptr<ObSSTable> none_sst = none_tb.get_built_table();
+  ASSERT_NE(none_sst, nullptr);
+
+  ASSERT_EQ(lz4_sst->block_count(), none_sst->block_count());
+  ASSERT_LT(lz4_sst->size() * 3, none_sst->size());
+
+  // the cache holds the uncompressed blocks
+  string value;
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(lz4_sst->get(seq, "key_" + to_string(i), &value), RC::SUCCESS);
+    ASSERT_EQ(value, "value_" + string(100, 'a' + i % 26));
+  }
+  ASSERT_GT(cache.usage(), lz4_sst->size());
+
+  // a broken block fails the checksum
+  {
+    fstream file("lz4_test.sst", std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(lz4_sst->block_meta(1).offset_ + 10);
+    file.put('\xff');
+  }
+  shared_ptr<ObSSTable> broken_sst = make_shared<ObSSTable>(0, "lz4_test.sst", &comparator, nullptr);
+  ASSERT_EQ(broken_sst->init(), RC::SUCCESS);
+  ASSERT_NE(broken_sst->read_block(0), nullptr);
+  ASSERT_EQ(broken_sst->read_block(1), nullptr);
+
+  lz4_sst->remove();
+  none_sst->remove();
+}
 
 int main(int argc, char **argv)
 {
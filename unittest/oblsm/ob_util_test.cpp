@@ -15,7 +15,11 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/util/ob_comparator.h"
 #include "oblsm/util/ob_file_reader.h"
 #include "oblsm/util/ob_file_writer.h"
+#include "oblsm/util/ob_rate_limiter.h"
+#include "common/lang/chrono.h"
 #include "common/lang/filesystem.h"
+#include "common/lang/thread.h"
+#include "common/lang/vector.h"
 
 using namespace oceanbase;
 
@@ -49,6 +53,38 @@ TEST(util_test, DISABLED_rw_file) {
   remove("tmpfile");
 }
 
+TEST(util_test, rate_limiter)
+{
+  // 1MB per second, refilled every 10ms
+  const int64_t rate = 1024 * 1024;
+  ObRateLimiter limiter(rate, 10 * 1000);
+
+  // 4 threads write 256KB in total, which takes about 250ms
+  auto           begin = chrono::steady_clock::now();
+  vector<thread> threads;
+  for (int i = 0; i < 4; i++) {
+    threads.emplace_back([&limiter]() {
+      for (int j = 0; j < 16; j++) {
+        limiter.request(4 * 1024);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  int64_t elapsed_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin).count();
+  EXPECT_EQ(limiter.total_bytes(), 256 * 1024);
+  EXPECT_GE(elapsed_ms, 200);
+  EXPECT_LT(elapsed_ms, 2000);
+
+  // a request larger than the bucket is served in several periods
+  limiter.set_bytes_per_second(rate * 4);
+  begin = chrono::steady_clock::now();
+  limiter.request(rate);
+  elapsed_ms = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - begin).count();
+  EXPECT_GE(elapsed_ms, 200);
+  EXPECT_LT(elapsed_ms, 2000);
+}
 
 int main(int argc, char **argv)
 {
@@ -10,13 +10,14 @@ See the Mulan PSL v2 for more details. */
 
 #include <chrono>
 #include <iostream>
+#include <map>
 
 #include "gtest/gtest.h"
 #include "sql/expr/aggregate_hash_table.h"
 
 using namespace std;
 
-TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
+TEST(AggregateHashTableTest, standard_hash_table)
 {
   // single group by column, single aggregate column
   {
@@ -24,15 +25,17 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
     Chunk                   aggr_chunk;
     std::unique_ptr<Column> column1 = std::make_unique<Column>(AttrType::INTS, 4);
     std::unique_ptr<Column> column2 = std::make_unique<Column>(AttrType::INTS, 4);
+    std::map<int, int>      expected;
     for (int i = 0; i < 1023; i++) {
       int key = i % 8;
       column1->append_one((char *)&key);
       column2->append_one((char *)&i);
+      expected[key] += i;
     }
     group_chunk.add_column(std::move(column1), 0);
     aggr_chunk.add_column(std::move(column2), 1);
 
-    AggregateExpr             aggregate_expr(AggregateExpr::Type::SUM, nullptr);
+    AggregateExpr aggregate_expr(AggregateExpr::Type::SUM, std::make_unique<ValueExpr>(Value(0)));
     std::vector<Expression *> aggregate_exprs;
     aggregate_exprs.push_back(&aggregate_expr);
     auto standard_hash_table = std::make_unique<StandardAggregateHashTable>(aggregate_exprs);
@@ -48,9 +51,10 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
     ASSERT_EQ(rc, RC::SUCCESS);
     ASSERT_EQ(output_chunk.rows(), 8);
     for (int i = 0; i < 8; i++) {
-      std::cout << "column1: " << output_chunk.get_value(1, i).get_string() << " "
-                << "sum(column2)" << output_chunk.get_value(0, i).get_string() << std::endl;
+      ASSERT_EQ(output_chunk.get_value(1, i).get_int(), expected[output_chunk.get_value(0, i).get_int()]);
     }
+    output_chunk.reset_data();
+    ASSERT_EQ(scanner.next(output_chunk), RC::RECORD_EOF);
   }
   // mutiple group by columns, mutiple aggregate columns
   {
@@ -61,24 +65,31 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
 
     std::unique_ptr<Column> aggr1 = std::make_unique<Column>(AttrType::FLOATS, 4);
     std::unique_ptr<Column> aggr2 = std::make_unique<Column>(AttrType::INTS, 4);
+    std::map<std::pair<std::string, int>, std::pair<float, int>> expected;
     for (int i = 0; i < 1023; i++) {
       float i_float  = i + 0.5;
-      int   i_group2 = i % 8;
+      int   i_group2 = i % 4;
+      // 字符串 '\0' 之后的内容不同，仍然属于同一个分组
+      char str[4] = {static_cast<char>('0' + i % 8), 0, static_cast<char>(i), static_cast<char>(i >> 8)};
 
-      group1->append_one((char *)std::to_string(i % 8).c_str());
+      group1->append_one(str);
       group2->append_one((char *)&i_group2);
       aggr1->append_one((char *)&i_float);
       aggr2->append_one((char *)&i);
+      auto &sums = expected[{std::string(1, str[0]), i_group2}];
+      sums.first += i_float;
+      sums.second += i;
     }
     group_chunk.add_column(std::move(group1), 0);
     group_chunk.add_column(std::move(group2), 1);
     aggr_chunk.add_column(std::move(aggr1), 0);
     aggr_chunk.add_column(std::move(aggr2), 1);
 
-    AggregateExpr             aggregate_expr(AggregateExpr::Type::SUM, nullptr);
+    AggregateExpr aggregate_expr1(AggregateExpr::Type::SUM, std::make_unique<ValueExpr>(Value(0.0f)));
+    AggregateExpr aggregate_expr2(AggregateExpr::Type::SUM, std::make_unique<ValueExpr>(Value(0)));
     std::vector<Expression *> aggregate_exprs;
-    aggregate_exprs.push_back(&aggregate_expr);
-    aggregate_exprs.push_back(&aggregate_expr);
+    aggregate_exprs.push_back(&aggregate_expr1);
+    aggregate_exprs.push_back(&aggregate_expr2);
     auto standard_hash_table = std::make_unique<StandardAggregateHashTable>(aggregate_exprs);
     RC   rc                  = standard_hash_table->add_chunk(group_chunk, aggr_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
@@ -87,24 +98,64 @@ TEST(AggregateHashTableTest, DISABLED_standard_hash_table)
         make_unique<Column>(group_chunk.column(0).attr_type(), group_chunk.column(0).attr_len()), 0);
     output_chunk.add_column(
         make_unique<Column>(group_chunk.column(1).attr_type(), group_chunk.column(1).attr_len()), 1);
-    output_chunk.add_column(make_unique<Column>(aggr_chunk.column(0).attr_type(), aggr_chunk.column(0).attr_len()), 1);
-    output_chunk.add_column(make_unique<Column>(aggr_chunk.column(1).attr_type(), aggr_chunk.column(1).attr_len()), 2);
+    output_chunk.add_column(make_unique<Column>(aggr_chunk.column(0).attr_type(), aggr_chunk.column(0).attr_len()), 2);
+    output_chunk.add_column(make_unique<Column>(aggr_chunk.column(1).attr_type(), aggr_chunk.column(1).attr_len()), 3);
     StandardAggregateHashTable::Scanner scanner(standard_hash_table.get());
     scanner.open_scan();
     rc = scanner.next(output_chunk);
     ASSERT_EQ(rc, RC::SUCCESS);
     ASSERT_EQ(output_chunk.rows(), 8);
     for (int i = 0; i < 8; i++) {
-      std::cout << "group1: " << output_chunk.get_value(0, i).get_string() << " "
-                << "group2: " << output_chunk.get_value(1, i).get_string() << " "
-                << "sum(aggr1): " << output_chunk.get_value(2, i).get_string() << " "
-                << "sum(aggr2): " << output_chunk.get_value(3, i).get_string() << std::endl;
+      auto iter = expected.find({output_chunk.get_value(0, i).get_string(), output_chunk.get_value(1, i).get_int()});
+      ASSERT_NE(iter, expected.end());
+      ASSERT_FLOAT_EQ(output_chunk.get_value(2, i).get_float(), iter->second.first);
+      ASSERT_EQ(output_chunk.get_value(3, i).get_int(), iter->second.second);
+    }
+  }
+  // groups more than the output chunk, the hash table resizes several times
+  {
+    const int group_num = Chunk::MAX_ROWS * 2 + 10;
+    AggregateExpr aggregate_expr(AggregateExpr::Type::COUNT, std::make_unique<ValueExpr>(Value(1)));
+    StandardAggregateHashTable standard_hash_table({&aggregate_expr});
+    for (int round = 0; round < 2; round++) {
+      for (int begin = 0; begin < group_num; begin += Chunk::MAX_ROWS) {
+        Chunk group_chunk;
+        Chunk aggr_chunk;
+        auto  group = std::make_unique<Column>(AttrType::INTS, 4);
+        for (int i = begin; i < std::min(begin + Chunk::MAX_ROWS, group_num); i++) {
+          group->append_one((char *)&i);
+        }
+        auto one = std::make_unique<Column>();
+        one->init(Value(1), group->count());
+        group_chunk.add_column(std::move(group), 0);
+        aggr_chunk.add_column(std::move(one), 0);
+        ASSERT_EQ(standard_hash_table.add_chunk(group_chunk, aggr_chunk), RC::SUCCESS);
+      }
+    }
+    ASSERT_EQ(standard_hash_table.size(), static_cast<size_t>(group_num));
+
+    Chunk output_chunk;
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 0);
+    output_chunk.add_column(make_unique<Column>(AttrType::INTS, 4), 1);
+    StandardAggregateHashTable::Scanner scanner(&standard_hash_table);
+    scanner.open_scan();
+    int next_key = 0;
+    RC  rc       = RC::SUCCESS;
+    while (OB_SUCC(rc = scanner.next(output_chunk))) {
+      for (int i = 0; i < output_chunk.rows(); i++, next_key++) {
+        // 按插入顺序输出
+        ASSERT_EQ(output_chunk.get_value(0, i).get_int(), next_key);
+        ASSERT_EQ(output_chunk.get_value(1, i).get_int(), 2);
+      }
+      output_chunk.reset_data();
     }
+    ASSERT_EQ(rc, RC::RECORD_EOF);
+    ASSERT_EQ(next_key, group_num);
   }
 }
 
 #ifdef USE_SIMD
-TEST(AggregateHashTableTest, DISABLED_linear_probing_hash_table)
+TEST(AggregateHashTableTest, linear_probing_hash_table)
 {
   // simple case
   {
@@ -106,6 +106,55 @@ TEST(ArithmeticTest, arithmetic_test)
 #endif
 }
 
+TEST(ArithmeticTest, null_aware_operators)
+{
+  // 第 i 行在 i % 5 == 0 时为 NULL，NULL 行的除数为 0，不能参与计算
+  const int        size = 100;
+  std::vector<int> a(size, 0);
+  std::vector<int> b(size, 0);
+  std::vector<uint8_t> a_nulls((size + 7) / 8, 0);
+  for (int i = 0; i < size; i++) {
+    a[i] = i * 2;
+    b[i] = i % 5 == 0 ? 0 : 2;
+    if (i % 5 == 0) {
+      a_nulls[i / 8] |= 1 << (i % 8);
+    }
+  }
+
+  std::vector<uint8_t> nulls((size + 7) / 8, 0);
+  merge_nulls<false, false>(a_nulls.data(), nullptr, nulls.data(), size);
+  ASSERT_EQ(nulls, a_nulls);
+
+  std::vector<int> result(size, -1);
+  binary_operator_with_nulls<false, false, int, DivideOperator>(a.data(), b.data(), result.data(), size, nulls.data());
+  for (int i = 0; i < size; i++) {
+    ASSERT_EQ(result[i], i % 5 == 0 ? 0 : i);
+  }
+
+  // 没有 NULL 时与 binary_operator 相同
+  binary_operator_with_nulls<false, true, int, SubtractOperator>(a.data(), b.data() + 1, result.data(), size, nullptr);
+  for (int i = 0; i < size; i++) {
+    ASSERT_EQ(result[i], i * 2 - 2);
+  }
+
+  // 常量为 NULL 时所有结果都是 NULL
+  uint8_t constant_null = 1;
+  merge_nulls<true, false>(&constant_null, nullptr, nulls.data(), size);
+  for (int i = 0; i < size; i++) {
+    ASSERT_TRUE((nulls[i / 8] >> (i % 8)) & 1);
+  }
+
+  // NULL 参与的比较结果都为 0
+  std::vector<uint8_t> select(size, 1);
+  compare_result<int, false, false>(a.data(), a.data(), size, select, CompOp::EQUAL_TO);
+  filter_nulls<false>(a_nulls.data(), size, select);
+  for (int i = 0; i < size; i++) {
+    ASSERT_EQ(select[i], i % 5 == 0 ? 0 : 1);
+  }
+  filter_nulls<true>(&constant_null, size, select);
+  ASSERT_EQ(std::count(select.begin(), select.end(), 1), 0);
+}
+
 int main(int argc, char **argv)
 {
 
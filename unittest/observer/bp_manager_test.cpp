@@ -125,6 +125,47 @@ TEST(test_frame_manager, test_frame_manager_simple_lru)
   frame_manager.cleanup();
 }
 
+TEST(test_frame_manager, test_frame_manager_scan_resistant)
+{
+  BPFrameManager frame_manager("Test");
+  frame_manager.init(1);
+
+  const int buffer_pool_id = 0;
+  auto      purger         = [](Frame *) { return RC::SUCCESS; };
+
+  // 访问过两次的页面进入热链表
+  const PageNum hot_page_num = 8;
+  for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    ASSERT_NE(frame, nullptr);
+    ASSERT_EQ(frame, frame_manager.get(buffer_pool_id, page_num));
+    frame->unpin();
+    frame->unpin();
+  }
+
+  // 模拟全表扫描，每个页面只访问一次
+  for (PageNum page_num = hot_page_num; page_num < hot_page_num + 10000; page_num++) {
+    Frame *frame = frame_manager.alloc(buffer_pool_id, page_num);
+    while (frame == nullptr) {
+      ASSERT_GT(frame_manager.purge_frames(1, purger), 0);
+      frame = frame_manager.alloc(buffer_pool_id, page_num);
+    }
+    frame->unpin();
+  }
+
+  for (PageNum page_num = 0; page_num < hot_page_num; page_num++) {
+    Frame *frame = frame_manager.get(buffer_pool_id, page_num);
+    ASSERT_NE(frame, nullptr);
+    frame->unpin();
+  }
+
+  // 所有页面都可以淘汰掉
+  while (frame_manager.frame_num() > 0) {
+    ASSERT_GT(frame_manager.purge_frames(16, purger), 0);
+  }
+  ASSERT_EQ(RC::SUCCESS, frame_manager.cleanup());
+}
+
 int main(int argc, char **argv)
 {
 
@@ -60,6 +60,105 @@ TEST(ChunkTest, chunk_test)
   }
 }
 
+TEST(ChunkTest, selection)
+{
+  const int row_num = 10;
+  Chunk     chunk;
+  chunk.add_column(std::make_unique<Column>(AttrType::INTS, sizeof(int), row_num), 0);
+  for (int i = 0; i < row_num; i++) {
+    chunk.column(0).append_one((char *)&i);
+  }
+  ASSERT_EQ(chunk.selection(), nullptr);
+  ASSERT_EQ(chunk.selected_rows(), row_num);
+
+  // 全部选中时不记录选择向量
+  chunk.select(vector<uint8_t>(row_num, 1));
+  ASSERT_EQ(chunk.selection(), nullptr);
+
+  // 选中偶数行
+  vector<uint8_t> select(row_num, 0);
+  for (int i = 0; i < row_num; i += 2) {
+    select[i] = 1;
+  }
+  chunk.select(select);
+  ASSERT_NE(chunk.selection(), nullptr);
+  ASSERT_EQ(chunk.rows(), row_num);
+  ASSERT_EQ(chunk.selected_rows(), row_num / 2);
+  for (int i = 0; i < chunk.selected_rows(); i++) {
+    ASSERT_EQ(chunk.get_value(0, chunk.row_index(i)).get_int(), i * 2);
+  }
+
+  // 再次过滤，结果是两次过滤的交集：0, 6
+  vector<uint8_t> select2(row_num, 0);
+  for (int i = 0; i < row_num; i += 3) {
+    select2[i] = 1;
+  }
+  chunk.select(select2);
+  ASSERT_EQ(chunk.selected_rows(), 2);
+  ASSERT_EQ(chunk.row_index(0), 0);
+  ASSERT_EQ(chunk.row_index(1), 6);
+
+  // 引用和复制都保留选择向量
+  Chunk chunk2;
+  chunk2.reference(chunk);
+  ASSERT_EQ(chunk2.selected_rows(), 2);
+  ASSERT_EQ(chunk2.row_index(1), 6);
+  Chunk chunk3(chunk);
+  ASSERT_EQ(chunk3.selected_rows(), 2);
+
+  chunk.reset_data();
+  ASSERT_EQ(chunk.selection(), nullptr);
+  ASSERT_EQ(chunk.selected_rows(), 0);
+}
+
+TEST(ChunkTest, nulls)
+{
+  const int row_num = 20;
+  Column    column(AttrType::INTS, sizeof(int), row_num);
+  ASSERT_FALSE(column.has_nulls());
+  ASSERT_EQ(column.nulls(), nullptr);
+
+  // 每 3 行有一个 NULL
+  for (int i = 0; i < row_num; i++) {
+    if (i % 3 == 0) {
+      ASSERT_EQ(column.append_null(), RC::SUCCESS);
+    } else {
+      ASSERT_EQ(column.append_one((char *)&i), RC::SUCCESS);
+    }
+  }
+  ASSERT_TRUE(column.has_nulls());
+  for (int i = 0; i < row_num; i++) {
+    ASSERT_EQ(column.is_null(i), i % 3 == 0);
+    if (i % 3 == 0) {
+      ASSERT_EQ(column.get_value(i).attr_type(), AttrType::UNDEFINED);
+    } else {
+      ASSERT_EQ(column.get_value(i).get_int(), i);
+    }
+  }
+
+  // 引用共享空值位图，复制会复制空值位图
+  Column reference;
+  reference.reference(column);
+  ASSERT_EQ(reference.nulls(), column.nulls());
+  Column copy(column);
+  ASSERT_NE(copy.nulls(), column.nulls());
+  for (int i = 0; i < row_num; i++) {
+    ASSERT_EQ(copy.is_null(i), i % 3 == 0);
+  }
+
+  // 修改引用的位图不会影响原来的列
+  uint8_t *nulls = reference.mutable_nulls();
+  nulls[0] &= ~1;
+  ASSERT_FALSE(reference.is_null(0));
+  ASSERT_TRUE(column.is_null(0));
+
+  column.reset_data();
+  ASSERT_FALSE(column.has_nulls());
+  int value = 1;
+  column.append_one((char *)&value);
+  ASSERT_FALSE(column.is_null(0));
+}
+
 int main(int argc, char **argv)
 {
 
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include <filesystem>
+#include <thread>
 
 #include "gtest/gtest.h"
 #include "common/log/log.h"
@@ -132,6 +133,128 @@ TEST(BufferPool, create)
   ASSERT_EQ(buffer_pool->id(), buffer_pool2->id());
 }
 
+TEST(DiskBufferPool, write_pages_and_concurrent_load)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "write_pages.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  const int page_num = 64;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  // 绕过 frame 直接把连续的页面一次写到文件中
+  vector<Page>   pages(page_num);
+  vector<Page *> page_ptrs;
+  for (int i = 0; i < page_num; i++) {
+    memset(&pages[i], 0, sizeof(Page));
+    memcpy(pages[i].data, &i, sizeof(i));
+    page_ptrs.push_back(&pages[i]);
+  }
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->purge_all_pages());
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->write_pages(1, page_ptrs));
+
+  // 多个线程同时加载同一个文件中的页面
+  vector<thread> threads;
+  atomic<int>    error_count{0};
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([buffer_pool, &error_count, t]() {
+      for (int i = 0; i < page_num; i++) {
+        int    index = (i + t * 16) % page_num;
+        Frame *frame = nullptr;
+        if (buffer_pool->get_this_page(index + 1, &frame) != RC::SUCCESS) {
+          error_count++;
+          continue;
+        }
+
+        frame->read_latch();
+        int value = -1;
+        memcpy(&value, frame->data(), sizeof(value));
+        frame->read_unlatch();
+        if (value != index) {
+          error_count++;
+        }
+        buffer_pool->unpin_page(frame);
+      }
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(0, error_count.load());
+
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
+TEST(DiskBufferPool, read_ahead)
+{
+  filesystem::path test_directory("buffer_pool");
+  filesystem::path bp_file = test_directory / "read_ahead.bp";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(bp_file.c_str()));
+
+  VacuousLogHandler log_handler;
+  DiskBufferPool   *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, bp_file.c_str(), buffer_pool));
+
+  const int page_num = 64;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    memcpy(frame->data(), &i, sizeof(i));
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+  // 释放一些页面，预读时要跳过它们
+  for (int i = 10; i < 20; i++) {
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->dispose_page(i + 1));
+  }
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->purge_all_pages());
+
+  BPFrameManager &frame_manager = bpm.get_frame_manager();
+  ASSERT_FALSE(frame_manager.contains(buffer_pool->id(), 5));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->prefetch_page(5));
+  ASSERT_TRUE(frame_manager.contains(buffer_pool->id(), 5));
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->prefetch_page(5));
+
+  // 开启预读之后，遍历的结果不变
+  BufferPoolIterator iterator;
+  ASSERT_EQ(RC::SUCCESS, iterator.init(*buffer_pool, 1, 8));
+  vector<PageNum> page_nums;
+  while (iterator.has_next()) {
+    page_nums.push_back(iterator.next());
+  }
+  ASSERT_EQ(page_num - 10, static_cast<int>(page_nums.size()));
+
+  for (PageNum page_num : page_nums) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(page_num, &frame));
+    int value = -1;
+    memcpy(&value, frame->data(), sizeof(value));
+    ASSERT_EQ(page_num - 1, value);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool->read_ahead(page_nums));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(bp_file.c_str()));
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #include <memory>
 
 #include "sql/expr/expression.h"
+#include "sql/expr/aggregate_state.h"
 #include "sql/expr/tuple.h"
 #include "gtest/gtest.h"
 
@@ -339,6 +340,72 @@ TEST(AggregateExpr, aggregate_expr_test)
   ASSERT_EQ(RC::INVALID_ARGUMENT, AggregateExpr::type_from_string("invalid type", aggr_type));
 }
 
+TEST(Expression, nulls)
+{
+  // col1 的第 i 行在 i % 4 == 0 时为 NULL
+  const int count   = 100;
+  const int int_len = sizeof(int);
+  auto      column  = std::make_unique<Column>(AttrType::INTS, int_len, count);
+  for (int i = 0; i < count; ++i) {
+    if (i % 4 == 0) {
+      column->append_null();
+    } else {
+      column->append_one((char *)&i);
+    }
+  }
+  Chunk chunk;
+  chunk.add_column(std::move(column), 0);
+  FieldMeta field_meta("col1", AttrType::INTS, 0, int_len, true, 0);
+  Field     field(nullptr, &field_meta);
+
+  // NULL 参与的算术运算结果为 NULL
+  ArithmeticExpr add_expr(
+      ArithmeticExpr::Type::ADD, std::make_unique<FieldExpr>(field), std::make_unique<ValueExpr>(Value(1)));
+  Column add_result;
+  ASSERT_EQ(add_expr.get_column(chunk, add_result), RC::SUCCESS);
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(add_result.is_null(i), i % 4 == 0);
+    if (i % 4 != 0) {
+      ASSERT_EQ(add_result.get_value(i).get_int(), i + 1);
+    }
+  }
+
+  // NULL 参与的比较结果不为真
+  ComparisonExpr       cmp_expr(CompOp::GREAT_EQUAL, std::make_unique<FieldExpr>(field), std::make_unique<ValueExpr>(Value(0)));
+  std::vector<uint8_t> select(count, 1);
+  ASSERT_EQ(cmp_expr.eval(chunk, select), RC::SUCCESS);
+  for (int i = 0; i < count; ++i) {
+    ASSERT_EQ(select[i], i % 4 == 0 ? 0 : 1);
+  }
+
+  // 聚合忽略 NULL 值
+  int expected_sum   = 0;
+  int expected_count = 0;
+  for (int i = 0; i < count; ++i) {
+    if (i % 4 != 0) {
+      expected_sum += i;
+      expected_count++;
+    }
+  }
+  SumState<int>   sum;
+  CountState<int> count_state;
+  AvgState<int>   avg;
+  ASSERT_EQ(RC::SUCCESS, aggregate_state_update_by_column(&sum, AggregateExpr::Type::SUM, AttrType::INTS, chunk.column(0)));
+  ASSERT_EQ(RC::SUCCESS,
+      aggregate_state_update_by_column(&count_state, AggregateExpr::Type::COUNT, AttrType::INTS, chunk.column(0)));
+  ASSERT_EQ(RC::SUCCESS, aggregate_state_update_by_column(&avg, AggregateExpr::Type::AVG, AttrType::INTS, chunk.column(0)));
+  ASSERT_EQ(sum.value, expected_sum);
+  ASSERT_EQ(count_state.value, expected_count);
+  ASSERT_EQ(avg.count, expected_count);
+
+  // 带选择向量：只聚合前 10 行，其中 0、4、8 为 NULL
+  vector<int>   selection{0, 1, 2, 3, 4, 5, 6, 7, 8, 9};
+  SumState<int> selected_sum;
+  ASSERT_EQ(RC::SUCCESS,
+      aggregate_state_update_by_column(&selected_sum, AggregateExpr::Type::SUM, AttrType::INTS, chunk.column(0), &selection));
+  ASSERT_EQ(selected_sum.value, 1 + 2 + 3 + 5 + 6 + 7 + 9);
+}
+
 int main(int argc, char **argv)
 {
 
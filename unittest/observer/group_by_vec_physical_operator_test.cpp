@@ -0,0 +1,273 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <map>
+
+#include "gtest/gtest.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/group_by_vec_physical_operator.h"
+
+using namespace std;
+
+/// 依次输出给定 chunk 的算子，作为 group by 的下层算子
+class ChunkSourceOperator : public PhysicalOperator
+{
+public:
+  explicit ChunkSourceOperator(vector<Chunk> &&chunks) : chunks_(std::move(chunks)) {}
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::TABLE_SCAN_VEC; }
+
+  RC open(Trx *trx) override
+  {
+    pos_ = 0;
+    return RC::SUCCESS;
+  }
+  RC next(Chunk &chunk) override
+  {
+    if (pos_ >= chunks_.size()) {
+      return RC::RECORD_EOF;
+    }
+    return chunk.reference(chunks_[pos_++]);
+  }
+  RC close() override { return RC::SUCCESS; }
+
+private:
+  vector<Chunk> chunks_;
+  size_t        pos_ = 0;
+};
+
+class GroupByVecTest : public testing::Test
+{
+public:
+  /// 表 (id int, name char(4), val int, score float)
+  void SetUp() override
+  {
+    id_meta_    = FieldMeta("id", AttrType::INTS, 0, 4, true, 0);
+    name_meta_  = FieldMeta("name", AttrType::CHARS, 4, 4, true, 1);
+    val_meta_   = FieldMeta("val", AttrType::INTS, 8, 4, true, 2);
+    score_meta_ = FieldMeta("score", AttrType::FLOATS, 12, 4, true, 3);
+  }
+
+  /// 第 i 行为 (key_func(i), "n" + 'a' + i % 3, i, 0.5)
+  Chunk make_chunk(int begin, int end, int (*key_func)(int))
+  {
+    auto id    = make_unique<Column>(AttrType::INTS, 4);
+    auto name  = make_unique<Column>(AttrType::CHARS, 4);
+    auto val   = make_unique<Column>(AttrType::INTS, 4);
+    auto score = make_unique<Column>(AttrType::FLOATS, 4);
+    for (int i = begin; i < end; i++) {
+      int   key         = key_func(i);
+      char  name_buf[4] = {'n', static_cast<char>('a' + (i % 3)), 0, 0};
+      float score_val   = 0.5;
+      id->append_one((char *)&key);
+      name->append_one(name_buf);
+      val->append_one((char *)&i);
+      score->append_one((char *)&score_val);
+    }
+    Chunk chunk;
+    chunk.add_column(std::move(id), 0);
+    chunk.add_column(std::move(name), 1);
+    chunk.add_column(std::move(val), 2);
+    chunk.add_column(std::move(score), 3);
+    return chunk;
+  }
+
+  unique_ptr<Expression> field_expr(const FieldMeta &meta) { return make_unique<FieldExpr>(nullptr, &meta); }
+
+  /// 执行算子，返回所有输出行
+  vector<vector<Value>> run(PhysicalOperator &oper)
+  {
+    vector<vector<Value>> rows;
+    EXPECT_EQ(RC::SUCCESS, oper.open(nullptr));
+    Chunk chunk;
+    RC    rc = RC::SUCCESS;
+    while (OB_SUCC(rc = oper.next(chunk))) {
+      EXPECT_GT(chunk.rows(), 0);
+      for (int i = 0; i < chunk.rows(); i++) {
+        vector<Value> row;
+        for (int j = 0; j < chunk.column_num(); j++) {
+          row.push_back(chunk.get_value(j, i));
+        }
+        rows.push_back(std::move(row));
+      }
+    }
+    EXPECT_EQ(RC::RECORD_EOF, rc);
+    EXPECT_EQ(RC::SUCCESS, oper.close());
+    return rows;
+  }
+
+protected:
+  FieldMeta id_meta_;
+  FieldMeta name_meta_;
+  FieldMeta val_meta_;
+  FieldMeta score_meta_;
+};
+
+TEST_F(GroupByVecTest, single_int_key_sum)
+{
+  // 包含负数键和 -1（线性探测哈希表的空槽位标记）
+  auto key_func = [](int i) { return i % 100 - 50; };
+
+  vector<Chunk> chunks;
+  const int     rows_per_chunk = 3000;
+  for (int c = 0; c < 3; c++) {
+    chunks.push_back(make_chunk(c * rows_per_chunk, (c + 1) * rows_per_chunk, key_func));
+  }
+  map<int, int> expected;
+  for (int i = 0; i < 3 * rows_per_chunk; i++) {
+    expected[key_func(i)] += i;
+  }
+
+  vector<unique_ptr<Expression>> group_by;
+  group_by.push_back(field_expr(id_meta_));
+  auto                 sum = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, field_expr(val_meta_));
+  vector<Expression *> aggregates{sum.get()};
+
+  GroupByVecPhysicalOperator oper(std::move(group_by), std::move(aggregates));
+  oper.add_child(make_unique<ChunkSourceOperator>(std::move(chunks)));
+
+  vector<vector<Value>> rows = run(oper);
+  ASSERT_EQ(rows.size(), expected.size());
+  map<int, int> actual;
+  for (auto &row : rows) {
+    ASSERT_EQ(row.size(), 2);
+    ASSERT_EQ(actual.count(row[0].get_int()), 0);
+    actual[row[0].get_int()] = row[1].get_int();
+  }
+  ASSERT_EQ(actual, expected);
+}
+
+TEST_F(GroupByVecTest, multi_keys_multi_aggregates)
+{
+  auto key_func = [](int i) { return i % 4; };
+
+  vector<Chunk> chunks;
+  chunks.push_back(make_chunk(0, 1000, key_func));
+  chunks.push_back(make_chunk(1000, 1200, key_func));
+
+  vector<unique_ptr<Expression>> group_by;
+  group_by.push_back(field_expr(id_meta_));
+  group_by.push_back(field_expr(name_meta_));
+  auto sum   = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, field_expr(score_meta_));
+  auto count = make_unique<AggregateExpr>(AggregateExpr::Type::COUNT, make_unique<ValueExpr>(Value(1)));
+  auto avg   = make_unique<AggregateExpr>(AggregateExpr::Type::AVG, field_expr(val_meta_));
+  vector<Expression *> aggregates{sum.get(), count.get(), avg.get()};
+
+  GroupByVecPhysicalOperator oper(std::move(group_by), std::move(aggregates));
+  oper.add_child(make_unique<ChunkSourceOperator>(std::move(chunks)));
+
+  // (id, name) 共 12 组
+  map<pair<int, string>, vector<int>> expected;
+  for (int i = 0; i < 1200; i++) {
+    string name = string("n") + static_cast<char>('a' + (i % 3));
+    expected[{key_func(i), name}].push_back(i);
+  }
+
+  vector<vector<Value>> rows = run(oper);
+  ASSERT_EQ(rows.size(), expected.size());
+  for (auto &row : rows) {
+    ASSERT_EQ(row.size(), 5);
+    auto iter = expected.find({row[0].get_int(), row[1].get_string()});
+    ASSERT_NE(iter, expected.end());
+    const vector<int> &vals    = iter->second;
+    float              avg_val = 0;
+    for (int v : vals) {
+      avg_val += v;
+    }
+    avg_val /= vals.size();
+    ASSERT_FLOAT_EQ(row[2].get_float(), 0.5 * vals.size());
+    ASSERT_EQ(row[3].get_int(), static_cast<int>(vals.size()));
+    ASSERT_FLOAT_EQ(row[4].get_float(), avg_val);
+    expected.erase(iter);
+  }
+}
+
+TEST_F(GroupByVecTest, groups_more_than_chunk)
+{
+  // 分组数超过一个 chunk 的容量，结果分多个 chunk 输出
+  const int     group_num = Chunk::MAX_ROWS * 2 + 100;
+  vector<Chunk> chunks;
+  for (int begin = 0; begin < group_num; begin += Chunk::MAX_ROWS) {
+    chunks.push_back(make_chunk(begin, std::min(begin + Chunk::MAX_ROWS, group_num), [](int i) { return i; }));
+  }
+
+  vector<unique_ptr<Expression>> group_by;
+  group_by.push_back(field_expr(id_meta_));
+  auto                 sum = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, field_expr(val_meta_));
+  vector<Expression *> aggregates{sum.get()};
+
+  GroupByVecPhysicalOperator oper(std::move(group_by), std::move(aggregates));
+  oper.add_child(make_unique<ChunkSourceOperator>(std::move(chunks)));
+
+  vector<vector<Value>> rows = run(oper);
+  ASSERT_EQ(rows.size(), group_num);
+  for (auto &row : rows) {
+    ASSERT_EQ(row[0].get_int(), row[1].get_int());
+  }
+}
+
+TEST_F(GroupByVecTest, selection)
+{
+  // 下层算子只选中 i % 3 != 0 的行
+  auto          key_func = [](int i) { return i % 10; };
+  vector<Chunk> chunks;
+  for (int c = 0; c < 2; c++) {
+    Chunk           chunk = make_chunk(c * 1000, (c + 1) * 1000, key_func);
+    vector<uint8_t> select(chunk.rows());
+    for (int i = 0; i < chunk.rows(); i++) {
+      select[i] = (c * 1000 + i) % 3 != 0;
+    }
+    chunk.select(select);
+    chunks.push_back(std::move(chunk));
+  }
+  map<int, pair<int, int>> expected;  // key -> (sum, count)
+  for (int i = 0; i < 2000; i++) {
+    if (i % 3 != 0) {
+      expected[key_func(i)].first += i;
+      expected[key_func(i)].second++;
+    }
+  }
+
+  vector<unique_ptr<Expression>> group_by;
+  group_by.push_back(field_expr(id_meta_));
+  auto sum   = make_unique<AggregateExpr>(AggregateExpr::Type::SUM, field_expr(val_meta_));
+  auto count = make_unique<AggregateExpr>(AggregateExpr::Type::COUNT, make_unique<ValueExpr>(Value(1)));
+  vector<Expression *> aggregates{sum.get(), count.get()};
+
+  GroupByVecPhysicalOperator oper(std::move(group_by), std::move(aggregates));
+  oper.add_child(make_unique<ChunkSourceOperator>(std::move(chunks)));
+
+  vector<vector<Value>> rows = run(oper);
+  ASSERT_EQ(rows.size(), expected.size());
+  for (auto &row : rows) {
+    auto iter = expected.find(row[0].get_int());
+    ASSERT_NE(iter, expected.end());
+    ASSERT_EQ(row[1].get_int(), iter->second.first);
+    ASSERT_EQ(row[2].get_int(), iter->second.second);
+  }
+}
+
+TEST_F(GroupByVecTest, empty_input)
+{
+  vector<unique_ptr<Expression>> group_by;
+  group_by.push_back(field_expr(name_meta_));
+  auto                 count = make_unique<AggregateExpr>(AggregateExpr::Type::COUNT, field_expr(val_meta_));
+  vector<Expression *> aggregates{count.get()};
+
+  GroupByVecPhysicalOperator oper(std::move(group_by), std::move(aggregates));
+  oper.add_child(make_unique<ChunkSourceOperator>(vector<Chunk>()));
+  ASSERT_TRUE(run(oper).empty());
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
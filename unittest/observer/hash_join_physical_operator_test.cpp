@@ -0,0 +1,232 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/hash_join_physical_operator.h"
+#include "sql/operator/nested_loop_join_physical_operator.h"
+#include "sql/operator/predicate_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+
+class HashJoinTest : public testing::Test
+{
+public:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(test_directory_);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("test_db", test_directory_.c_str(), "vacuous", "vacuous"));
+    trx_ = db_->trx_kit().create_trx(db_->log_handler());
+    ASSERT_NE(trx_, nullptr);
+  }
+
+  void TearDown() override
+  {
+    db_->trx_kit().destroy_trx(trx_);
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  /// 创建一个两列的表 (id int, val int)，并插入 (key_func(i), i)
+  Table *create_table(const char *name, int row_num, int (*key_func)(int))
+  {
+    vector<AttrInfoSqlNode> attr_infos(2);
+    attr_infos[0].name   = "id";
+    attr_infos[1].name   = "val";
+    for (AttrInfoSqlNode &attr_info : attr_infos) {
+      attr_info.type   = AttrType::INTS;
+      attr_info.length = 4;
+    }
+    EXPECT_EQ(RC::SUCCESS, db_->create_table(name, attr_infos, {}));
+
+    Table *table = db_->find_table(name);
+    EXPECT_NE(table, nullptr);
+    for (int i = 0; i < row_num; i++) {
+      Value  values[2] = {Value(key_func(i)), Value(i)};
+      Record record;
+      EXPECT_EQ(RC::SUCCESS, table->make_record(2, values, record));
+      EXPECT_EQ(RC::SUCCESS, trx_->insert_record(table, record));
+    }
+    return table;
+  }
+
+  unique_ptr<Expression> field_expr(Table *table, const char *field_name)
+  {
+    return make_unique<FieldExpr>(table, table->table_meta().field(field_name));
+  }
+
+  int count_rows(PhysicalOperator &oper, vector<string> *rows = nullptr)
+  {
+    EXPECT_EQ(RC::SUCCESS, oper.open(trx_));
+    int count = 0;
+    RC  rc    = RC::SUCCESS;
+    while (OB_SUCC(rc = oper.next())) {
+      count++;
+      if (rows != nullptr) {
+        rows->push_back(oper.current_tuple()->to_string());
+      }
+    }
+    EXPECT_EQ(RC::RECORD_EOF, rc);
+    EXPECT_EQ(RC::SUCCESS, oper.close());
+    return count;
+  }
+
+protected:
+  filesystem::path test_directory_ = "hash_join_test_dir";
+  unique_ptr<Db>   db_;
+  Trx             *trx_ = nullptr;
+};
+
+TEST_F(HashJoinTest, single_key)
+{
+  // 左表 id 唯一，右表每个 id 出现 3 次，还有一部分 id 在左表中不存在
+  Table *left  = create_table("t1", 100, [](int i) { return i; });
+  Table *right = create_table("t2", 450, [](int i) { return i / 3; });
+
+  for (bool build_left : {true, false}) {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    left_keys.push_back(field_expr(left, "id"));
+    right_keys.push_back(field_expr(right, "id"));
+
+    HashJoinPhysicalOperator hash_join(std::move(left_keys), std::move(right_keys), build_left);
+    hash_join.add_child(make_unique<TableScanPhysicalOperator>(left, ReadWriteMode::READ_ONLY));
+    hash_join.add_child(make_unique<TableScanPhysicalOperator>(right, ReadWriteMode::READ_ONLY));
+
+    vector<string> rows;
+    ASSERT_EQ(300, count_rows(hash_join, &rows));
+
+    // 输出的列总是左表在前
+    for (const string &row : rows) {
+      int left_id = -1, left_val = -1, right_id = -1, right_val = -1;
+      ASSERT_EQ(4, sscanf(row.c_str(), "%d, %d, %d, %d", &left_id, &left_val, &right_id, &right_val));
+      ASSERT_EQ(left_id, right_id);
+      ASSERT_EQ(left_id, left_val);
+      ASSERT_EQ(right_id, right_val / 3);
+    }
+  }
+}
+
+TEST_F(HashJoinTest, multi_keys_same_as_nested_loop)
+{
+  Table *left  = create_table("t1", 200, [](int i) { return i % 17; });
+  Table *right = create_table("t2", 150, [](int i) { return i % 13; });
+
+  vector<unique_ptr<Expression>> left_keys;
+  vector<unique_ptr<Expression>> right_keys;
+  left_keys.push_back(field_expr(left, "id"));
+  right_keys.push_back(field_expr(right, "id"));
+  left_keys.push_back(field_expr(left, "val"));
+  right_keys.push_back(field_expr(right, "val"));
+
+  HashJoinPhysicalOperator hash_join(std::move(left_keys), std::move(right_keys), false /*build_left*/);
+  hash_join.add_child(make_unique<TableScanPhysicalOperator>(left, ReadWriteMode::READ_ONLY));
+  hash_join.add_child(make_unique<TableScanPhysicalOperator>(right, ReadWriteMode::READ_ONLY));
+  vector<string> hash_join_rows;
+  int            hash_join_count = count_rows(hash_join, &hash_join_rows);
+
+  auto nlj = make_unique<NestedLoopJoinPhysicalOperator>();
+  nlj->add_child(make_unique<TableScanPhysicalOperator>(left, ReadWriteMode::READ_ONLY));
+  nlj->add_child(make_unique<TableScanPhysicalOperator>(right, ReadWriteMode::READ_ONLY));
+
+  vector<unique_ptr<Expression>> conditions;
+  conditions.push_back(
+      make_unique<ComparisonExpr>(CompOp::EQUAL_TO, field_expr(left, "id"), field_expr(right, "id")));
+  conditions.push_back(
+      make_unique<ComparisonExpr>(CompOp::EQUAL_TO, field_expr(left, "val"), field_expr(right, "val")));
+  PredicatePhysicalOperator predicate(make_unique<ConjunctionExpr>(ConjunctionExpr::Type::AND, conditions));
+  predicate.add_child(std::move(nlj));
+  vector<string> nlj_rows;
+  int            nlj_count = count_rows(predicate, &nlj_rows);
+
+  ASSERT_GT(hash_join_count, 0);
+  ASSERT_EQ(nlj_count, hash_join_count);
+  sort(hash_join_rows.begin(), hash_join_rows.end());
+  sort(nlj_rows.begin(), nlj_rows.end());
+  ASSERT_EQ(nlj_rows, hash_join_rows);
+}
+
+TEST_F(HashJoinTest, empty_build_side)
+{
+  Table *left  = create_table("t1", 0, [](int i) { return i; });
+  Table *right = create_table("t2", 10, [](int i) { return i; });
+
+  vector<unique_ptr<Expression>> left_keys;
+  vector<unique_ptr<Expression>> right_keys;
+  left_keys.push_back(field_expr(left, "id"));
+  right_keys.push_back(field_expr(right, "id"));
+
+  HashJoinPhysicalOperator hash_join(std::move(left_keys), std::move(right_keys), true /*build_left*/);
+  hash_join.add_child(make_unique<TableScanPhysicalOperator>(left, ReadWriteMode::READ_ONLY));
+  hash_join.add_child(make_unique<TableScanPhysicalOperator>(right, ReadWriteMode::READ_ONLY));
+  ASSERT_EQ(0, count_rows(hash_join));
+}
+
+TEST_F(HashJoinTest, spill_to_disk)
+{
+  // 左表的键分布很散，右表有很多重复的键，内存上限只够放下很少的数据
+  Table *left  = create_table("t1", 2000, [](int i) { return i % 700; });
+  Table *right = create_table("t2", 3000, [](int i) { return i % 500; });
+
+  auto make_hash_join = [&](bool build_left, int64_t memory_budget) {
+    vector<unique_ptr<Expression>> left_keys;
+    vector<unique_ptr<Expression>> right_keys;
+    left_keys.push_back(field_expr(left, "id"));
+    right_keys.push_back(field_expr(right, "id"));
+
+    auto hash_join = make_unique<HashJoinPhysicalOperator>(std::move(left_keys), std::move(right_keys), build_left);
+    hash_join->set_memory_budget(memory_budget);
+    hash_join->set_spill_directory(test_directory_.string());
+    hash_join->add_child(make_unique<TableScanPhysicalOperator>(left, ReadWriteMode::READ_ONLY));
+    hash_join->add_child(make_unique<TableScanPhysicalOperator>(right, ReadWriteMode::READ_ONLY));
+    return hash_join;
+  };
+
+  for (bool build_left : {true, false}) {
+    auto           in_memory = make_hash_join(build_left, HashJoinPhysicalOperator::DEFAULT_MEMORY_BUDGET);
+    vector<string> in_memory_rows;
+    int            in_memory_count = count_rows(*in_memory, &in_memory_rows);
+    ASSERT_FALSE(in_memory->spilled());
+
+    // 内存上限很小时会多次重新分区
+    for (int64_t memory_budget : {16 * 1024, 1024}) {
+      auto           spilled = make_hash_join(build_left, memory_budget);
+      vector<string> spilled_rows;
+      int            spilled_count = count_rows(*spilled, &spilled_rows);
+      ASSERT_TRUE(spilled->spilled());
+
+      ASSERT_GT(spilled_count, 0);
+      ASSERT_EQ(in_memory_count, spilled_count);
+      sort(in_memory_rows.begin(), in_memory_rows.end());
+      sort(spilled_rows.begin(), spilled_rows.end());
+      ASSERT_EQ(in_memory_rows, spilled_rows);
+    }
+  }
+
+  // 临时文件在算子关闭后都被删除了
+  for (const auto &entry : filesystem::directory_iterator(test_directory_)) {
+    ASSERT_NE(entry.path().extension(), ".spill");
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
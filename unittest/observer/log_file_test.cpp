@@ -295,6 +295,45 @@ TEST(LogFileManager, init_with_files)
   ASSERT_TRUE(filesystem::remove_all(directory));
 }
 
+TEST(LogFileManager, remove_files_before)
+{
+  const char *directory                 = "remove_files_before";
+  int         max_entry_number_per_file = 1000;
+
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directory(directory));
+
+  LSN lsns[] = {1000, 2000, 3000};
+  for (LSN lsn : lsns) {
+    string   filename = string(LogFileManager::file_prefix_) + to_string(lsn) + LogFileManager::file_suffix_;
+    ofstream ofs(filesystem::path(directory) / filename);
+    ofs.close();
+  }
+
+  LogFileManager manager;
+  ASSERT_EQ(RC::SUCCESS, manager.init(directory, max_entry_number_per_file));
+
+  // 检查点所在的文件不能删除
+  int removed_count = 0;
+  ASSERT_EQ(RC::SUCCESS, manager.remove_files_before(1999, removed_count));
+  ASSERT_EQ(0, removed_count);
+
+  ASSERT_EQ(RC::SUCCESS, manager.remove_files_before(2500, removed_count));
+  ASSERT_EQ(1, removed_count);
+  ASSERT_FALSE(filesystem::exists(filesystem::path(directory) / "clog_1000.log"));
+
+  // 最后一个文件总是保留
+  ASSERT_EQ(RC::SUCCESS, manager.remove_files_before(10000, removed_count));
+  ASSERT_EQ(1, removed_count);
+
+  vector<string> result_files;
+  ASSERT_EQ(RC::SUCCESS, manager.list_files(result_files, 0));
+  ASSERT_EQ(1, result_files.size());
+  ASSERT_EQ("clog_3000.log", filesystem::path(result_files[0]).filename());
+
+  ASSERT_TRUE(filesystem::remove_all(directory));
+}
+
 TEST(LogFileManager, last_file)
 {
   // create an empty directory and try to open last file
@@ -0,0 +1,192 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <limits>
+
+#include "gtest/gtest.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/buffer/page_flusher.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/db/db.h"
+#include "storage/record/record_scanner.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+
+TEST(PageFlusher, flush_in_lsn_order)
+{
+  filesystem::path directory("page_flusher");
+  filesystem::remove_all(directory);
+  filesystem::create_directories(directory);
+  filesystem::path buffer_pool_filename = directory / "buffer_pool.bp";
+
+  // 只有 128 个页帧
+  BufferPoolManager buffer_pool_manager(128 * BP_PAGE_SIZE);
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.init(make_unique<VacuousDoubleWriteBuffer>()));
+  VacuousLogHandler log_handler;
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.create_file(buffer_pool_filename.c_str()));
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.open_file(log_handler, buffer_pool_filename.c_str(), buffer_pool));
+
+  PageFlusherOptions options;
+  options.free_frame_num = 16;
+  PageFlusher flusher(buffer_pool_manager, log_handler, options);
+
+  // 页号越大的页面越早变脏
+  const int     page_num = 8;
+  vector<Frame *> frames;
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    frames.push_back(frame);
+  }
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = frames[i];
+    frame->set_lsn((page_num - i) * 10);
+    frame->clear_dirty();
+    frame->data()[0] = static_cast<char>(i);
+    frame->set_lsn((page_num - i) * 10 + 5);
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  // 文件头页面的 clean_lsn 最小，先把它刷掉
+  int flushed_count = 0;
+  ASSERT_EQ(RC::SUCCESS, flusher.flush_dirty_pages(1, flushed_count));
+  ASSERT_EQ(1, flushed_count);
+
+  BPFrameManager &frame_manager = buffer_pool_manager.get_frame_manager();
+  LSN             recovery_lsn  = 0;
+  ASSERT_TRUE(frame_manager.min_recovery_lsn(recovery_lsn));
+  ASSERT_EQ(11, recovery_lsn);
+
+  ASSERT_EQ(RC::SUCCESS, flusher.flush_dirty_pages(2, flushed_count));
+  ASSERT_EQ(2, flushed_count);
+  ASSERT_FALSE(frames[page_num - 1]->dirty());
+  ASSERT_FALSE(frames[page_num - 2]->dirty());
+  ASSERT_TRUE(frames[page_num - 3]->dirty());
+  ASSERT_TRUE(frame_manager.min_recovery_lsn(recovery_lsn));
+  ASSERT_EQ(31, recovery_lsn);
+
+  ASSERT_EQ(RC::SUCCESS, flusher.flush_dirty_pages(numeric_limits<int>::max(), flushed_count));
+  ASSERT_EQ(page_num - 2, flushed_count);
+  ASSERT_FALSE(frame_manager.min_recovery_lsn(recovery_lsn));
+
+  // 写满缓冲区，后台线程淘汰出一些空闲页帧
+  for (int i = page_num; frame_manager.free_frame_num() > 0; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->allocate_page(&frame));
+    frame->data()[0] = static_cast<char>(i);
+    frame->mark_dirty();
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  int freed_count = 0;
+  ASSERT_EQ(RC::SUCCESS, flusher.reserve_free_frames(freed_count));
+  ASSERT_EQ(options.free_frame_num, freed_count);
+  ASSERT_EQ(options.free_frame_num, frame_manager.free_frame_num());
+
+  // 淘汰的页面可以重新读出来
+  for (int i = 0; i < page_num; i++) {
+    Frame *frame = nullptr;
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->get_this_page(i + 1, &frame));
+    ASSERT_EQ(static_cast<char>(i), frame->data()[0]);
+    ASSERT_EQ(RC::SUCCESS, buffer_pool->unpin_page(frame));
+  }
+
+  ASSERT_EQ(RC::SUCCESS, buffer_pool_manager.close_file(buffer_pool_filename.c_str()));
+  filesystem::remove_all(directory);
+}
+
+static int count_log_files(const filesystem::path &directory)
+{
+  int count = 0;
+  for (const filesystem::directory_entry &entry : filesystem::directory_iterator(directory)) {
+    if (entry.is_regular_file()) {
+      count++;
+    }
+  }
+  return count;
+}
+
+TEST(PageFlusher, checkpoint_and_recover)
+{
+  filesystem::path directory("page_flusher_checkpoint");
+  filesystem::remove_all(directory);
+  filesystem::create_directories(directory);
+
+  const int record_num = 3000;
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test_db", directory.c_str(), "vacuous", "disk"));
+
+    vector<AttrInfoSqlNode> attr_infos(1);
+    attr_infos[0].name   = "id";
+    attr_infos[0].type   = AttrType::INTS;
+    attr_infos[0].length = 4;
+    ASSERT_EQ(RC::SUCCESS, db.create_table("t1", attr_infos, {}));
+    Table *table = db.find_table("t1");
+    ASSERT_NE(nullptr, table);
+
+    for (int i = 0; i < record_num; i++) {
+      Value  value(i);
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table->make_record(1, &value, record));
+      ASSERT_EQ(RC::SUCCESS, table->insert_record(record));
+    }
+
+    // 脏页还没有刷出去，检查点推进不了多少
+    ASSERT_EQ(RC::SUCCESS, db.log_handler().wait_lsn(db.log_handler().current_lsn()));
+    ASSERT_EQ(RC::SUCCESS, db.checkpoint());
+    const int log_file_num = count_log_files(directory / "clog");
+    ASSERT_GT(log_file_num, 2);
+
+    // 刷完脏页之后，检查点之前的日志文件都可以删除
+    PageFlusher flusher(db.buffer_pool_manager(), db.log_handler());
+    int         flushed_count = 0;
+    ASSERT_EQ(RC::SUCCESS, flusher.flush_dirty_pages(numeric_limits<int>::max(), flushed_count));
+    ASSERT_GT(flushed_count, 0);
+    ASSERT_EQ(RC::SUCCESS, db.checkpoint());
+    ASSERT_LT(count_log_files(directory / "clog"), log_file_num);
+    ASSERT_LE(count_log_files(directory / "clog"), 2);
+  }
+
+  // 从检查点开始恢复，数据不会丢失
+  Db db;
+  ASSERT_EQ(RC::SUCCESS, db.init("test_db", directory.c_str(), "vacuous", "disk"));
+  Table *table = db.find_table("t1");
+  ASSERT_NE(nullptr, table);
+
+  Trx           *trx     = db.trx_kit().create_trx(db.log_handler());
+  RecordScanner *scanner = nullptr;
+  ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY));
+  int    count = 0;
+  Record record;
+  while (OB_SUCC(scanner->next(record))) {
+    count++;
+  }
+  ASSERT_EQ(record_num, count);
+  scanner->close_scan();
+  delete scanner;
+  db.trx_kit().destroy_trx(trx);
+
+  filesystem::remove_all(directory);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -347,6 +347,187 @@ TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
   delete bpm;
 }
 
+TEST_P(PaxPageHandlerTestWithParam, get_chunk_projection)
+{
+  int               record_num = GetParam();
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  RC              rc = bpm->create_file(record_manager_file);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  rc = bpm->open_file(log_handler, record_manager_file, bp);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  Frame *frame = nullptr;
+  rc           = bp->allocate_page(&frame);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  const int          record_size        = 12;  // 4 + 4 + 4
+  RecordPageHandler *record_page_handle = new PaxRecordPageHandler();
+  TableMeta          table_meta;
+  table_meta.fields_.resize(3);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::FLOATS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+  table_meta.fields_[2].attr_type_ = AttrType::INTS;
+  table_meta.fields_[2].attr_len_  = 4;
+  table_meta.fields_[2].field_id_  = 2;
+
+  rc = record_page_handle->init_empty_page(*bp, log_handler, frame->page_num(), record_size, &table_meta);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  // 第 i 行为 (i, i + 0.5, i * 10)
+  char buf[record_size];
+  RID  rid;
+  for (int i = 0; i < record_num; i++) {
+    int   col1 = i;
+    float col2 = i + 0.5;
+    int   col3 = i * 10;
+    memcpy(buf, &col1, sizeof(int));
+    memcpy(buf + 4, &col2, sizeof(float));
+    memcpy(buf + 8, &col3, sizeof(int));
+    rc = record_page_handle->insert_record(buf, &rid);
+    ASSERT_EQ(rc, RC::SUCCESS);
+  }
+
+  // 删除偶数槽位
+  for (int i = 0; i < record_num; i += 2) {
+    RID del_rid(frame->page_num(), i);
+    ASSERT_EQ(record_page_handle->delete_record(&del_rid), RC::SUCCESS);
+  }
+  vector<int> expected;
+  for (int i = 1; i < record_num; i += 2) {
+    expected.push_back(i);
+  }
+
+  FieldMeta col3_meta;
+  col3_meta.init("col3", AttrType::INTS, 8, 4, true, 2);
+  for (bool zero_copy : {false, true}) {
+    // 只读取第 3 列
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(col3_meta), 2);
+    rc = record_page_handle->get_chunk(chunk, zero_copy);
+    ASSERT_EQ(rc, RC::SUCCESS);
+    ASSERT_EQ(chunk.column_num(), 1);
+    ASSERT_EQ(chunk.selected_rows(), static_cast<int>(expected.size()));
+    for (int i = 0; i < chunk.selected_rows(); i++) {
+      ASSERT_EQ(chunk.get_value(0, chunk.row_index(i)).get_int(), expected[i] * 10);
+    }
+    if (zero_copy) {
+      // 直接引用页面中的数据，已删除的槽位由选择向量过滤
+      ASSERT_EQ(chunk.rows(), record_num / 2 * 2);
+    } else {
+      ASSERT_EQ(chunk.rows(), static_cast<int>(expected.size()));
+    }
+  }
+
+  rc = record_page_handle->cleanup();
+  ASSERT_EQ(rc, RC::SUCCESS);
+  delete record_page_handle;
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST_P(PaxPageHandlerTestWithParam, insert_chunk_with_nulls)
+{
+  int               record_num = GetParam();
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  RC              rc = bpm->create_file(record_manager_file);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  rc = bpm->open_file(log_handler, record_manager_file, bp);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  Frame *frame = nullptr;
+  rc           = bp->allocate_page(&frame);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  const int          record_size        = 8;  // 4 + 4
+  RecordPageHandler *record_page_handle = new PaxRecordPageHandler();
+  TableMeta          table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_ = AttrType::INTS;
+  table_meta.fields_[0].attr_len_  = 4;
+  table_meta.fields_[0].field_id_  = 0;
+  table_meta.fields_[1].attr_type_ = AttrType::FLOATS;
+  table_meta.fields_[1].attr_len_  = 4;
+  table_meta.fields_[1].field_id_  = 1;
+
+  rc = record_page_handle->init_empty_page(*bp, log_handler, frame->page_num(), record_size, &table_meta);
+  ASSERT_EQ(rc, RC::SUCCESS);
+
+  // 第 i 行为 (i, i + 0.5)，第二列在 i % 3 == 0 时为 NULL
+  FieldMeta col1_meta;
+  FieldMeta col2_meta;
+  col1_meta.init("col1", AttrType::INTS, 0, 4, true, 0);
+  col2_meta.init("col2", AttrType::FLOATS, 4, 4, true, 1);
+  Chunk input;
+  input.add_column(make_unique<Column>(col1_meta), 0);
+  input.add_column(make_unique<Column>(col2_meta), 1);
+  for (int i = 0; i < record_num; i++) {
+    float col2 = i + 0.5;
+    input.column(0).append_one((char *)&i);
+    if (i % 3 == 0) {
+      input.column(1).append_null();
+    } else {
+      input.column(1).append_one((char *)&col2);
+    }
+  }
+  int insert_rows = 0;
+  rc              = record_page_handle->insert_chunk(input, 0, insert_rows);
+  ASSERT_EQ(rc, RC::SUCCESS);
+  ASSERT_EQ(insert_rows, record_num);
+
+  // 按行插入的记录没有 NULL
+  char  buf[record_size];
+  int   col1 = record_num;
+  float col2 = record_num + 0.5;
+  memcpy(buf, &col1, sizeof(int));
+  memcpy(buf + 4, &col2, sizeof(float));
+  RID rid;
+  ASSERT_EQ(record_page_handle->insert_record(buf, &rid), RC::SUCCESS);
+
+  for (bool zero_copy : {false, true}) {
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(col1_meta), 0);
+    chunk.add_column(make_unique<Column>(col2_meta), 1);
+    rc = record_page_handle->get_chunk(chunk, zero_copy);
+    ASSERT_EQ(rc, RC::SUCCESS);
+    ASSERT_EQ(chunk.rows(), record_num + 1);
+    ASSERT_FALSE(chunk.column(0).has_nulls());
+    ASSERT_TRUE(chunk.column(1).has_nulls());
+    for (int i = 0; i <= record_num; i++) {
+      ASSERT_EQ(chunk.get_value(0, i).get_int(), i);
+      ASSERT_EQ(chunk.column(1).is_null(i), i < record_num && i % 3 == 0);
+      if (!chunk.column(1).is_null(i)) {
+        ASSERT_FLOAT_EQ(chunk.get_value(1, i).get_float(), i + 0.5);
+      }
+    }
+  }
+
+  rc = record_page_handle->cleanup();
+  ASSERT_EQ(rc, RC::SUCCESS);
+  delete record_page_handle;
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
 INSTANTIATE_TEST_SUITE_P(PaxFileScannerTests, PaxRecordFileScannerWithParam, testing::Values(1, 10, 100, 1000, 2000, 10000));
 
 INSTANTIATE_TEST_SUITE_P(PaxPageTests, PaxPageHandlerTestWithParam, testing::Values(1, 10, 100, 337));
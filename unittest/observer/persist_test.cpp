@@ -131,6 +131,44 @@ TEST(test_persist, test_persist_file_io)
   ASSERT_EQ(access(file_name_1.c_str(), F_OK), -1);
 }
 
+TEST(test_persist, test_persist_vectored_io)
+{
+  std::string    file_name = "test_persist_vectored_io";
+  PersistHandler persist_handler;
+
+  remove(file_name.c_str());
+  ASSERT_EQ(persist_handler.create_file(file_name.c_str()), RC::SUCCESS);
+  ASSERT_EQ(persist_handler.open_file(), RC::SUCCESS);
+
+  std::string  str_1 = "vectored ";
+  std::string  str_2 = "write ";
+  std::string  str_3 = "and read";
+  struct iovec write_iov[3] = {
+      {(void *)str_1.data(), str_1.size()},
+      {(void *)str_2.data(), str_2.size()},
+      {(void *)str_3.data(), str_3.size()},
+  };
+  ASSERT_EQ(persist_handler.write_at(4, write_iov, 3), RC::SUCCESS);
+
+  // 读到多块内存中，分隔位置与写入时不同
+  char         buf_1[4]       = {0};
+  char         buf_2[MAX_LEN] = {0};
+  const int    total_size     = str_1.size() + str_2.size() + str_3.size();
+  struct iovec read_iov[2]    = {
+      {buf_1, sizeof(buf_1)},
+      {buf_2, static_cast<size_t>(total_size - sizeof(buf_1))},
+  };
+  ASSERT_EQ(persist_handler.read_at(4, read_iov, 2), RC::SUCCESS);
+  ASSERT_EQ(std::string(buf_1, sizeof(buf_1)) + std::string(buf_2), str_1 + str_2 + str_3);
+
+  // 文件中的数据不够时返回 RECORD_EOF
+  read_iov[1].iov_len = MAX_LEN;
+  ASSERT_EQ(persist_handler.read_at(4, read_iov, 2), RC::RECORD_EOF);
+
+  ASSERT_EQ(persist_handler.close_file(), RC::SUCCESS);
+  ASSERT_EQ(persist_handler.remove_file(), RC::SUCCESS);
+}
+
 int main(int argc, char **argv)
 {
 
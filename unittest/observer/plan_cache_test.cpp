@@ -0,0 +1,204 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/predicate_physical_operator.h"
+#include "sql/operator/scalar_group_by_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/plan_cache/plan_cache.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+
+TEST(PlanCache, normalize)
+{
+  string        normalized;
+  vector<Value> params;
+  ASSERT_TRUE(PlanCache::normalize("  select * from t1 where id = 12 and name='abc' and score=1.5;\n", normalized, params));
+  ASSERT_EQ(normalized, "select * from t1 where id = ?i and name=?s and score=?f;");
+  ASSERT_EQ(3, params.size());
+  ASSERT_EQ(AttrType::INTS, params[0].attr_type());
+  ASSERT_EQ(12, params[0].get_int());
+  ASSERT_EQ(AttrType::CHARS, params[1].attr_type());
+  ASSERT_EQ("abc", params[1].get_string());
+  ASSERT_EQ(AttrType::FLOATS, params[2].attr_type());
+  ASSERT_FLOAT_EQ(1.5, params[2].get_float());
+
+  // 只有常量不同的 SQL 得到同样的结果
+  string other;
+  ASSERT_TRUE(PlanCache::normalize("select * from t1 where id = 7 and name=\"x\" and score=0.25;", other, params));
+  ASSERT_EQ(normalized, other);
+
+  // 常量的类型不同时，key 也不同
+  ASSERT_TRUE(PlanCache::normalize("select * from t1 where id = 'a' and name=1 and score=1;", other, params));
+  ASSERT_NE(normalized, other);
+
+  // 标识符中的数字不是常量
+  ASSERT_TRUE(PlanCache::normalize("SELECT a1 from t_2", normalized, params));
+  ASSERT_EQ(normalized, "SELECT a1 from t_2");
+  ASSERT_TRUE(params.empty());
+
+  ASSERT_FALSE(PlanCache::normalize("insert into t1 values(1)", normalized, params));
+  ASSERT_FALSE(PlanCache::normalize("selected", normalized, params));
+  ASSERT_FALSE(PlanCache::normalize("select * from t1 where name='abc", normalized, params));
+}
+
+class PlanCacheTest : public testing::Test
+{
+public:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(test_directory_);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("test_db", test_directory_.c_str(), "vacuous", "vacuous"));
+
+    vector<AttrInfoSqlNode> attr_infos(2);
+    attr_infos[0].name = "id";
+    attr_infos[1].name = "val";
+    for (AttrInfoSqlNode &attr_info : attr_infos) {
+      attr_info.type   = AttrType::INTS;
+      attr_info.length = 4;
+    }
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t1", attr_infos, {}));
+    table_ = db_->find_table("t1");
+    ASSERT_NE(table_, nullptr);
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  /// select * from t1 where id = left and val = right
+  unique_ptr<PhysicalOperator> create_plan(int left, int right)
+  {
+    auto field = [this](const char *name) { return make_unique<FieldExpr>(table_, table_->table_meta().field(name)); };
+
+    vector<unique_ptr<Expression>> conditions;
+    conditions.push_back(
+        make_unique<ComparisonExpr>(CompOp::EQUAL_TO, field("id"), make_unique<ValueExpr>(Value(left))));
+    conditions.push_back(
+        make_unique<ComparisonExpr>(CompOp::EQUAL_TO, field("val"), make_unique<ValueExpr>(Value(right))));
+
+    auto predicate =
+        make_unique<PredicatePhysicalOperator>(make_unique<ConjunctionExpr>(ConjunctionExpr::Type::AND, conditions));
+    predicate->add_child(make_unique<TableScanPhysicalOperator>(table_, ReadWriteMode::READ_ONLY));
+    return predicate;
+  }
+
+protected:
+  filesystem::path test_directory_ = "plan_cache_test_dir";
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+};
+
+TEST_F(PlanCacheTest, bind_params)
+{
+  unique_ptr<PhysicalOperator> plan = create_plan(1, 2);
+
+  vector<vector<Value *>> param_slots;
+  ASSERT_TRUE(PlanCache::bind_params(*plan, {Value(1), Value(2)}, param_slots));
+  ASSERT_EQ(2, param_slots.size());
+  ASSERT_EQ(1, param_slots[0].size());
+  ASSERT_EQ(1, param_slots[1].size());
+
+  CachedPlan cached_plan(std::move(plan), param_slots, false);
+  ASSERT_EQ(RC::SUCCESS, cached_plan.bind({Value(10), Value(20)}));
+  ASSERT_EQ(10, param_slots[0][0]->get_int());
+  ASSERT_EQ(20, param_slots[1][0]->get_int());
+  ASSERT_NE(RC::SUCCESS, cached_plan.bind({Value(10)}));
+
+  // 相同的常量无法区分来源
+  plan = create_plan(3, 3);
+  ASSERT_FALSE(PlanCache::bind_params(*plan, {Value(3), Value(3)}, param_slots));
+
+  // SQL 中的常量没有出现在计划中，比如被常量折叠了
+  plan = create_plan(4, 5);
+  ASSERT_FALSE(PlanCache::bind_params(*plan, {Value(4), Value(2), Value(3)}, param_slots));
+
+  // 计划中的常量不是来自 SQL
+  ASSERT_FALSE(PlanCache::bind_params(*plan, {Value(4)}, param_slots));
+
+  // 类型不同的常量不能匹配
+  ASSERT_FALSE(PlanCache::bind_params(*plan, {Value(4), Value(5.0f)}, param_slots));
+
+  // 聚合算子不能重复执行
+  auto group_by = make_unique<ScalarGroupByPhysicalOperator>(vector<Expression *>());
+  group_by->add_child(create_plan(6, 7));
+  ASSERT_FALSE(PlanCache::bind_params(*group_by, {Value(6), Value(7)}, param_slots));
+}
+
+TEST_F(PlanCacheTest, acquire_and_invalidate)
+{
+  PlanCache &cache = db_->plan_cache();
+  const string key = "select * from t1 where id = ?i and val = ?i";
+
+  uint64_t version = 0;
+  ASSERT_EQ(nullptr, cache.acquire(key, version));
+  ASSERT_EQ(0, cache.hit_count());
+  ASSERT_EQ(1, cache.miss_count());
+
+  vector<vector<Value *>> param_slots;
+  unique_ptr<PhysicalOperator> plan = create_plan(1, 2);
+  ASSERT_TRUE(PlanCache::bind_params(*plan, {Value(1), Value(2)}, param_slots));
+  cache.release(key, make_unique<CachedPlan>(std::move(plan), param_slots, false), version);
+  ASSERT_EQ(1, cache.size());
+
+  unique_ptr<CachedPlan> cached_plan = cache.acquire(key, version);
+  ASSERT_NE(nullptr, cached_plan);
+  ASSERT_EQ(1, cache.hit_count());
+  // 计划正在使用中，不能被其它请求拿到
+  ASSERT_EQ(nullptr, cache.acquire(key, version));
+  ASSERT_EQ(2, cache.miss_count());
+
+  // DDL 之后缓存失效，使用中的计划归还时被丢弃
+  vector<AttrInfoSqlNode> attr_infos(1);
+  attr_infos[0].name   = "id";
+  attr_infos[0].type   = AttrType::INTS;
+  attr_infos[0].length = 4;
+  ASSERT_EQ(RC::SUCCESS, db_->create_table("t2", attr_infos, {}));
+  ASSERT_NE(version, cache.version());
+
+  cache.release(key, std::move(cached_plan), version);
+  ASSERT_EQ(0, cache.size());
+  ASSERT_EQ(nullptr, cache.acquire(key, version));
+}
+
+TEST_F(PlanCacheTest, lru_evict)
+{
+  PlanCache &cache = db_->plan_cache();
+  cache.set_capacity(2);
+
+  uint64_t version = cache.version();
+  for (int i = 0; i < 3; i++) {
+    vector<vector<Value *>> param_slots;
+    unique_ptr<PhysicalOperator> plan = create_plan(1, 2);
+    ASSERT_TRUE(PlanCache::bind_params(*plan, {Value(1), Value(2)}, param_slots));
+    cache.release("key" + to_string(i), make_unique<CachedPlan>(std::move(plan), param_slots, false), version);
+  }
+
+  ASSERT_EQ(2, cache.size());
+  ASSERT_EQ(nullptr, cache.acquire("key0", version));
+  ASSERT_NE(nullptr, cache.acquire("key2", version));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,186 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+
+#include "gtest/gtest.h"
+#include "sql/operator/cached_result_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/query_cache/query_cache.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+
+using namespace std;
+
+class QueryCacheTest : public testing::Test
+{
+public:
+  void SetUp() override
+  {
+    filesystem::remove_all(test_directory_);
+    filesystem::create_directories(test_directory_);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("test_db", test_directory_.c_str(), "vacuous", "vacuous"));
+
+    vector<AttrInfoSqlNode> attr_infos(2);
+    attr_infos[0].name = "id";
+    attr_infos[1].name = "val";
+    for (AttrInfoSqlNode &attr_info : attr_infos) {
+      attr_info.type   = AttrType::INTS;
+      attr_info.length = 4;
+    }
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t1", attr_infos, {}));
+    table_ = db_->find_table("t1");
+    ASSERT_NE(table_, nullptr);
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    filesystem::remove_all(test_directory_);
+  }
+
+  void insert(int id, int val)
+  {
+    Value  values[] = {Value(id), Value(val)};
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table_->make_record(2, values, record));
+    ASSERT_EQ(RC::SUCCESS, table_->insert_record(record));
+  }
+
+  vector<QueryCacheTable> snapshot_tables()
+  {
+    TableScanPhysicalOperator scan(table_, ReadWriteMode::READ_ONLY);
+    vector<QueryCacheTable>   tables;
+    QueryCache::snapshot_tables(scan, tables);
+    return tables;
+  }
+
+  static TupleSchema make_schema()
+  {
+    TupleSchema schema;
+    schema.append_cell("t1", "id");
+    schema.append_cell("t1", "val");
+    return schema;
+  }
+
+protected:
+  filesystem::path test_directory_ = "query_cache_test_dir";
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+};
+
+TEST_F(QueryCacheTest, invalidate_by_modification)
+{
+  QueryCache cache;
+  insert(1, 10);
+
+  vector<QueryCacheTable> tables = snapshot_tables();
+  ASSERT_EQ(1, tables.size());
+  ASSERT_EQ(table_->table_id(), tables[0].table_id);
+  ASSERT_EQ(table_->modify_version(), tables[0].modify_version);
+
+  vector<vector<Value>> rows = {{Value(1), Value(10)}};
+  cache.put("select * from t1", make_shared<const CachedResult>(make_schema(), rows, tables));
+  ASSERT_EQ(1, cache.size());
+
+  shared_ptr<const CachedResult> result = cache.get("select * from t1", *db_);
+  ASSERT_NE(nullptr, result);
+  ASSERT_EQ(1, cache.hit_count());
+  ASSERT_EQ(1, result->rows().size());
+  ASSERT_EQ(nullptr, cache.get("select id from t1", *db_));
+  ASSERT_EQ(1, cache.miss_count());
+
+  // 表被修改之后缓存失效
+  uint64_t version = table_->modify_version();
+  insert(2, 20);
+  ASSERT_NE(version, table_->modify_version());
+  ASSERT_EQ(nullptr, cache.get("select * from t1", *db_));
+  ASSERT_EQ(0, cache.size());
+  ASSERT_EQ(0, cache.memory_size());
+
+  // 表被删除之后缓存失效
+  cache.put("select * from t1", make_shared<const CachedResult>(make_schema(), rows, snapshot_tables()));
+  ASSERT_NE(nullptr, cache.get("select * from t1", *db_));
+  ASSERT_EQ(RC::SUCCESS, db_->drop_table("t1"));
+  ASSERT_EQ(nullptr, cache.get("select * from t1", *db_));
+}
+
+TEST_F(QueryCacheTest, collect_and_replay)
+{
+  QueryCache cache;
+
+  QueryResultCollector collector(cache, "key", snapshot_tables());
+  ValueListTuple       tuple;
+  for (int i = 0; i < 3; i++) {
+    tuple.set_cells({Value(i), Value(i * 10)});
+    ASSERT_TRUE(collector.collect(tuple));
+  }
+  collector.finish(make_schema());
+
+  shared_ptr<const CachedResult> result = cache.get("key", *db_);
+  ASSERT_NE(nullptr, result);
+
+  CachedResultPhysicalOperator oper(result);
+  TupleSchema                  schema;
+  ASSERT_EQ(RC::SUCCESS, oper.tuple_schema(schema));
+  ASSERT_EQ(2, schema.cell_num());
+  ASSERT_STREQ("val", schema.cell_at(1).field_name());
+
+  // 可以重复打开
+  for (int round = 0; round < 2; round++) {
+    ASSERT_EQ(RC::SUCCESS, oper.open(nullptr));
+    int count = 0;
+    while (RC::SUCCESS == oper.next()) {
+      Tuple *current = oper.current_tuple();
+      ASSERT_NE(nullptr, current);
+      Value value;
+      ASSERT_EQ(RC::SUCCESS, current->cell_at(1, value));
+      ASSERT_EQ(count * 10, value.get_int());
+      count++;
+    }
+    ASSERT_EQ(3, count);
+    ASSERT_EQ(RC::SUCCESS, oper.close());
+  }
+}
+
+TEST_F(QueryCacheTest, memory_bound)
+{
+  QueryCache cache;
+  cache.set_capacity(64 * 1024);
+
+  // 太大的结果不收集
+  QueryResultCollector large_collector(cache, "large", snapshot_tables());
+  ValueListTuple       tuple;
+  tuple.set_cells({Value(string(1024, 'a').c_str())});
+  bool collected = true;
+  for (int i = 0; i < 16 && collected; i++) {
+    collected = large_collector.collect(tuple);
+  }
+  ASSERT_FALSE(collected);
+
+  // 按照 LRU 淘汰，总内存不超过容量
+  vector<vector<Value>> rows(8, vector<Value>{Value(string(256, 'b').c_str())});
+  for (int i = 0; i < 64; i++) {
+    cache.put("key" + to_string(i), make_shared<const CachedResult>(make_schema(), rows, snapshot_tables()));
+    ASSERT_LE(cache.memory_size(), cache.capacity());
+  }
+  ASSERT_LT(cache.size(), 64);
+  ASSERT_GT(cache.size(), 0);
+  ASSERT_EQ(nullptr, cache.get("key0", *db_));
+  ASSERT_NE(nullptr, cache.get("key63", *db_));
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}